@@ -425,7 +425,14 @@ void Camera::clearBackground()
 {
     if (_clearBrush)
     {
-        _clearBrush->drawBackground(this);
+        // the depth brush only draws its own quad, the other ones read the camera while drawing
+        auto brush = _clearBrush;
+        auto renderer = _director->getRenderer();
+        renderer->retainForFrame(this);
+        renderer->retainForFrame(brush);
+        renderer->runOnRenderThread([this, brush]() {
+            brush->drawBackground(this);
+        }, brush->getBrushType() != CameraBackgroundBrush::BrushType::DEPTH);
     }
 }
 
@@ -443,8 +450,25 @@ void Camera::setFrameBufferObject(experimental::FrameBuffer *fbo)
 void Camera::apply()
 {
     _viewProjectionUpdated = _transformUpdated;
-    applyFrameBufferObject();
-    applyViewport();
+
+    // frame buffer objects aren't shared with the context of the main thread, it waits for them
+    auto renderer = _director->getRenderer();
+    renderer->retainForFrame(this);
+    if (_fbo)
+    {
+        renderer->runOnRenderThread([this]() {
+            applyFrameBufferObject();
+            applyViewport();
+        }, true);
+    }
+    else
+    {
+        const auto viewport = getDefaultViewport();
+        renderer->runOnRenderThread([this, viewport]() {
+            glGetIntegerv(GL_VIEWPORT, _oldViewport);
+            glViewport(viewport._left, viewport._bottom, viewport._width, viewport._height);
+        });
+    }
 }
 
 void Camera::applyFrameBufferObject()
@@ -483,8 +507,21 @@ void Camera::setViewport(const experimental::Viewport& vp)
 
 void Camera::restore()
 {
-    restoreFrameBufferObject();
-    restoreViewport();
+    auto renderer = _director->getRenderer();
+    renderer->retainForFrame(this);
+    if (_fbo)
+    {
+        renderer->runOnRenderThread([this]() {
+            restoreFrameBufferObject();
+            restoreViewport();
+        }, true);
+    }
+    else
+    {
+        renderer->runOnRenderThread([this]() {
+            restoreViewport();
+        });
+    }
 }
 
 void Camera::restoreFrameBufferObject()
@@ -128,15 +128,15 @@ void CameraBackgroundDepthBrush::drawBackground(Camera* camera)
     GLboolean oldDepthMask;
     {
         glColorMask(_clearColor, _clearColor, _clearColor, _clearColor);
-        glStencilMask(0);
+        GL::stencilMask(0);
         
-        oldDepthTest = glIsEnabled(GL_DEPTH_TEST);
+        oldDepthTest = GL::isEnabled(GL_DEPTH_TEST);
         glGetIntegerv(GL_DEPTH_FUNC, &oldDepthFunc);
-        glGetBooleanv(GL_DEPTH_WRITEMASK, &oldDepthMask);
+        oldDepthMask = GL::getDepthMask();
         
-        glDepthMask(GL_TRUE);
-        glEnable(GL_DEPTH_TEST);
-        glDepthFunc(GL_ALWAYS);
+        GL::depthMask(GL_TRUE);
+        GL::enable(GL_DEPTH_TEST);
+        GL::depthFunc(GL_ALWAYS);
     }
     
     //draw
@@ -168,13 +168,13 @@ void CameraBackgroundDepthBrush::drawBackground(Camera* camera)
     {
         if(GL_FALSE == oldDepthTest)
         {
-            glDisable(GL_DEPTH_TEST);
+            GL::disable(GL_DEPTH_TEST);
         }
-        glDepthFunc(oldDepthFunc);
+        GL::depthFunc(oldDepthFunc);
         
         if(GL_FALSE == oldDepthMask)
         {
-            glDepthMask(GL_FALSE);
+            GL::depthMask(GL_FALSE);
         }
         
         /* IMPORTANT: We only need to update the states that are not restored.
@@ -182,7 +182,7 @@ void CameraBackgroundDepthBrush::drawBackground(Camera* camera)
          after setting it.
          The other values don't need to be updated since they were restored to their original values
          */
-        glStencilMask(0xFFFFF);
+        GL::stencilMask(0xFFFFF);
         //        RenderState::StateBlock::_defaultState->setStencilWrite(0xFFFFF);
         
         /* BUG: RenderState does not support glColorMask yet. */
@@ -258,8 +258,7 @@ CameraBackgroundSkyBoxBrush::~CameraBackgroundSkyBoxBrush()
     
     if (Configuration::getInstance()->supportsShareableVAO())
     {
-        glDeleteVertexArrays(1, &_vao);
-        GL::bindVAO(0);
+        GL::deleteVertexArrays(1, &_vao);
         _vao = 0;
     }
 }
@@ -310,22 +309,22 @@ void CameraBackgroundSkyBoxBrush::drawBackground(Camera* camera)
     
     _glProgramState->apply(Mat4::IDENTITY);
     
-    glEnable(GL_DEPTH_TEST);
+    GL::enable(GL_DEPTH_TEST);
     RenderState::StateBlock::_defaultState->setDepthTest(true);
     
-    glDepthMask(GL_TRUE);
+    GL::depthMask(GL_TRUE);
     RenderState::StateBlock::_defaultState->setDepthWrite(true);
     
-    glDepthFunc(GL_ALWAYS);
+    GL::depthFunc(GL_ALWAYS);
     RenderState::StateBlock::_defaultState->setDepthFunction(RenderState::DEPTH_ALWAYS);
     
-    glEnable(GL_CULL_FACE);
+    GL::enable(GL_CULL_FACE);
     RenderState::StateBlock::_defaultState->setCullFace(true);
     
-    glCullFace(GL_BACK);
+    GL::cullFace(GL_BACK);
     RenderState::StateBlock::_defaultState->setCullFaceSide(RenderState::CULL_FACE_SIDE_BACK);
     
-    glDisable(GL_BLEND);
+    GL::disable(GL_BLEND);
     RenderState::StateBlock::_defaultState->setBlend(false);
     
     if (Configuration::getInstance()->supportsShareableVAO())
@@ -373,6 +372,16 @@ bool CameraBackgroundSkyBoxBrush::init()
 
 void CameraBackgroundSkyBoxBrush::initBuffer()
 {
+    // set up by the render thread, see GL::genVertexArrays()
+    auto renderer = Director::getInstance()->getRenderer();
+    if (!renderer->isRenderThread())
+    {
+        renderer->runOnRenderThread([this]() {
+            initBuffer();
+        }, true);
+        return;
+    }
+
     if (_vertexBuffer)
         glDeleteBuffers(1, &_vertexBuffer);
     if (_indexBuffer)
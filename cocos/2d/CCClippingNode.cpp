@@ -58,6 +58,8 @@ ClippingNode::ClippingNode()
 : _stencil(nullptr)
 ,_stencilStateManager(new StencilStateManager())
 {
+    // visit() queries the alpha test uniform from GL when the stencil has an alpha threshold
+    requireSerialVisit();
 }
 
 ClippingNode::~ClippingNode()
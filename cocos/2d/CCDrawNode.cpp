@@ -147,10 +147,8 @@ DrawNode::~DrawNode()
     
     if (Configuration::getInstance()->supportsShareableVAO())
     {
-        GL::bindVAO(0);
-        glDeleteVertexArrays(1, &_vao);
-        glDeleteVertexArrays(1, &_vaoGLLine);
-        glDeleteVertexArrays(1, &_vaoGLPoint);
+        GLuint vaos[3] = { _vao, _vaoGLLine, _vaoGLPoint };
+        GL::deleteVertexArrays(3, vaos);
         _vao = _vaoGLLine = _vaoGLPoint = 0;
     }
 }
@@ -213,6 +211,39 @@ bool DrawNode::init()
     ensureCapacityGLPoint(64);
     ensureCapacityGLLine(256);
     
+    setupBuffer();
+    
+    CHECK_GL_ERROR_DEBUG();
+    
+    _dirty = true;
+    _dirtyGLLine = true;
+    _dirtyGLPoint = true;
+    
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    // Need to listen the event only when not use batchnode, because it will use VBO
+    auto listener = EventListenerCustom::create(EVENT_RENDERER_RECREATED, [this](EventCustom* event){
+   /** listen the event that renderer was recreated on Android/WP8 */
+        this->init();
+    });
+
+    _eventDispatcher->addEventListenerWithSceneGraphPriority(listener, this);
+#endif
+    
+    return true;
+}
+
+void DrawNode::setupBuffer()
+{
+    // set up by the render thread, see GL::genVertexArrays()
+    auto renderer = Director::getInstance()->getRenderer();
+    if (!renderer->isRenderThread())
+    {
+        renderer->runOnRenderThread([this]() {
+            setupBuffer();
+        }, true);
+        return;
+    }
+
     if (Configuration::getInstance()->supportsShareableVAO())
     {
         glGenVertexArrays(1, &_vao);
@@ -280,24 +311,6 @@ bool DrawNode::init()
 
         glBindBuffer(GL_ARRAY_BUFFER, 0);
     }
-    
-    CHECK_GL_ERROR_DEBUG();
-    
-    _dirty = true;
-    _dirtyGLLine = true;
-    _dirtyGLPoint = true;
-    
-#if CC_ENABLE_CACHE_TEXTURE_DATA
-    // Need to listen the event only when not use batchnode, because it will use VBO
-    auto listener = EventListenerCustom::create(EVENT_RENDERER_RECREATED, [this](EventCustom* event){
-   /** listen the event that renderer was recreated on Android/WP8 */
-        this->init();
-    });
-
-    _eventDispatcher->addEventListenerWithSceneGraphPriority(listener, this);
-#endif
-    
-    return true;
 }
 
 void DrawNode::draw(Renderer *renderer, const Mat4 &transform, uint32_t flags)
@@ -452,6 +465,13 @@ void DrawNode::onDrawGLPoint(const Mat4 &transform, uint32_t flags)
     CHECK_GL_ERROR_DEBUG();
 }
 
+bool DrawNode::getLocalDrawBounds(AABB* bounds) const
+{
+    // the primitives may be drawn anywhere, regardless of the content size
+    bounds->reset();
+    return false;
+}
+
 void DrawNode::drawPoint(const Vec2& position, const float pointSize, const Color4F &color)
 {
     ensureCapacityGLPoint(1);
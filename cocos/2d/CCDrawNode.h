@@ -312,6 +312,7 @@ public:
     
     // Overrides
     virtual void draw(Renderer *renderer, const Mat4 &transform, uint32_t flags) override;
+    virtual bool getLocalDrawBounds(AABB* bounds) const override;
     
     void setLineWidth(int lineWidth);
 
@@ -328,6 +329,8 @@ protected:
     void ensureCapacityGLPoint(int count);
     void ensureCapacityGLLine(int count);
 
+    void setupBuffer();
+
     GLuint      _vao;
     GLuint      _vbo;
     GLuint      _vaoGLPoint;
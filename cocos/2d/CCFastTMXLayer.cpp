@@ -171,6 +171,8 @@ void TMXLayer::draw(Renderer *renderer, const Mat4& transform, uint32_t flags)
         _renderCommands.resize(_primitives.size());
     }
     
+    _texture->requestLOD(0);
+
     int index = 0;
     for(const auto& iter : _primitives)
     {
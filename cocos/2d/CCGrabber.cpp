@@ -25,6 +25,8 @@ THE SOFTWARE.
 ****************************************************************************/
 #include "2d/CCGrabber.h"
 #include "base/ccMacros.h"
+#include "base/CCDirector.h"
+#include "renderer/CCRenderer.h"
 #include "renderer/CCTexture2D.h"
 
 NS_CC_BEGIN
@@ -36,11 +38,21 @@ Grabber::Grabber(void)
     memset(_oldClearColor, 0, sizeof(_oldClearColor));
 
     // generate FBO
-    glGenFramebuffers(1, &_FBO);
+    GL::genFramebuffers(1, &_FBO);
 }
 
 void Grabber::grab(Texture2D *texture)
 {
+    // the FBO is bound by the render thread, see GL::genFramebuffers()
+    auto renderer = Director::getInstance()->getRenderer();
+    if (!renderer->isRenderThread())
+    {
+        renderer->runOnRenderThread([this, texture]() {
+            grab(texture);
+        }, true);
+        return;
+    }
+
     glGetIntegerv(GL_FRAMEBUFFER_BINDING, &_oldFBO);
 
     // bind
@@ -95,7 +107,7 @@ void Grabber::afterRender(cocos2d::Texture2D *texture)
 Grabber::~Grabber()
 {
     CCLOGINFO("deallocing Grabber: %p", this);
-    glDeleteFramebuffers(1, &_FBO);
+    GL::deleteFramebuffers(1, &_FBO);
 }
 
 NS_CC_END
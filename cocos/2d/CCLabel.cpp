@@ -659,6 +659,8 @@ void Label::setString(const std::string& text)
     {
         _utf8Text = text;
         _contentDirty = true;
+        // the new content size is only known when the label is updated
+        markSubtreeBoundsDirty();
 
         std::u16string utf16String;
         if (StringUtils::UTF8ToUTF16(_utf8Text, utf16String))
@@ -508,6 +508,7 @@ bool LayerColor::initWithColor(const Color4B& color, GLfloat w, GLfloat h)
         _displayedColor.g = _realColor.g = color.g;
         _displayedColor.b = _realColor.b = color.b;
         _displayedOpacity = _realOpacity = color.a;
+        _initialColor = color;
 
         for (size_t i = 0; i<sizeof(_squareVertices) / sizeof( _squareVertices[0]); i++ )
         {
@@ -530,6 +531,12 @@ bool LayerColor::initWithColor(const Color4B& color)
     return initWithColor(color, s.width, s.height);
 }
 
+void LayerColor::resetColor()
+{
+    setOpacity(_initialColor.a);
+    setColor(Color3B(_initialColor));
+}
+
 /// override contentSize
 void LayerColor::setContentSize(const Size & size)
 {
@@ -405,8 +405,10 @@ protected:
     void onDraw(const Mat4& transform, uint32_t flags);
 
     virtual void updateColor() override;
+    virtual void resetColor() override;
 
     BlendFunc _blendFunc;
+    Color4B _initialColor;
     Vec2 _squareVertices[4];
     Color4F  _squareColors[4];
     CustomCommand _customCommand;
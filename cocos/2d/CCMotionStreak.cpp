@@ -396,6 +396,13 @@ void MotionStreak::onDraw(const Mat4 &transform, uint32_t flags)
     CC_INCREMENT_GL_DRAWN_BATCHES_AND_VERTICES(1, _nuPoints*2);
 }
 
+bool MotionStreak::getLocalDrawBounds(AABB* bounds) const
+{
+    // the streak vertices are in world space
+    bounds->reset();
+    return false;
+}
+
 void MotionStreak::draw(Renderer *renderer, const Mat4 &transform, uint32_t flags)
 {
     if(_nuPoints <= 1)
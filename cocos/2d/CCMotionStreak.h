@@ -126,6 +126,7 @@ public:
     * @lua NA
     */
     virtual void draw(Renderer *renderer, const Mat4 &transform, uint32_t flags) override;
+    virtual bool getLocalDrawBounds(AABB* bounds) const override;
     /**
     * @lua NA
     */
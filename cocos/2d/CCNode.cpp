@@ -31,6 +31,7 @@ THE SOFTWARE.
 #include <algorithm>
 #include <string>
 #include <regex>
+#include <unordered_map>
 
 #include "base/CCDirector.h"
 #include "base/CCScheduler.h"
@@ -40,9 +41,14 @@ THE SOFTWARE.
 #include "2d/CCActionManager.h"
 #include "2d/CCScene.h"
 #include "2d/CCComponent.h"
+#include "2d/CCStaticBatch.h"
+#include "2d/CCTransformSystem.h"
+#include "2d/CCNodeIndex.h"
 #include "renderer/CCGLProgram.h"
 #include "renderer/CCGLProgramState.h"
 #include "renderer/CCMaterial.h"
+#include "renderer/CCRenderer.h"
+#include "renderer/CCBatchDiagnostics.h"
 #include "math/TransformUtils.h"
 
 
@@ -58,6 +64,14 @@ NS_CC_BEGIN
 // FIXME:: Yes, nodes might have a sort problem once every 30 days if the game runs at 60 FPS and each frame sprites are reordered.
 unsigned int Node::s_globalOrderOfArrival = 0;
 
+// states of the children removed by removeChildren()
+enum
+{
+    BATCH_REMOVAL_NONE = 0,
+    BATCH_REMOVAL_PENDING,
+    BATCH_REMOVAL_DETACHED,
+};
+
 // MARK: Constructor, Destructor, Init
 
 Node::Node()
@@ -84,6 +98,7 @@ Node::Node()
 // lazy alloc
 , _localZOrderAndArrival(0)
 , _localZOrder(0)
+, _reorderPending(true)
 , _globalZOrder(0)
 , _parent(nullptr)
 // "whole screen" objects. like Scenes and Layers, should set _ignoreAnchorPointForPosition to true
@@ -98,6 +113,19 @@ Node::Node()
 , _visible(true)
 , _ignoreAnchorPointForPosition(false)
 , _reorderChildDirty(false)
+, _batchingChildren(false)
+, _batchRemoval(0)
+, _parallelVisitEnabled(false)
+, _serialVisitCount(0)
+, _subtreeCullingEnabled(false)
+, _subtreeBoundsDirty(true)
+, _subtreeBoundsKnown(true)
+, _culledFlags(0)
+, _subtreeContentDirty(true)
+, _staticBatch(nullptr)
+, _transformSystem(nullptr)
+, _transformIndex(-1)
+, _nodeIndex(nullptr)
 , _isTransitionFinished(false)
 #if CC_ENABLE_SCRIPT_BINDING
 , _updateScriptHandler(0)
@@ -161,6 +189,7 @@ Node::~Node()
     
     // attributes
     CC_SAFE_RELEASE_NULL(_glProgramState);
+    CC_SAFE_DELETE(_staticBatch);
 
     for (auto& child : _children)
     {
@@ -193,6 +222,32 @@ bool Node::init()
     return true;
 }
 
+void Node::unuse()
+{
+    this->stopAllActions();
+
+    for (const auto& child : _children)
+        child->unuse();
+}
+
+void Node::reuse()
+{
+    setPosition3D(Vec3::ZERO);
+    setRotation3D(Vec3::ZERO);
+    setScale(1.0f);
+    setSkewX(0.0f);
+    setSkewY(0.0f);
+    setVisible(true);
+    setLocalZOrder(0);
+    resetColor();
+}
+
+void Node::resetColor()
+{
+    setOpacity(255);
+    setColor(Color3B::WHITE);
+}
+
 void Node::cleanup()
 {
 #if CC_ENABLE_SCRIPT_BINDING
@@ -235,6 +290,9 @@ void Node::setSkewX(float skewX)
     
     _skewX = skewX;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    markTransformChanged();
+    if (_parent)
+        _parent->markSubtreeBoundsDirty();
 }
 
 float Node::getSkewY() const
@@ -249,6 +307,9 @@ void Node::setSkewY(float skewY)
     
     _skewY = skewY;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    markTransformChanged();
+    if (_parent)
+        _parent->markSubtreeBoundsDirty();
 }
 
 void Node::setLocalZOrder(int z)
@@ -271,11 +332,13 @@ void Node::_setLocalZOrder(int z)
 {
     _localZOrderAndArrival = (static_cast<std::int64_t>(z) << 32) | (_localZOrderAndArrival & 0xffffffff);
     _localZOrder = z;
+    _reorderPending = true;
 }
 
 void Node::updateOrderOfArrival()
 {
     _localZOrderAndArrival = (_localZOrderAndArrival & 0xffffffff00000000) | (++s_globalOrderOfArrival);
+    _reorderPending = true;
 }
 
 void Node::setGlobalZOrder(float globalZOrder)
@@ -284,6 +347,7 @@ void Node::setGlobalZOrder(float globalZOrder)
     {
         _globalZOrder = globalZOrder;
         _eventDispatcher->setDirtyForNode(this);
+        markSubtreeContentDirty();
     }
 }
 
@@ -302,6 +366,9 @@ void Node::setRotation(float rotation)
     
     _rotationZ_X = _rotationZ_Y = rotation;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    markTransformChanged();
+    if (_parent)
+        _parent->markSubtreeBoundsDirty();
     
     updateRotationQuat();
 }
@@ -319,6 +386,9 @@ void Node::setRotation3D(const Vec3& rotation)
         return;
     
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    markTransformChanged();
+    if (_parent)
+        _parent->markSubtreeBoundsDirty();
 
     _rotationX = rotation.x;
     _rotationY = rotation.y;
@@ -370,6 +440,9 @@ void Node::setRotationQuat(const Quaternion& quat)
     _rotationQuat = quat;
     updateRotation3D();
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    markTransformChanged();
+    if (_parent)
+        _parent->markSubtreeBoundsDirty();
 }
 
 Quaternion Node::getRotationQuat() const
@@ -384,6 +457,9 @@ void Node::setRotationSkewX(float rotationX)
     
     _rotationZ_X = rotationX;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    markTransformChanged();
+    if (_parent)
+        _parent->markSubtreeBoundsDirty();
     
     updateRotationQuat();
 }
@@ -400,6 +476,9 @@ void Node::setRotationSkewY(float rotationY)
     
     _rotationZ_Y = rotationY;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    markTransformChanged();
+    if (_parent)
+        _parent->markSubtreeBoundsDirty();
     
     updateRotationQuat();
 }
@@ -419,6 +498,9 @@ void Node::setScale(float scale)
     
     _scaleX = _scaleY = _scaleZ = scale;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    markTransformChanged();
+    if (_parent)
+        _parent->markSubtreeBoundsDirty();
 }
 
 /// scaleX getter
@@ -436,6 +518,9 @@ void Node::setScale(float scaleX,float scaleY)
     _scaleX = scaleX;
     _scaleY = scaleY;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    markTransformChanged();
+    if (_parent)
+        _parent->markSubtreeBoundsDirty();
 }
 
 /// scaleX setter
@@ -446,6 +531,9 @@ void Node::setScaleX(float scaleX)
     
     _scaleX = scaleX;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    markTransformChanged();
+    if (_parent)
+        _parent->markSubtreeBoundsDirty();
 }
 
 /// scaleY getter
@@ -462,6 +550,9 @@ void Node::setScaleZ(float scaleZ)
     
     _scaleZ = scaleZ;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    markTransformChanged();
+    if (_parent)
+        _parent->markSubtreeBoundsDirty();
 }
 
 /// scaleY getter
@@ -478,6 +569,9 @@ void Node::setScaleY(float scaleY)
     
     _scaleY = scaleY;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    markTransformChanged();
+    if (_parent)
+        _parent->markSubtreeBoundsDirty();
 }
 
 
@@ -508,6 +602,9 @@ void Node::setPosition(float x, float y)
     _position.y = y;
     
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    markTransformChanged();
+    if (_parent)
+        _parent->markSubtreeBoundsDirty();
     _usingNormalizedPosition = false;
 }
 
@@ -553,6 +650,9 @@ void Node::setPositionZ(float positionZ)
         return;
     
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    markTransformChanged();
+    if (_parent)
+        _parent->markSubtreeBoundsDirty();
 
     _positionZ = positionZ;
 }
@@ -573,6 +673,9 @@ void Node::setNormalizedPosition(const Vec2& position)
     _usingNormalizedPosition = true;
     _normalizedPositionDirty = true;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    markTransformChanged();
+    if (_parent)
+        _parent->markSubtreeBoundsDirty();
 }
 
 ssize_t Node::getChildrenCount() const
@@ -594,6 +697,8 @@ void Node::setVisible(bool visible)
         _visible = visible;
         if(_visible)
             _transformUpdated = _transformDirty = _inverseDirty = true;
+        if (_parent)
+            _parent->markSubtreeBoundsDirty();
     }
 }
 
@@ -615,6 +720,9 @@ void Node::setAnchorPoint(const Vec2& point)
         _anchorPoint = point;
         _anchorPointInPoints.set(_contentSize.width * _anchorPoint.x, _contentSize.height * _anchorPoint.y);
         _transformUpdated = _transformDirty = _inverseDirty = true;
+        markTransformChanged();
+        if (_parent)
+            _parent->markSubtreeBoundsDirty();
     }
 }
 
@@ -632,6 +740,8 @@ void Node::setContentSize(const Size & size)
 
         _anchorPointInPoints.set(_contentSize.width * _anchorPoint.x, _contentSize.height * _anchorPoint.y);
         _transformUpdated = _transformDirty = _inverseDirty = _contentSizeDirty = true;
+        markTransformChanged();
+        markSubtreeBoundsDirty();
     }
 }
 
@@ -644,8 +754,21 @@ bool Node::isRunning() const
 /// parent setter
 void Node::setParent(Node * parent)
 {
+    if (_parent)
+        _parent->markSubtreeBoundsDirty();
+    if (_transformSystem)
+        _transformSystem->removeSubtree(this);
+    // the ancestors count the nodes of the subtree which can't be visited in parallel
+    for (Node* node = _parent; _serialVisitCount && node; node = node->_parent)
+        node->_serialVisitCount -= _serialVisitCount;
+    for (Node* node = parent; _serialVisitCount && node; node = node->_parent)
+        node->_serialVisitCount += _serialVisitCount;
     _parent = parent;
     _transformUpdated = _transformDirty = _inverseDirty = true;
+    if (_parent)
+        _parent->markSubtreeBoundsDirty();
+    if (_parent && _parent->_transformSystem)
+        _parent->_transformSystem->addSubtree(this);
 }
 
 /// isRelativeAnchorPoint getter
@@ -661,6 +784,9 @@ void Node::setIgnoreAnchorPointForPosition(bool newValue)
     {
         _ignoreAnchorPointForPosition = newValue;
         _transformUpdated = _transformDirty = _inverseDirty = true;
+        markTransformChanged();
+        if (_parent)
+            _parent->markSubtreeBoundsDirty();
     }
 }
 
@@ -673,7 +799,11 @@ int Node::getTag() const
 /// tag setter
 void Node::setTag(int tag)
 {
+    if (_nodeIndex && _parent)
+        _nodeIndex->removeNode(this);
     _tag = tag ;
+    if (_nodeIndex && _parent)
+        _nodeIndex->addNode(this);
 }
 
 const std::string& Node::getName() const
@@ -683,9 +813,13 @@ const std::string& Node::getName() const
 
 void Node::setName(const std::string& name)
 {
+    if (_nodeIndex && _parent)
+        _nodeIndex->removeNode(this);
     _name = name;
     std::hash<std::string> h;
     _hashOfName = h(name);
+    if (_nodeIndex && _parent)
+        _nodeIndex->addNode(this);
 }
 
 /// userData setter
@@ -726,6 +860,8 @@ void Node::setGLProgramState(cocos2d::GLProgramState* glProgramState)
 
         if (_glProgramState)
             _glProgramState->setNodeBinding(this);
+
+        markSubtreeContentDirty();
     }
 }
 
@@ -779,6 +915,10 @@ Node* Node::getChildByTag(int tag) const
 {
     CCASSERT(tag != Node::INVALID_TAG, "Invalid tag");
 
+    Node* indexed = nullptr;
+    if (_nodeIndex && _nodeIndex->findChildByTag(this, tag, &indexed))
+        return indexed;
+
     for (const auto child : _children)
     {
         if(child && child->_tag == tag)
@@ -793,6 +933,10 @@ Node* Node::getChildByName(const std::string& name) const
     
     std::hash<std::string> h;
     size_t hash = h(name);
+
+    Node* indexed = nullptr;
+    if (_nodeIndex && _nodeIndex->findChildByName(this, name, hash, &indexed))
+        return indexed;
     
     for (const auto& child : _children)
     {
@@ -879,6 +1023,28 @@ bool Node::doEnumerateRecursive(const Node* node, const std::string &name, std::
     return ret;
 }
 
+// the search strings of enumerateChildren() are usually a few literals, used many times
+static const size_t MAX_CACHED_SEARCH_REGEXES = 64;
+
+static bool isLiteralSearchName(const std::string& name)
+{
+    return name.find_first_of(".[]{}()\\*+?|^$") == std::string::npos;
+}
+
+// returns nullptr when the cache is full
+static const std::regex* getCachedSearchRegex(const std::string& name)
+{
+    static std::unordered_map<std::string, std::regex> s_searchRegexes;
+
+    auto it = s_searchRegexes.find(name);
+    if (it != s_searchRegexes.end())
+        return &it->second;
+
+    if (s_searchRegexes.size() >= MAX_CACHED_SEARCH_REGEXES)
+        return nullptr;
+    return &s_searchRegexes.emplace(name, std::regex(name)).first->second;
+}
+
 bool Node::doEnumerate(std::string name, std::function<bool (Node *)> callback) const
 {
     // name may be xxx/yyy, should find its parent
@@ -892,27 +1058,51 @@ bool Node::doEnumerate(std::string name, std::function<bool (Node *)> callback)
         needRecursive = true;
     }
     
+    // returns true to terminate the enumeration
+    auto matched = [&](Node* child) {
+        if (!needRecursive)
+        {
+            // terminate enumeration if callback return true
+            return callback(child);
+        }
+        return child->doEnumerate(name, callback);
+    };
+
     bool ret = false;
-    for (const auto& child : getChildren())
+    if (isLiteralSearchName(searchName))
     {
-        if (std::regex_match(child->_name, std::regex(searchName)))
+        std::hash<std::string> h;
+        size_t hash = h(searchName);
+
+        Node* indexed = nullptr;
+        // unnamed children aren't indexed
+        if (!searchName.empty() && _nodeIndex && _nodeIndex->findChildByName(this, searchName, hash, &indexed))
+            return indexed && matched(indexed);
+
+        for (const auto& child : getChildren())
         {
-            if (!needRecursive)
+            if (child->_hashOfName == hash && child->_name == searchName && matched(child))
             {
-                // terminate enumeration if callback return true
-                if (callback(child))
-                {
-                    ret = true;
-                    break;
-                }
-            }
-            else
-            {
-                ret = child->doEnumerate(name, callback);
-                if (ret)
-                    break;
+                ret = true;
+                break;
             }
         }
+        return ret;
+    }
+
+    const std::regex* cachedRegex = getCachedSearchRegex(searchName);
+    std::regex regex;
+    if (!cachedRegex)
+        regex.assign(searchName);
+    const std::regex& searchRegex = cachedRegex ? *cachedRegex : regex;
+
+    for (const auto& child : getChildren())
+    {
+        if (std::regex_match(child->_name, searchRegex) && matched(child))
+        {
+            ret = true;
+            break;
+        }
     }
     
     return ret;
@@ -954,6 +1144,9 @@ void Node::addChildHelper(Node* child, int localZOrder, int tag, const std::stri
     
     child->setParent(this);
 
+    if (_nodeIndex)
+        _nodeIndex->addChild(child);
+
     child->updateOrderOfArrival();
 
     if( _running )
@@ -966,6 +1159,10 @@ void Node::addChildHelper(Node* child, int localZOrder, int tag, const std::stri
         }
     }
     
+    // addChildren() updates them once
+    if (_batchingChildren)
+        return;
+
     if (_cascadeColorEnabled)
     {
         updateCascadeColor();
@@ -977,6 +1174,35 @@ void Node::addChildHelper(Node* child, int localZOrder, int tag, const std::stri
     }
 }
 
+void Node::addChildren(const Vector<Node*>& children)
+{
+    if (children.empty())
+        return;
+
+    if (_children.empty())
+    {
+        this->childrenAlloc();
+    }
+    _children.reserve(_children.size() + children.size());
+
+    _batchingChildren = true;
+    for (const auto& child : children)
+    {
+        this->addChild(child);
+    }
+    _batchingChildren = false;
+
+    if (_cascadeColorEnabled)
+    {
+        updateCascadeColor();
+    }
+
+    if (_cascadeOpacityEnabled)
+    {
+        updateCascadeOpacity();
+    }
+}
+
 void Node::addChild(Node *child, int zOrder)
 {
     CCASSERT( child != nullptr, "Argument must be non-nil");
@@ -1014,6 +1240,13 @@ void Node::removeChild(Node* child, bool cleanup /* = true */)
         return;
     }
 
+    // removed by removeChildren(), which compacts the children array at the end
+    if (_batchingChildren && child->_batchRemoval == BATCH_REMOVAL_PENDING)
+    {
+        this->detachChild(child, CC_INVALID_INDEX, cleanup);
+        return;
+    }
+
     ssize_t index = _children.getIndex(child);
     if( index != CC_INVALID_INDEX )
         this->detachChild( child, index, cleanup );
@@ -1081,6 +1314,8 @@ void Node::removeAllChildrenWithCleanup(bool cleanup)
             sEngine->releaseScriptObject(this, child);
         }
 #endif // CC_ENABLE_GC_FOR_NATIVE_OBJECTS
+        if (child->_nodeIndex)
+            child->_nodeIndex->removeChild(child);
         // set parent nil at the end
         child->setParent(nullptr);
     }
@@ -1088,8 +1323,70 @@ void Node::removeAllChildrenWithCleanup(bool cleanup)
     _children.clear();
 }
 
+void Node::removeChildren(const Vector<Node*>& children, bool cleanup)
+{
+    if (_children.empty() || children.empty())
+        return;
+
+    // finds the children to remove in one pass, in the order of the children array
+    for (const auto& child : children)
+    {
+        child->_batchRemoval = BATCH_REMOVAL_PENDING;
+    }
+    std::vector<Node*> removed;
+    removed.reserve(children.size());
+    for (const auto& child : _children)
+    {
+        if (child->_batchRemoval == BATCH_REMOVAL_PENDING)
+            removed.push_back(child);
+    }
+    for (const auto& child : children)
+    {
+        child->_batchRemoval = BATCH_REMOVAL_NONE;
+    }
+    for (const auto& child : removed)
+    {
+        child->_batchRemoval = BATCH_REMOVAL_PENDING;
+    }
+
+    _batchingChildren = true;
+    for (const auto& child : removed)
+    {
+        // the callbacks of a previous child may have removed it already
+        if (child->_batchRemoval == BATCH_REMOVAL_PENDING)
+            this->removeChild(child, cleanup);
+    }
+    _batchingChildren = false;
+
+    // the detached children are moved to the end and erased at once, keeping the order of the others
+    auto detached = std::stable_partition(_children.begin(), _children.end(), [](Node* child) {
+        return child->_batchRemoval != BATCH_REMOVAL_DETACHED;
+    });
+    for (auto it = detached; it != _children.end(); ++it)
+    {
+        (*it)->_batchRemoval = BATCH_REMOVAL_NONE;
+        // released at the end of the frame, the director retains the ones to clean up
+        if (!cleanup)
+        {
+            (*it)->retain();
+            (*it)->autorelease();
+        }
+    }
+    _children.erase(detached, _children.end());
+
+    // not detached by an overridden removeChild()
+    for (const auto& child : removed)
+    {
+        if (child->_batchRemoval == BATCH_REMOVAL_PENDING)
+            child->_batchRemoval = BATCH_REMOVAL_NONE;
+    }
+}
+
 void Node::detachChild(Node *child, ssize_t childIndex, bool doCleanup)
 {
+    // removed by removeChildren()
+    const bool batched = (child->_batchRemoval == BATCH_REMOVAL_PENDING);
+
     // IMPORTANT:
     //  -1st do onExit
     //  -2nd cleanup
@@ -1103,7 +1400,11 @@ void Node::detachChild(Node *child, ssize_t childIndex, bool doCleanup)
     // its scheduledSelectors_ dict will not get released!
     if (doCleanup)
     {
-        child->cleanup();
+        // paused by onExit(), it is cleaned up at the end of the frame
+        if (batched)
+            _director->cleanupNodeLater(child);
+        else
+            child->cleanup();
     }
     
 #if CC_ENABLE_GC_FOR_NATIVE_OBJECTS
@@ -1113,10 +1414,15 @@ void Node::detachChild(Node *child, ssize_t childIndex, bool doCleanup)
         sEngine->releaseScriptObject(this, child);
     }
 #endif // CC_ENABLE_GC_FOR_NATIVE_OBJECTS
+    if (child->_nodeIndex)
+        child->_nodeIndex->removeChild(child);
     // set parent nil at the end
     child->setParent(nullptr);
 
-    _children.erase(childIndex);
+    if (batched)
+        child->_batchRemoval = BATCH_REMOVAL_DETACHED;
+    else
+        _children.erase(childIndex);
 }
 
 
@@ -1142,6 +1448,7 @@ void Node::reorderChild(Node *child, int zOrder)
     _reorderChildDirty = true;
     child->updateOrderOfArrival();
     child->_setLocalZOrder(zOrder);
+    markSubtreeContentDirty();
 }
 
 void Node::sortAllChildren()
@@ -1174,6 +1481,9 @@ void Node::visit()
 
 uint32_t Node::processParentFlags(const Mat4& parentTransform, uint32_t parentFlags)
 {
+    // the overrides of visit() call it first, the commands they add are attributed to this node
+    BatchDiagnostics::setDrawingNode(this);
+
     if(_usingNormalizedPosition)
     {
         CCASSERT(_parent, "setNormalizedPosition() doesn't work with orphan nodes");
@@ -1183,6 +1493,7 @@ uint32_t Node::processParentFlags(const Mat4& parentTransform, uint32_t parentFl
             _position.x = _normalizedPosition.x * s.width;
             _position.y = _normalizedPosition.y * s.height;
             _transformUpdated = _transformDirty = _inverseDirty = true;
+            markTransformChanged();
             _normalizedPositionDirty = false;
         }
     }
@@ -1197,8 +1508,12 @@ uint32_t Node::processParentFlags(const Mat4& parentTransform, uint32_t parentFl
     flags |= (_contentSizeDirty ? FLAGS_CONTENT_SIZE_DIRTY : 0);
     
 
-    if(flags & FLAGS_DIRTY_MASK)
+    // the transform system multiplied it before the visit, unless a transform changed since then
+    if ((flags & FLAGS_DIRTY_MASK)
+        && !(_transformSystem && _transformSystem->getWorldTransform(this, parentTransform, &_modelViewTransform)))
+    {
         _modelViewTransform = this->transform(parentTransform);
+    }
     
     _transformUpdated = false;
     _contentSizeDirty = false;
@@ -1223,6 +1538,17 @@ void Node::visit(Renderer* renderer, const Mat4 &parentTransform, uint32_t paren
 
     uint32_t flags = processParentFlags(parentTransform, parentFlags);
 
+#if CC_USE_CULLING
+    // the children transforms are updated when the subtree is visible again
+    if (_subtreeCullingEnabled && isSubtreeOutOfFrustum())
+    {
+        _culledFlags |= (flags & FLAGS_DIRTY_MASK);
+        return;
+    }
+#endif
+    flags |= _culledFlags;
+    _culledFlags = 0;
+
     // IMPORTANT:
     // To ease the migration to v3.0, we still support the Mat4 stack,
     // but it is deprecated and your code should not rely on it
@@ -1231,9 +1557,30 @@ void Node::visit(Renderer* renderer, const Mat4 &parentTransform, uint32_t paren
     
     bool visibleByCamera = isVisitableByVisitingCamera();
 
+    if (_staticBatch && visibleByCamera && _staticBatch->draw(this, renderer, _modelViewTransform, flags))
+    {
+        // the children transforms are updated too when the subtree is visited again
+        _culledFlags |= (flags & FLAGS_DIRTY_MASK);
+        _director->popMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
+        return;
+    }
+
     int i = 0;
 
-    if(!_children.empty())
+    if(!_children.empty() && _parallelVisitEnabled)
+    {
+        sortAllChildren();
+        // children zOrder < 0 are recorded before self draw, as below
+        while (i < _children.size() && _children.at(i)->_localZOrder < 0)
+            ++i;
+
+        renderer->visitInParallel(_children, 0, i, _modelViewTransform, flags);
+        BatchDiagnostics::setDrawingNode(this);
+        if (visibleByCamera)
+            this->draw(renderer, _modelViewTransform, flags);
+        renderer->visitInParallel(_children, i, _children.size(), _modelViewTransform, flags);
+    }
+    else if(!_children.empty())
     {
         sortAllChildren();
         // draw children zOrder < 0
@@ -1247,6 +1594,7 @@ void Node::visit(Renderer* renderer, const Mat4 &parentTransform, uint32_t paren
                 break;
         }
         // self draw
+        BatchDiagnostics::setDrawingNode(this);
         if (visibleByCamera)
             this->draw(renderer, _modelViewTransform, flags);
 
@@ -1266,6 +1614,115 @@ void Node::visit(Renderer* renderer, const Mat4 &parentTransform, uint32_t paren
     // _orderOfArrival = 0;
 }
 
+bool Node::getLocalDrawBounds(AABB* bounds) const
+{
+    bounds->reset();
+    const Size& size = getContentSize();
+    if (size.width > 0 && size.height > 0)
+        bounds->set(Vec3::ZERO, Vec3(size.width, size.height, 0));
+    return true;
+}
+
+const AABB* Node::getSubtreeBounds()
+{
+    if (_subtreeBoundsDirty)
+    {
+        _subtreeBoundsKnown = getLocalDrawBounds(&_subtreeBounds);
+        mergeChildrenSubtreeBounds();
+        _subtreeBoundsDirty = false;
+    }
+
+    return _subtreeBoundsKnown ? &_subtreeBounds : nullptr;
+}
+
+void Node::mergeChildrenSubtreeBounds()
+{
+    mergeSubtreeBounds(_children);
+}
+
+void Node::mergeSubtreeBounds(const Vector<Node*>& children)
+{
+    for (const auto& child : children)
+    {
+        // computed for the invisible children too, so that no dirty node is left below a clean one
+        const AABB* childBounds = child->getSubtreeBounds();
+        if (!child->_visible)
+            continue;
+
+        if (!childBounds)
+        {
+            _subtreeBoundsKnown = false;
+        }
+        else if (_subtreeBoundsKnown && !childBounds->isEmpty())
+        {
+            AABB bounds(*childBounds);
+            bounds.transform(child->getNodeToParentTransform());
+            _subtreeBounds.merge(bounds);
+        }
+    }
+}
+
+void Node::markSubtreeBoundsDirty()
+{
+    // the ancestors of a dirty node are already dirty
+    for (Node* node = this; node && !(node->_subtreeBoundsDirty && node->_subtreeContentDirty); node = node->_parent)
+    {
+        node->_subtreeBoundsDirty = true;
+        node->_subtreeContentDirty = true;
+    }
+}
+
+void Node::requireSerialVisit()
+{
+    for (Node* node = this; node; node = node->_parent)
+        ++node->_serialVisitCount;
+}
+
+void Node::markTransformChanged()
+{
+    if (_transformSystem)
+        _transformSystem->markDirty(this);
+}
+
+void Node::markSubtreeContentDirty()
+{
+    for (Node* node = this; node && !node->_subtreeContentDirty; node = node->_parent)
+    {
+        node->_subtreeContentDirty = true;
+    }
+}
+
+void Node::setFrozen(bool frozen)
+{
+    if (frozen == (_staticBatch != nullptr))
+        return;
+
+    if (frozen)
+    {
+        _staticBatch = new (std::nothrow) StaticBatch();
+        markSubtreeContentDirty();
+    }
+    else
+    {
+        CC_SAFE_DELETE(_staticBatch);
+    }
+}
+
+bool Node::isSubtreeOutOfFrustum()
+{
+    auto camera = Camera::getVisitingCamera();
+    if (!camera)
+        return false;
+
+    const AABB* bounds = getSubtreeBounds();
+    if (!bounds || bounds->isEmpty())
+        return false;
+
+    AABB worldBounds(*bounds);
+    worldBounds.transform(_modelViewTransform);
+    return !camera->isVisibleInFrustum(&worldBounds);
+}
+
 Mat4 Node::transform(const Mat4& parentTransform)
 {
     return parentTransform * this->getNodeToParentTransform();
@@ -1775,6 +2232,9 @@ void Node::setNodeToParentTransform(const Mat4& transform)
     _transform = transform;
     _transformDirty = false;
     _transformUpdated = true;
+    markTransformChanged();
+    if (_parent)
+        _parent->markSubtreeBoundsDirty();
 
     if (_additionalTransform)
         // _additionalTransform[1] has a copy of lastest transform
@@ -1807,6 +2267,9 @@ void Node::setAdditionalTransform(const Mat4* additionalTransform)
         _additionalTransform[0] = *additionalTransform;
     }
     _transformUpdated = _additionalTransformDirty = _inverseDirty = true;
+    markTransformChanged();
+    if (_parent)
+        _parent->markSubtreeBoundsDirty();
 }
 
 void Node::setAdditionalTransform(const Mat4& additionalTransform)
@@ -2161,6 +2624,7 @@ bool isScreenPointInRect(const Vec2 &pt, const Camera* camera, const Mat4& w2l,
 void Node::setCameraMask(unsigned short mask, bool applyChildren)
 {
     _cameraMask = mask;
+    markSubtreeContentDirty();
     if (applyChildren)
     {
         for (const auto& child : _children)
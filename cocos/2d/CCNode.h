@@ -36,6 +36,7 @@
 #include "base/CCScriptSupport.h"
 #include "math/CCAffineTransform.h"
 #include "math/CCMath.h"
+#include "3d/CCAABB.h"
 #include "2d/CCComponentContainer.h"
 #include "2d/CCComponent.h"
 
@@ -62,6 +63,9 @@ class GLProgramState;
 class Material;
 class Camera;
 class PhysicsBody;
+class StaticBatch;
+class TransformSystem;
+class NodeIndex;
 
 /**
  * @addtogroup _2d
@@ -756,6 +760,14 @@ public:
      *
      */
     virtual void addChild(Node* child, int localZOrder, const std::string &name);
+    /**
+     * Adds several children to the container, with their local z-order and their name.
+     * The capacity of the children array is reserved once, and the cascaded color and opacity are updated once.
+     *
+     * @param children  Nodes without a parent.
+     * @since v3.13
+     */
+    void addChildren(const Vector<Node*>& children);
     /**
      * Gets a child from the container with its tag.
      *
@@ -912,6 +924,18 @@ public:
      */
     virtual void removeAllChildrenWithCleanup(bool cleanup);
 
+    /**
+     * Removes several children from the container in one pass over the children array.
+     * Each child is removed with removeChild(), but the array is compacted once at the end, and the children are
+     * cleaned up and released at the end of the frame, after the scene is drawn. Nodes which aren't children of
+     * this node are ignored.
+     *
+     * @param children  The children to remove. It can be the array returned by getChildren().
+     * @param cleanup   True if all running actions and callbacks on the children should be removed, false otherwise.
+     * @since v3.13
+     */
+    void removeChildren(const Vector<Node*>& children, bool cleanup = true);
+
     /**
      * Reorders a child according to a new z value.
      *
@@ -930,20 +954,53 @@ public:
     /**
     * Sorts helper function
     *
+    * Only the nodes added or reordered since the last sort are sorted, and then merged with the others,
+    * which are still in order. If the others aren't in order anymore, all the nodes are sorted.
     */
     template<typename _T> inline
     static void sortNodes(cocos2d::Vector<_T*>& nodes)
     {
         static_assert(std::is_base_of<Node, _T>::value, "Node::sortNodes: Only accept derived of Node!");
+        auto first = std::begin(nodes);
+        auto last = std::end(nodes);
+
+        // move the reordered nodes to the end, keeping the order of the others
+        std::vector<_T*> reordered;
+        bool othersInOrder = true;
+        auto kept = first;
+        for (auto it = first; it != last; ++it)
+        {
+            _T* node = *it;
+            if (node->_reorderPending)
+            {
+                node->_reorderPending = false;
+                reordered.push_back(node);
+            }
+            else
+            {
+                if (kept != first && isNodeOrderLess(node, *(kept - 1)))
+                    othersInOrder = false;
+                *kept++ = node;
+            }
+        }
+
+        if (reordered.empty() && othersInOrder)
+            return;
+        std::copy(reordered.begin(), reordered.end(), kept);
+
+        if (othersInOrder)
+        {
+            std::stable_sort(kept, last, isNodeOrderLess<_T>);
+            std::inplace_merge(first, kept, last, isNodeOrderLess<_T>);
+        }
+        else
+        {
 #if CC_64BITS
-        std::sort(std::begin(nodes), std::end(nodes), [](_T* n1, _T* n2) {
-            return (n1->_localZOrderAndArrival < n2->_localZOrderAndArrival);
-        });
+            std::sort(first, last, isNodeOrderLess<_T>);
 #else
-        std::stable_sort(std::begin(nodes), std::end(nodes), [](_T* n1, _T* n2) {
-            return n1->_localZOrder < n2->_localZOrder;
-        });
+            std::stable_sort(first, last, isNodeOrderLess<_T>);
 #endif
+        }
     }
 
     /// @} end of Children and Parent
@@ -1142,6 +1199,24 @@ public:
      */
     virtual void cleanup();
 
+    /**
+     * Called by NodePool when the node is put back into the pool, after it is removed from its parent.
+     * Stops the actions of the node and of its descendants. Their scheduled callbacks and event listeners
+     * stay registered, paused since the node left the stage.
+     * Override it to stop what the node doesn't need while it is pooled.
+     * @since v3.13
+     */
+    virtual void unuse();
+
+    /**
+     * Called by NodePool when the node is taken out of the pool.
+     * Resets the position, the rotation, the scale, the skew, the visibility and the local Z order of the node,
+     * and calls resetColor(). Its descendants are kept as they are.
+     * Override it to reset the other properties the node changes while it is used.
+     * @since v3.13
+     */
+    virtual void reuse();
+
     /**
      * Override this method to draw your own node.
      * The following GL states will be enabled by default:
@@ -1169,6 +1244,113 @@ public:
     virtual void visit(Renderer *renderer, const Mat4& parentTransform, uint32_t parentFlags);
     virtual void visit() final;
 
+    /**
+     * Sets whether the children of this node are visited in parallel.
+     * Each child subtree records its render commands on one of the renderer recording threads,
+     * see `Renderer::setRecordingThreadCount()`. The order of the recorded commands is the same as a serial visit.
+     * Only enable it for subtrees which don't issue GL calls nor use the Director matrix stack while being visited.
+     * The children whose subtree contains a node that does, like RenderTexture, NodeGrid and ClippingNode,
+     * are visited serially, see isParallelVisitSafe().
+     *
+     * @param enabled True to visit the children in parallel, false otherwise. Default is false.
+     */
+    void setParallelVisitEnabled(bool enabled) { _parallelVisitEnabled = enabled; }
+    /**
+     * Returns whether the children of this node are visited in parallel.
+     *
+     * @return True if the children of this node are visited in parallel.
+     */
+    bool isParallelVisitEnabled() const { return _parallelVisitEnabled; }
+    /**
+     * Returns whether the subtree of this node can be visited by a recording thread, see setParallelVisitEnabled().
+     *
+     * @return False if the node or one of its descendants must be visited by the main thread.
+     * @since v3.13
+     */
+    bool isParallelVisitSafe() const { return _serialVisitCount == 0; }
+
+    /**
+     * Sets whether this node and its descendants are skipped when they are out of the frustum of the visiting camera.
+     * The bounds of the subtree are cached in the node's space, and only computed again when a node of the subtree
+     * changes. It lets large scenes, like scrolling maps, skip whole branches instead of culling each leaf.
+     *
+     * The bounds are computed from getLocalDrawBounds(), so only enable it for subtrees whose nodes
+     * draw within it. Only Node::visit() checks the bounds; nodes overriding visit() can't be culling roots.
+     *
+     * @param enabled True to cull the subtree, false otherwise. Default is false.
+     * @since v3.13
+     */
+    void setSubtreeCullingEnabled(bool enabled) { _subtreeCullingEnabled = enabled; }
+    /**
+     * Returns whether this node and its descendants are skipped when they are out of the frustum.
+     *
+     * @return True if the subtree is culled.
+     * @since v3.13
+     */
+    bool isSubtreeCullingEnabled() const { return _subtreeCullingEnabled; }
+
+    /**
+     * Returns the bounds of what the node itself draws, in its own space, without its children.
+     * By default it is the rect of its content size. Override it in nodes drawing outside of their content size.
+     *
+     * @param bounds The bounds, left empty when the node doesn't draw anything.
+     * @return False if the bounds aren't known, then the subtrees containing the node aren't culled.
+     * @since v3.13
+     */
+    virtual bool getLocalDrawBounds(AABB* bounds) const;
+
+    /**
+     * Returns the bounds of this node and its visible descendants, in the node's space.
+     * The bounds are cached until markSubtreeBoundsDirty() is called.
+     *
+     * @return The bounds, or nullptr if the bounds of a node of the subtree aren't known.
+     * @since v3.13
+     */
+    const AABB* getSubtreeBounds();
+
+    /**
+     * Invalidates the cached bounds of this node's subtree, and of its ancestors.
+     * Transform, content size, visibility and hierarchy changes call it. Call it when what the node draws changes
+     * without changing its content size. It also calls markSubtreeContentDirty().
+     * @since v3.13
+     */
+    void markSubtreeBoundsDirty();
+
+    /**
+     * Sets whether the subtree of this node is frozen.
+     * The geometry of a frozen subtree is baked into static vertex buffers, and drawn with a few commands
+     * without visiting its nodes. It suits large subtrees which rarely change, like the decorations of a level.
+     *
+     * Transform, color, texture and hierarchy changes of the descendants bake the subtree again, see
+     * markSubtreeContentDirty(). Moving the frozen node itself doesn't. Subtrees that can't be baked, see StaticBatch,
+     * are visited as usual. The baked geometry is drawn with the global Z order of the frozen node.
+     *
+     * @param frozen True to bake the subtree, false to visit it as usual. Default is false.
+     * @since v3.13
+     */
+    void setFrozen(bool frozen);
+    /**
+     * Returns whether the subtree of this node is frozen.
+     *
+     * @return True if the subtree is baked.
+     * @since v3.13
+     */
+    bool isFrozen() const { return _staticBatch != nullptr; }
+
+    /**
+     * Invalidates what is baked from this node's subtree, and from its ancestors' subtrees, see setFrozen().
+     * Nodes call it when what they draw changes. markSubtreeBoundsDirty() calls it too.
+     * @since v3.13
+     */
+    void markSubtreeContentDirty();
+
+    /**
+     * Queues the node in the TransformSystem of its scene, if it has one, so that its world transform is
+     * multiplied again. The transform setters call it, subclasses which change their transform otherwise must call it too.
+     * @since v3.13
+     */
+    void markTransformChanged();
+
 
     /** Returns the Scene that contains the Node.
      It returns `nullptr` if the node doesn't belong to any Scene.
@@ -1843,6 +2025,17 @@ protected:
     /// helper that reorder a child
     void insertChild(Node* child, int z);
 
+    /// order of the children, by local Z order and then by order of arrival
+    template<typename _T> inline
+    static bool isNodeOrderLess(_T* n1, _T* n2)
+    {
+#if CC_64BITS
+        return n1->_localZOrderAndArrival < n2->_localZOrderAndArrival;
+#else
+        return n1->_localZOrder < n2->_localZOrder;
+#endif
+    }
+
     /// Removes a child, call child->onExit(), do cleanup, remove it from children array.
     void detachChild(Node *child, ssize_t index, bool doCleanup);
 
@@ -1857,12 +2050,29 @@ protected:
     virtual void updateCascadeColor();
     virtual void disableCascadeColor();
     virtual void updateColor() {}
+
+    /// Called by reuse(), restores the color and the opacity the node is created with, white and opaque.
+    /// Nodes created with another color override it.
+    virtual void resetColor();
+
+    /// Called by the constructors of the nodes which use the Director matrix stack or issue GL calls while
+    /// being visited, so that their subtrees are never visited in parallel.
+    void requireSerialVisit();
+
+    /// Called by getSubtreeBounds(), merges the bounds of the children into the subtree bounds.
+    /// Nodes which visit other nodes than their children override it, like ProtectedNode.
+    virtual void mergeChildrenSubtreeBounds();
+    /// Merges the bounds of the visible nodes of `children` into the subtree bounds.
+    void mergeSubtreeBounds(const Vector<Node*>& children);
     
     bool doEnumerate(std::string name, std::function<bool (Node *)> callback) const;
     bool doEnumerateRecursive(const Node* node, const std::string &name, std::function<bool (Node *)> callback) const;
     
     //check whether this camera mask is visible by the current visiting camera
     bool isVisitableByVisitingCamera() const;
+
+    //check whether the subtree bounds are out of the frustum of the visiting camera
+    bool isSubtreeOutOfFrustum();
     
     // update quaternion from Rotation3D
     void updateRotationQuat();
@@ -1915,6 +2125,7 @@ protected:
 
     std::int64_t _localZOrderAndArrival; /// cache, for 64bits compress optimize.
     int _localZOrder; /// < Local order (relative to its siblings) used to sort the node
+    bool _reorderPending;           ///< whether the order changed since the node was last sorted with its siblings
 
     float _globalZOrder;            ///< Global order used to sort the node
 
@@ -1947,6 +2158,20 @@ protected:
                                           ///< Used by Layer and Scene.
 
     bool _reorderChildDirty;          ///< children order dirty flag
+    bool _batchingChildren;           ///< whether several children are being added or removed at once
+    unsigned char _batchRemoval;      ///< state of the node while its parent removes several children at once
+    bool _parallelVisitEnabled;       ///< whether the children are visited by the renderer recording threads
+    int _serialVisitCount;            ///< nodes of the subtree, itself included, which must be visited by the main thread
+    bool _subtreeCullingEnabled;      ///< whether the subtree is skipped when out of the frustum
+    bool _subtreeBoundsDirty;         ///< whether _subtreeBounds needs to be computed again
+    bool _subtreeBoundsKnown;         ///< false if the bounds of a node of the subtree aren't known
+    AABB _subtreeBounds;              ///< bounds of the node and its visible descendants, in its space
+    uint32_t _culledFlags;            ///< dirty flags received while the subtree was culled or drawn baked
+    bool _subtreeContentDirty;        ///< whether the baked geometry of the frozen ancestors needs to be baked again
+    StaticBatch* _staticBatch;        ///< baked geometry of the subtree, when it is frozen
+    TransformSystem* _transformSystem; ///< system multiplying the transforms of the scene, when it is enabled
+    int _transformIndex;              ///< index of the node in the arrays of the transform system
+    NodeIndex* _nodeIndex;            ///< index of the names and tags of the scene, when it is enabled
     bool _isTransitionFinished;       ///< flag to indicate whether the transition was finished
 
 #if CC_ENABLE_SCRIPT_BINDING
@@ -1991,6 +2216,10 @@ public:
     friend class PhysicsBody;
 #endif
 
+    friend class StaticBatch;
+    friend class TransformSystem;
+    friend class NodeIndex;
+
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(Node);
 };
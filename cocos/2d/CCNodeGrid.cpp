@@ -56,7 +56,8 @@ NodeGrid::NodeGrid()
 , _nodeGrid(nullptr)
 , _gridRect(Rect::ZERO)
 {
-
+    // the grid loads its projection into the Director matrix stack while visited
+    requireSerialVisit();
 }
 
 void NodeGrid::setTarget(Node* target)
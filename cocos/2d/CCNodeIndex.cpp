@@ -0,0 +1,179 @@
+/****************************************************************************
+ Copyright (c) 2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "2d/CCNodeIndex.h"
+
+#include <iterator>
+
+#include "2d/CCNode.h"
+
+NS_CC_BEGIN
+
+NodeIndex::NodeIndex(Node* root)
+: _root(root)
+{
+    _root->_nodeIndex = this;
+    for (const auto& child : _root->_children)
+    {
+        if (child->_parent == _root)
+            addChild(child);
+    }
+}
+
+NodeIndex::~NodeIndex()
+{
+    // the nodes of the scene are still alive, the removed ones are already cleared
+    clearSubtree(_root);
+}
+
+void NodeIndex::clearSubtree(Node* node)
+{
+    node->_nodeIndex = nullptr;
+    _childCounts.erase(node);
+
+    for (const auto& child : node->_children)
+    {
+        if (child->_parent == node && child->_nodeIndex == this)
+        {
+            removeNode(child);
+            clearSubtree(child);
+        }
+    }
+}
+
+void NodeIndex::addChild(Node* child)
+{
+    Node* parent = child->_parent;
+    CCASSERT(parent && parent->_nodeIndex == this, "The parent must be indexed");
+
+    addNode(child);
+    ++_childCounts[parent];
+    child->_nodeIndex = this;
+
+    for (const auto& grandChild : child->_children)
+    {
+        // bones are also in the children of their parent bone
+        if (grandChild->_parent == child)
+            addChild(grandChild);
+    }
+}
+
+void NodeIndex::removeChild(Node* child)
+{
+    removeNode(child);
+
+    auto it = _childCounts.find(child->_parent);
+    if (it != _childCounts.end() && --it->second == 0)
+        _childCounts.erase(it);
+
+    clearSubtree(child);
+}
+
+void NodeIndex::addNode(Node* node)
+{
+    if (!node->_name.empty())
+    {
+        Key key = {node->_parent, node->_hashOfName};
+        _names.insert(std::make_pair(key, node));
+    }
+    if (node->_tag != Node::INVALID_TAG)
+    {
+        Key key = {node->_parent, static_cast<size_t>(node->_tag)};
+        _tags.insert(std::make_pair(key, node));
+    }
+}
+
+void NodeIndex::removeNode(Node* node)
+{
+    if (!node->_name.empty())
+    {
+        Key key = {node->_parent, node->_hashOfName};
+        eraseEntry(_names, key, node);
+    }
+    if (node->_tag != Node::INVALID_TAG)
+    {
+        Key key = {node->_parent, static_cast<size_t>(node->_tag)};
+        eraseEntry(_tags, key, node);
+    }
+}
+
+void NodeIndex::eraseEntry(Entries& entries, const Key& key, Node* node)
+{
+    auto range = entries.equal_range(key);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        if (it->second == node)
+        {
+            entries.erase(it);
+            return;
+        }
+    }
+}
+
+bool NodeIndex::isComplete(const Node* parent) const
+{
+    auto it = _childCounts.find(parent);
+    const ssize_t count = (it != _childCounts.end()) ? it->second : 0;
+    return count == parent->_children.size();
+}
+
+bool NodeIndex::findChildByName(const Node* parent, const std::string& name, size_t hash, Node** child) const
+{
+    if (!isComplete(parent))
+        return false;
+
+    Node* found = nullptr;
+    Key key = {parent, hash};
+    auto range = _names.equal_range(key);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        // different names may have the same hash
+        if (it->second->_name == name)
+        {
+            // the first one of the children is returned
+            if (found)
+                return false;
+            found = it->second;
+        }
+    }
+
+    *child = found;
+    return true;
+}
+
+bool NodeIndex::findChildByTag(const Node* parent, int tag, Node** child) const
+{
+    if (!isComplete(parent))
+        return false;
+
+    Key key = {parent, static_cast<size_t>(tag)};
+    auto range = _tags.equal_range(key);
+    if (range.first != range.second && std::next(range.first) != range.second)
+        return false;
+
+    *child = (range.first != range.second) ? range.first->second : nullptr;
+    return true;
+}
+
+NS_CC_END
@@ -0,0 +1,138 @@
+/****************************************************************************
+ Copyright (c) 2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CC_NODE_INDEX_H__
+#define __CC_NODE_INDEX_H__
+
+#include <string>
+#include <unordered_map>
+
+#include "base/ccTypes.h"
+
+NS_CC_BEGIN
+
+class Node;
+
+/**
+ * @addtogroup _2d
+ * @{
+ */
+
+/** @brief NodeIndex maps the names and the tags of the children of a scene to the nodes.
+ *
+ * Node::getChildByName(), Node::getChildByTag() and Node::enumerateChildren() use it instead of
+ * iterating over the children. It is updated when a child is added or removed, and when the name or the
+ * tag of a child changes.
+ *
+ * The children which a subclass adds to its children array without Node::addChild() aren't indexed.
+ * The lookups on such a parent, or among children sharing the same name or tag, iterate over the
+ * children as usual.
+ *
+ * It is owned by the scene, see Scene::setNodeIndexEnabled().
+ * @since v3.13
+ */
+class CC_DLL NodeIndex
+{
+public:
+    /**
+     * @js ctor
+     */
+    explicit NodeIndex(Node* root);
+    /**
+     * @js NA
+     * @lua NA
+     */
+    ~NodeIndex();
+
+    /** Indexes a child added to a node of the index, and its descendants. */
+    void addChild(Node* child);
+
+    /** Forgets a child removed from its parent, and its descendants. */
+    void removeChild(Node* child);
+
+    /** Indexes the name and the tag of a child. */
+    void addNode(Node* node);
+
+    /** Forgets the name and the tag of a child, before they change. */
+    void removeNode(Node* node);
+
+    /** Finds the child with a name.
+     *
+     * @param parent A node of the index.
+     * @param name The name to search.
+     * @param hash The hash of the name.
+     * @param child The child found, or nullptr if there isn't any.
+     * @return False if the children of the parent have to be searched instead.
+     */
+    bool findChildByName(const Node* parent, const std::string& name, size_t hash, Node** child) const;
+
+    /** Finds the child with a tag.
+     *
+     * @param parent A node of the index.
+     * @param tag The tag to search.
+     * @param child The child found, or nullptr if there isn't any.
+     * @return False if the children of the parent have to be searched instead.
+     */
+    bool findChildByTag(const Node* parent, int tag, Node** child) const;
+
+    /** Returns the number of indexed names and tags */
+    ssize_t getEntryCount() const { return _names.size() + _tags.size(); }
+
+protected:
+    struct Key
+    {
+        const Node* parent;
+        size_t value;
+
+        bool operator==(const Key& other) const { return parent == other.parent && value == other.value; }
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(const Key& key) const
+        {
+            return std::hash<const Node*>()(key.parent) ^ (key.value * 0x9e3779b9u);
+        }
+    };
+
+    typedef std::unordered_multimap<Key, Node*, KeyHash> Entries;
+
+    // whether all the children of the parent are indexed
+    bool isComplete(const Node* parent) const;
+    void clearSubtree(Node* node);
+    static void eraseEntry(Entries& entries, const Key& key, Node* node);
+
+    Node* _root;
+    Entries _names;
+    Entries _tags;
+    // number of indexed children of each parent
+    std::unordered_map<const Node*, ssize_t> _childCounts;
+};
+
+// end of _2d group
+/// @}
+
+NS_CC_END
+
+#endif //__CC_NODE_INDEX_H__
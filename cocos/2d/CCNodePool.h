@@ -0,0 +1,244 @@
+/****************************************************************************
+ Copyright (c) 2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CC_NODE_POOL_H__
+#define __CC_NODE_POOL_H__
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+#include "2d/CCNode.h"
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup _2d
+ * @{
+ */
+
+/** @struct NodePoolStats
+ * Counters of a NodePool, since it was created or since resetStats() was called.
+ * @since v3.13
+ */
+struct CC_DLL NodePoolStats
+{
+    /** Nodes created because the pool was empty */
+    unsigned int created;
+    /** Nodes taken out of the pool */
+    unsigned int reused;
+    /** Nodes put back into the pool */
+    unsigned int unused;
+    /** Nodes released because the pool was full */
+    unsigned int discarded;
+    /** Largest number of nodes the pool held */
+    ssize_t peakSize;
+};
+
+/** @brief NodePool keeps the nodes which aren't used anymore, to use them again instead of creating new ones.
+ *
+ * A node put back into the pool is removed from its parent without being cleaned up. Its scheduled
+ * callbacks and its event listeners stay registered but paused, and its children, its program state and
+ * its buffers are kept. Node::unuse() is called on it, and Node::reuse() is called before it is taken out
+ * of the pool again.
+ *
+ * @code
+ * NodePool<Sprite> bullets([]() { return Sprite::createWithSpriteFrameName("bullet.png"); });
+ * bullets.reserve(100);
+ *
+ * auto bullet = bullets.get();
+ * layer->addChild(bullet);
+ * ...
+ * bullets.put(bullet);
+ * @endcode
+ *
+ * @since v3.13
+ */
+template<class T>
+class NodePool
+{
+public:
+    /** Default maximum number of pooled nodes */
+    static const ssize_t DEFAULT_CAPACITY = 256;
+
+    /** Creates a pool creating its nodes with T::create().
+     * @js NA
+     */
+    explicit NodePool(ssize_t capacity = DEFAULT_CAPACITY)
+    : _createFunc([]() { return T::create(); })
+    , _capacity(capacity)
+    {
+        static_assert(std::is_base_of<Node, T>::value, "NodePool: T must be a Node");
+        resetStats();
+    }
+
+    /** Creates a pool creating its nodes with a function.
+     *
+     * @param createFunc A function returning an autoreleased node.
+     * @param capacity The maximum number of pooled nodes.
+     * @js NA
+     */
+    explicit NodePool(const std::function<T*()>& createFunc, ssize_t capacity = DEFAULT_CAPACITY)
+    : _createFunc(createFunc)
+    , _capacity(capacity)
+    {
+        static_assert(std::is_base_of<Node, T>::value, "NodePool: T must be a Node");
+        resetStats();
+    }
+
+    /**
+     * @js NA
+     * @lua NA
+     */
+    ~NodePool()
+    {
+        clear();
+    }
+
+    /** Takes a node out of the pool, or creates one if the pool is empty.
+     *
+     * @return An autoreleased node, as returned by create(), or nullptr if it couldn't be created.
+     */
+    T* get()
+    {
+        T* node = nullptr;
+        if (_nodes.empty())
+        {
+            node = _createFunc();
+            if (!node)
+                return nullptr;
+            ++_stats.created;
+        }
+        else
+        {
+            // the reference of the pool is handed to the autorelease pool
+            node = _nodes.back();
+            _nodes.pop_back();
+            node->autorelease();
+            ++_stats.reused;
+        }
+
+        node->reuse();
+        return node;
+    }
+
+    /** Removes a node from its parent, and puts it back into the pool.
+     * The node is released instead if the pool is full.
+     */
+    void put(T* node)
+    {
+        CCASSERT(node != nullptr, "Invalid node");
+        CCASSERT(std::find(_nodes.begin(), _nodes.end(), node) == _nodes.end(), "The node is already in the pool");
+
+        node->retain();
+        // the scheduled callbacks and the event listeners are only paused
+        node->removeFromParentAndCleanup(false);
+        node->unuse();
+        ++_stats.unused;
+
+        if ((ssize_t)_nodes.size() >= _capacity)
+        {
+            ++_stats.discarded;
+            node->cleanup();
+            node->release();
+            return;
+        }
+
+        _nodes.push_back(node);
+        _stats.peakSize = std::max(_stats.peakSize, (ssize_t)_nodes.size());
+    }
+
+    /** Creates nodes until the pool holds count nodes, so that they aren't created while the game runs. */
+    void reserve(ssize_t count)
+    {
+        count = std::min(count, _capacity);
+        while ((ssize_t)_nodes.size() < count)
+        {
+            T* node = _createFunc();
+            if (!node)
+                break;
+            ++_stats.created;
+            node->retain();
+            _nodes.push_back(node);
+        }
+        _stats.peakSize = std::max(_stats.peakSize, (ssize_t)_nodes.size());
+    }
+
+    /** Releases the pooled nodes. */
+    void clear()
+    {
+        for (auto node : _nodes)
+        {
+            node->cleanup();
+            node->release();
+        }
+        _nodes.clear();
+    }
+
+    /** Returns the number of pooled nodes */
+    ssize_t size() const { return (ssize_t)_nodes.size(); }
+
+    /** Sets the maximum number of pooled nodes, releasing the pooled nodes above it. */
+    void setCapacity(ssize_t capacity)
+    {
+        _capacity = capacity;
+        while ((ssize_t)_nodes.size() > _capacity)
+        {
+            _nodes.back()->cleanup();
+            _nodes.back()->release();
+            _nodes.pop_back();
+            ++_stats.discarded;
+        }
+    }
+
+    /** Returns the maximum number of pooled nodes */
+    ssize_t getCapacity() const { return _capacity; }
+
+    /** Returns the counters of the pool */
+    const NodePoolStats& getStats() const { return _stats; }
+
+    /** Resets the counters of the pool */
+    void resetStats()
+    {
+        _stats.created = 0;
+        _stats.reused = 0;
+        _stats.unused = 0;
+        _stats.discarded = 0;
+        _stats.peakSize = (ssize_t)_nodes.size();
+    }
+
+protected:
+    std::function<T*()> _createFunc;
+    // retained, not running
+    std::vector<T*> _nodes;
+    ssize_t _capacity;
+    NodePoolStats _stats;
+};
+
+// end of _2d group
+/// @}
+
+NS_CC_END
+
+#endif //__CC_NODE_POOL_H__
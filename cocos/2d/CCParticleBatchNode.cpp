@@ -31,6 +31,7 @@
 #include "2d/CCParticleBatchNode.h"
 #include "2d/CCGrid.h"
 #include "2d/CCParticleSystem.h"
+#include "2d/CCNodeIndex.h"
 #include "renderer/CCTextureCache.h"
 #include "renderer/CCQuadCommand.h"
 #include "renderer/CCRenderer.h"
@@ -225,6 +226,9 @@ int ParticleBatchNode::addChildHelper(ParticleSystem* child, int z, int aTag, co
 
     child->setParent(this);
 
+    if (_nodeIndex)
+        _nodeIndex->addChild(child);
+
     if( _running )
     {
         child->onEnter();
@@ -405,6 +409,7 @@ void ParticleBatchNode::draw(Renderer *renderer, const Mat4 &transform, uint32_t
     {
         return;
     }
+    _textureAtlas->getTexture()->requestLOD(0);
     _batchCommand.init(_globalZOrder, getGLProgram(), _blendFunc, _textureAtlas, _modelViewTransform, flags);
     renderer->addCommand(&_batchCommand);
     CC_PROFILER_STOP("CCParticleBatchNode - draw");
@@ -465,6 +470,10 @@ void ParticleBatchNode::updateAllAtlasIndexes()
     int index = 0;
     
     for(const auto &child : _children) {
+        // detached by removeChildren(), which erases it from the children array at the end
+        if (child->getParent() != this)
+            continue;
+
         ParticleSystem* partiSys = static_cast<ParticleSystem*>(child);
         partiSys->setAtlasIndex(index);
         index += partiSys->getTotalParticles();
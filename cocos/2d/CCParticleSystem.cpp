@@ -809,6 +809,19 @@ void ParticleSystem::onExit()
     Node::onExit();
 }
 
+void ParticleSystem::unuse()
+{
+    Node::unuse();
+    stopSystem();
+}
+
+void ParticleSystem::reuse()
+{
+    Node::reuse();
+    // emits again from the start, without the particles of the previous use
+    resetSystem();
+}
+
 void ParticleSystem::stopSystem()
 {
     _isActive = false;
@@ -832,6 +845,13 @@ bool ParticleSystem::isFull()
 }
 
 // ParticleSystem - MainLoop
+bool ParticleSystem::getLocalDrawBounds(AABB* bounds) const
+{
+    // the particles move away from the emitter, and may be positioned in world space
+    bounds->reset();
+    return false;
+}
+
 void ParticleSystem::update(float dt)
 {
     CC_PROFILER_START_CATEGORY(kProfilerCategoryParticles , "CCParticleSystem - update");
@@ -744,7 +744,10 @@ public:
     // Overrides
     virtual void onEnter() override;
     virtual void onExit() override;
+    virtual void unuse() override;
+    virtual void reuse() override;
     virtual void update(float dt) override;
+    virtual bool getLocalDrawBounds(AABB* bounds) const override;
     virtual Texture2D* getTexture() const override;
     virtual void setTexture(Texture2D *texture) override;
     /**
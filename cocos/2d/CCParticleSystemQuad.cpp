@@ -62,8 +62,7 @@ ParticleSystemQuad::~ParticleSystemQuad()
         glDeleteBuffers(2, &_buffersVBO[0]);
         if (Configuration::getInstance()->supportsShareableVAO())
         {
-            glDeleteVertexArrays(1, &_VAOname);
-            GL::bindVAO(0);
+            GL::deleteVertexArrays(1, &_VAOname);
         }
     }
 }
@@ -463,6 +462,8 @@ void ParticleSystemQuad::draw(Renderer *renderer, const Mat4 &transform, uint32_
     //quad command
     if(_particleCount > 0)
     {
+        if (_texture)
+            _texture->requestLOD(0);
         _quadCommand.init(_globalZOrder, _texture, getGLProgramState(), _blendFunc, _quads, _particleCount, transform, flags);
         renderer->addCommand(&_quadCommand);
     }
@@ -548,6 +549,16 @@ void ParticleSystemQuad::setTotalParticles(int tp)
 
 void ParticleSystemQuad::setupVBOandVAO()
 {
+    // set up by the render thread, see GL::genVertexArrays()
+    auto renderer = Director::getInstance()->getRenderer();
+    if (!renderer->isRenderThread())
+    {
+        renderer->runOnRenderThread([this]() {
+            setupVBOandVAO();
+        }, true);
+        return;
+    }
+
     // clean VAO
     glDeleteBuffers(2, &_buffersVBO[0]);
     glDeleteVertexArrays(1, &_VAOname);
@@ -682,8 +693,7 @@ void ParticleSystemQuad::setBatchNode(ParticleBatchNode * batchNode)
             memset(_buffersVBO, 0, sizeof(_buffersVBO));
             if (Configuration::getInstance()->supportsShareableVAO())
             {
-                glDeleteVertexArrays(1, &_VAOname);
-                GL::bindVAO(0);
+                GL::deleteVertexArrays(1, &_VAOname);
                 _VAOname = 0;
             }
         }
@@ -30,6 +30,7 @@
 
 #include "base/CCDirector.h"
 #include "2d/CCScene.h"
+#include "renderer/CCBatchDiagnostics.h"
 
 NS_CC_BEGIN
 
@@ -317,6 +318,7 @@ void ProtectedNode::visit(Renderer* renderer, const Mat4 &parentTransform, uint3
     //
     // draw self
     //
+    BatchDiagnostics::setDrawingNode(this);
     if (isVisitableByVisitingCamera())
         this->draw(renderer, _modelViewTransform, flags);
     
@@ -467,4 +469,11 @@ void ProtectedNode::setCameraMask(unsigned short mask, bool applyChildren)
     
 }
 
+void ProtectedNode::mergeChildrenSubtreeBounds()
+{
+    // the protected children are visited too, so an ancestor culling the subtree must include them
+    Node::mergeChildrenSubtreeBounds();
+    mergeSubtreeBounds(_protectedChildren);
+}
+
 NS_CC_END
@@ -189,6 +189,8 @@ protected:
     
     /// helper that reorder a child
     void insertProtectedChild(Node* child, int z);
+
+    virtual void mergeChildrenSubtreeBounds() override;
     
     Vector<Node*> _protectedChildren;        ///< array of children nodes
     bool _reorderProtectedChildDirty;
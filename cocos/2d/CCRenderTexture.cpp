@@ -61,6 +61,9 @@ RenderTexture::RenderTexture()
 , _sprite(nullptr)
 , _saveFileCallback(nullptr)
 {
+    // begin() and end(), called by draw() when auto drawing, load the projection of the texture into the Director matrix stack
+    requireSerialVisit();
+
 #if CC_ENABLE_CACHE_TEXTURE_DATA
     // Listen this event to save render texture before come to background.
     // Then it can be restored after coming to foreground on Android.
@@ -77,16 +80,22 @@ RenderTexture::~RenderTexture()
     CC_SAFE_RELEASE(_sprite);
     CC_SAFE_RELEASE(_textureCopy);
     
-    glDeleteFramebuffers(1, &_FBO);
-    if (_depthRenderBufffer)
-    {
-        glDeleteRenderbuffers(1, &_depthRenderBufffer);
-    }
+    // the frame buffer object belongs to the context of the render thread
+    GLuint fbo = _FBO;
+    GLuint depthRenderBuffer = _depthRenderBufffer;
+    GLuint stencilRenderBuffer = _stencilRenderBufffer;
+    _director->getRenderer()->runOnRenderThread([fbo, depthRenderBuffer, stencilRenderBuffer]() {
+        glDeleteFramebuffers(1, &fbo);
+        if (depthRenderBuffer)
+        {
+            glDeleteRenderbuffers(1, &depthRenderBuffer);
+        }
 
-    if (_stencilRenderBufffer)
-    {
-        glDeleteRenderbuffers(1, &_stencilRenderBufffer);
-    }
+        if (stencilRenderBuffer)
+        {
+            glDeleteRenderbuffers(1, &stencilRenderBuffer);
+        }
+    });
 
     CC_SAFE_DELETE(_UITextureImage);
 }
@@ -190,6 +199,17 @@ bool RenderTexture::initWithWidthAndHeight(int w, int h, Texture2D::PixelFormat
 {
     CCASSERT(format != Texture2D::PixelFormat::A8, "only RGB and RGBA formats are valid for a render texture");
 
+    // set up by the render thread, see GL::genFramebuffers()
+    auto renderer = _director->getRenderer();
+    if (!renderer->isRenderThread())
+    {
+        bool result = false;
+        renderer->runOnRenderThread([&]() {
+            result = initWithWidthAndHeight(w, h, format, depthStencilFormat);
+        }, true);
+        return result;
+    }
+
     bool ret = false;
     void *data = nullptr;
     do 
@@ -535,6 +555,17 @@ Image* RenderTexture::newImage(bool fliimage)
 {
     CCASSERT(_pixelFormat == Texture2D::PixelFormat::RGBA8888, "only RGBA8888 can be saved as image");
 
+    // reads the frame buffer object once the queued frames are rendered into it
+    auto renderer = _director->getRenderer();
+    if (!renderer->isRenderThread())
+    {
+        Image* image = nullptr;
+        renderer->runOnRenderThread([&]() {
+            image = newImage(fliimage);
+        }, true);
+        return image;
+    }
+
     if (nullptr == _texture)
     {
         return nullptr;
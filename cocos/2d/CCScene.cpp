@@ -28,11 +28,14 @@ THE SOFTWARE.
 #include "2d/CCScene.h"
 #include "base/CCDirector.h"
 #include "2d/CCCamera.h"
+#include "2d/CCTransformSystem.h"
+#include "2d/CCNodeIndex.h"
 #include "base/CCEventDispatcher.h"
 #include "base/CCEventListenerCustom.h"
 #include "base/ccUTF8.h"
 #include "renderer/CCRenderer.h"
 #include "renderer/CCFrameBuffer.h"
+#include "renderer/CCOcclusionCuller.h"
 
 #if CC_USE_PHYSICS
 #include "physics/CCPhysicsWorld.h"
@@ -50,6 +53,8 @@ THE SOFTWARE.
 NS_CC_BEGIN
 
 Scene::Scene()
+: _ownTransformSystem(nullptr)
+, _ownNodeIndex(nullptr)
 {
 #if CC_USE_3D_PHYSICS && CC_ENABLE_BULLET_INTEGRATION
     _physics3DWorld = nullptr;
@@ -79,6 +84,8 @@ Scene::Scene()
 
 Scene::~Scene()
 {
+    CC_SAFE_DELETE(_ownTransformSystem);
+    CC_SAFE_DELETE(_ownNodeIndex);
 #if CC_USE_3D_PHYSICS && CC_ENABLE_BULLET_INTEGRATION
     CC_SAFE_RELEASE(_physics3DWorld);
     CC_SAFE_RELEASE(_physics3dDebugCamera);
@@ -102,6 +109,39 @@ Scene::~Scene()
 #endif // CC_ENABLE_GC_FOR_NATIVE_OBJECTS
 }
 
+void Scene::setTransformSystemEnabled(bool enabled)
+{
+    if (enabled == (_ownTransformSystem != nullptr))
+        return;
+
+    if (enabled)
+    {
+        // the scene is laid out in the arrays by the first update
+        _ownTransformSystem = new (std::nothrow) TransformSystem(this);
+        _transformSystem = _ownTransformSystem;
+    }
+    else
+    {
+        CC_SAFE_DELETE(_ownTransformSystem);
+    }
+}
+
+void Scene::setNodeIndexEnabled(bool enabled)
+{
+    if (enabled == (_ownNodeIndex != nullptr))
+        return;
+
+    if (enabled)
+    {
+        // indexes the children already added
+        _ownNodeIndex = new (std::nothrow) NodeIndex(this);
+    }
+    else
+    {
+        CC_SAFE_DELETE(_ownNodeIndex);
+    }
+}
+
 #if CC_USE_NAVMESH
 void Scene::setNavMesh(NavMesh* navMesh)
 {
@@ -190,6 +230,9 @@ void Scene::render(Renderer* renderer, const Mat4& eyeTransform, const Mat4* eye
     Camera* defaultCamera = nullptr;
     const auto& transform = getNodeToParentTransform();
 
+    if (_ownTransformSystem)
+        _ownTransformSystem->update(transform);
+
     for (const auto& camera : getCameras())
     {
         if (!camera->isVisible())
@@ -217,6 +260,8 @@ void Scene::render(Renderer* renderer, const Mat4& eyeTransform, const Mat4* eye
         camera->apply();
         //clear background with max depth
         camera->clearBackground();
+        //rasterize the occluders seen by this camera
+        renderer->getOcclusionCuller()->prepare(camera);
         //visit the scene
         visit(renderer, transform, 0);
 #if CC_USE_NAVMESH
@@ -227,6 +272,7 @@ void Scene::render(Renderer* renderer, const Mat4& eyeTransform, const Mat4* eye
 #endif
 
         renderer->render();
+        renderer->getOcclusionCuller()->reset();
         camera->restore();
 
         director->popMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_PROJECTION);
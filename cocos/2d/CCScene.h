@@ -38,6 +38,8 @@ class BaseLight;
 class Renderer;
 class EventListenerCustom;
 class EventCustom;
+class TransformSystem;
+class NodeIndex;
 #if CC_USE_PHYSICS
 class PhysicsWorld;
 #endif
@@ -113,6 +115,30 @@ public:
     
     /** override function */
     virtual void removeAllChildren() override;
+
+    /** Sets whether the transforms of the scene are multiplied in one pass over contiguous arrays before it is
+     * visited, see TransformSystem. It suits large scenes whose nodes are rarely added or removed.
+     *
+     * @param enabled True to use the transform system, false to multiply the transforms during the visit. Default is false.
+     * @since v3.13
+     */
+    void setTransformSystemEnabled(bool enabled);
+    /** Returns whether the transforms of the scene are multiplied by a TransformSystem.
+     * @since v3.13
+     */
+    bool isTransformSystemEnabled() const { return _ownTransformSystem != nullptr; }
+
+    /** Sets whether the names and the tags of the children of the scene are indexed, see NodeIndex.
+     * getChildByName(), getChildByTag() and enumerateChildren() then don't iterate over the children.
+     *
+     * @param enabled True to index the children, false to iterate over them. Default is false.
+     * @since v3.13
+     */
+    void setNodeIndexEnabled(bool enabled);
+    /** Returns whether the names and the tags of the children of the scene are indexed.
+     * @since v3.13
+     */
+    bool isNodeIndexEnabled() const { return _ownNodeIndex != nullptr; }
     
 CC_CONSTRUCTOR_ACCESS:
     Scene();
@@ -137,6 +163,8 @@ protected:
     Camera*              _defaultCamera; //weak ref, default camera created by scene, _cameras[0], Caution that the default camera can not be added to _cameras before onEnter is called
     bool                 _cameraOrderDirty; // order is dirty, need sort
     EventListenerCustom*       _event;
+    TransformSystem*           _ownTransformSystem;
+    NodeIndex*                 _ownNodeIndex;
 
     std::vector<BaseLight *> _lights;
     
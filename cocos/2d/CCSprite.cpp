@@ -37,6 +37,7 @@ THE SOFTWARE.
 #include "renderer/CCTexture2D.h"
 #include "renderer/CCRenderer.h"
 #include "base/CCDirector.h"
+#include "platform/CCGLView.h"
 #include "base/ccUTF8.h"
 #include "2d/CCCamera.h"
 
@@ -164,6 +165,23 @@ bool Sprite::initWithTexture(Texture2D *texture, const Rect& rect)
     return initWithTexture(texture, rect, false);
 }
 
+// Returns the page of the dynamic atlas where the texture was packed, with the rect offset in it
+static Texture2D* getDynamicAtlasPage(TextureCache* textureCache, Texture2D* texture, Rect* rect)
+{
+    auto dynamicAtlas = textureCache->getDynamicAtlas();
+    if (dynamicAtlas)
+    {
+        Rect rectInPixels = CC_RECT_POINTS_TO_PIXELS(*rect);
+        auto page = dynamicAtlas->getPage(texture, &rectInPixels);
+        if (page)
+        {
+            *rect = CC_RECT_PIXELS_TO_POINTS(rectInPixels);
+            return page;
+        }
+    }
+    return texture;
+}
+
 bool Sprite::initWithFile(const std::string& filename)
 {
     if (filename.empty())
@@ -175,11 +193,13 @@ bool Sprite::initWithFile(const std::string& filename)
     _fileName = filename;
     _fileType = 0;
 
-    Texture2D *texture = _director->getTextureCache()->addImage(filename);
+    auto textureCache = _director->getTextureCache();
+    Texture2D *texture = textureCache->addImage(filename);
     if (texture)
     {
         Rect rect = Rect::ZERO;
         rect.size = texture->getContentSize();
+        texture = getDynamicAtlasPage(textureCache, texture, &rect);
         return initWithTexture(texture, rect);
     }
 
@@ -200,10 +220,13 @@ bool Sprite::initWithFile(const std::string &filename, const Rect& rect)
     _fileName = filename;
     _fileType = 0;
 
-    Texture2D *texture = _director->getTextureCache()->addImage(filename);
+    auto textureCache = _director->getTextureCache();
+    Texture2D *texture = textureCache->addImage(filename);
     if (texture)
     {
-        return initWithTexture(texture, rect);
+        Rect rectInTexture = rect;
+        texture = getDynamicAtlasPage(textureCache, texture, &rectInTexture);
+        return initWithTexture(texture, rectInTexture);
     }
 
     // don't release here.
@@ -393,6 +416,7 @@ void Sprite::setTexture(Texture2D *texture)
         CC_SAFE_RELEASE(_texture);
         _texture = texture;
         updateBlendFunc();
+        markSubtreeContentDirty();
     }
 }
 
@@ -454,6 +478,7 @@ void Sprite::setTextureRect(const Rect& rect, bool rotated, const Size& untrimme
     }
     
     _polyInfo.setQuad(&_quad);
+    markSubtreeContentDirty();
 }
 
 // override this method to generate "double scale" sprites
@@ -663,6 +688,15 @@ void Sprite::draw(Renderer *renderer, const Mat4 &transform, uint32_t flags)
     if(_insideBounds)
 #endif
     {
+        // texels of the texture rect shown by each pixel of the sprite on screen
+        if (_texture->isStreamed())
+        {
+            const float width = Vec3(transform.m[0], transform.m[1], transform.m[2]).length() * _contentSize.width;
+            const float height = Vec3(transform.m[4], transform.m[5], transform.m[6]).length() * _contentSize.height;
+            const float pixelScale = Director::getInstance()->getOpenGLView()->getScaleX() / CC_CONTENT_SCALE_FACTOR();
+            _texture->requestLOD(std::min(_rect.size.width / width, _rect.size.height / height) / pixelScale);
+        }
+
         _trianglesCommand.init(_globalZOrder, 
             _texture, 
             getGLProgramState(), 
@@ -953,6 +987,7 @@ void Sprite::setFlippedX(bool flippedX)
         if (_textureAtlas) {
             setDirty(true);
         }
+        markSubtreeContentDirty();
     }
 }
 
@@ -973,6 +1008,7 @@ void Sprite::setFlippedY(bool flippedY)
         if (_textureAtlas) {
             setDirty(true);
         }
+        markSubtreeContentDirty();
     }
 }
 
@@ -1018,6 +1054,8 @@ void Sprite::updateColor(void)
 
     // self render
     // do nothing
+
+    markSubtreeContentDirty();
 }
 
 void Sprite::setOpacityModifyRGB(bool modify)
@@ -1196,6 +1234,7 @@ const PolygonInfo& Sprite::getPolygonInfo() const
 void Sprite::setPolygonInfo(const PolygonInfo& info)
 {
     _polyInfo = info;
+    markSubtreeContentDirty();
 }
 
 NS_CC_END
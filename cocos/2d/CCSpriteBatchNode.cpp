@@ -28,6 +28,7 @@ THE SOFTWARE.
 
 #include "2d/CCSpriteBatchNode.h"
 #include "2d/CCSprite.h"
+#include "2d/CCStaticBatch.h"
 #include "base/CCDirector.h"
 #include "base/CCProfiling.h"
 #include "base/ccUTF8.h"
@@ -163,7 +164,8 @@ void SpriteBatchNode::visit(Renderer *renderer, const Mat4 &parentTransform, uin
         _director->pushMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
         _director->loadMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW, _modelViewTransform);
         
-        draw(renderer, _modelViewTransform, flags);
+        if (!_staticBatch || !_staticBatch->draw(this, renderer, _modelViewTransform, flags))
+            draw(renderer, _modelViewTransform, flags);
         
         _director->popMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
         // FIX ME: Why need to set _orderOfArrival to 0??
@@ -381,6 +383,9 @@ void SpriteBatchNode::draw(Renderer *renderer, const Mat4 &transform, uint32_t f
         child->updateTransform();
     }
 
+    // the quads may show the texture at any scale, so it keeps its full resolution when it is streamed
+    _textureAtlas->getTexture()->requestLOD(0);
+
     _batchCommand.init(_globalZOrder, getGLProgram(), _blendFunc, _textureAtlas, transform, flags);
     renderer->addCommand(&_batchCommand);
 }
@@ -624,6 +629,7 @@ void SpriteBatchNode::updateBlendFunc()
 void SpriteBatchNode::setBlendFunc(const BlendFunc &blendFunc)
 {
     _blendFunc = blendFunc;
+    markSubtreeContentDirty();
 }
 
 const BlendFunc& SpriteBatchNode::getBlendFunc() const
@@ -640,6 +646,7 @@ void SpriteBatchNode::setTexture(Texture2D *texture)
 {
     _textureAtlas->setTexture(texture);
     updateBlendFunc();
+    markSubtreeContentDirty();
 }
 
 
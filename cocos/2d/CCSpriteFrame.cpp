@@ -111,6 +111,17 @@ bool SpriteFrame::initWithTexture(Texture2D* texture, const Rect& rect, bool rot
 
 bool SpriteFrame::initWithTextureFilename(const std::string& filename, const Rect& rect, bool rotated, const Vec2& offset, const Size& originalSize)
 {
+    // if the image was packed in the dynamic atlas, the frame uses its region in the page
+    auto textureCache = Director::getInstance()->getTextureCache();
+    if (textureCache->isDynamicAtlasEnabled() && !filename.empty())
+    {
+        auto texture = textureCache->addImage(filename);
+        Rect rectInPage = rect;
+        auto page = texture ? textureCache->getDynamicAtlas()->getPage(texture, &rectInPage) : nullptr;
+        if (page)
+            return initWithTexture(page, rectInPage, rotated, offset, originalSize);
+    }
+
     _texture = nullptr;
     _textureFilename = filename;
     _rectInPixels = rect;
@@ -0,0 +1,285 @@
+/****************************************************************************
+ Copyright (c) 2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "2d/CCStaticBatch.h"
+
+#include <typeinfo>
+
+#include "2d/CCLayer.h"
+#include "2d/CCSprite.h"
+#include "2d/CCSpriteBatchNode.h"
+#include "renderer/CCGLProgramState.h"
+#include "renderer/CCPrimitive.h"
+#include "renderer/CCRenderer.h"
+#include "renderer/CCTextureAtlas.h"
+#include "renderer/CCVertexIndexBuffer.h"
+
+NS_CC_BEGIN
+
+// triangles of a V3F_C4B_T2F_Quad, as indexed by TextureAtlas
+static const unsigned short QUAD_INDICES[6] = {0, 1, 2, 3, 2, 1};
+
+StaticBatch::StaticBatch()
+: _chunkFirstRun(0)
+, _baked(false)
+{
+}
+
+StaticBatch::~StaticBatch()
+{
+    clear();
+}
+
+bool StaticBatch::draw(Node* root, Renderer* renderer, const Mat4& transform, uint32_t flags)
+{
+    if (root->_subtreeContentDirty)
+    {
+        // the buffers can only be created by the thread owning the GL context
+        if (renderer->isRecordingInParallel())
+            return false;
+
+        bake(root);
+    }
+
+    if (!_baked)
+        return false;
+
+    for (size_t i = 0; i < _runs.size(); ++i)
+    {
+        const auto& run = _runs[i];
+        _commands[i].init(root->getGlobalZOrder(), run.textureID, run.glProgramState, run.blendFunc, run.primitive, transform, flags);
+        renderer->addCommand(&_commands[i]);
+    }
+    return true;
+}
+
+void StaticBatch::clear()
+{
+    for (auto& run : _runs)
+    {
+        CC_SAFE_RELEASE(run.glProgramState);
+        CC_SAFE_RELEASE(run.primitive);
+    }
+    _runs.clear();
+    _commands.clear();
+    _chunkFirstRun = 0;
+    _baked = false;
+}
+
+void StaticBatch::bake(Node* root)
+{
+    clear();
+
+    _baked = true;
+    bakeNode(root, root, Mat4::IDENTITY);
+    if (_baked)
+        flushChunk();
+    else
+        clear();
+
+    // the geometry is only needed again when the subtree changes
+    std::vector<V3F_C4B_T2F>().swap(_vertices);
+    std::vector<unsigned short>().swap(_indices);
+
+    _commands.resize(_runs.size());
+}
+
+void StaticBatch::bakeNode(Node* node, Node* root, const Mat4& transform)
+{
+    node->_subtreeContentDirty = false;
+
+    if (!node->isVisible())
+    {
+        for (const auto child : node->getChildren())
+            cleanSubtree(child);
+        return;
+    }
+
+    if (node != root && (node->getCameraMask() != root->getCameraMask() || node->getGlobalZOrder() != root->getGlobalZOrder()))
+        _baked = false;
+
+    // the children of a SpriteBatchNode are drawn from its quads
+    if (typeid(*node) == typeid(SpriteBatchNode))
+    {
+        bakeSelf(node, root, transform);
+        for (const auto child : node->getChildren())
+            cleanSubtree(child);
+        return;
+    }
+
+    // same order as Node::visit()
+    node->sortAllChildren();
+    const auto& children = node->getChildren();
+
+    ssize_t i = 0;
+    for ( ; i < children.size() && children.at(i)->getLocalZOrder() < 0; ++i)
+    {
+        auto child = children.at(i);
+        bakeNode(child, root, transform * child->getNodeToParentTransform());
+    }
+
+    bakeSelf(node, root, transform);
+
+    for ( ; i < children.size(); ++i)
+    {
+        auto child = children.at(i);
+        bakeNode(child, root, transform * child->getNodeToParentTransform());
+    }
+}
+
+void StaticBatch::bakeSelf(Node* node, Node* root, const Mat4& transform)
+{
+    if (!_baked)
+        return;
+
+    const std::type_info& type = typeid(*node);
+    if (type == typeid(Node) || type == typeid(Layer))
+    {
+        // nothing to draw
+    }
+    else if (type == typeid(Sprite))
+    {
+        auto sprite = static_cast<Sprite*>(node);
+        auto texture = sprite->getTexture();
+        if (sprite->getBatchNode() || !texture || texture->getAlphaTextureName() != 0
+            || sprite->getGLProgramState() != GLProgramState::getOrCreateWithGLProgramName(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_NO_MVP))
+        {
+            _baked = false;
+            return;
+        }
+
+        // the baked vertices are transformed by the model view matrix of the root
+        auto glProgramState = GLProgramState::getOrCreateWithGLProgramName(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR);
+        const auto& triangles = sprite->getPolygonInfo().triangles;
+        append(texture->getName(), glProgramState, sprite->getBlendFunc(),
+               triangles.verts, triangles.vertCount, triangles.indices, triangles.indexCount, transform);
+    }
+    else if (type == typeid(SpriteBatchNode))
+    {
+        auto batchNode = static_cast<SpriteBatchNode*>(node);
+        auto texture = batchNode->getTexture();
+        auto glProgramState = batchNode->getGLProgramState();
+        if (!texture || texture->getAlphaTextureName() != 0 || !glProgramState || glProgramState->getVertexAttribsFlags() != 0)
+        {
+            _baked = false;
+            return;
+        }
+
+        // same as SpriteBatchNode::visit()
+        batchNode->sortAllChildren();
+        for (const auto child : batchNode->getChildren())
+            child->updateTransform();
+
+        auto textureAtlas = batchNode->getTextureAtlas();
+        const V3F_C4B_T2F_Quad* quads = textureAtlas->getQuads();
+        for (ssize_t i = 0; i < textureAtlas->getTotalQuads(); ++i)
+        {
+            append(texture->getName(), glProgramState, batchNode->getBlendFunc(),
+                   &quads[i].tl, 4, QUAD_INDICES, 6, transform);
+        }
+    }
+    else
+    {
+        _baked = false;
+    }
+}
+
+void StaticBatch::cleanSubtree(Node* node)
+{
+    node->_subtreeContentDirty = false;
+    for (const auto child : node->getChildren())
+        cleanSubtree(child);
+}
+
+void StaticBatch::append(GLuint textureID, GLProgramState* glProgramState, const BlendFunc& blendFunc,
+                         const V3F_C4B_T2F* verts, int vertCount, const unsigned short* indices, int indexCount, const Mat4& transform)
+{
+    if (vertCount <= 0 || indexCount <= 0)
+        return;
+
+    CCASSERT(vertCount <= MAX_VERTICES, "Too many vertices");
+    if (_vertices.size() + vertCount > MAX_VERTICES)
+        flushChunk();
+
+    if (_runs.size() == _chunkFirstRun
+        || _runs.back().textureID != textureID
+        || _runs.back().glProgramState != glProgramState
+        || _runs.back().blendFunc != blendFunc)
+    {
+        Run run;
+        run.textureID = textureID;
+        run.glProgramState = glProgramState;
+        run.blendFunc = blendFunc;
+        run.primitive = nullptr;
+        run.start = (int)_indices.size();
+        run.count = 0;
+        glProgramState->retain();
+        _runs.push_back(run);
+    }
+
+    const auto base = (unsigned short)_vertices.size();
+    for (int i = 0; i < vertCount; ++i)
+    {
+        V3F_C4B_T2F vertex = verts[i];
+        transform.transformPoint(&vertex.vertices);
+        _vertices.push_back(vertex);
+    }
+    for (int i = 0; i < indexCount; ++i)
+    {
+        _indices.push_back(base + indices[i]);
+    }
+    _runs.back().count += indexCount;
+}
+
+void StaticBatch::flushChunk()
+{
+    if (_vertices.empty())
+        return;
+
+    auto vertexBuffer = VertexBuffer::create(sizeof(V3F_C4B_T2F), (int)_vertices.size());
+    vertexBuffer->updateVertices(_vertices.data(), (int)_vertices.size(), 0);
+
+    auto indexBuffer = IndexBuffer::create(IndexBuffer::IndexType::INDEX_TYPE_SHORT_16, (int)_indices.size());
+    indexBuffer->updateIndices(_indices.data(), (int)_indices.size(), 0);
+
+    auto vertexData = VertexData::create();
+    vertexData->setStream(vertexBuffer, VertexStreamAttribute(0, GLProgram::VERTEX_ATTRIB_POSITION, GL_FLOAT, 3));
+    vertexData->setStream(vertexBuffer, VertexStreamAttribute(offsetof(V3F_C4B_T2F, colors), GLProgram::VERTEX_ATTRIB_COLOR, GL_UNSIGNED_BYTE, 4, true));
+    vertexData->setStream(vertexBuffer, VertexStreamAttribute(offsetof(V3F_C4B_T2F, texCoords), GLProgram::VERTEX_ATTRIB_TEX_COORD, GL_FLOAT, 2));
+
+    for (size_t i = _chunkFirstRun; i < _runs.size(); ++i)
+    {
+        auto primitive = Primitive::create(vertexData, indexBuffer, GL_TRIANGLES);
+        primitive->setStart(_runs[i].start);
+        primitive->setCount(_runs[i].count);
+        primitive->retain();
+        _runs[i].primitive = primitive;
+    }
+
+    _chunkFirstRun = _runs.size();
+    _vertices.clear();
+    _indices.clear();
+}
+
+NS_CC_END
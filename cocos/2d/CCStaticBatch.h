@@ -0,0 +1,132 @@
+/****************************************************************************
+ Copyright (c) 2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CC_STATIC_BATCH_H__
+#define __CC_STATIC_BATCH_H__
+
+#include <vector>
+
+#include "base/ccTypes.h"
+#include "renderer/CCPrimitiveCommand.h"
+
+NS_CC_BEGIN
+
+class Node;
+class Renderer;
+class Primitive;
+class GLProgramState;
+
+/**
+ * @addtogroup _2d
+ * @{
+ */
+
+/** @brief StaticBatch draws a frozen subtree from vertex buffers baked once in the space of its root.
+ *
+ * The geometry of the sprites of the subtree, and the quads of its SpriteBatchNodes, is transformed
+ * to the space of the root and uploaded to static vertex and index buffers. Each frame the subtree is
+ * drawn with one PrimitiveCommand per run of consecutive geometry sharing the same texture, program
+ * and blend function, without visiting its nodes. Moving the root doesn't bake the subtree again.
+ *
+ * The subtree is baked again when a node of it changes, see Node::markSubtreeContentDirty().
+ * Only subtrees made of Node, Layer, Sprite and SpriteBatchNode objects drawn with the default shaders,
+ * with the same camera mask and global Z order as the root, can be baked. Other subtrees are visited as usual.
+ *
+ * It is owned by the frozen node, see Node::setFrozen().
+ * @since v3.13
+ */
+class CC_DLL StaticBatch
+{
+public:
+    /** Maximum number of vertices of a vertex buffer, indexed with 16 bits indices */
+    static const int MAX_VERTICES = 65535;
+
+    /**
+     * @js ctor
+     */
+    StaticBatch();
+    /**
+     * @js NA
+     * @lua NA
+     */
+    ~StaticBatch();
+
+    /** Adds the commands drawing the subtree of the root, baking it first if it changed.
+     *
+     * @param root The frozen node owning the batch.
+     * @param renderer The renderer the commands are added to.
+     * @param transform The model view transform of the root.
+     * @param flags The flags of the root.
+     * @return False if the subtree can't be baked, then it should be visited as usual.
+     */
+    bool draw(Node* root, Renderer* renderer, const Mat4& transform, uint32_t flags);
+
+    /** Releases the baked buffers. */
+    void clear();
+
+    /** Returns the number of commands drawing the subtree */
+    ssize_t getCommandCount() const { return _runs.size(); }
+
+    /** Returns whether the last bake succeeded */
+    bool isBaked() const { return _baked; }
+
+protected:
+    // consecutive triangles drawn with the same state
+    struct Run
+    {
+        GLuint textureID;
+        GLProgramState* glProgramState;
+        BlendFunc blendFunc;
+        Primitive* primitive;
+        int start;
+        int count;
+    };
+
+    void bake(Node* root);
+    void bakeNode(Node* node, Node* root, const Mat4& transform);
+    void bakeSelf(Node* node, Node* root, const Mat4& transform);
+    // clears the dirty flags of a subtree whose geometry is already baked or isn't drawn
+    void cleanSubtree(Node* node);
+    void append(GLuint textureID, GLProgramState* glProgramState, const BlendFunc& blendFunc,
+                const V3F_C4B_T2F* verts, int vertCount, const unsigned short* indices, int indexCount, const Mat4& transform);
+    // uploads the geometry appended since the previous chunk
+    void flushChunk();
+
+    std::vector<Run> _runs;
+    std::vector<PrimitiveCommand> _commands;
+
+    // geometry of the chunk being baked
+    std::vector<V3F_C4B_T2F> _vertices;
+    std::vector<unsigned short> _indices;
+    size_t _chunkFirstRun;
+
+    bool _baked;
+};
+
+// end of _2d group
+/// @}
+
+NS_CC_END
+
+#endif //__CC_STATIC_BATCH_H__
@@ -0,0 +1,231 @@
+/****************************************************************************
+ Copyright (c) 2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "2d/CCTransformSystem.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "2d/CCNode.h"
+
+NS_CC_BEGIN
+
+TransformSystem::TransformSystem(Node* root)
+: _root(root)
+, _removedCount(0)
+, _updateID(0)
+, _mainThreadID(std::this_thread::get_id())
+, _rebuildPending(true)
+, _rescanPending(false)
+{
+}
+
+TransformSystem::~TransformSystem()
+{
+    // the nodes of the scene are still alive, the removed ones are already cleared
+    clearSubtree(_root);
+}
+
+void TransformSystem::clearSubtree(Node* node)
+{
+    if (node->_transformSystem != this)
+        return;
+
+    node->_transformSystem = nullptr;
+    node->_transformIndex = -1;
+    for (const auto& child : node->_children)
+    {
+        clearSubtree(child);
+    }
+}
+
+void TransformSystem::rebuild()
+{
+    _nodes.clear();
+    _parents.clear();
+    _dirtyIndices.clear();
+    _removedCount = 0;
+    append(_root, -1);
+
+    const size_t count = _nodes.size();
+    _localTransforms.resize(count);
+    _worldTransforms.resize(count);
+    _changed.assign(count, 1);
+    _copied.assign(count, 0);
+    _updateIDs.assign(count, 0);
+    _rebuildPending = false;
+
+    // multiplies the whole scene from the root
+    _dirtyIndices.push_back(0);
+}
+
+void TransformSystem::append(Node* node, int parentIndex)
+{
+    const int index = (int)_nodes.size();
+    node->_transformSystem = this;
+    node->_transformIndex = index;
+    _nodes.push_back(node);
+    _parents.push_back(parentIndex);
+
+    for (const auto& child : node->_children)
+    {
+        append(child, index);
+    }
+}
+
+void TransformSystem::addSubtree(Node* node)
+{
+    // the next update appends it with the rest of the scene
+    if (_rebuildPending)
+        return;
+
+    const int index = (int)_nodes.size();
+    append(node, node->getParent()->_transformIndex);
+
+    const size_t count = _nodes.size();
+    _localTransforms.resize(count);
+    _worldTransforms.resize(count);
+    _changed.resize(count, 1);
+    _copied.resize(count, 0);
+    _updateIDs.resize(count, 0);
+    _dirtyIndices.push_back(index);
+}
+
+void TransformSystem::removeSubtree(Node* node)
+{
+    if (node->_transformSystem != this)
+        return;
+
+    const int index = node->_transformIndex;
+    if (!_rebuildPending && index >= 0 && _nodes[index] == node)
+    {
+        _nodes[index] = nullptr;
+        ++_removedCount;
+        if (_removedCount * 2 > (ssize_t)_nodes.size())
+            _rebuildPending = true;
+    }
+
+    node->_transformSystem = nullptr;
+    node->_transformIndex = -1;
+    for (const auto& child : node->_children)
+    {
+        removeSubtree(child);
+    }
+}
+
+void TransformSystem::markDirty(Node* node)
+{
+    // the next rebuild multiplies every node
+    const int index = node->_transformIndex;
+    if (_rebuildPending || node->_transformSystem != this || index < 0 || _changed[index])
+        return;
+
+    _changed[index] = 1;
+    // nodes visited in parallel may change, only the main thread touches the queue
+    if (std::this_thread::get_id() == _mainThreadID)
+        _dirtyIndices.push_back(index);
+    else
+        _rescanPending = true;
+}
+
+void TransformSystem::update(const Mat4& parentTransform)
+{
+    if (_rebuildPending)
+        rebuild();
+
+    if (memcmp(&_rootParentTransform, &parentTransform, sizeof(Mat4)) != 0)
+    {
+        _rootParentTransform = parentTransform;
+        _dirtyIndices.push_back(0);
+    }
+
+    if (_rescanPending.exchange(false))
+    {
+        for (size_t i = 0, count = _changed.size(); i < count; ++i)
+        {
+            if (_changed[i] && _nodes[i])
+                _dirtyIndices.push_back((int)i);
+        }
+    }
+
+    if (_dirtyIndices.empty())
+        return;
+
+    // the parents come first, so a changed node's ancestors are up to date when it is reached,
+    // and the changed descendants of a changed node are multiplied with it
+    ++_updateID;
+    std::sort(_dirtyIndices.begin(), _dirtyIndices.end());
+    for (int index : _dirtyIndices)
+    {
+        if (_nodes[index] && _updateIDs[index] != _updateID)
+            updateSubtree(index);
+    }
+    _dirtyIndices.clear();
+}
+
+void TransformSystem::updateSubtree(int index)
+{
+    Node* node = _nodes[index];
+    if (_changed[index])
+    {
+        _localTransforms[index] = node->getNodeToParentTransform();
+        _changed[index] = 0;
+    }
+
+    const int parentIndex = _parents[index];
+    const Mat4& parentWorld = (parentIndex < 0) ? _rootParentTransform : _worldTransforms[parentIndex];
+    Mat4::multiply(parentWorld, _localTransforms[index], &_worldTransforms[index]);
+    _updateIDs[index] = _updateID;
+
+    for (const auto& child : node->_children)
+    {
+        if (child->_transformSystem == this && child->_transformIndex >= 0)
+            updateSubtree(child->_transformIndex);
+    }
+}
+
+bool TransformSystem::getWorldTransform(const Node* node, const Mat4& parentTransform, Mat4* transform)
+{
+    const int index = node->_transformIndex;
+    if (_rebuildPending || index < 0 || index >= (int)_nodes.size() || _nodes[index] != node)
+        return false;
+
+    // the node changed after the update, or the parent passes another transform than the one it copied
+    bool valid = !_changed[index];
+    if (valid)
+    {
+        const int parentIndex = _parents[index];
+        if (parentIndex < 0)
+            valid = memcmp(&_rootParentTransform, &parentTransform, sizeof(Mat4)) == 0;
+        else
+            valid = _copied[parentIndex] && &parentTransform == &_nodes[parentIndex]->_modelViewTransform;
+    }
+
+    _copied[index] = valid;
+    if (valid)
+        *transform = _worldTransforms[index];
+    return valid;
+}
+
+NS_CC_END
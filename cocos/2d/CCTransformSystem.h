@@ -0,0 +1,138 @@
+/****************************************************************************
+ Copyright (c) 2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CC_TRANSFORM_SYSTEM_H__
+#define __CC_TRANSFORM_SYSTEM_H__
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "base/ccTypes.h"
+#include "math/Mat4.h"
+
+NS_CC_BEGIN
+
+class Node;
+
+/**
+ * @addtogroup _2d
+ * @{
+ */
+
+/** @brief TransformSystem multiplies the transforms of a scene in one linear pass before it is visited.
+ *
+ * The nodes of the scene are stored in arrays ordered so that each parent comes before its children,
+ * with their local transforms and their world transforms next to each other. The nodes whose transform changes
+ * are queued by Node::markTransformChanged(). Before the scene is visited, the world transforms of the queued nodes
+ * and of their descendants are multiplied with the SSE or NEON implementation of Mat4::multiply(), the other nodes
+ * aren't touched. Node::visit() then copies the world transform from the arrays.
+ *
+ * A node whose transform changes while the scene is visited, or which is visited with another transform than
+ * the one its parent copied, multiplies its transform as usual. Adding a node appends its subtree to the arrays,
+ * and removing it leaves holes which are compacted once they are the majority.
+ *
+ * It is owned by the scene, see Scene::setTransformSystemEnabled().
+ * @since v3.13
+ */
+class CC_DLL TransformSystem
+{
+public:
+    /**
+     * @js ctor
+     */
+    explicit TransformSystem(Node* root);
+    /**
+     * @js NA
+     * @lua NA
+     */
+    ~TransformSystem();
+
+    /** Multiplies the world transforms of the nodes which changed since the last update.
+     *
+     * @param parentTransform The transform the root is visited with.
+     */
+    void update(const Mat4& parentTransform);
+
+    /** Appends a node added to a node of the system, and its descendants. */
+    void addSubtree(Node* node);
+
+    /** Removes a node and its descendants, which are leaving the system. */
+    void removeSubtree(Node* node);
+
+    /** Queues a node of the system whose local transform changed, for the next update. */
+    void markDirty(Node* node);
+
+    /** Copies the world transform of the node computed by the last update, if it is still valid.
+     * It can be called by several threads at once, for different nodes.
+     *
+     * @param node A node of the system.
+     * @param parentTransform The transform the node is visited with.
+     * @param transform The world transform of the node.
+     * @return False if the transform of the node changed since the last update, or if it isn't visited
+     * with the world transform its parent copied.
+     */
+    bool getWorldTransform(const Node* node, const Mat4& parentTransform, Mat4* transform);
+
+    /** Returns the number of nodes in the system */
+    ssize_t getNodeCount() const { return _nodes.size() - _removedCount; }
+
+protected:
+    void rebuild();
+    void append(Node* node, int parentIndex);
+    void clearSubtree(Node* node);
+    void updateSubtree(int index);
+
+    Node* _root;
+
+    // the nodes, parents first, nullptr once removed
+    std::vector<Node*> _nodes;
+    std::vector<int> _parents;
+    std::vector<Mat4> _localTransforms;
+    std::vector<Mat4> _worldTransforms;
+    // whether the local transform changed since the last update, or was never read
+    std::vector<unsigned char> _changed;
+    // whether the last visit of the node copied its world transform
+    std::vector<unsigned char> _copied;
+    // the update in which the world transform was last multiplied
+    std::vector<unsigned int> _updateIDs;
+    // the changed nodes queued on the main thread
+    std::vector<int> _dirtyIndices;
+
+    Mat4 _rootParentTransform;
+    ssize_t _removedCount;
+    unsigned int _updateID;
+    std::thread::id _mainThreadID;
+    // the arrays are filled again by the next update
+    bool _rebuildPending;
+    // a node changed on another thread, the next update looks for the changed nodes
+    std::atomic<bool> _rescanPending;
+};
+
+// end of _2d group
+/// @}
+
+NS_CC_END
+
+#endif //__CC_TRANSFORM_SYSTEM_H__
@@ -78,6 +78,28 @@ static const char          *s_spotLightUniformRangeInverseName = "u_SpotLightSou
 
 static const char          *s_ambientLightUniformColorName = "u_AmbientLightSourceColor";
 
+// same order as Mesh::MeshUniform
+static const char          *s_meshUniformNames[] =
+{
+    "u_color",
+    "u_matrixPalette",
+    s_dirLightUniformColorName,
+    s_dirLightUniformDirName,
+    s_pointLightUniformColorName,
+    s_pointLightUniformPositionName,
+    s_pointLightUniformRangeInverseName,
+    s_spotLightUniformColorName,
+    s_spotLightUniformPositionName,
+    s_spotLightUniformDirName,
+    s_spotLightUniformInnerAngleCosName,
+    s_spotLightUniformOuterAngleCosName,
+    s_spotLightUniformRangeInverseName,
+    s_ambientLightUniformColorName,
+};
+
+// the program states of the passes replaced more often than that are looked up again
+static const size_t MAX_CACHED_UNIFORM_HANDLES = 16;
+
 // helpers
 void Mesh::resetLightUniformValues()
 {
@@ -145,6 +167,7 @@ Mesh::~Mesh()
     CC_SAFE_RELEASE(_meshIndexData);
     CC_SAFE_RELEASE(_material);
     CC_SAFE_RELEASE(_glProgramState);
+    clearUniformHandles();
 }
 
 GLuint Mesh::getVertexBuffer() const
@@ -345,6 +368,8 @@ void Mesh::setMaterial(Material* material)
         CC_SAFE_RETAIN(_material);
     }
 
+    clearUniformHandles();
+
     if (_material)
     {
         for (auto technique: _material->getTechniques())
@@ -355,6 +380,19 @@ void Mesh::setMaterial(Material* material)
                 pass->setVertexAttribBinding(vertexAttribBinding);
             }
         }
+
+        // the mesh can be drawn instanced if all the programs read the model view per instance
+        bool instanced = true;
+        for (const auto pass : _material->_currentTechnique->_passes)
+        {
+            if (!pass->getGLProgramState()->getGLProgram()->getVertexAttrib(GLProgram::ATTRIBUTE_NAME_INSTANCE_MODELVIEW))
+                instanced = false;
+        }
+        _meshCommand.setInstanced(instanced);
+    }
+    else
+    {
+        _meshCommand.setInstanced(false);
     }
     // Was the texture set before the GLProgramState ? Set it
     for(auto& tex : _textures)
@@ -382,6 +420,10 @@ void Mesh::draw(Renderer* renderer, float globalZOrder, const Mat4& transform, u
     if (isTransparent)
         flags |= Node::FLAGS_RENDER_AS_3D;
 
+    // the render state is set before init() since instanced commands hash it
+    _material->getStateBlock()->setDepthWrite(true);
+    _material->getStateBlock()->setBlend(_force2DQueue || isTransparent);
+
     _meshCommand.init(globalZ,
                       _material,
                       getVertexBuffer(),
@@ -392,17 +434,10 @@ void Mesh::draw(Renderer* renderer, float globalZOrder, const Mat4& transform, u
                       transform,
                       flags);
 
-
-//    if (isTransparent && !forceDepthWrite)
-//        _material->getStateBlock()->setDepthWrite(false);
-//    else
-        _material->getStateBlock()->setDepthWrite(true);
-
-
     _meshCommand.setSkipBatching(isTransparent);
     _meshCommand.setTransparent(isTransparent);
+    _meshCommand.setInstanceColor(color);
     _meshCommand.set3D(!_force2DQueue);
-    _material->getStateBlock()->setBlend(_force2DQueue || isTransparent);
 
     // set default uniforms for Mesh
     // 'u_color' and others
@@ -411,10 +446,13 @@ void Mesh::draw(Renderer* renderer, float globalZOrder, const Mat4& transform, u
     for(const auto pass : technique->_passes)
     {
         auto programState = pass->getGLProgramState();
-        programState->setUniformVec4("u_color", color);
+        auto handles = getUniformHandles(programState);
+        // instanced programs read the color per instance
+        if (!_meshCommand.isInstanced())
+            programState->setUniformVec4(handles[MESH_UNIFORM_COLOR], color);
 
         if (_skin)
-            programState->setUniformVec4v("u_matrixPalette", (GLsizei)_skin->getMatrixPaletteSize(), _skin->getMatrixPalette());
+            programState->setUniformVec4v(handles[MESH_UNIFORM_MATRIX_PALETTE], (GLsizei)_skin->getMatrixPaletteSize(), _skin->getMatrixPalette());
 
         if (scene && scene->getLights().size() > 0)
             setLightUniforms(pass, scene, color, lightMask);
@@ -529,6 +567,7 @@ void Mesh::setLightUniforms(Pass* pass, Scene* scene, const Vec4& color, unsigne
     auto &lights = scene->getLights();
 
     auto glProgramState = pass->getGLProgramState();
+    auto handles = getUniformHandles(glProgramState);
     auto attributes = pass->getVertexAttributeBinding()->getVertexAttribsFlags();
 
     if (attributes & (1 << GLProgram::VERTEX_ATTRIB_NORMAL))
@@ -610,28 +649,28 @@ void Mesh::setLightUniforms(Pass* pass, Scene* scene, const Vec4& color, unsigne
 
         if (0 < maxDirLight)
         {
-            glProgramState->setUniformVec3v(s_dirLightUniformColorName, _dirLightUniformColorValues.size(), &_dirLightUniformColorValues[0]);
-            glProgramState->setUniformVec3v(s_dirLightUniformDirName, _dirLightUniformDirValues.size(), &_dirLightUniformDirValues[0]);
+            glProgramState->setUniformVec3v(handles[MESH_UNIFORM_DIR_LIGHT_COLOR], _dirLightUniformColorValues.size(), &_dirLightUniformColorValues[0]);
+            glProgramState->setUniformVec3v(handles[MESH_UNIFORM_DIR_LIGHT_DIR], _dirLightUniformDirValues.size(), &_dirLightUniformDirValues[0]);
         }
 
         if (0 < maxPointLight)
         {
-            glProgramState->setUniformVec3v(s_pointLightUniformColorName, _pointLightUniformColorValues.size(), &_pointLightUniformColorValues[0]);
-            glProgramState->setUniformVec3v(s_pointLightUniformPositionName, _pointLightUniformPositionValues.size(), &_pointLightUniformPositionValues[0]);
-            glProgramState->setUniformFloatv(s_pointLightUniformRangeInverseName, _pointLightUniformRangeInverseValues.size(), &_pointLightUniformRangeInverseValues[0]);
+            glProgramState->setUniformVec3v(handles[MESH_UNIFORM_POINT_LIGHT_COLOR], _pointLightUniformColorValues.size(), &_pointLightUniformColorValues[0]);
+            glProgramState->setUniformVec3v(handles[MESH_UNIFORM_POINT_LIGHT_POSITION], _pointLightUniformPositionValues.size(), &_pointLightUniformPositionValues[0]);
+            glProgramState->setUniformFloatv(handles[MESH_UNIFORM_POINT_LIGHT_RANGE_INVERSE], _pointLightUniformRangeInverseValues.size(), &_pointLightUniformRangeInverseValues[0]);
         }
 
         if (0 < maxSpotLight)
         {
-            glProgramState->setUniformVec3v(s_spotLightUniformColorName, _spotLightUniformColorValues.size(), &_spotLightUniformColorValues[0]);
-            glProgramState->setUniformVec3v(s_spotLightUniformPositionName, _spotLightUniformPositionValues.size(), &_spotLightUniformPositionValues[0]);
-            glProgramState->setUniformVec3v(s_spotLightUniformDirName, _spotLightUniformDirValues.size(), &_spotLightUniformDirValues[0]);
-            glProgramState->setUniformFloatv(s_spotLightUniformInnerAngleCosName, _spotLightUniformInnerAngleCosValues.size(), &_spotLightUniformInnerAngleCosValues[0]);
-            glProgramState->setUniformFloatv(s_spotLightUniformOuterAngleCosName, _spotLightUniformOuterAngleCosValues.size(), &_spotLightUniformOuterAngleCosValues[0]);
-            glProgramState->setUniformFloatv(s_spotLightUniformRangeInverseName, _spotLightUniformRangeInverseValues.size(), &_spotLightUniformRangeInverseValues[0]);
+            glProgramState->setUniformVec3v(handles[MESH_UNIFORM_SPOT_LIGHT_COLOR], _spotLightUniformColorValues.size(), &_spotLightUniformColorValues[0]);
+            glProgramState->setUniformVec3v(handles[MESH_UNIFORM_SPOT_LIGHT_POSITION], _spotLightUniformPositionValues.size(), &_spotLightUniformPositionValues[0]);
+            glProgramState->setUniformVec3v(handles[MESH_UNIFORM_SPOT_LIGHT_DIR], _spotLightUniformDirValues.size(), &_spotLightUniformDirValues[0]);
+            glProgramState->setUniformFloatv(handles[MESH_UNIFORM_SPOT_LIGHT_INNER_ANGLE_COS], _spotLightUniformInnerAngleCosValues.size(), &_spotLightUniformInnerAngleCosValues[0]);
+            glProgramState->setUniformFloatv(handles[MESH_UNIFORM_SPOT_LIGHT_OUTER_ANGLE_COS], _spotLightUniformOuterAngleCosValues.size(), &_spotLightUniformOuterAngleCosValues[0]);
+            glProgramState->setUniformFloatv(handles[MESH_UNIFORM_SPOT_LIGHT_RANGE_INVERSE], _spotLightUniformRangeInverseValues.size(), &_spotLightUniformRangeInverseValues[0]);
         }
 
-        glProgramState->setUniformVec3(s_ambientLightUniformColorName, Vec3(ambientColor.x, ambientColor.y, ambientColor.z));
+        glProgramState->setUniformVec3(handles[MESH_UNIFORM_AMBIENT_LIGHT_COLOR], Vec3(ambientColor.x, ambientColor.y, ambientColor.z));
     }
     else // normal does not exist
     {
@@ -656,11 +695,48 @@ void Mesh::setLightUniforms(Pass* pass, Scene* scene, const Vec4& color, unsigne
         {
             ambient.x /= 255.f; ambient.y /= 255.f; ambient.z /= 255.f;
             //override the uniform value of u_color using the calculated color 
-            glProgramState->setUniformVec4("u_color", Vec4(color.x * ambient.x, color.y * ambient.y, color.z * ambient.z, color.w));
+            glProgramState->setUniformVec4(handles[MESH_UNIFORM_COLOR], Vec4(color.x * ambient.x, color.y * ambient.y, color.z * ambient.z, color.w));
         }
     }
 }
 
+const UniformHandle* Mesh::getUniformHandles(GLProgramState* glProgramState)
+{
+    auto glProgram = glProgramState->getGLProgram();
+    for (const auto& uniformHandles : _uniformHandles)
+    {
+        // the handles only depend on the program
+        if (uniformHandles.glProgramState == glProgramState && uniformHandles.glProgram == glProgram)
+            return uniformHandles.handles;
+    }
+
+    // the program states of the passes were replaced many times, forget the old ones
+    if (_uniformHandles.size() >= MAX_CACHED_UNIFORM_HANDLES)
+        clearUniformHandles();
+
+    // retained so that a new state or program can't be allocated at the same address
+    MeshUniformHandles uniformHandles;
+    uniformHandles.glProgramState = glProgramState;
+    uniformHandles.glProgram = glProgram;
+    glProgramState->retain();
+    glProgram->retain();
+    for (int i = 0; i < MESH_UNIFORM_MAX; ++i)
+        uniformHandles.handles[i] = glProgramState->getUniformHandle(s_meshUniformNames[i]);
+
+    _uniformHandles.push_back(uniformHandles);
+    return _uniformHandles.back().handles;
+}
+
+void Mesh::clearUniformHandles()
+{
+    for (auto& uniformHandles : _uniformHandles)
+    {
+        uniformHandles.glProgramState->release();
+        uniformHandles.glProgram->release();
+    }
+    _uniformHandles.clear();
+}
+
 void Mesh::setBlendFunc(const BlendFunc &blendFunc)
 {
     // Blend must be saved for future use
@@ -34,6 +34,7 @@
 #include "base/CCRef.h"
 #include "math/CCMath.h"
 #include "renderer/CCMeshCommand.h"
+#include "renderer/CCGLProgramState.h"
 
 NS_CC_BEGIN
 
@@ -237,6 +238,34 @@ protected:
     void setLightUniforms(Pass* pass, Scene* scene, const Vec4& color, unsigned int lightmask);
     void bindMeshCommand();
 
+    // uniforms set every frame, looked up once per GLProgramState instead of by name
+    enum MeshUniform
+    {
+        MESH_UNIFORM_COLOR,
+        MESH_UNIFORM_MATRIX_PALETTE,
+        MESH_UNIFORM_DIR_LIGHT_COLOR,
+        MESH_UNIFORM_DIR_LIGHT_DIR,
+        MESH_UNIFORM_POINT_LIGHT_COLOR,
+        MESH_UNIFORM_POINT_LIGHT_POSITION,
+        MESH_UNIFORM_POINT_LIGHT_RANGE_INVERSE,
+        MESH_UNIFORM_SPOT_LIGHT_COLOR,
+        MESH_UNIFORM_SPOT_LIGHT_POSITION,
+        MESH_UNIFORM_SPOT_LIGHT_DIR,
+        MESH_UNIFORM_SPOT_LIGHT_INNER_ANGLE_COS,
+        MESH_UNIFORM_SPOT_LIGHT_OUTER_ANGLE_COS,
+        MESH_UNIFORM_SPOT_LIGHT_RANGE_INVERSE,
+        MESH_UNIFORM_AMBIENT_LIGHT_COLOR,
+        MESH_UNIFORM_MAX
+    };
+    struct MeshUniformHandles
+    {
+        GLProgramState* glProgramState; // retained
+        GLProgram* glProgram; // retained
+        UniformHandle handles[MESH_UNIFORM_MAX];
+    };
+    const UniformHandle* getUniformHandles(GLProgramState* glProgramState);
+    void clearUniformHandles();
+
     std::map<NTextureData::Usage, Texture2D*> _textures; //textures that submesh is using
     MeshSkin*           _skin;     //skin
     bool                _visible; // is the submesh visible
@@ -268,6 +297,8 @@ protected:
     std::vector<float> _spotLightUniformOuterAngleCosValues;
     std::vector<float> _spotLightUniformRangeInverseValues;
 
+    std::vector<MeshUniformHandles> _uniformHandles;
+
     std::string _texFile;
 };
 
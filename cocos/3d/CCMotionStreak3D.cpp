@@ -386,9 +386,9 @@ void MotionStreak3D::onDraw(const Mat4 &transform, uint32_t flags)
 
     GL::bindTexture2D( _texture->getName() );
     
-    glDisable(GL_CULL_FACE);
+    GL::disable(GL_CULL_FACE);
     RenderState::StateBlock::_defaultState->setCullFace(false);
-    glEnable(GL_DEPTH_TEST);
+    GL::enable(GL_DEPTH_TEST);
     RenderState::StateBlock::_defaultState->setDepthTest(true);
 
     glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, 0, _vertices);
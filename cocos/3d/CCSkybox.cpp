@@ -55,8 +55,7 @@ Skybox::~Skybox()
 
     if (Configuration::getInstance()->supportsShareableVAO())
     {
-        glDeleteVertexArrays(1, &_vao);
-        GL::bindVAO(0);
+        GL::deleteVertexArrays(1, &_vao);
         _vao = 0;
     }
 
@@ -104,6 +103,16 @@ bool Skybox::init(const std::string& positive_x, const std::string& negative_x,
 
 void Skybox::initBuffers()
 {
+    // set up by the render thread, see GL::genVertexArrays()
+    auto renderer = Director::getInstance()->getRenderer();
+    if (!renderer->isRenderThread())
+    {
+        renderer->runOnRenderThread([this]() {
+            initBuffers();
+        }, true);
+        return;
+    }
+
     if (Configuration::getInstance()->supportsShareableVAO())
     {
         glGenVertexArrays(1, &_vao);
@@ -166,19 +175,19 @@ void Skybox::onDraw(const Mat4& transform, uint32_t flags)
     cameraModelMat.m[12] = cameraModelMat.m[13] = cameraModelMat.m[14] = 0;
     state->setUniformMat4("u_cameraRot", cameraModelMat);
 
-    glEnable(GL_DEPTH_TEST);
+    GL::enable(GL_DEPTH_TEST);
     RenderState::StateBlock::_defaultState->setDepthTest(true);
 
-    glDepthFunc(GL_LEQUAL);
+    GL::depthFunc(GL_LEQUAL);
     RenderState::StateBlock::_defaultState->setDepthFunction(RenderState::DEPTH_LEQUAL);
 
-    glEnable(GL_CULL_FACE);
+    GL::enable(GL_CULL_FACE);
     RenderState::StateBlock::_defaultState->setCullFace(true);
 
-    glCullFace(GL_BACK);
+    GL::cullFace(GL_BACK);
     RenderState::StateBlock::_defaultState->setCullFaceSide(RenderState::CULL_FACE_SIDE_BACK);
     
-    glDisable(GL_BLEND);
+    GL::disable(GL_BLEND);
     RenderState::StateBlock::_defaultState->setBlend(false);
 
     if (Configuration::getInstance()->supportsShareableVAO())
@@ -39,7 +39,9 @@
 #include "platform/CCPlatformMacros.h"
 #include "platform/CCFileUtils.h"
 #include "renderer/CCTextureCache.h"
+#include "renderer/CCTextureStreamer.h"
 #include "renderer/CCRenderer.h"
+#include "renderer/CCOcclusionCuller.h"
 #include "renderer/CCGLProgramState.h"
 #include "renderer/CCGLProgramCache.h"
 #include "renderer/CCMaterial.h"
@@ -48,7 +50,7 @@
 
 NS_CC_BEGIN
 
-static Sprite3DMaterial* getSprite3DMaterialForAttribs(MeshVertexData* meshVertexData, bool usesLight);
+static Sprite3DMaterial* getSprite3DMaterialForAttribs(MeshVertexData* meshVertexData, bool usesLight, bool instanced);
 
 Sprite3D* Sprite3D::create()
 {
@@ -262,11 +264,14 @@ Sprite3D::Sprite3D()
 , _shaderUsingLight(false)
 , _forceDepthWrite(false)
 , _usingAutogeneratedGLProgram(true)
+, _instancingEnabled(false)
+, _occluder(false)
 {
 }
 
 Sprite3D::~Sprite3D()
 {
+    setOccluder(false);
     _meshes.clear();
     _meshVertexDatas.clear();
     CC_SAFE_RELEASE_NULL(_skeleton);
@@ -483,6 +488,16 @@ Material* Sprite3D::getMaterial(int meshIndex) const
 }
 
 
+void Sprite3D::setInstancingEnabled(bool enabled)
+{
+    if (_instancingEnabled != enabled)
+    {
+        _instancingEnabled = enabled;
+        if (_usingAutogeneratedGLProgram)
+            genMaterial(_shaderUsingLight);
+    }
+}
+
 void Sprite3D::genMaterial(bool useLight)
 {
     _shaderUsingLight = useLight;
@@ -490,7 +505,7 @@ void Sprite3D::genMaterial(bool useLight)
     std::unordered_map<const MeshVertexData*, Sprite3DMaterial*> materials;
     for(auto meshVertexData : _meshVertexDatas)
     {
-        auto material = getSprite3DMaterialForAttribs(meshVertexData, useLight);
+        auto material = getSprite3DMaterialForAttribs(meshVertexData, useLight, _instancingEnabled);
         materials[meshVertexData] = material;
     }
     
@@ -750,12 +765,56 @@ void Sprite3D::visit(cocos2d::Renderer *renderer, const cocos2d::Mat4 &parentTra
     director->popMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
 }
 
+bool Sprite3D::getLocalDrawBounds(AABB* bounds) const
+{
+    bounds->reset();
+    for (const auto& it : _meshes) {
+        if (it->isVisible())
+            bounds->merge(it->getAABB());
+    }
+    return true;
+}
+
+void Sprite3D::setOccluder(bool occluder)
+{
+    if (_occluder == occluder)
+        return;
+
+    auto renderer = Director::getInstance()->getRenderer();
+    if (!renderer)
+        return;
+
+    _occluder = occluder;
+    if (_occluder)
+    {
+        // empty bounds are skipped by the culler
+        renderer->getOcclusionCuller()->addOccluder(this, _occluderBounds);
+    }
+    else
+    {
+        renderer->getOcclusionCuller()->removeOccluder(this);
+    }
+}
+
+void Sprite3D::setOccluderBounds(const AABB& bounds)
+{
+    _occluderBounds = bounds;
+    if (_occluder)
+        Director::getInstance()->getRenderer()->getOcclusionCuller()->addOccluder(this, _occluderBounds);
+}
+
 void Sprite3D::draw(Renderer *renderer, const Mat4 &transform, uint32_t flags)
 {
 #if CC_USE_CULLING
     // camera clipping
     if(_children.size() == 0 && Camera::getVisitingCamera() && !Camera::getVisitingCamera()->isVisibleInFrustum(&getAABB()))
         return;
+
+    // occlusion culling, the occluders themselves are always drawn
+    auto occlusionCuller = renderer->getOcclusionCuller();
+    const bool testOcclusion = !_occluder && occlusionCuller->isEnabled() && occlusionCuller->getOccluderCount() > 0;
+    if (testOcclusion && occlusionCuller->isOccluded(getAABB()))
+        return;
 #endif
     
     if (_skeleton)
@@ -783,8 +842,25 @@ void Sprite3D::draw(Renderer *renderer, const Mat4 &transform, uint32_t flags)
         }
     }
     
+    // the streamed textures are assumed to span the bounding box
     for (auto mesh: _meshes)
     {
+        auto texture = mesh->getTexture();
+        if (texture && texture->isStreamed())
+            TextureStreamer::requestLOD(texture, Camera::getVisitingCamera(), getAABB());
+    }
+
+    for (auto mesh: _meshes)
+    {
+#if CC_USE_CULLING
+        if (testOcclusion && _meshes.size() > 1)
+        {
+            AABB meshBounds(mesh->getAABB());
+            meshBounds.transform(transform);
+            if (occlusionCuller->isOccluded(meshBounds))
+                continue;
+        }
+#endif
         mesh->draw(renderer,
                    _globalZOrder,
                    transform,
@@ -997,7 +1073,7 @@ Sprite3DCache::~Sprite3DCache()
 //
 // MARK: Helpers
 //
-static Sprite3DMaterial* getSprite3DMaterialForAttribs(MeshVertexData* meshVertexData, bool usesLight)
+static Sprite3DMaterial* getSprite3DMaterialForAttribs(MeshVertexData* meshVertexData, bool usesLight, bool instanced)
 {
     bool textured = meshVertexData->hasVertexAttrib(GLProgram::VERTEX_ATTRIB_TEX_COORD);
     bool hasSkin = meshVertexData->hasVertexAttrib(GLProgram::VERTEX_ATTRIB_BLEND_INDEX)
@@ -1019,6 +1095,9 @@ static Sprite3DMaterial* getSprite3DMaterialForAttribs(MeshVertexData* meshVerte
     {
         type = hasNormal && usesLight ? Sprite3DMaterial::MaterialType::DIFFUSE_NOTEX : Sprite3DMaterial::MaterialType::UNLIT_NOTEX;
     }
+
+    if (instanced && type == Sprite3DMaterial::MaterialType::UNLIT && !hasSkin)
+        type = Sprite3DMaterial::MaterialType::UNLIT_INSTANCED;
     
     return Sprite3DMaterial::createBuiltInMaterial(type, hasSkin);
 }
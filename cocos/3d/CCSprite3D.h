@@ -158,6 +158,15 @@ public:
      */
     void setForceDepthWrite(bool value) { _forceDepthWrite = value; }
     bool isForceDepthWrite() const { return _forceDepthWrite;};
+
+    /**
+     * Draws the unlit and non skinned meshes with a material that reads the model view and the color per instance.
+     * Sprite3Ds sharing the same model and texture are then drawn with a single instanced draw call when the GPU
+     * supports it (see Configuration::supportsInstancing()). It has no effect if a Material was set manually.
+     * Disabled by default.
+     */
+    void setInstancingEnabled(bool enabled);
+    bool isInstancingEnabled() const { return _instancingEnabled; }
     
     /**
      * Returns 2d bounding-box
@@ -176,6 +185,21 @@ public:
     
     /**draw*/
     virtual void draw(Renderer *renderer, const Mat4 &transform, uint32_t flags) override;
+    /**bounds of the visible meshes, used by the subtree culling*/
+    virtual bool getLocalDrawBounds(AABB* bounds) const override;
+
+    /**
+     * Sets whether the sprite hides the 3D sprites behind it, see OcclusionCuller.
+     * It hides nothing until setOccluderBounds() gives it a box inside its meshes: the AABB of the meshes
+     * is larger than what they draw, so it would hide sprites which are visible.
+     * @since v3.13
+     */
+    void setOccluder(bool occluder);
+    /** Returns whether the sprite hides the 3D sprites behind it. @since v3.13 */
+    bool isOccluder() const { return _occluder; }
+    /** Sets the box rasterized when the sprite is an occluder, in the sprite's space. It must be inside the meshes,
+     * for a box shaped mesh like a wall it can be the AABB of the mesh. @since v3.13 */
+    void setOccluderBounds(const AABB& bounds);
 
     /** Adds a new material to the sprite.
      The Material will be applied to all the meshes that belong to the sprite.
@@ -265,6 +289,9 @@ protected:
     bool                         _shaderUsingLight; // is current shader using light ?
     bool                         _forceDepthWrite; // Always write to depth buffer
     bool                         _usingAutogeneratedGLProgram;
+    bool                         _instancingEnabled;
+    bool                         _occluder;
+    AABB                         _occluderBounds;
     
     struct AsyncLoadParam
     {
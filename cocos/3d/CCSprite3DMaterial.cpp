@@ -44,6 +44,7 @@ Sprite3DMaterial* Sprite3DMaterial::_vertexLitMaterial = nullptr;
 Sprite3DMaterial* Sprite3DMaterial::_diffuseMaterial = nullptr;
 Sprite3DMaterial* Sprite3DMaterial::_diffuseNoTexMaterial = nullptr;
 Sprite3DMaterial* Sprite3DMaterial::_bumpedDiffuseMaterial = nullptr;
+Sprite3DMaterial* Sprite3DMaterial::_unLitInstancedMaterial = nullptr;
 
 Sprite3DMaterial* Sprite3DMaterial::_unLitMaterialSkin = nullptr;
 Sprite3DMaterial* Sprite3DMaterial::_vertexLitMaterialSkin = nullptr;
@@ -117,6 +118,14 @@ void Sprite3DMaterial::createBuiltInMaterial()
     {
         _bumpedDiffuseMaterialSkin->_type = Sprite3DMaterial::MaterialType::BUMPED_DIFFUSE;
     }
+
+    glProgram = GLProgramCache::getInstance()->getGLProgram(GLProgram::SHADER_3D_POSITION_TEXTURE_INSTANCED);
+    glprogramstate = GLProgramState::create(glProgram);
+    _unLitInstancedMaterial = new (std::nothrow) Sprite3DMaterial();
+    if (_unLitInstancedMaterial && _unLitInstancedMaterial->initWithGLProgramState(glprogramstate))
+    {
+        _unLitInstancedMaterial->_type = Sprite3DMaterial::MaterialType::UNLIT_INSTANCED;
+    }
 }
 
 void Sprite3DMaterial::releaseBuiltInMaterial()
@@ -129,6 +138,7 @@ void Sprite3DMaterial::releaseBuiltInMaterial()
     CC_SAFE_RELEASE_NULL(_diffuseMaterial);
     CC_SAFE_RELEASE_NULL(_diffuseNoTexMaterial);
     CC_SAFE_RELEASE_NULL(_bumpedDiffuseMaterial);
+    CC_SAFE_RELEASE_NULL(_unLitInstancedMaterial);
     
     CC_SAFE_RELEASE_NULL(_vertexLitMaterialSkin);
     CC_SAFE_RELEASE_NULL(_diffuseMaterialSkin);
@@ -201,6 +211,11 @@ Sprite3DMaterial* Sprite3DMaterial::createBuiltInMaterial(MaterialType type, boo
         case Sprite3DMaterial::MaterialType::BUMPED_DIFFUSE:
             material = skinned ? _bumpedDiffuseMaterialSkin : _bumpedDiffuseMaterial;
             break;
+
+        case Sprite3DMaterial::MaterialType::UNLIT_INSTANCED:
+            CCASSERT(!skinned, "skinned meshes can't be drawn instanced");
+            material = _unLitInstancedMaterial;
+            break;
             
         default:
             break;
@@ -58,6 +58,7 @@ public:
         DIFFUSE, // diffuse (pixel lighting)
         DIFFUSE_NOTEX, //diffuse (without texture)
         BUMPED_DIFFUSE, //bumped diffuse
+        UNLIT_INSTANCED, //unlit material, model view and color are read per instance
         
         //Custom material
         CUSTOM, //Create from material file
@@ -123,6 +124,7 @@ protected:
     static Sprite3DMaterial* _diffuseMaterial;
     static Sprite3DMaterial* _diffuseNoTexMaterial;
     static Sprite3DMaterial* _bumpedDiffuseMaterial;
+    static Sprite3DMaterial* _unLitInstancedMaterial;
     
     static Sprite3DMaterial* _unLitMaterialSkin;
     static Sprite3DMaterial* _vertexLitMaterialSkin;
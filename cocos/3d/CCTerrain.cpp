@@ -35,10 +35,13 @@ USING_NS_CC;
 #include "renderer/CCGLProgramStateCache.h"
 #include "renderer/ccGLStateCache.h"
 #include "renderer/CCRenderState.h"
+#include "renderer/CCTextureCache.h"
+#include "renderer/CCTextureStreamer.h"
 #include "base/CCDirector.h"
 #include "base/CCEventType.h"
 #include "2d/CCCamera.h"
 #include "platform/CCImage.h"
+#include "platform/CCFileUtils.h"
 
 NS_CC_BEGIN
 
@@ -51,6 +54,14 @@ static bool isPOT(int number)
     return flag;
 }
 
+// lowers the resolution of the texture while the terrain is far, when the TextureCache streams textures
+static void streamTexture(Texture2D* texture, const std::string& fileName)
+{
+    auto streamer = Director::getInstance()->getTextureCache()->getTextureStreamer();
+    if (streamer && texture)
+        streamer->addTexture(texture, FileUtils::getInstance()->fullPathForFilename(fileName));
+}
+
 Terrain * Terrain::create(TerrainData &parameter, CrackFixedType fixedType)
 {
     Terrain * terrain = new (std::nothrow)Terrain();
@@ -122,6 +133,16 @@ bool Terrain::initProperties()
 
 void Terrain::draw(cocos2d::Renderer *renderer, const cocos2d::Mat4 &transform, uint32_t flags)
 {
+    // the detail maps are repeated detailMapSize times over the terrain
+    auto camera = Camera::getVisitingCamera();
+    const AABB& bounds = _quadRoot->_worldSpaceAABB;
+    for (int i = 0; i < 4; ++i)
+    {
+        const float repeat = _alphaMap ? _terrainData._detailMaps[i]._detailMapSize : 1;
+        TextureStreamer::requestLOD(_detailMapTextures[i], camera, bounds, repeat);
+    }
+    TextureStreamer::requestLOD(_alphaMap, camera, bounds);
+
     _customCommand.func = CC_CALLBACK_0(Terrain::onDraw, this, transform, flags);
     renderer->addCommand(&_customCommand);
 }
@@ -713,6 +734,7 @@ void Terrain::setDetailMap(unsigned int index, DetailMap detailMap)
     textImage->initWithImageFile(detailMap._detailMapSrc);
     _detailMapTextures[index]->initWithImage(textImage);
     delete textImage;
+    streamTexture(_detailMapTextures[index], detailMap._detailMapSrc);
 }
 
 Terrain::ChunkIndices Terrain::lookForIndicesLOD(int neighborLod[4], int selfLod, bool * result)
@@ -869,6 +891,7 @@ bool Terrain::initTextures()
         texParam.magFilter = GL_LINEAR;
         texture->setTexParameters(texParam);
         delete textImage;
+        streamTexture(texture, _terrainData._detailMaps[0]._detailMapSrc);
     }else
     {
         //alpha map
@@ -882,6 +905,7 @@ bool Terrain::initTextures()
         texParam.magFilter = GL_LINEAR;
         _alphaMap->setTexParameters(texParam);
         delete image;
+        streamTexture(_alphaMap, _terrainData._alphaMapSrc);
 
         for(int i =0;i<_terrainData._detailMapAmount;i++)
         {
@@ -898,6 +922,7 @@ bool Terrain::initTextures()
             texParam.minFilter = GL_LINEAR_MIPMAP_LINEAR;
             texParam.magFilter = GL_LINEAR;
             texture->setTexParameters(texParam);
+            streamTexture(texture, _terrainData._detailMaps[i]._detailMapSrc);
         }
     }
     setMaxDetailMapAmount(_terrainData._detailMapAmount);
@@ -74,6 +74,9 @@ cocos2d.cpp \
 2d/CCScene.cpp \
 2d/CCSprite.cpp \
 2d/CCSpriteBatchNode.cpp \
+2d/CCStaticBatch.cpp \
+2d/CCTransformSystem.cpp \
+2d/CCNodeIndex.cpp \
 2d/CCSpriteFrame.cpp \
 2d/CCSpriteFrameCache.cpp \
 2d/CCTMXLayer.cpp \
@@ -135,6 +138,7 @@ base/CCEventTouch.cpp \
 base/CCIMEDispatcher.cpp \
 base/CCNS.cpp \
 base/CCProfiling.cpp \
+base/CCFrameBenchmark.cpp \
 base/CCProperties.cpp \
 base/CCRef.cpp \
 base/CCScheduler.cpp \
@@ -180,6 +184,12 @@ renderer/CCTechnique.cpp \
 renderer/CCTexture2D.cpp \
 renderer/CCTextureAtlas.cpp \
 renderer/CCTextureCache.cpp \
+renderer/CCDynamicAtlas.cpp \
+renderer/CCTextureStreamer.cpp \
+renderer/CCProgramBinaryCache.cpp \
+renderer/CCBatchDiagnostics.cpp \
+renderer/CCFrameArena.cpp \
+renderer/CCOcclusionCuller.cpp \
 renderer/CCTextureCube.cpp \
 renderer/CCTrianglesCommand.cpp \
 renderer/CCVertexAttribBinding.cpp \
@@ -52,6 +52,8 @@ Configuration::Configuration()
 , _supportsOESDepth24(false)
 , _supportsOESPackedDepthStencil(false)
 , _supportsOESMapBuffer(false)
+, _supportsInstancing(false)
+, _supportsProgramBinary(false)
 , _maxSamplesAllowed(0)
 , _maxTextureUnits(0)
 , _glExtensions(nullptr)
@@ -163,6 +165,25 @@ void Configuration::gatherGPUInfo()
     _supportsOESPackedDepthStencil = checkForGLExtension("GL_OES_packed_depth_stencil");
     _valueDict["gl.supports_OES_packed_depth_stencil"] = Value(_supportsOESPackedDepthStencil);
 
+    _supportsInstancing = checkForGLExtension("instanced_arrays");
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32) || (CC_TARGET_PLATFORM == CC_PLATFORM_LINUX)
+    // glew only resolves the core entry points if the context exposes them
+    _supportsInstancing = _supportsInstancing && glDrawElementsInstanced && glVertexAttribDivisor;
+#endif
+    _valueDict["gl.supports_instanced_arrays"] = Value(_supportsInstancing);
+
+#if CC_USE_PROGRAM_BINARY_CACHE
+    // some drivers expose the extension without any binary format
+    GLint programBinaryFormats = 0;
+    _supportsProgramBinary = checkForGLExtension("get_program_binary");
+    if (_supportsProgramBinary)
+    {
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &programBinaryFormats);
+    }
+    _supportsProgramBinary = _supportsProgramBinary && programBinaryFormats > 0 && glGetProgramBinary && glProgramBinary;
+#endif
+    _valueDict["gl.supports_program_binary"] = Value(_supportsProgramBinary);
+
 
     CHECK_GL_ERROR_DEBUG();
 }
@@ -290,6 +311,20 @@ bool Configuration::supportsMapBuffer() const
 #endif
 }
 
+bool Configuration::supportsInstancing() const
+{
+#if CC_USE_INSTANCING
+    return _supportsInstancing;
+#else
+    return false;
+#endif
+}
+
+bool Configuration::supportsProgramBinary() const
+{
+    return _supportsProgramBinary;
+}
+
 bool Configuration::supportsOESDepth24() const
 {
     return _supportsOESDepth24;
@@ -170,6 +170,25 @@ public:
      */
     bool supportsMapBuffer() const;
 
+    /** Whether or not instanced drawing is supported.
+     *
+     * It checks for the `instanced_arrays` extension, and is always `false` when `CC_USE_INSTANCING` is disabled.
+     *
+     * @return Whether or not `glDrawElementsInstanced()` and `glVertexAttribDivisor()` are supported.
+     * @since v3.13
+     */
+    bool supportsInstancing() const;
+
+    /** Whether or not linked programs can be saved and loaded as binaries.
+     *
+     * It checks for the `get_program_binary` extension and at least one binary format, and is always `false`
+     * when `CC_USE_PROGRAM_BINARY_CACHE` is disabled.
+     *
+     * @return Whether or not `glGetProgramBinary()` and `glProgramBinary()` are supported.
+     * @since v3.13
+     */
+    bool supportsProgramBinary() const;
+
     
     /** Max support directional light in shader, for Sprite3D.
      *
@@ -260,6 +279,8 @@ protected:
     bool            _supportsOESMapBuffer;
     bool            _supportsOESDepth24;
     bool            _supportsOESPackedDepthStencil;
+    bool            _supportsInstancing;
+    bool            _supportsProgramBinary;
     
     GLint           _maxSamplesAllowed;
     GLint           _maxTextureUnits;
@@ -65,6 +65,8 @@
 #include "2d/CCScene.h"
 #include "platform/CCFileUtils.h"
 #include "renderer/CCTextureCache.h"
+#include "renderer/CCRenderer.h"
+#include "renderer/CCBatchDiagnostics.h"
 #include "base/base64.h"
 #include "base/ccUtils.h"
 #include "base/allocator/CCAllocatorDiagnostics.h"
@@ -390,6 +392,7 @@ Console::Console()
 , _bindAddress("")
 {
     createCommandAllocator();
+    createCommandBatches();
     createCommandConfig();
     createCommandDebugMsg();
     createCommandDirector();
@@ -895,6 +898,16 @@ void Console::createCommandAllocator()
         CC_CALLBACK_2(Console::commandAllocator, this)});
 }
 
+void Console::createCommandBatches()
+{
+    addCommand({"batches", "Print why the draw calls of the last frame couldn't be batched. Args: [-h | help | on | off | save filename | ]",
+        CC_CALLBACK_2(Console::commandBatches, this)});
+    addSubCommand("batches", {"on", "Start recording the batch breaks.", CC_CALLBACK_2(Console::commandBatchesSubCommandOnOff, this)});
+    addSubCommand("batches", {"off", "Stop recording the batch breaks.", CC_CALLBACK_2(Console::commandBatchesSubCommandOnOff, this)});
+    addSubCommand("batches", {"save", "Save the report of the last frame as JSON, in the writable path.",
+        CC_CALLBACK_2(Console::commandBatchesSubCommandSave, this)});
+}
+
 void Console::createCommandConfig()
 {
     addCommand({"config", "Print the Configuration object. Args: [-h | help | ]",
@@ -1012,6 +1025,50 @@ void Console::commandAllocator(int fd, const std::string& args)
 #endif
 }
 
+void Console::commandBatches(int fd, const std::string& args)
+{
+    Scheduler *sched = Director::getInstance()->getScheduler();
+    sched->performFunctionInCocosThread( [=](){
+        auto diagnostics = Director::getInstance()->getRenderer()->getBatchDiagnostics();
+        if (diagnostics)
+            Console::Utility::mydprintf(fd, "%s", diagnostics->getDescription().c_str());
+        else
+            Console::Utility::mydprintf(fd, "batches: off, type [batches on] to record them\n");
+        Console::Utility::sendPrompt(fd);
+    });
+}
+
+void Console::commandBatchesSubCommandOnOff(int fd, const std::string& args)
+{
+    bool state = (args.compare("on") == 0);
+    Scheduler *sched = Director::getInstance()->getScheduler();
+    sched->performFunctionInCocosThread( [=](){
+        Director::getInstance()->getRenderer()->setBatchDiagnosticsEnabled(state);
+    });
+}
+
+void Console::commandBatchesSubCommandSave(int fd, const std::string& args)
+{
+    auto argv = Console::Utility::split(args, ' ');
+    if (argv.size() != 2)
+    {
+        const char msg[] = "batches: invalid arguments.\n";
+        Console::Utility::sendToConsole(fd, msg, strlen(msg));
+        return;
+    }
+
+    std::string filename = argv[1];
+    Scheduler *sched = Director::getInstance()->getScheduler();
+    sched->performFunctionInCocosThread( [=](){
+        auto diagnostics = Director::getInstance()->getRenderer()->getBatchDiagnostics();
+        if (!diagnostics)
+            Console::Utility::mydprintf(fd, "batches: off, type [batches on] to record them\n");
+        else if (!diagnostics->saveToFile(filename))
+            Console::Utility::mydprintf(fd, "batches: couldn't save %s\n", filename.c_str());
+        Console::Utility::sendPrompt(fd);
+    });
+}
+
 void Console::commandConfig(int fd, const std::string& args)
 {
     Scheduler *sched = Director::getInstance()->getScheduler();
@@ -194,6 +194,7 @@ protected:
     
     // create a map of command.
     void createCommandAllocator();
+    void createCommandBatches();
     void createCommandConfig();
     void createCommandDebugMsg();
     void createCommandDirector();
@@ -211,6 +212,9 @@ protected:
 
     // Add commands here
     void commandAllocator(int fd, const std::string& args);
+    void commandBatches(int fd, const std::string& args);
+    void commandBatchesSubCommandOnOff(int fd, const std::string& args);
+    void commandBatchesSubCommandSave(int fd, const std::string& args);
     void commandConfig(int fd, const std::string& args);
     void commandDebugMsg(int fd, const std::string& args);
     void commandDebugMsgSubCommandOnOff(int fd, const std::string& args);
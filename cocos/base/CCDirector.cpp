@@ -44,6 +44,7 @@ THE SOFTWARE.
 #include "2d/CCLabelAtlas.h"
 #include "renderer/CCGLProgramCache.h"
 #include "renderer/CCGLProgramStateCache.h"
+#include "renderer/CCProgramBinaryCache.h"
 #include "renderer/CCTextureCache.h"
 #include "renderer/ccGLStateCache.h"
 #include "renderer/CCRenderer.h"
@@ -130,6 +131,7 @@ bool Director::init(void)
     _totalFrames = 0;
     _lastUpdate = std::chrono::steady_clock::now();
     _secondsPerFrame = 1.0f;
+    _fixedDeltaTime = 0.0f;
 
     // paused ?
     _paused = false;
@@ -293,7 +295,11 @@ void Director::drawScene()
         _runningScene->stepPhysicsAndNavigation(_deltaTime);
 #endif
         //clear draw stats
-        _renderer->clearDrawStats();
+        auto renderer = _renderer;
+        _renderer->runOnRenderThread([renderer]() {
+            renderer->clearDrawStats();
+            GL::resetStateCacheStats();
+        });
         
         //render the scene
         _openGLView->renderScene(_runningScene, _renderer);
@@ -313,6 +319,12 @@ void Director::drawScene()
     }
     _renderer->render();
 
+    // the stats and the listeners read the counters of the frame once the render thread is done with it
+    auto renderer = _renderer;
+    _renderer->runOnRenderThread([renderer]() {
+        renderer->snapshotFrameStats();
+    });
+
     _eventDispatcher->dispatchEvent(_eventAfterDraw);
 
     popMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
@@ -322,9 +334,15 @@ void Director::drawScene()
     // swap buffers
     if (_openGLView)
     {
-        _openGLView->swapBuffers();
+        auto view = _openGLView;
+        _renderer->runOnRenderThread([view]() {
+            view->swapBuffers();
+        });
     }
 
+    // waits until the render thread is done with the previous frame when the rendering is pipelined
+    _renderer->endFrame();
+
     if (_displayStats)
     {
         calculateMPF();
@@ -341,6 +359,10 @@ void Director::calculateDeltaTime()
         _deltaTime = 0;
         _nextDeltaTimeZero = false;
     }
+    else if (_fixedDeltaTime > 0)
+    {
+        _deltaTime = _fixedDeltaTime;
+    }
     else
     {
         _deltaTime = std::chrono::duration_cast<std::chrono::microseconds>(now - _lastUpdate).count() / 1000000.0f;
@@ -439,6 +461,20 @@ void Director::setNextDeltaTimeZero(bool nextDeltaTimeZero)
 // MUST BE moved outside.
 // Why the Director must have this code ?
 //
+// The matrix stack is not thread safe: it is left untouched while the renderer records
+// commands in parallel, see Renderer::visitInParallel(). The visit() overrides still push
+// and load the model view matrix for the deprecated code, which is ignored, but the nodes
+// which need the other stacks must be visited serially, see Node::requireSerialVisit().
+//
+bool Director::isMatrixStackFrozen(MATRIX_STACK_TYPE type) const
+{
+    if (!_renderer->isRecordingInParallel())
+        return false;
+
+    CCASSERT(type == MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW, "Only the model view matrix stack can be used while recording in parallel, see Node::setParallelVisitEnabled()");
+    return true;
+}
+
 void Director::initMatrixStack()
 {
     while (!_modelViewMatrixStack.empty())
@@ -468,6 +504,9 @@ void Director::resetMatrixStack()
 
 void Director::popMatrix(MATRIX_STACK_TYPE type)
 {
+    if (isMatrixStackFrozen(type))
+        return;
+
     if(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW == type)
     {
         _modelViewMatrixStack.pop();
@@ -488,6 +527,9 @@ void Director::popMatrix(MATRIX_STACK_TYPE type)
 
 void Director::loadIdentityMatrix(MATRIX_STACK_TYPE type)
 {
+    if (isMatrixStackFrozen(type))
+        return;
+
     if(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW == type)
     {
         _modelViewMatrixStack.top() = Mat4::IDENTITY;
@@ -508,6 +550,9 @@ void Director::loadIdentityMatrix(MATRIX_STACK_TYPE type)
 
 void Director::loadMatrix(MATRIX_STACK_TYPE type, const Mat4& mat)
 {
+    if (isMatrixStackFrozen(type))
+        return;
+
     if(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW == type)
     {
         _modelViewMatrixStack.top() = mat;
@@ -528,6 +573,9 @@ void Director::loadMatrix(MATRIX_STACK_TYPE type, const Mat4& mat)
 
 void Director::multiplyMatrix(MATRIX_STACK_TYPE type, const Mat4& mat)
 {
+    if (isMatrixStackFrozen(type))
+        return;
+
     if(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW == type)
     {
         _modelViewMatrixStack.top() *= mat;
@@ -548,6 +596,9 @@ void Director::multiplyMatrix(MATRIX_STACK_TYPE type, const Mat4& mat)
 
 void Director::pushMatrix(MATRIX_STACK_TYPE type)
 {
+    if (isMatrixStackFrozen(type))
+        return;
+
     if(type == MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW)
     {
         _modelViewMatrixStack.push(_modelViewMatrixStack.top());
@@ -666,16 +717,18 @@ float Director::getZEye(void) const
 
 void Director::setAlphaBlending(bool on)
 {
-    if (on)
-    {
-        GL::blendFunc(CC_BLEND_SRC, CC_BLEND_DST);
-    }
-    else
-    {
-        GL::blendFunc(GL_ONE, GL_ZERO);
-    }
+    _renderer->runOnRenderThread([on]() {
+        if (on)
+        {
+            GL::blendFunc(CC_BLEND_SRC, CC_BLEND_DST);
+        }
+        else
+        {
+            GL::blendFunc(GL_ONE, GL_ZERO);
+        }
 
-    CHECK_GL_ERROR_DEBUG();
+        CHECK_GL_ERROR_DEBUG();
+    });
 }
 
 void Director::setDepthTest(bool on)
@@ -683,6 +736,16 @@ void Director::setDepthTest(bool on)
     _renderer->setDepthTest(on);
 }
 
+void Director::setPipelinedRendering(bool enabled)
+{
+    _renderer->setPipelineEnabled(enabled);
+}
+
+bool Director::isPipelinedRendering() const
+{
+    return _renderer->isPipelineEnabled();
+}
+
 void Director::setClearColor(const Color4F& clearColor)
 {
     _renderer->setClearColor(clearColor);
@@ -951,6 +1014,11 @@ void Director::restart()
 
 void Director::reset()
 {
+    // the resources are released on the main thread, which takes the context of the view back
+    _renderer->setPipelineEnabled(false);
+
+    cleanupNodes();
+
 #if CC_ENABLE_GC_FOR_NATIVE_OBJECTS
     auto sEngine = ScriptEngineManager::getInstance()->getScriptEngine();
 #endif // CC_ENABLE_GC_FOR_NATIVE_OBJECTS
@@ -1038,6 +1106,7 @@ void Director::reset()
     AnimationCache::destroyInstance();
     SpriteFrameCache::destroyInstance();
     GLProgramCache::destroyInstance();
+    ProgramBinaryCache::destroyInstance();
     GLProgramStateCache::destroyInstance();
     FileUtils::destroyInstance();
     AsyncTaskPool::destroyInstance();
@@ -1196,8 +1265,9 @@ void Director::showStats()
             _accumDt = 0;
         }
 
-        auto currentCalls = (unsigned long)_renderer->getDrawnBatches();
-        auto currentVerts = (unsigned long)_renderer->getDrawnVertices();
+        const auto stats = _renderer->getFrameStats();
+        auto currentCalls = (unsigned long)stats.drawnBatches;
+        auto currentVerts = (unsigned long)stats.drawnVertices;
         if( currentCalls != prevCalls ) {
             sprintf(buffer, "GL calls:%6lu", currentCalls);
             _drawnBatchesLabel->setString(buffer);
@@ -1395,12 +1465,56 @@ void Director::mainLoop()
     else if (! _invalid)
     {
         drawScene();
+
+        cleanupNodes();
      
         // release the objects
         PoolManager::getInstance()->getCurrentPool()->clear();
     }
 }
 
+void Director::cleanupNodeLater(Node* node)
+{
+    CCASSERT(node != nullptr, "Invalid node");
+    _nodesToCleanup.pushBack(node);
+}
+
+void Director::cleanupNodes()
+{
+    if (_nodesToCleanup.empty())
+        return;
+
+    // the cleanups may remove more nodes
+    Vector<Node*> nodes = std::move(_nodesToCleanup);
+    _nodesToCleanup.clear();
+
+    // the subtrees only held by this vector are destroyed when it is released
+    std::vector<Node*> destroyed;
+    for (const auto& node : nodes)
+    {
+        if (node->getParent())
+            continue;
+
+        node->cleanup();
+
+        if (node->getReferenceCount() == 1)
+        {
+            destroyed.push_back(node);
+        }
+    }
+    for (size_t i = 0; i < destroyed.size(); ++i)
+    {
+        for (const auto& child : destroyed[i]->getChildren())
+        {
+            if (child->getReferenceCount() == 1)
+                destroyed.push_back(child);
+        }
+    }
+
+    // removes their listeners at once, instead of scanning every listener for each destroyed listener
+    _eventDispatcher->removeEventListenersForTargets(destroyed);
+}
+
 void Director::stopAnimation()
 {
     _invalid = true;
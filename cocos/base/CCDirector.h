@@ -196,6 +196,18 @@ public:
      */
     void setNextDeltaTimeZero(bool nextDeltaTimeZero);
 
+    /**
+     * Sets a fixed delta time used by every frame instead of the measured one.
+     * It makes the frames reproducible, for example when benchmarking or capturing frames offscreen.
+     * Pass 0 to use the measured delta time again.
+     * @since v3.13
+     */
+    void setFixedDeltaTime(float fixedDeltaTime) { _fixedDeltaTime = fixedDeltaTime; }
+    /** Returns the fixed delta time, or 0 if the measured delta time is used.
+     * @since v3.13
+     */
+    float getFixedDeltaTime() const { return _fixedDeltaTime; }
+
     /** Whether or not the Director is paused. */
     bool isPaused() { return _paused; }
 
@@ -385,6 +397,17 @@ public:
     /** Enables/disables OpenGL depth test. */
     void setDepthTest(bool on);
 
+    /** Enables/disables the pipelined rendering: the frames are rendered by a render thread, one frame
+     * behind the main thread, which updates and visits the next frame meanwhile.
+     * The view must be set first. See Renderer::setPipelineEnabled() for the details.
+     * @since v3.13
+     */
+    void setPipelinedRendering(bool enabled);
+    /** Whether the frames are rendered by a render thread.
+     * @since v3.13
+     */
+    bool isPipelinedRendering() const;
+
     void mainLoop();
 
     /** The size in pixels of the surface. It could be different than the screen size.
@@ -502,8 +525,18 @@ public:
      */
     bool isValid() const { return !_invalid; }
 
+    /**
+     * Cleans up a node removed from its parent at the end of the frame, after the scene is drawn, unless it
+     * was added to a parent again. Node::removeChildren() uses it to clean up many nodes in one pass.
+     * The event listeners of the nodes destroyed by the sweep are removed together.
+     * @since v3.13
+     */
+    void cleanupNodeLater(Node* node);
+
 protected:
     void reset();
+
+    void cleanupNodes();
     
     void purgeDirector();
     bool _purgeDirectorInNextLoop; // this flag will be set to true in end()
@@ -526,6 +559,8 @@ protected:
     void destroyTextureCache();
 
     void initMatrixStack();
+    /** Whether the matrix stack must be left untouched because the renderer records commands in parallel. */
+    bool isMatrixStackFrozen(MATRIX_STACK_TYPE type) const;
 
     std::stack<Mat4> _modelViewMatrixStack;
     std::stack<Mat4> _projectionMatrixStack;
@@ -590,12 +625,18 @@ protected:
 
     /* scheduled scenes */
     Vector<Scene*> _scenesStack;
+
+    /* nodes cleaned up at the end of the frame */
+    Vector<Node*> _nodesToCleanup;
     
     /* last time the main loop was updated */
     std::chrono::steady_clock::time_point _lastUpdate;
 
     /* whether or not the next delta time will be zero */
     bool _nextDeltaTimeZero;
+
+    /* delta time used by every frame when not 0 */
+    float _fixedDeltaTime;
     
     /* projection used */
     Projection _projection;
@@ -23,6 +23,7 @@
  ****************************************************************************/
 #include "base/CCEventDispatcher.h"
 #include <algorithm>
+#include <unordered_set>
 
 #include "base/CCEventCustom.h"
 #include "base/CCEventListenerTouch.h"
@@ -402,6 +403,105 @@ void EventDispatcher::removeEventListenersForTarget(Node* target, bool recursive
     }
 }
 
+void EventDispatcher::removeEventListenersForTargets(const std::vector<Node*>& targets)
+{
+    // the listener vectors can't be compacted while they are dispatched
+    if (_inDispatch != 0)
+    {
+        for (const auto& target : targets)
+        {
+            removeEventListenersForTarget(target);
+        }
+        return;
+    }
+
+    std::unordered_set<Node*> nodes(targets.begin(), targets.end());
+    std::unordered_set<EventListener*> listeners;
+    for (const auto& node : nodes)
+    {
+        _nodePriorityMap.erase(node);
+        _dirtyNodes.erase(node);
+
+        auto found = _nodeListenersMap.find(node);
+        if (found != _nodeListenersMap.end())
+        {
+            listeners.insert(found->second->begin(), found->second->end());
+            delete found->second;
+            _nodeListenersMap.erase(found);
+        }
+    }
+
+    if (!listeners.empty())
+    {
+        auto isRemoved = [&listeners](EventListener* l) {
+            return listeners.find(l) != listeners.end();
+        };
+
+        for (auto iter = _listenerMap.begin(); iter != _listenerMap.end();)
+        {
+            auto listenerVector = iter->second;
+            auto sceneGraphPriorityListeners = listenerVector->getSceneGraphPriorityListeners();
+            auto fixedPriorityListeners = listenerVector->getFixedPriorityListeners();
+
+            if (sceneGraphPriorityListeners)
+            {
+                auto last = std::remove_if(sceneGraphPriorityListeners->begin(), sceneGraphPriorityListeners->end(), isRemoved);
+                if (last != sceneGraphPriorityListeners->end())
+                {
+                    sceneGraphPriorityListeners->erase(last, sceneGraphPriorityListeners->end());
+                    setDirty(iter->first, DirtyFlag::SCENE_GRAPH_PRIORITY);
+                }
+            }
+
+            if (fixedPriorityListeners)
+            {
+                auto last = std::remove_if(fixedPriorityListeners->begin(), fixedPriorityListeners->end(), isRemoved);
+                if (last != fixedPriorityListeners->end())
+                {
+                    fixedPriorityListeners->erase(last, fixedPriorityListeners->end());
+                    setDirty(iter->first, DirtyFlag::FIXED_PRIORITY);
+                }
+            }
+
+            if (listenerVector->empty())
+            {
+                _priorityDirtyFlagMap.erase(iter->first);
+                iter = _listenerMap.erase(iter);
+                CC_SAFE_DELETE(listenerVector);
+            }
+            else
+            {
+                ++iter;
+            }
+        }
+
+        for (auto& l : listeners)
+        {
+            l->setRegistered(false);
+            l->setAssociatedNode(nullptr);
+            releaseListener(l);
+        }
+    }
+
+    // the listeners which aren't added yet, see removeEventListenersForTarget()
+    for (auto iter = _toAddedListeners.begin(); iter != _toAddedListeners.end(); )
+    {
+        EventListener * listener = *iter;
+
+        if (nodes.find(listener->getAssociatedNode()) != nodes.end())
+        {
+            listener->setAssociatedNode(nullptr);
+            listener->setRegistered(false);
+            releaseListener(listener);
+            iter = _toAddedListeners.erase(iter);
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+}
+
 void EventDispatcher::associateNodeAndEventListener(Node* node, EventListener* listener)
 {
     std::vector<EventListener*>* listeners = nullptr;
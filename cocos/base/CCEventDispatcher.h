@@ -110,6 +110,14 @@ public:
      * @param recursive True if remove recursively, the default value is false.
      */
     void removeEventListenersForTarget(Node* target, bool recursive = false);
+
+    /** Removes all listeners which are associated with the specified targets.
+     * The registered listeners are scanned once for all the targets, instead of once per listener.
+     *
+     * @param targets The target nodes, their children aren't included.
+     * @since v3.13
+     */
+    void removeEventListenersForTargets(const std::vector<Node*>& targets);
     
     /** Removes all custom listeners with the same event name.
      *
@@ -0,0 +1,189 @@
+/****************************************************************************
+ Copyright (c) 2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "base/CCFrameBenchmark.h"
+
+#include <algorithm>
+
+#include "base/CCDirector.h"
+#include "base/CCEventDispatcher.h"
+#include "base/CCEventListenerCustom.h"
+#include "base/ccUtils.h"
+#include "base/ccUTF8.h"
+#include "platform/CCFileUtils.h"
+#include "renderer/CCRenderer.h"
+#include "renderer/ccGLStateCache.h"
+
+NS_CC_BEGIN
+
+FrameBenchmark::FrameBenchmark()
+: _frameBegun(false)
+, _synchronous(false)
+, _captureInterval(0)
+, _beforeUpdateListener(nullptr)
+, _afterVisitListener(nullptr)
+, _afterDrawListener(nullptr)
+{
+}
+
+FrameBenchmark::~FrameBenchmark()
+{
+    stop();
+}
+
+void FrameBenchmark::start()
+{
+    stop();
+    _frames.clear();
+    _frameBegun = false;
+
+    auto dispatcher = Director::getInstance()->getEventDispatcher();
+    _beforeUpdateListener = dispatcher->addCustomEventListener(Director::EVENT_BEFORE_UPDATE, [this](EventCustom*) { onBeforeUpdate(); });
+    _afterVisitListener = dispatcher->addCustomEventListener(Director::EVENT_AFTER_VISIT, [this](EventCustom*) { onAfterVisit(); });
+    _afterDrawListener = dispatcher->addCustomEventListener(Director::EVENT_AFTER_DRAW, [this](EventCustom*) { onAfterDraw(); });
+}
+
+void FrameBenchmark::stop()
+{
+    if (!isRunning())
+        return;
+
+    auto dispatcher = Director::getInstance()->getEventDispatcher();
+    dispatcher->removeEventListener(_beforeUpdateListener);
+    dispatcher->removeEventListener(_afterVisitListener);
+    dispatcher->removeEventListener(_afterDrawListener);
+    _beforeUpdateListener = _afterVisitListener = _afterDrawListener = nullptr;
+}
+
+void FrameBenchmark::setCaptureInterval(unsigned int interval, const std::string& prefix)
+{
+    _captureInterval = interval;
+    _capturePrefix = prefix;
+}
+
+void FrameBenchmark::onBeforeUpdate()
+{
+    _frameBegin = std::chrono::steady_clock::now();
+    _frameBegun = true;
+}
+
+void FrameBenchmark::onAfterVisit()
+{
+    // the capture command is queued after the scene, so it reads back the whole frame
+    const size_t frame = _frames.size();
+    if (_captureInterval > 0 && frame % _captureInterval == 0)
+    {
+        utils::captureScreen([](bool succeed, const std::string& filename) {
+            if (!succeed)
+                CCLOG("cocos2d: FrameBenchmark: couldn't capture %s", filename.c_str());
+        }, StringUtils::format("%s%d.png", _capturePrefix.c_str(), (int)frame));
+    }
+}
+
+void FrameBenchmark::onAfterDraw()
+{
+    auto director = Director::getInstance();
+    auto renderer = director->getRenderer();
+    if (_synchronous)
+    {
+        // waits for the render thread too when the rendering is pipelined
+        renderer->runOnRenderThread([]() {
+            glFinish();
+        }, true);
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    // the counters of this frame when it was waited for, else of the last frame the render thread finished
+    const auto stats = renderer->getFrameStats();
+
+    Frame frame;
+    // the update is skipped while the director is paused, then only the rendering is timed
+    frame.frameTime = _frameBegun ? std::chrono::duration_cast<std::chrono::microseconds>(now - _frameBegin).count() / 1000.0f : 0.0f;
+    frame.deltaTime = director->getDeltaTime();
+    frame.drawnBatches = stats.drawnBatches;
+    frame.drawnVertices = stats.drawnVertices;
+    frame.glCalls = stats.stateCache.issuedCalls;
+    frame.skippedGLCalls = stats.stateCache.skippedCalls;
+    _frames.push_back(frame);
+
+    _frameBegun = false;
+}
+
+std::string FrameBenchmark::toJSON() const
+{
+    std::vector<float> times;
+    times.reserve(_frames.size());
+    double totalTime = 0;
+    double totalBatches = 0;
+    double totalVertices = 0;
+    for (const auto& frame : _frames)
+    {
+        times.push_back(frame.frameTime);
+        totalTime += frame.frameTime;
+        totalBatches += frame.drawnBatches;
+        totalVertices += frame.drawnVertices;
+    }
+    std::sort(times.begin(), times.end());
+
+    auto percentile = [&times](float p) -> float {
+        if (times.empty())
+            return 0.0f;
+        size_t index = std::min(times.size() - 1, (size_t)(p * (times.size() - 1) + 0.5f));
+        return times[index];
+    };
+    const double count = std::max((double)_frames.size(), 1.0);
+
+    std::string json = "{\n";
+    json += StringUtils::format("  \"frameCount\": %d,\n", (int)_frames.size());
+    json += StringUtils::format("  \"averageFrameTime\": %.3f,\n", totalTime / count);
+    json += StringUtils::format("  \"minFrameTime\": %.3f,\n", times.empty() ? 0.0f : times.front());
+    json += StringUtils::format("  \"maxFrameTime\": %.3f,\n", times.empty() ? 0.0f : times.back());
+    json += StringUtils::format("  \"p50FrameTime\": %.3f,\n", percentile(0.5f));
+    json += StringUtils::format("  \"p95FrameTime\": %.3f,\n", percentile(0.95f));
+    json += StringUtils::format("  \"p99FrameTime\": %.3f,\n", percentile(0.99f));
+    json += StringUtils::format("  \"averageDrawnBatches\": %.2f,\n", totalBatches / count);
+    json += StringUtils::format("  \"averageDrawnVertices\": %.2f,\n", totalVertices / count);
+    json += "  \"frames\": [";
+    for (size_t i = 0; i < _frames.size(); ++i)
+    {
+        const auto& frame = _frames[i];
+        json += StringUtils::format("%s\n    {\"frameTime\": %.3f, \"deltaTime\": %.5f, \"drawnBatches\": %d, \"drawnVertices\": %d, \"glCalls\": %u, \"skippedGLCalls\": %u}",
+                                    i == 0 ? "" : ",",
+                                    frame.frameTime, frame.deltaTime,
+                                    (int)frame.drawnBatches, (int)frame.drawnVertices,
+                                    frame.glCalls, frame.skippedGLCalls);
+    }
+    json += "\n  ]\n}\n";
+    return json;
+}
+
+bool FrameBenchmark::saveToFile(const std::string& filename) const
+{
+    auto fileUtils = FileUtils::getInstance();
+    std::string fullPath = fileUtils->isAbsolutePath(filename) ? filename : fileUtils->getWritablePath() + filename;
+    return fileUtils->writeStringToFile(toJSON(), fullPath);
+}
+
+NS_CC_END
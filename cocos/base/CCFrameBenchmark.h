@@ -0,0 +1,131 @@
+/****************************************************************************
+ Copyright (c) 2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef __CC_FRAME_BENCHMARK_H__
+#define __CC_FRAME_BENCHMARK_H__
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "platform/CCPlatformMacros.h"
+
+NS_CC_BEGIN
+
+class EventListenerCustom;
+
+/**
+ * @addtogroup base
+ * @{
+ */
+
+/** @brief FrameBenchmark records the time and the draw stats of each frame rendered by the Director.
+ *
+ * The records can be saved as JSON, to compare runs of the same scene. To get reproducible frames,
+ * set a fixed delta time with Director::setFixedDeltaTime(). On Linux, the frames can be rendered
+ * without a window by GLViewHeadless.
+ *
+ * Frames can also be captured to image files every few frames, to check the rendering of the benchmarked scene.
+ * @since v3.13
+ * @js NA
+ * @lua NA
+ */
+class CC_DLL FrameBenchmark
+{
+public:
+    /** Stats of one frame */
+    struct Frame
+    {
+        /** Time from the update of the scheduler to the end of the rendering, in milliseconds */
+        float frameTime;
+        /** Delta time the frame was updated with, in seconds */
+        float deltaTime;
+        /** Draw calls issued by the Renderer */
+        ssize_t drawnBatches;
+        /** Vertices drawn by the Renderer */
+        ssize_t drawnVertices;
+        /** State calls sent to GL */
+        unsigned int glCalls;
+        /** State calls skipped by the GL state cache */
+        unsigned int skippedGLCalls;
+    };
+
+    FrameBenchmark();
+    ~FrameBenchmark();
+
+    /** Starts recording the frames rendered by the Director. The frames recorded before are discarded. */
+    void start();
+
+    /** Stops recording. */
+    void stop();
+
+    /** Whether the frames are being recorded. */
+    bool isRunning() const { return _afterDrawListener != nullptr; }
+
+    /** Sets whether to wait for GL to finish each frame, so the frame time includes the GPU work. False by default. */
+    void setSynchronous(bool synchronous) { _synchronous = synchronous; }
+
+    /** Captures the screen every `interval` frames, into files named `<prefix><frame>.png`.
+     * 0 disables the capture, which is the default.
+     */
+    void setCaptureInterval(unsigned int interval, const std::string& prefix);
+
+    /** Returns the recorded frames. */
+    const std::vector<Frame>& getFrames() const { return _frames; }
+
+    /** Returns the recorded frames and their summary as a JSON string. */
+    std::string toJSON() const;
+
+    /** Saves toJSON() into a file.
+     *
+     * @param filename A full path, or a file name relative to the writable path.
+     * @return True if the file was written.
+     */
+    bool saveToFile(const std::string& filename) const;
+
+protected:
+    void onBeforeUpdate();
+    void onAfterVisit();
+    void onAfterDraw();
+
+    std::vector<Frame> _frames;
+    std::chrono::steady_clock::time_point _frameBegin;
+    bool _frameBegun;
+    bool _synchronous;
+
+    unsigned int _captureInterval;
+    std::string _capturePrefix;
+
+    EventListenerCustom* _beforeUpdateListener;
+    EventListenerCustom* _afterVisitListener;
+    EventListenerCustom* _afterDrawListener;
+};
+
+// end of base group
+/// @}
+
+NS_CC_END
+
+#endif // __CC_FRAME_BENCHMARK_H__
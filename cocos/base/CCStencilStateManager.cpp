@@ -136,7 +136,7 @@ void StencilStateManager::onBeforeVisit()
     
     // manually save the stencil state
     
-    _currentStencilEnabled = glIsEnabled(GL_STENCIL_TEST);
+    _currentStencilEnabled = GL::isEnabled(GL_STENCIL_TEST);
     glGetIntegerv(GL_STENCIL_WRITEMASK, (GLint *)&_currentStencilWriteMask);
     glGetIntegerv(GL_STENCIL_FUNC, (GLint *)&_currentStencilFunc);
     glGetIntegerv(GL_STENCIL_REF, &_currentStencilRef);
@@ -146,7 +146,7 @@ void StencilStateManager::onBeforeVisit()
     glGetIntegerv(GL_STENCIL_PASS_DEPTH_PASS, (GLint *)&_currentStencilPassDepthPass);
     
     // enable stencil use
-    glEnable(GL_STENCIL_TEST);
+    GL::enable(GL_STENCIL_TEST);
     //    RenderState::StateBlock::_defaultState->setStencilTest(true);
     
     // check for OpenGL error while enabling stencil test
@@ -154,12 +154,12 @@ void StencilStateManager::onBeforeVisit()
     
     // all bits on the stencil buffer are readonly, except the current layer bit,
     // this means that operation like glClear or glStencilOp will be masked with this value
-    glStencilMask(mask_layer);
+    GL::stencilMask(mask_layer);
     //    RenderState::StateBlock::_defaultState->setStencilWrite(mask_layer);
     
     // manually save the depth test state
     
-    glGetBooleanv(GL_DEPTH_WRITEMASK, &_currentDepthWriteMask);
+    _currentDepthWriteMask = GL::getDepthMask();
     
     // disable depth test while drawing the stencil
     //glDisable(GL_DEPTH_TEST);
@@ -167,7 +167,7 @@ void StencilStateManager::onBeforeVisit()
     // as the stencil is not meant to be rendered in the real scene,
     // it should never prevent something else to be drawn,
     // only disabling depth buffer update should do
-    glDepthMask(GL_FALSE);
+    GL::depthMask(GL_FALSE);
     RenderState::StateBlock::_defaultState->setDepthWrite(false);
     
     ///////////////////////////////////
@@ -179,8 +179,8 @@ void StencilStateManager::onBeforeVisit()
     //     never draw it into the frame buffer
     //     if not in inverted mode: set the current layer value to 0 in the stencil buffer
     //     if in inverted mode: set the current layer value to 1 in the stencil buffer
-    glStencilFunc(GL_NEVER, mask_layer, mask_layer);
-    glStencilOp(!_inverted ? GL_ZERO : GL_REPLACE, GL_KEEP, GL_KEEP);
+    GL::stencilFunc(GL_NEVER, mask_layer, mask_layer);
+    GL::stencilOp(!_inverted ? GL_ZERO : GL_REPLACE, GL_KEEP, GL_KEEP);
     
     // draw a fullscreen solid rectangle to clear the stencil buffer
     //ccDrawSolidRect(Vec2::ZERO, ccpFromSize([[Director sharedDirector] winSize]), Color4F(1, 1, 1, 1));
@@ -194,10 +194,10 @@ void StencilStateManager::onBeforeVisit()
     //     never draw it into the frame buffer
     //     if not in inverted mode: set the current layer value to 1 in the stencil buffer
     //     if in inverted mode: set the current layer value to 0 in the stencil buffer
-    glStencilFunc(GL_NEVER, mask_layer, mask_layer);
+    GL::stencilFunc(GL_NEVER, mask_layer, mask_layer);
     //    RenderState::StateBlock::_defaultState->setStencilFunction(RenderState::STENCIL_NEVER, mask_layer, mask_layer);
     
-    glStencilOp(!_inverted ? GL_REPLACE : GL_ZERO, GL_KEEP, GL_KEEP);
+    GL::stencilOp(!_inverted ? GL_REPLACE : GL_ZERO, GL_KEEP, GL_KEEP);
     //    RenderState::StateBlock::_defaultState->setStencilOperation(
     //                                                                !_inverted ? RenderState::STENCIL_OP_REPLACE : RenderState::STENCIL_OP_ZERO,
     //                                                                RenderState::STENCIL_OP_KEEP,
@@ -242,7 +242,7 @@ void StencilStateManager::onAfterDrawStencil()
     }
     
     // restore the depth test state
-    glDepthMask(_currentDepthWriteMask);
+    GL::depthMask(_currentDepthWriteMask);
     RenderState::StateBlock::_defaultState->setDepthWrite(_currentDepthWriteMask != 0);
     
     //if (currentDepthTestEnabled) {
@@ -258,10 +258,10 @@ void StencilStateManager::onAfterDrawStencil()
     //         draw the pixel and keep the current layer in the stencil buffer
     //     else
     //         do not draw the pixel but keep the current layer in the stencil buffer
-    glStencilFunc(GL_EQUAL, _mask_layer_le, _mask_layer_le);
+    GL::stencilFunc(GL_EQUAL, _mask_layer_le, _mask_layer_le);
     //    RenderState::StateBlock::_defaultState->setStencilFunction(RenderState::STENCIL_EQUAL, _mask_layer_le, _mask_layer_le);
     
-    glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
+    GL::stencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
     //    RenderState::StateBlock::_defaultState->setStencilOperation(RenderState::STENCIL_OP_KEEP, RenderState::STENCIL_OP_KEEP, RenderState::STENCIL_OP_KEEP);
     
     // draw (according to the stencil test function) this node and its children
@@ -274,18 +274,18 @@ void StencilStateManager::onAfterVisit()
     // CLEANUP
     
     // manually restore the stencil state
-    glStencilFunc(_currentStencilFunc, _currentStencilRef, _currentStencilValueMask);
+    GL::stencilFunc(_currentStencilFunc, _currentStencilRef, _currentStencilValueMask);
     //    RenderState::StateBlock::_defaultState->setStencilFunction((RenderState::StencilFunction)_currentStencilFunc, _currentStencilRef, _currentStencilValueMask);
     
-    glStencilOp(_currentStencilFail, _currentStencilPassDepthFail, _currentStencilPassDepthPass);
+    GL::stencilOp(_currentStencilFail, _currentStencilPassDepthFail, _currentStencilPassDepthPass);
     //    RenderState::StateBlock::_defaultState->setStencilOperation((RenderState::StencilOperation)_currentStencilFail,
     //                                                                (RenderState::StencilOperation)_currentStencilPassDepthFail,
     //                                                                (RenderState::StencilOperation)_currentStencilPassDepthPass);
     
-    glStencilMask(_currentStencilWriteMask);
+    GL::stencilMask(_currentStencilWriteMask);
     if (!_currentStencilEnabled)
     {
-        glDisable(GL_STENCIL_TEST);
+        GL::disable(GL_STENCIL_TEST);
         //        RenderState::StateBlock::_defaultState->setStencilTest(false);
     }
     
@@ -171,6 +171,34 @@ THE SOFTWARE.
     #endif
 #endif
 
+/** @def CC_USE_INSTANCING
+ * If enabled, the Renderer draws consecutive instanced MeshCommands that share the same geometry and state
+ * with a single instanced draw call, when the GPU supports instanced arrays.
+ * Android doesn't expose the instanced drawing entry points in its GLES2 headers, so it is disabled there.
+ * To disable it set it to 0. Enabled by default on iOS, Mac, Windows and Linux.
+ */
+#ifndef CC_USE_INSTANCING
+    #if (CC_TARGET_PLATFORM == CC_PLATFORM_IOS) || (CC_TARGET_PLATFORM == CC_PLATFORM_MAC) || (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32) || (CC_TARGET_PLATFORM == CC_PLATFORM_LINUX)
+        #define CC_USE_INSTANCING 1
+    #else
+        #define CC_USE_INSTANCING 0
+    #endif
+#endif
+
+/** @def CC_USE_PROGRAM_BINARY_CACHE
+ * If enabled, linked GL programs are saved to the writable path with glGetProgramBinary(), and loaded back
+ * with glProgramBinary() instead of being compiled again, when the driver supports program binaries.
+ * iOS doesn't support program binaries and the Mac view uses a legacy context, so it is disabled there.
+ * To disable it set it to 0. Enabled by default on Android, Windows and Linux.
+ */
+#ifndef CC_USE_PROGRAM_BINARY_CACHE
+    #if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID) || (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32) || (CC_TARGET_PLATFORM == CC_PLATFORM_LINUX)
+        #define CC_USE_PROGRAM_BINARY_CACHE 1
+    #else
+        #define CC_USE_PROGRAM_BINARY_CACHE 0
+    #endif
+#endif
+
 
 /** @def CC_USE_LA88_LABELS
  * If enabled, it will use LA88 (Luminance Alpha 16-bit textures) for LabelTTF objects.
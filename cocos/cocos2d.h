@@ -49,6 +49,7 @@ THE SOFTWARE.
 #include "base/CCMap.h"
 #include "base/CCNS.h"
 #include "base/CCProfiling.h"
+#include "base/CCFrameBenchmark.h"
 #include "base/CCProperties.h"
 #include "base/CCRef.h"
 #include "base/CCRefPtr.h"
@@ -165,6 +166,12 @@ THE SOFTWARE.
 #include "renderer/CCTexture2D.h"
 #include "renderer/CCTextureCube.h"
 #include "renderer/CCTextureCache.h"
+#include "renderer/CCDynamicAtlas.h"
+#include "renderer/CCTextureStreamer.h"
+#include "renderer/CCFrameArena.h"
+#include "renderer/CCBatchDiagnostics.h"
+#include "renderer/CCProgramBinaryCache.h"
+#include "renderer/CCOcclusionCuller.h"
 #include "renderer/CCTrianglesCommand.h"
 #include "renderer/CCVertexAttribBinding.h"
 #include "renderer/CCVertexIndexBuffer.h"
@@ -231,6 +238,7 @@ THE SOFTWARE.
 #if (CC_TARGET_PLATFORM == CC_PLATFORM_LINUX)
     #include "platform/linux/CCApplication-linux.h"
     #include "platform/desktop/CCGLViewImpl-desktop.h"
+    #include "platform/linux/CCGLViewImpl-headless.h"
     #include "platform/linux/CCGL-linux.h"
     #include "platform/linux/CCStdC-linux.h"
 #endif // CC_TARGET_PLATFORM == CC_PLATFORM_LINUX
@@ -258,6 +266,10 @@ THE SOFTWARE.
 #include "2d/CCSprite.h"
 #include "2d/CCAutoPolygon.h"
 #include "2d/CCSpriteBatchNode.h"
+#include "2d/CCStaticBatch.h"
+#include "2d/CCTransformSystem.h"
+#include "2d/CCNodeIndex.h"
+#include "2d/CCNodePool.h"
 #include "2d/CCSpriteFrame.h"
 #include "2d/CCSpriteFrameCache.h"
 
@@ -31,102 +31,46 @@
 
 #include <spine/SkeletonBatch.h>
 #include <spine/extension.h>
-#include <algorithm>
 
 USING_NS_CC;
-#define EVENT_AFTER_DRAW_RESET_POSITION "director_after_draw"
-using std::max;
 
 namespace spine {
 
 static SkeletonBatch* instance = nullptr;
 
 void SkeletonBatch::setBufferSize (int vertexCount) {
-	if (instance) delete instance;
-	instance = new SkeletonBatch(vertexCount);
+	// the vertices are allocated from the frame arena of the renderer, which grows as needed
+	getInstance();
 }
 
 SkeletonBatch* SkeletonBatch::getInstance () {
-	if (!instance) instance = new SkeletonBatch(8192);
+	if (!instance) instance = new SkeletonBatch();
 	return instance;
 }
 
-SkeletonBatch::SkeletonBatch (int capacity) :
-	_capacity(capacity), _position(0)
-{
-	_buffer = new V3F_C4B_T2F[capacity];
-	_firstCommand = new Command();
-	_command = _firstCommand;
-
-    Director::getInstance()->getEventDispatcher()->addCustomEventListener(EVENT_AFTER_DRAW_RESET_POSITION, [this](EventCustom* eventCustom){
-        this->update(0);
-    });;
+SkeletonBatch::SkeletonBatch () {
 }
 
 SkeletonBatch::~SkeletonBatch () {
-	Director::getInstance()->getEventDispatcher()->removeCustomEventListeners(EVENT_AFTER_DRAW_RESET_POSITION);
-
-	Command* command = _firstCommand;
-	while (command) {
-		Command* next = command->next;
-		delete command;
-		command = next;
-	}
-
-	delete [] _buffer;
 }
 
 void SkeletonBatch::update (float delta) {
-	_position = 0;
-	_command = _firstCommand;
 }
 
 void SkeletonBatch::addCommand (cocos2d::Renderer* renderer, float globalZOrder, GLuint textureID, GLProgramState* glProgramState,
 	BlendFunc blendFunc, const TrianglesCommand::Triangles& triangles, const Mat4& transform, uint32_t transformFlags
 ) {
-	if (_position + triangles.vertCount > _capacity) {
-		int newCapacity = max(_capacity + _capacity / 2, _position + triangles.vertCount);
-		V3F_C4B_T2F* newBuffer = new V3F_C4B_T2F[newCapacity];
-		memcpy(newBuffer, _buffer, _position);
-
-		int newPosition = 0;
-		Command* command = _firstCommand;
-		while (newPosition < _position) {
-			command->triangles->verts = newBuffer + newPosition;
-			newPosition += command->triangles->vertCount;
-			command = command->next;
-		}
-
-		delete [] _buffer;
-		_buffer = newBuffer;
-		_capacity = newCapacity;
-	}
-
-	memcpy(_buffer + _position, triangles.verts, sizeof(V3F_C4B_T2F) * triangles.vertCount);
-	_command->triangles->verts = _buffer + _position;
-	_position += triangles.vertCount;
+	// the command and its vertices live until the renderer is done with the frame
+	FrameArena* arena = renderer->getFrameArena();
 
-	_command->triangles->vertCount = triangles.vertCount;
-	_command->triangles->indexCount = triangles.indexCount;
-	_command->triangles->indices = triangles.indices;
-
-	_command->trianglesCommand->init(globalZOrder, textureID, glProgramState, blendFunc, *_command->triangles, transform, transformFlags);
-	renderer->addCommand(_command->trianglesCommand);
-
-	if (!_command->next) _command->next = new Command();
-	_command = _command->next;
-}
-
-SkeletonBatch::Command::Command () :
-	next(nullptr)
-{
-	trianglesCommand = new TrianglesCommand();
-	triangles = new TrianglesCommand::Triangles();
-}
+	TrianglesCommand::Triangles copy = triangles;
+	V3F_C4B_T2F* vertices = arena->allocateArray<V3F_C4B_T2F>(triangles.vertCount);
+	memcpy(vertices, triangles.verts, sizeof(V3F_C4B_T2F) * triangles.vertCount);
+	copy.verts = vertices;
 
-SkeletonBatch::Command::~Command () {
-	delete triangles;
-	delete trianglesCommand;
+	TrianglesCommand* command = arena->construct<TrianglesCommand>();
+	command->init(globalZOrder, textureID, glProgramState, blendFunc, copy, transform, transformFlags);
+	renderer->addCommand(command);
 }
 
 }
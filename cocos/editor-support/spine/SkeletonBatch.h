@@ -39,9 +39,7 @@ namespace spine {
 
 class SkeletonBatch {
 public:
-	/* Sets the max number of vertices that can be drawn in a single frame. The buffer will grow automatically as needed, but
-	 * setting it to the appropriate is more efficient. Best to call before getInstance is called for the first time. Default is
-	 * 8192. */
+	/* Kept for compatibility: the vertices are allocated from the frame arena of the renderer, which grows as needed. */
 	static void setBufferSize (int vertexCount);
 
 	static SkeletonBatch* getInstance ();
@@ -52,25 +50,8 @@ public:
 		cocos2d::BlendFunc blendType, const cocos2d::TrianglesCommand:: Triangles& triangles, const cocos2d::Mat4& mv, uint32_t flags);
 
 protected:
-	SkeletonBatch (int capacity);
+	SkeletonBatch ();
 	virtual ~SkeletonBatch ();
-
-	cocos2d::V3F_C4B_T2F* _buffer;
-	int _capacity;
-	int _position;
-
-	class Command {
-	public:
-		Command ();
-		virtual ~Command ();
-
-		cocos2d::TrianglesCommand* trianglesCommand;
-		cocos2d::TrianglesCommand::Triangles* triangles;
-		Command* next;
-	};
-
-	Command* _firstCommand;
-	Command* _command;
 };
 
 }
@@ -106,7 +106,7 @@ Physics3DDebugDrawer::~Physics3DDebugDrawer()
     
     if (_vao)
     {
-        glDeleteVertexArrays(1, &_vao);
+        GL::deleteVertexArrays(1, &_vao);
         _vao = 0;
     }
     if (_vbo)
@@ -131,7 +131,7 @@ void Physics3DDebugDrawer::drawImplementation( const Mat4 &transform, uint32_t f
 {
     _program->use();
     _program->setUniformsForBuiltins(transform);
-    glEnable(GL_DEPTH_TEST);
+    GL::enable(GL_DEPTH_TEST);
 
     GL::blendFunc(_blendFunc.src, _blendFunc.dst);
 
@@ -161,7 +161,7 @@ void Physics3DDebugDrawer::drawImplementation( const Mat4 &transform, uint32_t f
 
     CC_INCREMENT_GL_DRAWN_BATCHES_AND_VERTICES(1,_bufferCount);
 
-    glDisable(GL_DEPTH_TEST);
+    GL::disable(GL_DEPTH_TEST);
     RenderState::StateBlock::_defaultState->setDepthTest(false);
 }
 
@@ -171,6 +171,16 @@ void Physics3DDebugDrawer::init()
 
     ensureCapacity(512);
 
+    // set up by the render thread, see GL::genVertexArrays()
+    auto renderer = Director::getInstance()->getRenderer();
+    if (!renderer->isRenderThread())
+    {
+        renderer->runOnRenderThread([this]() {
+            init();
+        }, true);
+        return;
+    }
+
     if (Configuration::getInstance()->supportsShareableVAO())
     {
         glGenVertexArrays(1, &_vao);
@@ -24,6 +24,7 @@ THE SOFTWARE.
 ****************************************************************************/
 
 #include "platform/CCGLView.h"
+#include "renderer/ccGLStateCache.h"
 
 #include "base/CCTouch.h"
 #include "base/CCDirector.h"
@@ -255,7 +256,7 @@ void GLView::setViewPortInPoints(float x , float y , float w , float h)
 
 void GLView::setScissorInPoints(float x , float y , float w , float h)
 {
-    glScissor((GLint)(x * _scaleX + _viewPortRect.origin.x),
+    GL::scissor((GLint)(x * _scaleX + _viewPortRect.origin.x),
               (GLint)(y * _scaleY + _viewPortRect.origin.y),
               (GLsizei)(w * _scaleX),
               (GLsizei)(h * _scaleY));
@@ -263,7 +264,7 @@ void GLView::setScissorInPoints(float x , float y , float w , float h)
 
 bool GLView::isScissorEnabled()
 {
-    return (GL_FALSE == glIsEnabled(GL_SCISSOR_TEST)) ? false : true;
+    return GL::isEnabled(GL_SCISSOR_TEST);
 }
 
 Rect GLView::getScissorRect() const
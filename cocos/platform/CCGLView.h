@@ -122,6 +122,24 @@ public:
     /** Exchanges the front and back buffers, subclass must implement this method. */
     virtual void swapBuffers() = 0;
 
+    /** Creates a second GL context which shares its objects with the context of the view.
+     * The main thread uses it while the Renderer is pipelined, see Renderer::setPipelineEnabled().
+     *
+     * @return False if the view can't share its context, which is the default.
+     * @since v3.13
+     */
+    virtual bool createSharedContext() { return false; }
+
+    /** Makes the context of the view, or the shared one, current on the calling thread.
+     * @since v3.13
+     */
+    virtual void makeContextCurrent(bool shared) {}
+
+    /** Detaches the current context from the calling thread, so that another thread can make it current.
+     * @since v3.13
+     */
+    virtual void releaseCurrentContext() {}
+
     /** Open or close IME keyboard , subclass must implement this method. 
      *
      * @param open Open or close IME keyboard.
@@ -27,6 +27,7 @@ THE SOFTWARE.
 #include "platform/CCImage.h"
 
 #include <string>
+#include <algorithm>
 #include <ctype.h>
 
 #include "base/CCData.h"
@@ -2446,18 +2447,146 @@ void Image::premultipliedAlpha()
 #else
     CCASSERT(_renderFormat == Texture2D::PixelFormat::RGBA8888, "The pixel format should be RGBA8888!");
     
-    unsigned int* fourBytes = (unsigned int*)_data;
-    for(int i = 0; i < _width * _height; i++)
-    {
-        unsigned char* p = _data + i * 4;
-        fourBytes[i] = CC_RGB_PREMULTIPLY_ALPHA(p[0], p[1], p[2], p[3]);
-    }
+    Texture2D::premultiplyAlpha(_data, _width * _height * 4);
     
     _hasPremultipliedAlpha = true;
 #endif
 }
 
 
+bool Image::isOpaque() const
+{
+    if (_renderFormat == Texture2D::PixelFormat::RGB888)
+        return true;
+
+    const unsigned char* alpha = _data + 3;
+    const unsigned char* end = _data + _dataLen;
+    for (; alpha < end; alpha += 4)
+    {
+        if (*alpha != 255)
+            return false;
+    }
+    return true;
+}
+
+bool Image::encodeETC()
+{
+#ifdef GL_ETC1_RGB8_OES
+    // the encoder reads RGB888 pixels
+    unsigned char* rgbData = nullptr;
+    ssize_t rgbDataLen = 0;
+    Texture2D::convertDataToFormat(_data, _dataLen, _renderFormat, Texture2D::PixelFormat::RGB888, &rgbData, &rgbDataLen);
+
+    const ssize_t etcDataLen = etc1_get_encoded_data_size(_width, _height);
+    unsigned char* etcData = static_cast<unsigned char*>(malloc(etcDataLen));
+    const bool encoded = etcData && etc1_encode_image(rgbData, _width, _height, 3, _width * 3, etcData) == 0;
+
+    if (rgbData != _data)
+    {
+        free(rgbData);
+    }
+
+    if (!encoded)
+    {
+        CC_SAFE_FREE(etcData);
+        return false;
+    }
+
+    free(_data);
+    _data = etcData;
+    _dataLen = etcDataLen;
+    _renderFormat = Texture2D::PixelFormat::ETC;
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool Image::transcode(bool allowCompression)
+{
+    if (_unpack || !_data || _numberOfMipmaps > 1
+        || (_renderFormat != Texture2D::PixelFormat::RGBA8888 && _renderFormat != Texture2D::PixelFormat::RGB888))
+    {
+        return false;
+    }
+
+    const bool opaque = isOpaque();
+
+    // ETC1 blocks are 4x4 pixels, the other sizes would be padded
+    if (allowCompression && opaque && Configuration::getInstance()->supportsETC()
+        && _width % 4 == 0 && _height % 4 == 0 && encodeETC())
+    {
+        return true;
+    }
+
+    const auto format = opaque ? Texture2D::PixelFormat::RGB565 : Texture2D::PixelFormat::RGBA4444;
+    unsigned char* outData = nullptr;
+    ssize_t outDataLen = 0;
+    Texture2D::convertDataToFormat(_data, _dataLen, _renderFormat, format, &outData, &outDataLen);
+    if (outData == _data)
+        return false;
+
+    free(_data);
+    _data = outData;
+    _dataLen = outDataLen;
+    _renderFormat = format;
+    return true;
+}
+
+bool Image::downsample(int lod)
+{
+    if (lod <= 0)
+        return true;
+
+    int channels = 0;
+    switch (_renderFormat)
+    {
+    case Texture2D::PixelFormat::RGBA8888: channels = 4; break;
+    case Texture2D::PixelFormat::RGB888: channels = 3; break;
+    case Texture2D::PixelFormat::AI88: channels = 2; break;
+    case Texture2D::PixelFormat::I8:
+    case Texture2D::PixelFormat::A8: channels = 1; break;
+    default: break;
+    }
+
+    if (_unpack || !_data || _numberOfMipmaps > 1 || channels == 0)
+        return false;
+
+    for (int level = 0; level < lod && (_width > 1 || _height > 1); ++level)
+    {
+        const int width = std::max(_width >> 1, 1);
+        const int height = std::max(_height >> 1, 1);
+        const ssize_t dataLen = width * height * channels;
+        unsigned char* data = static_cast<unsigned char*>(malloc(dataLen));
+        if (!data)
+            return false;
+
+        // the last row and column of odd sizes are sampled twice
+        for (int y = 0; y < height; ++y)
+        {
+            const unsigned char* row0 = _data + (y * 2) * _width * channels;
+            const unsigned char* row1 = _data + std::min(y * 2 + 1, _height - 1) * _width * channels;
+            unsigned char* out = data + y * width * channels;
+            for (int x = 0; x < width; ++x)
+            {
+                const int x0 = (x * 2) * channels;
+                const int x1 = std::min(x * 2 + 1, _width - 1) * channels;
+                for (int c = 0; c < channels; ++c)
+                {
+                    *out++ = (unsigned char)((row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) >> 2);
+                }
+            }
+        }
+
+        free(_data);
+        _data = data;
+        _dataLen = dataLen;
+        _width = width;
+        _height = height;
+    }
+    return true;
+}
+
 void Image::setPVRImagesHavePremultipliedAlpha(bool haveAlphaPremultiplied)
 {
     _PVRHaveAlphaPremultiplied = haveAlphaPremultiplied;
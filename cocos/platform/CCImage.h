@@ -63,6 +63,7 @@ class CC_DLL Image : public Ref
 {
 public:
     friend class TextureCache;
+    friend class TextureStreamer;
     /**
      * @js ctor
      */
@@ -152,6 +153,26 @@ public:
     bool                     hasAlpha();
     bool                     isCompressed();
 
+    /**
+     @brief    Converts the decoded pixels to a format which takes less memory once uploaded.
+               Opaque images are encoded to ETC1 when the GPU supports it and compression is allowed, the other ones
+               are converted to RGB565, or to RGBA4444 if they have transparent pixels. Compressed images, images with
+               mipmaps and images which aren't RGB888 or RGBA8888 are kept as they are.
+     @param    allowCompression    Whether the image can be encoded to ETC1, which is slow: TextureCache only allows it on its loading thread.
+     @return   True if the pixels were converted.
+     @since v3.13
+     */
+    bool transcode(bool allowCompression);
+
+    /**
+     @brief    Halves the width and height of the image lod times, averaging each 2x2 block of pixels.
+               Only uncompressed images without mipmaps, with 8 bits per channel, can be downsampled.
+     @param    lod    Number of times the size is halved, it doesn't go below 1x1.
+     @return   True if the image was downsampled, or if lod is 0.
+     @since v3.13
+     */
+    bool downsample(int lod);
+
 
     /**
      @brief    Save Image data to the specified file, with specified format.
@@ -182,6 +203,9 @@ protected:
     bool saveImageToJPG(const std::string& filePath);
     
     void premultipliedAlpha();
+    // whether all the pixels of a RGB888 or RGBA8888 image are opaque
+    bool isOpaque() const;
+    bool encodeETC();
     
 protected:
     /**
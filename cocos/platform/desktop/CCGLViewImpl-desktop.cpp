@@ -38,6 +38,7 @@ THE SOFTWARE.
 #include "base/ccUtils.h"
 #include "base/ccUTF8.h"
 #include "2d/CCCamera.h"
+#include "renderer/ccGLStateCache.h"
 
 NS_CC_BEGIN
 
@@ -284,6 +285,7 @@ GLViewImpl::GLViewImpl(bool initglfw)
 , _retinaFactor(1)
 , _frameZoomFactor(1.0f)
 , _mainWindow(nullptr)
+, _sharedWindow(nullptr)
 , _monitor(nullptr)
 , _mouseX(0.0f)
 , _mouseY(0.0f)
@@ -485,6 +487,11 @@ bool GLViewImpl::isOpenGLReady()
 
 void GLViewImpl::end()
 {
+    if (_sharedWindow)
+    {
+        glfwDestroyWindow(_sharedWindow);
+        _sharedWindow = nullptr;
+    }
     if(_mainWindow)
     {
         glfwSetWindowShouldClose(_mainWindow,1);
@@ -500,6 +507,31 @@ void GLViewImpl::swapBuffers()
         glfwSwapBuffers(_mainWindow);
 }
 
+bool GLViewImpl::createSharedContext()
+{
+    if (_sharedWindow)
+        return true;
+    if (!_mainWindow)
+        return false;
+
+    // windows are created by the main thread, their contexts can be made current on any thread
+    glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+    _sharedWindow = glfwCreateWindow(1, 1, _viewName.c_str(), nullptr, _mainWindow);
+    glfwWindowHint(GLFW_VISIBLE, GL_TRUE);
+
+    return _sharedWindow != nullptr;
+}
+
+void GLViewImpl::makeContextCurrent(bool shared)
+{
+    glfwMakeContextCurrent(shared ? _sharedWindow : _mainWindow);
+}
+
+void GLViewImpl::releaseCurrentContext()
+{
+    glfwMakeContextCurrent(nullptr);
+}
+
 bool GLViewImpl::windowShouldClose()
 {
     if(_mainWindow)
@@ -618,7 +650,7 @@ void GLViewImpl::setViewPortInPoints(float x , float y , float w , float h)
 
 void GLViewImpl::setScissorInPoints(float x , float y , float w , float h)
 {
-    glScissor((GLint)(x * _scaleX * _retinaFactor * _frameZoomFactor + _viewPortRect.origin.x * _retinaFactor * _frameZoomFactor),
+    GL::scissor((GLint)(x * _scaleX * _retinaFactor * _frameZoomFactor + _viewPortRect.origin.x * _retinaFactor * _frameZoomFactor),
                (GLint)(y * _scaleY * _retinaFactor  * _frameZoomFactor + _viewPortRect.origin.y * _retinaFactor * _frameZoomFactor),
                (GLsizei)(w * _scaleX * _retinaFactor * _frameZoomFactor),
                (GLsizei)(h * _scaleY * _retinaFactor * _frameZoomFactor));
@@ -83,6 +83,9 @@ public:
     virtual bool isOpenGLReady() override;
     virtual void end() override;
     virtual void swapBuffers() override;
+    virtual bool createSharedContext() override;
+    virtual void makeContextCurrent(bool shared) override;
+    virtual void releaseCurrentContext() override;
     virtual void setFrameSize(float width, float height) override;
     virtual void setIMEKeyboardState(bool bOpen) override;
 
@@ -146,6 +149,8 @@ protected:
     float _frameZoomFactor;
 
     GLFWwindow* _mainWindow;
+    // hidden window whose context shares its objects with the one of the main window
+    GLFWwindow* _sharedWindow;
     GLFWmonitor* _monitor;
 
     std::string _glfwError;
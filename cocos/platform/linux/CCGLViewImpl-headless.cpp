@@ -0,0 +1,235 @@
+/****************************************************************************
+ Copyright (c) 2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "platform/linux/CCGLViewImpl-headless.h"
+#if CC_TARGET_PLATFORM == CC_PLATFORM_LINUX && CC_USE_HEADLESS_GLVIEW
+
+#include "base/ccMacros.h"
+
+NS_CC_BEGIN
+
+GLViewHeadless* GLViewHeadless::create(const std::string& viewName, const Size& frameSize)
+{
+    auto ret = new (std::nothrow) GLViewHeadless();
+    if (ret && ret->initWithSize(viewName, frameSize))
+    {
+        ret->autorelease();
+        return ret;
+    }
+    CC_SAFE_DELETE(ret);
+    return nullptr;
+}
+
+GLViewHeadless::GLViewHeadless()
+: _display(EGL_NO_DISPLAY)
+, _config(nullptr)
+, _surface(EGL_NO_SURFACE)
+, _context(EGL_NO_CONTEXT)
+, _sharedSurface(EGL_NO_SURFACE)
+, _sharedContext(EGL_NO_CONTEXT)
+, _frameLimit(0)
+, _renderedFrames(0)
+, _shouldClose(false)
+{
+}
+
+GLViewHeadless::~GLViewHeadless()
+{
+    destroyContext();
+}
+
+bool GLViewHeadless::initWithSize(const std::string& viewName, const Size& frameSize)
+{
+    setViewName(viewName);
+
+    _display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    EGLint major = 0;
+    EGLint minor = 0;
+    if (_display == EGL_NO_DISPLAY || !eglInitialize(_display, &major, &minor))
+    {
+        CCLOG("cocos2d: GLViewHeadless: couldn't initialize EGL");
+        _display = EGL_NO_DISPLAY;
+        return false;
+    }
+    CCLOG("cocos2d: GLViewHeadless: EGL %d.%d", major, minor);
+
+    // the engine is built against desktop GL on Linux
+    if (!eglBindAPI(EGL_OPENGL_API))
+    {
+        CCLOG("cocos2d: GLViewHeadless: desktop OpenGL isn't supported by EGL");
+        destroyContext();
+        return false;
+    }
+
+    const EGLint configAttribs[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, _glContextAttrs.redBits,
+        EGL_GREEN_SIZE, _glContextAttrs.greenBits,
+        EGL_BLUE_SIZE, _glContextAttrs.blueBits,
+        EGL_ALPHA_SIZE, _glContextAttrs.alphaBits,
+        EGL_DEPTH_SIZE, _glContextAttrs.depthBits,
+        EGL_STENCIL_SIZE, _glContextAttrs.stencilBits,
+        EGL_NONE
+    };
+    EGLint numConfigs = 0;
+    if (!eglChooseConfig(_display, configAttribs, &_config, 1, &numConfigs) || numConfigs < 1)
+    {
+        CCLOG("cocos2d: GLViewHeadless: no pbuffer config matches the GL context attributes");
+        destroyContext();
+        return false;
+    }
+
+    const EGLint surfaceAttribs[] = {
+        EGL_WIDTH, (EGLint)frameSize.width,
+        EGL_HEIGHT, (EGLint)frameSize.height,
+        EGL_NONE
+    };
+    _surface = eglCreatePbufferSurface(_display, _config, surfaceAttribs);
+    _context = eglCreateContext(_display, _config, EGL_NO_CONTEXT, nullptr);
+    if (_surface == EGL_NO_SURFACE || _context == EGL_NO_CONTEXT || !eglMakeCurrent(_display, _surface, _surface, _context))
+    {
+        CCLOG("cocos2d: GLViewHeadless: couldn't create a %dx%d pbuffer (EGL error 0x%x)",
+              (int)frameSize.width, (int)frameSize.height, eglGetError());
+        destroyContext();
+        return false;
+    }
+
+    // GLEW resolves the entry points of the current context, whichever API created it
+    glewExperimental = GL_TRUE;
+    GLenum glewResult = glewInit();
+    if (GLEW_OK != glewResult)
+    {
+        CCLOG("cocos2d: GLViewHeadless: %s", (const char*)glewGetErrorString(glewResult));
+        destroyContext();
+        return false;
+    }
+    CCLOG("cocos2d: GLViewHeadless: %s", (const char*)glGetString(GL_RENDERER));
+
+    setFrameSize(frameSize.width, frameSize.height);
+
+    // Enable point size by default.
+    glEnable(GL_VERTEX_PROGRAM_POINT_SIZE);
+
+    return true;
+}
+
+void GLViewHeadless::destroyContext()
+{
+    if (_display == EGL_NO_DISPLAY)
+        return;
+
+    eglMakeCurrent(_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (_sharedContext != EGL_NO_CONTEXT)
+        eglDestroyContext(_display, _sharedContext);
+    if (_sharedSurface != EGL_NO_SURFACE)
+        eglDestroySurface(_display, _sharedSurface);
+    if (_context != EGL_NO_CONTEXT)
+        eglDestroyContext(_display, _context);
+    if (_surface != EGL_NO_SURFACE)
+        eglDestroySurface(_display, _surface);
+    eglTerminate(_display);
+
+    _sharedContext = EGL_NO_CONTEXT;
+    _sharedSurface = EGL_NO_SURFACE;
+    _context = EGL_NO_CONTEXT;
+    _surface = EGL_NO_SURFACE;
+    _display = EGL_NO_DISPLAY;
+}
+
+bool GLViewHeadless::isOpenGLReady()
+{
+    return _context != EGL_NO_CONTEXT;
+}
+
+void GLViewHeadless::end()
+{
+    _shouldClose = true;
+    // Release self. Otherwise, GLViewHeadless could not be freed.
+    release();
+}
+
+void GLViewHeadless::swapBuffers()
+{
+    if (_context == EGL_NO_CONTEXT)
+        return;
+
+    eglSwapBuffers(_display, _surface);
+    ++_renderedFrames;
+}
+
+bool GLViewHeadless::createSharedContext()
+{
+    if (_sharedContext != EGL_NO_CONTEXT)
+        return true;
+    if (_context == EGL_NO_CONTEXT)
+        return false;
+
+    const EGLint surfaceAttribs[] = {
+        EGL_WIDTH, 1,
+        EGL_HEIGHT, 1,
+        EGL_NONE
+    };
+    _sharedSurface = eglCreatePbufferSurface(_display, _config, surfaceAttribs);
+    _sharedContext = eglCreateContext(_display, _config, _context, nullptr);
+    if (_sharedSurface == EGL_NO_SURFACE || _sharedContext == EGL_NO_CONTEXT)
+    {
+        CCLOG("cocos2d: GLViewHeadless: couldn't create a shared context (EGL error 0x%x)", eglGetError());
+        if (_sharedContext != EGL_NO_CONTEXT)
+            eglDestroyContext(_display, _sharedContext);
+        if (_sharedSurface != EGL_NO_SURFACE)
+            eglDestroySurface(_display, _sharedSurface);
+        _sharedContext = EGL_NO_CONTEXT;
+        _sharedSurface = EGL_NO_SURFACE;
+        return false;
+    }
+    return true;
+}
+
+void GLViewHeadless::makeContextCurrent(bool shared)
+{
+    if (shared)
+        eglMakeCurrent(_display, _sharedSurface, _sharedSurface, _sharedContext);
+    else
+        eglMakeCurrent(_display, _surface, _surface, _context);
+}
+
+void GLViewHeadless::releaseCurrentContext()
+{
+    eglMakeCurrent(_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+}
+
+void GLViewHeadless::setIMEKeyboardState(bool /*open*/)
+{
+}
+
+bool GLViewHeadless::windowShouldClose()
+{
+    return _shouldClose || _context == EGL_NO_CONTEXT || (_frameLimit > 0 && _renderedFrames >= _frameLimit);
+}
+
+NS_CC_END
+
+#endif // CC_TARGET_PLATFORM == CC_PLATFORM_LINUX && CC_USE_HEADLESS_GLVIEW
@@ -0,0 +1,98 @@
+/****************************************************************************
+ Copyright (c) 2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef __CC_GLVIEWIMPL_HEADLESS_H__
+#define __CC_GLVIEWIMPL_HEADLESS_H__
+
+#include "platform/CCPlatformConfig.h"
+#if CC_TARGET_PLATFORM == CC_PLATFORM_LINUX && CC_USE_HEADLESS_GLVIEW
+
+#include <atomic>
+
+#include <EGL/egl.h>
+
+#include "platform/CCGLView.h"
+
+NS_CC_BEGIN
+
+/** @brief GLViewHeadless renders into an offscreen EGL pbuffer instead of a window.
+ *
+ * It lets the Director run where there is no display, for example on a build server, to benchmark
+ * scenes with FrameBenchmark or to render reference frames. Create it in applicationDidFinishLaunching()
+ * instead of GLViewImpl. Application::run() then runs until the frame limit is reached.
+ *
+ * With Mesa, set EGL_PLATFORM=surfaceless to get a display without an X server.
+ * Only available when the engine is built with the USE_HEADLESS_GLVIEW option.
+ * @since v3.13
+ */
+class CC_DLL GLViewHeadless : public GLView
+{
+public:
+    /** Creates a view whose frame buffer has the given size, in pixels. */
+    static GLViewHeadless* create(const std::string& viewName, const Size& frameSize);
+
+    /** Sets the number of frames to render before windowShouldClose() returns true. 0 means no limit, which is the default. */
+    void setFrameLimit(unsigned int frames) { _frameLimit = frames; }
+    /** Returns the frame limit. */
+    unsigned int getFrameLimit() const { return _frameLimit; }
+    /** Returns the number of frames rendered so far. */
+    unsigned int getRenderedFrames() const { return _renderedFrames; }
+
+    // overrides
+    virtual bool isOpenGLReady() override;
+    virtual void end() override;
+    virtual void swapBuffers() override;
+    virtual bool createSharedContext() override;
+    virtual void makeContextCurrent(bool shared) override;
+    virtual void releaseCurrentContext() override;
+    virtual void setIMEKeyboardState(bool open) override;
+    virtual bool windowShouldClose() override;
+
+protected:
+    GLViewHeadless();
+    virtual ~GLViewHeadless();
+
+    bool initWithSize(const std::string& viewName, const Size& frameSize);
+    void destroyContext();
+
+    EGLDisplay _display;
+    EGLConfig _config;
+    EGLSurface _surface;
+    EGLContext _context;
+    // context sharing its objects with _context, with its own small pbuffer
+    EGLSurface _sharedSurface;
+    EGLContext _sharedContext;
+
+    unsigned int _frameLimit;
+    // swapped by the render thread when the rendering is pipelined
+    std::atomic<unsigned int> _renderedFrames;
+    bool _shouldClose;
+};
+
+NS_CC_END
+
+#endif // CC_TARGET_PLATFORM == CC_PLATFORM_LINUX && CC_USE_HEADLESS_GLVIEW
+
+#endif // __CC_GLVIEWIMPL_HEADLESS_H__
@@ -0,0 +1,259 @@
+/****************************************************************************
+ Copyright (c) 2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "renderer/CCBatchDiagnostics.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <typeindex>
+#include <typeinfo>
+#if defined(__GNUC__)
+#include <cxxabi.h>
+#endif
+
+#include "2d/CCNode.h"
+#include "base/ccUTF8.h"
+#include "platform/CCFileUtils.h"
+
+NS_CC_BEGIN
+
+BatchDiagnostics* BatchDiagnostics::s_active = nullptr;
+
+static const char* s_reasonNames[] = {
+    "queueChange",
+    "material",
+    "texture",
+    "program",
+    "blend",
+    "skipBatching",
+    "bufferFull",
+    "groupCommand",
+    "customCommand",
+    "meshCommand",
+    "batchCommand",
+    "primitiveCommand",
+};
+
+static_assert(sizeof(s_reasonNames) / sizeof(s_reasonNames[0]) == (size_t)BatchDiagnostics::BreakReason::COUNT, "Missing reason names");
+
+static const std::string& getClassName(const Node* node)
+{
+    static std::unordered_map<std::type_index, std::string> classNames;
+
+    std::type_index type = typeid(*node);
+    auto it = classNames.find(type);
+    if (it != classNames.end())
+        return it->second;
+
+    std::string name = type.name();
+#if defined(__GNUC__)
+    int status = 0;
+    char* demangled = abi::__cxa_demangle(type.name(), nullptr, nullptr, &status);
+    if (demangled)
+    {
+        if (status == 0)
+            name = demangled;
+        free(demangled);
+    }
+#else
+    // MSVC names are "class cocos2d::Sprite"
+    auto space = name.find(' ');
+    if (space != std::string::npos)
+        name = name.substr(space + 1);
+#endif
+    return classNames.insert(std::make_pair(type, name)).first->second;
+}
+
+static void resetReport(BatchDiagnostics::FrameReport& report, unsigned int frame)
+{
+    report.frame = frame;
+    report.drawCalls = 0;
+    std::fill(std::begin(report.breaks), std::end(report.breaks), 0);
+    report.entries.clear();
+}
+
+static std::string escapeJSON(const std::string& str)
+{
+    std::string result;
+    result.reserve(str.size());
+    for (const char c : str)
+    {
+        if (c == '"' || c == '\\')
+        {
+            result += '\\';
+            result += c;
+        }
+        else if ((unsigned char)c < 0x20)
+        {
+            result += StringUtils::format("\\u%04x", c);
+        }
+        else
+        {
+            result += c;
+        }
+    }
+    return result;
+}
+
+const char* BatchDiagnostics::getReasonName(BreakReason reason)
+{
+    CCASSERT(reason < BreakReason::COUNT, "Invalid reason");
+    return s_reasonNames[(int)reason];
+}
+
+BatchDiagnostics::BatchDiagnostics()
+: _drawingNode(nullptr)
+, _pendingReason(BreakReason::QUEUE_CHANGE)
+, _frame(0)
+{
+    CCASSERT(s_active == nullptr, "Only one BatchDiagnostics can be recording");
+    s_active = this;
+
+    resetReport(_currentReport, 0);
+    resetReport(_lastReport, 0);
+}
+
+BatchDiagnostics::~BatchDiagnostics()
+{
+    s_active = nullptr;
+}
+
+int BatchDiagnostics::getNodeIndex(const Node* node)
+{
+    auto it = _nodeIndices.find(node);
+    if (it != _nodeIndices.end())
+        return it->second;
+
+    // the node might be released before the end of the frame, its names are copied
+    NodeInfo info;
+    info.nodeClass = getClassName(node);
+    info.nodeName = node->getName();
+    _nodes.push_back(info);
+
+    int index = (int)_nodes.size() - 1;
+    _nodeIndices[node] = index;
+    return index;
+}
+
+void BatchDiagnostics::addCommand(const RenderCommand* command)
+{
+    _commandNodes[command] = _drawingNode ? getNodeIndex(_drawingNode) : -1;
+}
+
+void BatchDiagnostics::addDraw(const RenderCommand* command, BreakReason reason)
+{
+    auto it = _commandNodes.find(command);
+    int node = it != _commandNodes.end() ? it->second : -1;
+
+    ++_drawCalls[std::make_pair(node, (int)reason)];
+    ++_currentReport.breaks[(int)reason];
+    ++_currentReport.drawCalls;
+}
+
+void BatchDiagnostics::endFrame()
+{
+    for (const auto& drawCalls : _drawCalls)
+    {
+        Entry entry;
+        int node = drawCalls.first.first;
+        entry.nodeClass = node >= 0 ? _nodes[node].nodeClass : "";
+        entry.nodeName = node >= 0 ? _nodes[node].nodeName : "";
+        entry.reason = (BreakReason)drawCalls.first.second;
+        entry.drawCalls = drawCalls.second;
+        _currentReport.entries.push_back(entry);
+    }
+    std::stable_sort(_currentReport.entries.begin(), _currentReport.entries.end(), [](const Entry& a, const Entry& b) {
+        return a.drawCalls > b.drawCalls;
+    });
+
+    std::swap(_lastReport, _currentReport);
+    resetReport(_currentReport, ++_frame);
+
+    _nodes.clear();
+    _nodeIndices.clear();
+    _commandNodes.clear();
+    _drawCalls.clear();
+    _drawingNode = nullptr;
+    _pendingReason = BreakReason::QUEUE_CHANGE;
+}
+
+std::string BatchDiagnostics::getDescription(size_t maxEntries) const
+{
+    const auto& report = _lastReport;
+    std::string description = StringUtils::format("frame %u: %u draw calls\n", report.frame, report.drawCalls);
+
+    for (int i = 0; i < (int)BreakReason::COUNT; ++i)
+    {
+        if (report.breaks[i] > 0)
+            description += StringUtils::format("  %-18s %u\n", s_reasonNames[i], report.breaks[i]);
+    }
+
+    size_t count = std::min(maxEntries, report.entries.size());
+    for (size_t i = 0; i < count; ++i)
+    {
+        const auto& entry = report.entries[i];
+        description += StringUtils::format("  %5u  %-18s %s \"%s\"\n", entry.drawCalls, getReasonName(entry.reason),
+                                           entry.nodeClass.empty() ? "<no node>" : entry.nodeClass.c_str(), entry.nodeName.c_str());
+    }
+    if (count < report.entries.size())
+    {
+        description += StringUtils::format("  ... %d more\n", (int)(report.entries.size() - count));
+    }
+    return description;
+}
+
+std::string BatchDiagnostics::toJSON() const
+{
+    const auto& report = _lastReport;
+
+    std::string json = "{\n";
+    json += StringUtils::format("  \"frame\": %u,\n", report.frame);
+    json += StringUtils::format("  \"drawCalls\": %u,\n", report.drawCalls);
+    json += "  \"breaks\": {";
+    for (int i = 0; i < (int)BreakReason::COUNT; ++i)
+    {
+        json += StringUtils::format("%s\"%s\": %u", i == 0 ? "" : ", ", s_reasonNames[i], report.breaks[i]);
+    }
+    json += "},\n";
+    json += "  \"entries\": [";
+    for (size_t i = 0; i < report.entries.size(); ++i)
+    {
+        const auto& entry = report.entries[i];
+        json += StringUtils::format("%s\n    {\"nodeClass\": \"%s\", \"nodeName\": \"%s\", \"reason\": \"%s\", \"drawCalls\": %u}",
+                                    i == 0 ? "" : ",",
+                                    escapeJSON(entry.nodeClass).c_str(), escapeJSON(entry.nodeName).c_str(),
+                                    getReasonName(entry.reason), entry.drawCalls);
+    }
+    json += "\n  ]\n}\n";
+    return json;
+}
+
+bool BatchDiagnostics::saveToFile(const std::string& filename) const
+{
+    auto fileUtils = FileUtils::getInstance();
+    std::string fullPath = fileUtils->isAbsolutePath(filename) ? filename : fileUtils->getWritablePath() + filename;
+    return fileUtils->writeStringToFile(toJSON(), fullPath);
+}
+
+NS_CC_END
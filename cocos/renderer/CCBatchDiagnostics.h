@@ -0,0 +1,188 @@
+/****************************************************************************
+ Copyright (c) 2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CC_BATCH_DIAGNOSTICS_H__
+#define __CC_BATCH_DIAGNOSTICS_H__
+
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "platform/CCPlatformMacros.h"
+
+NS_CC_BEGIN
+
+class Node;
+class RenderCommand;
+
+/**
+ * @addtogroup renderer
+ * @{
+ */
+
+/** @brief BatchDiagnostics records why each draw call of a frame couldn't be merged with the previous one.
+ *
+ * Every command added to the Renderer is attributed to the node being drawn, and every draw call is recorded
+ * with the reason of the break: a different texture, program, blend function or material between two
+ * triangles commands, or a command which is never batched, like a custom or a group command.
+ * The breaks of a frame are summed by node class, node name and reason in a report, which can be printed
+ * with the `batches` Console command or saved as JSON.
+ *
+ * While it is enabled, the nodes are visited by a single thread and the pipelined render queues are executed
+ * while the main thread waits, so the commands are attributed before they are drawn.
+ * See Renderer::setBatchDiagnosticsEnabled().
+ * @since v3.13
+ */
+class CC_DLL BatchDiagnostics
+{
+public:
+    /** Why a draw call couldn't be merged with the previous one */
+    enum class BreakReason
+    {
+        /** First draw call of a render queue */
+        QUEUE_CHANGE,
+        /** Same texture, program and blend function, but different uniforms or render states */
+        MATERIAL,
+        TEXTURE,
+        PROGRAM,
+        BLEND,
+        /** The command isn't batched, see RenderCommand::setSkipBatching() */
+        SKIP_BATCHING,
+        /** The vertex buffer of the batch was full */
+        BUFFER_FULL,
+        GROUP_COMMAND,
+        CUSTOM_COMMAND,
+        MESH_COMMAND,
+        BATCH_COMMAND,
+        PRIMITIVE_COMMAND,
+        COUNT
+    };
+
+    /** Draw calls of a frame that broke a batch for the same reason, drawing nodes of the same class and name */
+    struct Entry
+    {
+        std::string nodeClass;
+        std::string nodeName;
+        BreakReason reason;
+        unsigned int drawCalls;
+    };
+
+    /** Summary of the draw calls of a frame */
+    struct FrameReport
+    {
+        unsigned int frame;
+        unsigned int drawCalls;
+        unsigned int breaks[(int)BreakReason::COUNT];
+        /** Sorted by decreasing number of draw calls */
+        std::vector<Entry> entries;
+    };
+
+    /** Returns the name of the reason, as used by the reports. */
+    static const char* getReasonName(BreakReason reason);
+
+    /**
+     * Sets the node whose draw() is called next, the commands added to the Renderer are attributed to it.
+     * Called by the nodes while visiting, it does nothing when the diagnostics are disabled.
+     */
+    static void setDrawingNode(const Node* node)
+    {
+        if (s_active)
+            s_active->_drawingNode = node;
+    }
+
+    /**
+     * @js NA
+     * @lua NA
+     */
+    BatchDiagnostics();
+    /**
+     * @js NA
+     * @lua NA
+     */
+    ~BatchDiagnostics();
+
+    /** Attributes a command added to the Renderer to the drawing node. */
+    void addCommand(const RenderCommand* command);
+
+    /** Records a draw call of the command, which couldn't be merged with the previous draw call because of reason. */
+    void addDraw(const RenderCommand* command, BreakReason reason);
+
+    /** Sets the reason of the break before the next batch of triangles. */
+    void setPendingReason(BreakReason reason) { _pendingReason = reason; }
+    /** Returns the reason of the break before the next batch of triangles. */
+    BreakReason getPendingReason() const { return _pendingReason; }
+
+    /** Ends the recorded frame and builds its report. Called by the Renderer. */
+    void endFrame();
+
+    /** Returns the report of the last frame. */
+    const FrameReport& getLastReport() const { return _lastReport; }
+
+    /** Returns the report of the last frame as text, the entries with the most draw calls first. */
+    std::string getDescription(size_t maxEntries = 20) const;
+
+    /** Returns the report of the last frame as JSON. */
+    std::string toJSON() const;
+
+    /**
+     * Saves the report of the last frame as JSON.
+     * @param filename A path relative to the writable path, or an absolute one.
+     */
+    bool saveToFile(const std::string& filename) const;
+
+protected:
+    struct NodeInfo
+    {
+        std::string nodeClass;
+        std::string nodeName;
+    };
+
+    // returns the index in _nodes of the node, adding it the first time it draws in the frame
+    int getNodeIndex(const Node* node);
+
+    static BatchDiagnostics* s_active;
+
+    const Node* _drawingNode;
+    BreakReason _pendingReason;
+
+    // nodes which added commands in the frame
+    std::vector<NodeInfo> _nodes;
+    std::unordered_map<const Node*, int> _nodeIndices;
+    std::unordered_map<const RenderCommand*, int> _commandNodes;
+    // draw calls of the frame, by node index and reason
+    std::map<std::pair<int, int>, unsigned int> _drawCalls;
+
+    unsigned int _frame;
+    FrameReport _currentReport;
+    FrameReport _lastReport;
+};
+
+// end of renderer group
+/// @}
+
+NS_CC_END
+
+#endif //__CC_BATCH_DIAGNOSTICS_H__
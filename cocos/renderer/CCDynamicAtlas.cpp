@@ -0,0 +1,364 @@
+/****************************************************************************
+ Copyright (c) 2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "renderer/CCDynamicAtlas.h"
+
+#include <algorithm>
+#include <climits>
+
+#include "base/ccMacros.h"
+#include "platform/CCImage.h"
+#include "renderer/CCTexture2D.h"
+#include "renderer/CCTextureCache.h"
+
+NS_CC_BEGIN
+
+// pixels copied around each image, so that linear filtering doesn't sample its neighbours
+static const int EXTRUDE = 1;
+
+//
+// MARK: SkylinePacker
+//
+void DynamicAtlas::SkylinePacker::reset(int width, int height)
+{
+    _width = width;
+    _height = height;
+
+    _skyline.clear();
+    Segment segment = {0, 0, width};
+    _skyline.push_back(segment);
+}
+
+int DynamicAtlas::SkylinePacker::fit(size_t index, int width, int height) const
+{
+    int x = _skyline[index].x;
+    if (x + width > _width)
+        return -1;
+
+    // the rect lies on the highest segment it spans
+    int y = _skyline[index].y;
+    int widthLeft = width;
+    while (widthLeft > 0)
+    {
+        y = std::max(y, _skyline[index].y);
+        if (y + height > _height)
+            return -1;
+        widthLeft -= _skyline[index].width;
+        ++index;
+    }
+    return y;
+}
+
+bool DynamicAtlas::SkylinePacker::insert(int width, int height, int* x, int* y)
+{
+    int bestIndex = -1;
+    int bestTop = INT_MAX;
+    int bestWidth = INT_MAX;
+    int bestY = 0;
+
+    for (size_t i = 0; i < _skyline.size(); ++i)
+    {
+        int top = fit(i, width, height);
+        if (top < 0)
+            continue;
+
+        // bottom-left: the lowest top edge first, then the narrowest segment
+        if (top + height < bestTop || (top + height == bestTop && _skyline[i].width < bestWidth))
+        {
+            bestIndex = (int)i;
+            bestTop = top + height;
+            bestWidth = _skyline[i].width;
+            bestY = top;
+        }
+    }
+
+    if (bestIndex < 0)
+        return false;
+
+    *x = _skyline[bestIndex].x;
+    *y = bestY;
+
+    Segment segment = {*x, bestY + height, width};
+    _skyline.insert(_skyline.begin() + bestIndex, segment);
+
+    // shrink or remove the segments now covered by the new one
+    for (size_t i = bestIndex + 1; i < _skyline.size(); )
+    {
+        int previousRight = _skyline[i - 1].x + _skyline[i - 1].width;
+        if (_skyline[i].x >= previousRight)
+            break;
+
+        int shrink = previousRight - _skyline[i].x;
+        _skyline[i].x += shrink;
+        _skyline[i].width -= shrink;
+        if (_skyline[i].width > 0)
+            break;
+
+        _skyline.erase(_skyline.begin() + i);
+    }
+
+    // merge the neighbours at the same height
+    for (size_t i = 0; i + 1 < _skyline.size(); )
+    {
+        if (_skyline[i].y == _skyline[i + 1].y)
+        {
+            _skyline[i].width += _skyline[i + 1].width;
+            _skyline.erase(_skyline.begin() + i + 1);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+
+    return true;
+}
+
+//
+// MARK: DynamicAtlas
+//
+DynamicAtlas::DynamicAtlas(int pageSize, int maxPages, int maxImageSize)
+: _pageSize(pageSize)
+, _maxPages(maxPages)
+, _maxImageSize(std::min(maxImageSize, pageSize - 2 * EXTRUDE))
+, _useCounter(0)
+{
+}
+
+DynamicAtlas::~DynamicAtlas()
+{
+    removeAllTextures();
+}
+
+bool DynamicAtlas::addTexture(Texture2D* texture, Image* image)
+{
+    CCASSERT(texture && image, "Invalid arguments");
+
+    const int width = image->getWidth();
+    const int height = image->getHeight();
+    const bool premultipliedAlpha = image->hasPremultipliedAlpha();
+    const bool uncompressed = !image->isCompressed()
+        && image->getNumberOfMipmaps() <= 1
+        && image->getRenderFormat() == Texture2D::PixelFormat::RGBA8888
+        && texture->getPixelFormat() == Texture2D::PixelFormat::RGBA8888;
+
+    auto packed = _regions.find(texture);
+    if (packed != _regions.end())
+    {
+        // the texture was reloaded, the sprites drawn from its region keep their texture coordinates
+        auto& region = packed->second;
+        if (uncompressed
+            && region.page->premultipliedAlpha == premultipliedAlpha
+            && (int)region.rect.size.width == width
+            && (int)region.rect.size.height == height)
+        {
+            writeImage(region.page, (int)region.rect.origin.x - EXTRUDE, (int)region.rect.origin.y - EXTRUDE, image);
+            return true;
+        }
+
+        // it doesn't fit its region anymore, which is reclaimed with its page
+        _regions.erase(packed);
+    }
+
+    if (!uncompressed || width > _maxImageSize || height > _maxImageSize)
+    {
+        return false;
+    }
+
+    const int paddedWidth = width + 2 * EXTRUDE;
+    const int paddedHeight = height + 2 * EXTRUDE;
+
+    int x = 0;
+    int y = 0;
+    Page* page = nullptr;
+    for (const auto candidate : _pages)
+    {
+        if (candidate->premultipliedAlpha == premultipliedAlpha && candidate->packer.insert(paddedWidth, paddedHeight, &x, &y))
+        {
+            page = candidate;
+            break;
+        }
+    }
+
+    if (!page)
+    {
+        page = ((int)_pages.size() < _maxPages) ? createPage(premultipliedAlpha) : evictPage(premultipliedAlpha);
+        if (!page || !page->packer.insert(paddedWidth, paddedHeight, &x, &y))
+            return false;
+    }
+
+    writeImage(page, x, y, image);
+
+    Region region;
+    region.page = page;
+    region.rect.setRect(x + EXTRUDE, y + EXTRUDE, width, height);
+    _regions[texture] = region;
+
+    return true;
+}
+
+void DynamicAtlas::writeImage(Page* page, int x, int y, Image* image)
+{
+    const int width = image->getWidth();
+    const int height = image->getHeight();
+    const int paddedWidth = width + 2 * EXTRUDE;
+    const int paddedHeight = height + 2 * EXTRUDE;
+
+    _extruded.resize(paddedWidth * paddedHeight * 4);
+    const unsigned char* src = image->getData();
+    for (int row = 0; row < paddedHeight; ++row)
+    {
+        const int srcRow = std::min(std::max(row - EXTRUDE, 0), height - 1);
+        const unsigned char* srcLine = src + srcRow * width * 4;
+        unsigned char* dstLine = &_extruded[row * paddedWidth * 4];
+
+        for (int i = 0; i < EXTRUDE; ++i)
+        {
+            memcpy(dstLine + i * 4, srcLine, 4);
+            memcpy(dstLine + (EXTRUDE + width + i) * 4, srcLine + (width - 1) * 4, 4);
+        }
+        memcpy(dstLine + EXTRUDE * 4, srcLine, width * 4);
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    page->texture->updateWithData(_extruded.data(), x, y, paddedWidth, paddedHeight);
+
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    unsigned char* pagePixels = page->image->getData();
+    for (int row = 0; row < paddedHeight; ++row)
+    {
+        memcpy(pagePixels + ((y + row) * _pageSize + x) * 4, &_extruded[row * paddedWidth * 4], paddedWidth * 4);
+    }
+#endif
+}
+
+void DynamicAtlas::removeTexture(Texture2D* texture)
+{
+    _regions.erase(texture);
+}
+
+void DynamicAtlas::removeAllTextures()
+{
+    _regions.clear();
+
+    for (auto page : _pages)
+    {
+        CC_SAFE_RELEASE(page->image);
+        page->texture->release();
+        delete page;
+    }
+    _pages.clear();
+}
+
+Texture2D* DynamicAtlas::getPage(Texture2D* texture, Rect* rectInPixels)
+{
+    auto it = _regions.find(texture);
+    if (it == _regions.end())
+        return nullptr;
+
+    auto& region = it->second;
+    region.page->lastUsed = ++_useCounter;
+    if (rectInPixels)
+        rectInPixels->origin += region.rect.origin;
+    return region.page->texture;
+}
+
+bool DynamicAtlas::isPageInUse(Texture2D* texture) const
+{
+    auto it = _regions.find(texture);
+    return it != _regions.end() && it->second.page->texture->getReferenceCount() > 1;
+}
+
+DynamicAtlas::Page* DynamicAtlas::createPage(bool premultipliedAlpha)
+{
+    const ssize_t dataLen = _pageSize * _pageSize * 4;
+    std::vector<unsigned char> transparent(dataLen, 0);
+
+    auto image = new (std::nothrow) Image();
+    auto texture = new (std::nothrow) Texture2D();
+    if (!image || !texture
+        || !image->initWithRawData(transparent.data(), dataLen, _pageSize, _pageSize, 8, premultipliedAlpha)
+        || !texture->initWithImage(image, Texture2D::PixelFormat::RGBA8888))
+    {
+        CCLOG("cocos2d: DynamicAtlas: couldn't create a page of %dx%d", _pageSize, _pageSize);
+        CC_SAFE_RELEASE(image);
+        CC_SAFE_RELEASE(texture);
+        return nullptr;
+    }
+
+    auto page = new (std::nothrow) Page();
+    page->texture = texture;
+    page->premultipliedAlpha = premultipliedAlpha;
+    page->lastUsed = _useCounter;
+    page->packer.reset(_pageSize, _pageSize);
+
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    // the page is restored from its pixels
+    VolatileTextureMgr::addImage(texture, image);
+    page->image = image;
+#else
+    page->image = nullptr;
+    image->release();
+#endif
+
+    _pages.push_back(page);
+    return page;
+}
+
+DynamicAtlas::Page* DynamicAtlas::evictPage(bool premultipliedAlpha)
+{
+    Page* victim = nullptr;
+    for (const auto page : _pages)
+    {
+        // only the atlas references the page
+        if (page->texture->getReferenceCount() == 1 && (!victim || page->lastUsed < victim->lastUsed))
+            victim = page;
+    }
+
+    if (!victim)
+        return nullptr;
+
+    CCLOG("cocos2d: DynamicAtlas: clearing unused page %u", victim->texture->getName());
+    releasePage(victim);
+    return createPage(premultipliedAlpha);
+}
+
+void DynamicAtlas::releasePage(Page* page)
+{
+    for (auto it = _regions.begin(); it != _regions.end(); /* nothing */)
+    {
+        if (it->second.page == page)
+            it = _regions.erase(it);
+        else
+            ++it;
+    }
+
+    _pages.erase(std::find(_pages.begin(), _pages.end(), page));
+
+    CC_SAFE_RELEASE(page->image);
+    page->texture->release();
+    delete page;
+}
+
+NS_CC_END
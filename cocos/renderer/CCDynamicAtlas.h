@@ -0,0 +1,172 @@
+/****************************************************************************
+ Copyright (c) 2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CC_DYNAMIC_ATLAS_H__
+#define __CC_DYNAMIC_ATLAS_H__
+
+#include <unordered_map>
+#include <vector>
+
+#include "base/CCRef.h"
+#include "math/CCGeometry.h"
+
+NS_CC_BEGIN
+
+class Texture2D;
+class Image;
+
+/**
+ * @addtogroup _2d
+ * @{
+ */
+
+/** @brief DynamicAtlas packs small images into shared atlas pages when they are loaded.
+ *
+ * Sprites created from different image files can then share the same texture, and the Renderer
+ * batches them in a single draw call. The standalone textures are still created, so the regular
+ * TextureCache API doesn't change.
+ *
+ * Images are packed with a skyline bottom-left packer, with their edges extruded by one pixel
+ * to avoid bleeding when filtering. When all the pages are full, the least recently used page which
+ * isn't referenced by any node anymore is cleared and reused.
+ *
+ * It is owned by the TextureCache, see TextureCache::setDynamicAtlasEnabled().
+ * @since v3.13
+ */
+class CC_DLL DynamicAtlas : public Ref
+{
+public:
+    /** Default width and height of the pages, in pixels */
+    static const int DEFAULT_PAGE_SIZE = 1024;
+    /** Default maximum number of pages */
+    static const int DEFAULT_MAX_PAGES = 4;
+    /** Default maximum width and height of the packed images, in pixels */
+    static const int DEFAULT_MAX_IMAGE_SIZE = 256;
+
+    /**
+     * @js ctor
+     */
+    DynamicAtlas(int pageSize = DEFAULT_PAGE_SIZE, int maxPages = DEFAULT_MAX_PAGES, int maxImageSize = DEFAULT_MAX_IMAGE_SIZE);
+    /**
+     * @js NA
+     * @lua NA
+     */
+    virtual ~DynamicAtlas();
+
+    /** Packs the image the texture was created with.
+     * Only uncompressed RGBA8888 images smaller than the maximum image size are packed.
+     * If the texture is already packed and the image has the same size, as when it is reloaded, its region
+     * is updated in place so the sprites drawn from it keep their texture coordinates.
+     *
+     * @return False if the image wasn't packed.
+     */
+    bool addTexture(Texture2D* texture, Image* image);
+
+    /** Forgets where the texture was packed. Its region is reclaimed when its page is cleared. */
+    void removeTexture(Texture2D* texture);
+
+    /** Forgets all the packed textures and releases the pages. */
+    void removeAllTextures();
+
+    /** Returns the page where the texture was packed, or nullptr if it wasn't packed.
+     *
+     * @param texture A texture previously passed to addTexture().
+     * @param rectInPixels A rect of the texture, offset to the same rect in the page if it was packed.
+     */
+    Texture2D* getPage(Texture2D* texture, Rect* rectInPixels);
+
+    /** Returns whether the texture is packed in a page which is referenced by something else than the atlas,
+     * such as the sprites drawn from the page.
+     */
+    bool isPageInUse(Texture2D* texture) const;
+
+    /** Returns the number of pages */
+    ssize_t getPageCount() const { return _pages.size(); }
+
+    /** Returns the number of packed textures */
+    ssize_t getTextureCount() const { return _regions.size(); }
+
+protected:
+    // Skyline bottom-left bin packer
+    class SkylinePacker
+    {
+    public:
+        void reset(int width, int height);
+        bool insert(int width, int height, int* x, int* y);
+
+    protected:
+        // returns the y where a rect fits at the given segment of the skyline, or -1
+        int fit(size_t index, int width, int height) const;
+
+        struct Segment
+        {
+            int x;
+            int y;
+            int width;
+        };
+        std::vector<Segment> _skyline;
+        int _width;
+        int _height;
+    };
+
+    struct Page
+    {
+        Texture2D* texture;
+        // pixels of the page, kept to restore it when the GL context is lost
+        Image* image;
+        SkylinePacker packer;
+        bool premultipliedAlpha;
+        unsigned int lastUsed;
+    };
+
+    struct Region
+    {
+        Page* page;
+        Rect rect;
+    };
+
+    // copies the image with its borders extruded at x, y in the page
+    void writeImage(Page* page, int x, int y, Image* image);
+
+    Page* createPage(bool premultipliedAlpha);
+    // clears the least recently used page which isn't referenced anymore
+    Page* evictPage(bool premultipliedAlpha);
+    void releasePage(Page* page);
+
+    std::vector<Page*> _pages;
+    std::unordered_map<Texture2D*, Region> _regions;
+    std::vector<unsigned char> _extruded;
+
+    int _pageSize;
+    int _maxPages;
+    int _maxImageSize;
+    unsigned int _useCounter;
+};
+
+// end of _2d group
+/// @}
+
+NS_CC_END
+
+#endif //__CC_DYNAMIC_ATLAS_H__
@@ -0,0 +1,118 @@
+/****************************************************************************
+ Copyright (c) 2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "renderer/CCFrameArena.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+
+#include "base/ccMacros.h"
+
+NS_CC_BEGIN
+
+FrameArena::FrameArena(size_t chunkSize)
+: _chunkSize(chunkSize)
+, _currentChunk(0)
+, _offset(0)
+, _usedSize(0)
+, _capacity(0)
+{
+}
+
+FrameArena::~FrameArena()
+{
+    reset();
+    releaseChunks();
+}
+
+void* FrameArena::allocate(size_t size, size_t alignment)
+{
+    CCASSERT(alignment != 0 && (alignment & (alignment - 1)) == 0, "The alignment must be a power of two");
+
+    while (_currentChunk < _chunks.size())
+    {
+        const Chunk& chunk = _chunks[_currentChunk];
+        uintptr_t address = reinterpret_cast<uintptr_t>(chunk.data) + _offset;
+        size_t padding = (alignment - (address & (alignment - 1))) & (alignment - 1);
+        if (_offset + padding + size <= chunk.size)
+        {
+            _offset += padding + size;
+            _usedSize += padding + size;
+            return chunk.data + _offset - size;
+        }
+
+        // the rest of this chunk is wasted until the next reset
+        ++_currentChunk;
+        _offset = 0;
+    }
+
+    addChunk(std::max(_chunkSize, size + alignment));
+    return allocate(size, alignment);
+}
+
+void FrameArena::reset()
+{
+    // in reverse order, like the destructors of local variables
+    for (auto it = _destructors.rbegin(); it != _destructors.rend(); ++it)
+    {
+        it->second(it->first);
+    }
+    _destructors.clear();
+
+    // the next frames will likely need as much memory, make it a single chunk
+    if (_chunks.size() > 1)
+    {
+        size_t capacity = _capacity;
+        releaseChunks();
+        addChunk(capacity);
+    }
+
+    _currentChunk = 0;
+    _offset = 0;
+    _usedSize = 0;
+}
+
+void FrameArena::addChunk(size_t size)
+{
+    Chunk chunk;
+    chunk.data = static_cast<unsigned char*>(malloc(size));
+    chunk.size = size;
+    CCASSERT(chunk.data, "FrameArena: out of memory");
+
+    _chunks.push_back(chunk);
+    _capacity += size;
+}
+
+void FrameArena::releaseChunks()
+{
+    for (auto& chunk : _chunks)
+    {
+        free(chunk.data);
+    }
+    _chunks.clear();
+    _capacity = 0;
+}
+
+NS_CC_END
@@ -0,0 +1,132 @@
+/****************************************************************************
+ Copyright (c) 2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CC_FRAME_ARENA_H__
+#define __CC_FRAME_ARENA_H__
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "platform/CCPlatformMacros.h"
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup renderer
+ * @{
+ */
+
+/** @brief FrameArena is a linear allocator for the data that only lives until the frame is rendered.
+ *
+ * Allocating only bumps an offset into a chunk of memory, and reset() releases everything at once, so
+ * the render commands and the transient vertices created while visiting don't go through malloc and free
+ * every frame. The chunks are kept across resets, and merged into a single one when the frame needed
+ * more than one, so a steady scene stops allocating memory after a few frames.
+ *
+ * The Renderer owns the arenas, see Renderer::getFrameArena(). An arena is not thread safe.
+ * @since v3.13
+ */
+class CC_DLL FrameArena
+{
+public:
+    /** Default size of the chunks, in bytes */
+    static const size_t DEFAULT_CHUNK_SIZE = 64 * 1024;
+
+    /**
+     * @js NA
+     * @lua NA
+     */
+    explicit FrameArena(size_t chunkSize = DEFAULT_CHUNK_SIZE);
+    /**
+     * @js NA
+     * @lua NA
+     */
+    ~FrameArena();
+
+    /** Returns size bytes aligned to alignment, which must be a power of two. */
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+    /** Returns uninitialized storage for count plain data objects, like vertices and indices. Their destructors are never called. */
+    template <typename T>
+    T* allocateArray(size_t count)
+    {
+        return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    /** Constructs an object in the arena. Its destructor is called by reset(), it must not be deleted. */
+    template <typename T, typename... Args>
+    T* construct(Args&&... args)
+    {
+        T* object = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        if (!std::is_trivially_destructible<T>::value)
+        {
+            _destructors.push_back(std::make_pair(static_cast<void*>(object), &destroy<T>));
+        }
+        return object;
+    }
+
+    /** Destroys the constructed objects and makes all the memory available again. */
+    void reset();
+
+    /** Returns the number of bytes allocated since the last reset */
+    size_t getUsedSize() const { return _usedSize; }
+
+    /** Returns the number of bytes in the chunks */
+    size_t getCapacity() const { return _capacity; }
+
+protected:
+    template <typename T>
+    static void destroy(void* object)
+    {
+        static_cast<T*>(object)->~T();
+    }
+
+    void addChunk(size_t size);
+    void releaseChunks();
+
+    struct Chunk
+    {
+        unsigned char* data;
+        size_t size;
+    };
+
+    std::vector<Chunk> _chunks;
+    std::vector<std::pair<void*, void (*)(void*)>> _destructors;
+    size_t _chunkSize;
+    // chunk being filled and offset of its free memory
+    size_t _currentChunk;
+    size_t _offset;
+    size_t _usedSize;
+    size_t _capacity;
+};
+
+// end of renderer group
+/// @}
+
+NS_CC_END
+
+#endif //__CC_FRAME_ARENA_H__
@@ -326,10 +326,28 @@ void FrameBuffer::applyDefaultFBO()
 
 void FrameBuffer::clearAllFBOs()
 {
-    for (auto fbo : _frameBuffers)
+    if (_frameBuffers.empty())
+        return;
+
+    auto renderer = Director::getInstance()->getRenderer();
+    if (_frameBuffers.size() == 1 && _defaultFBO)
     {
-        fbo->clearFBO();
+        // the default one is the frame buffer of the view, which doesn't need to wait
+        auto fbo = _defaultFBO;
+        renderer->retainForFrame(fbo);
+        renderer->runOnRenderThread([fbo]() {
+            fbo->clearFBO();
+        });
+        return;
     }
+
+    // frame buffer objects aren't shared with the context of the main thread
+    renderer->runOnRenderThread([]() {
+        for (auto fbo : _frameBuffers)
+        {
+            fbo->clearFBO();
+        }
+    }, true);
 }
 
 FrameBuffer* FrameBuffer::create(uint8_t fid, unsigned int width, unsigned int height)
@@ -353,12 +371,15 @@ bool FrameBuffer::init(uint8_t fid, unsigned int width, unsigned int height)
     _width = width;
     _height = height;
     
-    GLint oldfbo;
-    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &oldfbo);
+    // set up by the render thread, see GL::genFramebuffers()
+    Director::getInstance()->getRenderer()->runOnRenderThread([this]() {
+        GLint oldfbo;
+        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &oldfbo);
 
-    glGenFramebuffers(1, &_fbo);
-    glBindFramebuffer(GL_FRAMEBUFFER, _fbo);
-    glBindFramebuffer(GL_FRAMEBUFFER, oldfbo);
+        glGenFramebuffers(1, &_fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, _fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, oldfbo);
+    }, true);
     
 //    _rt = RenderTarget::create(width, height);
 //    if(nullptr == _rt) return false;
@@ -403,7 +424,7 @@ FrameBuffer::~FrameBuffer()
     {
         CC_SAFE_RELEASE_NULL(_rt);
         CC_SAFE_RELEASE_NULL(_rtDepthStencil);
-        glDeleteFramebuffers(1, &_fbo);
+        GL::deleteFramebuffers(1, &_fbo);
         _fbo = 0;
         _frameBuffers.erase(this);
 #if CC_ENABLE_CACHE_TEXTURE_DATA
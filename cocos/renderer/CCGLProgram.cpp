@@ -36,6 +36,8 @@ THE SOFTWARE.
 #include "base/ccUTF8.h"
 #include "base/uthash.h"
 #include "renderer/ccGLStateCache.h"
+#include "renderer/CCProgramBinaryCache.h"
+#include "renderer/CCRenderer.h"
 #include "platform/CCFileUtils.h"
 
 // helper functions
@@ -81,6 +83,7 @@ const char* GLProgram::SHADER_NAME_ETC1AS_POSITION_TEXTURE_GRAY_NO_MVP = "#Shade
 
 const char* GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR = "ShaderPositionTextureColor";
 const char* GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_NO_MVP = "ShaderPositionTextureColor_noMVP";
+const char* GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_MULTI_TEXTURE_NO_MVP = "ShaderPositionTextureColorMultiTexture_noMVP";
 const char* GLProgram::SHADER_NAME_POSITION_TEXTURE_ALPHA_TEST = "ShaderPositionTextureColorAlphaTest";
 const char* GLProgram::SHADER_NAME_POSITION_TEXTURE_ALPHA_TEST_NO_MV = "ShaderPositionTextureColorAlphaTest_NoMV";
 const char* GLProgram::SHADER_NAME_POSITION_COLOR = "ShaderPositionColor";
@@ -100,6 +103,7 @@ const char* GLProgram::SHADER_NAME_LABEL_OUTLINE = "ShaderLabelOutline";
 
 const char* GLProgram::SHADER_3D_POSITION = "Shader3DPosition";
 const char* GLProgram::SHADER_3D_POSITION_TEXTURE = "Shader3DPositionTexture";
+const char* GLProgram::SHADER_3D_POSITION_TEXTURE_INSTANCED = "Shader3DPositionTextureInstanced";
 const char* GLProgram::SHADER_3D_SKINPOSITION_TEXTURE = "Shader3DSkinPositionTexture";
 const char* GLProgram::SHADER_3D_POSITION_NORMAL = "Shader3DPositionNormal";
 const char* GLProgram::SHADER_3D_POSITION_NORMAL_TEXTURE = "Shader3DPositionNormalTexture";
@@ -141,6 +145,9 @@ const char* GLProgram::ATTRIBUTE_NAME_BLEND_WEIGHT = "a_blendWeight";
 const char* GLProgram::ATTRIBUTE_NAME_BLEND_INDEX = "a_blendIndex";
 const char* GLProgram::ATTRIBUTE_NAME_TANGENT = "a_tangent";
 const char* GLProgram::ATTRIBUTE_NAME_BINORMAL = "a_binormal";
+const char* GLProgram::ATTRIBUTE_NAME_INSTANCE_MODELVIEW = "a_instanceModelView";
+const char* GLProgram::ATTRIBUTE_NAME_INSTANCE_COLOR = "a_instanceColor";
+const char* GLProgram::ATTRIBUTE_NAME_TEXTURE_INDEX = "a_textureIndex";
 
 
 
@@ -204,6 +211,8 @@ GLProgram::GLProgram()
 : _program(0)
 , _vertShader(0)
 , _fragShader(0)
+, _linkedFromBinary(false)
+, _uniformsVersion(0)
 , _flags()
 {
     _director = Director::getInstance();
@@ -227,6 +236,7 @@ GLProgram::~GLProgram()
         free(e.second.first);
     }
     _hashForUniforms.clear();
+    ++_uniformsVersion;
 }
 
 bool GLProgram::initWithByteArrays(const GLchar* vShaderByteArray, const GLchar* fShaderByteArray)
@@ -245,6 +255,24 @@ bool GLProgram::initWithByteArrays(const GLchar* vShaderByteArray, const GLchar*
     replaceDefines(compileTimeDefines, replacedDefines);
 
     _vertShader = _fragShader = 0;
+    _linkedFromBinary = false;
+    _binaryKey.clear();
+
+    auto binaryCache = ProgramBinaryCache::getInstance();
+    if (binaryCache->isEnabled())
+    {
+        _binaryKey = binaryCache->getKey(std::string(COCOS2D_SHADER_UNIFORMS) + replacedDefines
+                                         + (vShaderByteArray ? vShaderByteArray : "") + "\n"
+                                         + (fShaderByteArray ? fShaderByteArray : ""));
+        if (binaryCache->loadProgram(_program, _binaryKey))
+        {
+            // already linked, link() only has to parse the attributes and uniforms
+            _linkedFromBinary = true;
+            _hashForUniforms.clear();
+            ++_uniformsVersion;
+            return true;
+        }
+    }
 
     if (vShaderByteArray)
     {
@@ -277,6 +305,7 @@ bool GLProgram::initWithByteArrays(const GLchar* vShaderByteArray, const GLchar*
     }
 
     _hashForUniforms.clear();
+    ++_uniformsVersion;
 
     CHECK_GL_ERROR_DEBUG();
 
@@ -311,6 +340,7 @@ void GLProgram::bindPredefinedVertexAttribs()
         {GLProgram::ATTRIBUTE_NAME_TEX_COORD2, GLProgram::VERTEX_ATTRIB_TEX_COORD2},
         {GLProgram::ATTRIBUTE_NAME_TEX_COORD3, GLProgram::VERTEX_ATTRIB_TEX_COORD3},
         {GLProgram::ATTRIBUTE_NAME_NORMAL, GLProgram::VERTEX_ATTRIB_NORMAL},
+        {GLProgram::ATTRIBUTE_NAME_TEXTURE_INDEX, GLProgram::VERTEX_ATTRIB_TEXTURE_INDEX},
     };
 
     const int size = sizeof(attribute_locations) / sizeof(attribute_locations[0]);
@@ -561,16 +591,27 @@ bool GLProgram::link()
 
     GLint status = GL_TRUE;
 
-    bindPredefinedVertexAttribs();
+    if (!_linkedFromBinary)
+    {
+        bindPredefinedVertexAttribs();
+
+#if CC_USE_PROGRAM_BINARY_CACHE
+        // some drivers only keep a retrievable binary if they are told so before linking
+        if (!_binaryKey.empty() && glProgramParameteri)
+        {
+            glProgramParameteri(_program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        }
+#endif
 
-    glLinkProgram(_program);
+        glLinkProgram(_program);
 
-    // Calling glGetProgramiv(...GL_LINK_STATUS...) will force linking of the program at this moment.
-    // Otherwise, they might be linked when they are used for the first time. (I guess this depends on the driver implementation)
-    // So it might slow down the "booting" process on certain devices. But, on the other hand it is important to know if the shader
-    // linked successfully. Some shaders might be downloaded in runtime so, release version should have this check.
-    // For more info, see Github issue #16231
-    glGetProgramiv(_program, GL_LINK_STATUS, &status);
+        // Calling glGetProgramiv(...GL_LINK_STATUS...) will force linking of the program at this moment.
+        // Otherwise, they might be linked when they are used for the first time. (I guess this depends on the driver implementation)
+        // So it might slow down the "booting" process on certain devices. But, on the other hand it is important to know if the shader
+        // linked successfully. Some shaders might be downloaded in runtime so, release version should have this check.
+        // For more info, see Github issue #16231
+        glGetProgramiv(_program, GL_LINK_STATUS, &status);
+    }
 
     if (status == GL_FALSE)
     {
@@ -584,6 +625,11 @@ bool GLProgram::link()
         parseUniforms();
 
         clearShader();
+
+        if (!_linkedFromBinary && !_binaryKey.empty())
+        {
+            ProgramBinaryCache::getInstance()->saveProgram(_program, _binaryKey);
+        }
     }
 
     return (status == GL_TRUE);
@@ -678,6 +724,12 @@ bool GLProgram::updateUniformLocation(GLint location, const GLvoid* data, unsign
         }
     }
 
+    GL::countUniform(updated);
+    if (updated)
+    {
+        ++_uniformsVersion;
+    }
+
     return updated;
 }
 
@@ -882,7 +934,11 @@ void GLProgram::setUniformsForBuiltins()
 
 void GLProgram::setUniformsForBuiltins(const Mat4 &matrixMV)
 {
-    const auto& matrixP = _director->getMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_PROJECTION);
+    // built-in uniforms don't change the values set by GLProgramState
+    auto uniformsVersion = _uniformsVersion;
+
+    // the render thread may execute commands recorded with another projection than the one of the Director
+    const auto& matrixP = _director->getRenderer()->getProjectionMatrix();
 
     if (_flags.usesP)
         setUniformLocationWithMatrix4fv(_builtInUniforms[UNIFORM_P_MATRIX], matrixP.m, 1);
@@ -922,6 +978,8 @@ void GLProgram::setUniformsForBuiltins(const Mat4 &matrixMV)
 
     if (_flags.usesRandom)
         setUniformLocationWith4f(_builtInUniforms[GLProgram::UNIFORM_RANDOM01], CCRANDOM_0_1(), CCRANDOM_0_1(), CCRANDOM_0_1(), CCRANDOM_0_1());
+
+    _uniformsVersion = uniformsVersion;
 }
 
 void GLProgram::reset()
@@ -940,6 +998,7 @@ void GLProgram::reset()
     }
 
     _hashForUniforms.clear();
+    ++_uniformsVersion;
 }
 
 inline void GLProgram::clearShader()
@@ -118,6 +118,8 @@ public:
 
         // backward compatibility
         VERTEX_ATTRIB_TEX_COORDS = VERTEX_ATTRIB_TEX_COORD,
+        /**Texture unit sampled by a vertex of the multi texture batches, it shares the index of Tex coord unit 1.*/
+        VERTEX_ATTRIB_TEXTURE_INDEX = VERTEX_ATTRIB_TEX_COORD1,
     };
 
     /**Preallocated uniform handle.*/
@@ -179,6 +181,11 @@ public:
     static const char* SHADER_NAME_POSITION_TEXTURE_COLOR;
     /**Built in shader for 2d. Support Position, Texture and Color vertex attribute, but without multiply vertex by MVP matrix.*/
     static const char* SHADER_NAME_POSITION_TEXTURE_COLOR_NO_MVP;
+    /**Built in shader for 2d. Like SHADER_NAME_POSITION_TEXTURE_COLOR_NO_MVP, but every vertex samples one of
+    the textures bound to the first units, selected by a texture index vertex attribute.
+    Used by the Renderer to batch the sprites which only differ by their texture.
+    */
+    static const char* SHADER_NAME_POSITION_TEXTURE_COLOR_MULTI_TEXTURE_NO_MVP;
     /**Built in shader for 2d. Support Position, Texture vertex attribute, but include alpha test.*/
     static const char* SHADER_NAME_POSITION_TEXTURE_ALPHA_TEST;
     /**Built in shader for 2d. Support Position, Texture and Color vertex attribute, include alpha test and without multiply vertex by MVP matrix.*/
@@ -215,6 +222,11 @@ public:
     /**Built in shader used for 3D, support Position and Texture vertex attribute, with color specified by a uniform.*/
     static const char* SHADER_3D_POSITION_TEXTURE;
     /**
+    Built in shader used for 3D, support Position and Texture vertex attribute, with the model view matrix and
+    the color read from per instance attributes, used for instanced drawing.
+    */
+    static const char* SHADER_3D_POSITION_TEXTURE_INSTANCED;
+    /**
     Built in shader used for 3D, support Position (Skeletal animation by hardware skin) and Texture vertex attribute,
     with color specified by a uniform.
     */
@@ -332,6 +344,12 @@ public:
     static const char* ATTRIBUTE_NAME_TANGENT;
     /**Attribute blend binormal.*/
     static const char* ATTRIBUTE_NAME_BINORMAL;
+    /**Attribute model view matrix of an instance, a mat4 which takes four consecutive locations.*/
+    static const char* ATTRIBUTE_NAME_INSTANCE_MODELVIEW;
+    /**Attribute color of an instance.*/
+    static const char* ATTRIBUTE_NAME_INSTANCE_COLOR;
+    /**Attribute texture index, the texture unit a vertex samples.*/
+    static const char* ATTRIBUTE_NAME_TEXTURE_INDEX;
     /**
     end of Built Attribute names
     @}
@@ -536,6 +554,10 @@ protected:
     GLuint            _vertShader;
     /**OpenGL handle for fragment shader.*/
     GLuint            _fragShader;
+    /**Key of the program in the ProgramBinaryCache, empty if the cache is disabled.*/
+    std::string       _binaryKey;
+    /**Whether the program was loaded from its binary instead of being compiled.*/
+    bool              _linkedFromBinary;
     /**Built in uniforms.*/
     GLint             _builtInUniforms[UNIFORM_MAX];
     /**Indicate whether it has a offline shader compiler or not.*/
@@ -547,6 +569,8 @@ protected:
     std::unordered_map<std::string, VertexAttrib> _vertexAttribs;
     /**Hash value of uniforms for quick access.*/
     std::unordered_map<GLint, std::pair<GLvoid*, unsigned int>> _hashForUniforms;
+    /**Incremented when a user uniform is uploaded, so that GLProgramState knows if the program still has its values.*/
+    unsigned int _uniformsVersion;
     //cached director pointer for calling
     Director* _director;
 
@@ -28,18 +28,25 @@ THE SOFTWARE.
 #include "renderer/CCGLProgramCache.h"
 
 #include "renderer/CCGLProgram.h"
+#include "renderer/CCProgramBinaryCache.h"
+#include "renderer/CCRenderer.h"
+#include "renderer/ccGLStateCache.h"
 #include "renderer/ccShaders.h"
 #include "base/ccMacros.h"
 #include "base/CCConfiguration.h"
 #include "base/CCEventListenerCustom.h"
 #include "base/CCDirector.h"
 #include "base/CCEventDispatcher.h"
+#include "base/CCScheduler.h"
+#include "platform/CCFileUtils.h"
+#include "platform/CCGLView.h"
 
 NS_CC_BEGIN
 
 enum {
     kShaderType_PositionTextureColor,
     kShaderType_PositionTextureColor_noMVP,
+    kShaderType_PositionTextureColorMultiTexture_noMVP,
     kShaderType_PositionTextureColorAlphaTest,
     kShaderType_PositionTextureColorAlphaTestNoMV,
     kShaderType_PositionColor,
@@ -57,6 +64,7 @@ enum {
     kShaderType_LabelOutline,
     kShaderType_3DPosition,
     kShaderType_3DPositionTex,
+    kShaderType_3DPositionTexInstanced,
     kShaderType_3DSkinPositionTex,
     kShaderType_3DPositionNormal,
     kShaderType_3DPositionNormalTex,
@@ -78,6 +86,8 @@ enum {
 };
 
 static GLProgramCache *_sharedGLProgramCache = nullptr;
+static unsigned int s_precompileGenerations = 0;
+static const std::string PRECOMPILE_SCHEDULE_KEY = "GLProgramCache::precompileNextProgram";
 
 GLProgramCache* GLProgramCache::getInstance()
 {
@@ -110,12 +120,31 @@ void GLProgramCache::purgeSharedShaderCache()
 
 GLProgramCache::GLProgramCache()
 : _programs()
+, _precompileThread(nullptr)
+, _precompileIndex(0)
+, _precompileGeneration(0)
 {
 
 }
 
 GLProgramCache::~GLProgramCache()
 {
+    if (_precompileThread)
+    {
+        _precompileThread->join();
+        delete _precompileThread;
+        GL::setStateCacheThread(std::thread::id());
+    }
+    else if (_precompileGeneration)
+    {
+        Director::getInstance()->getScheduler()->unschedule(PRECOMPILE_SCHEDULE_KEY, this);
+    }
+
+    for (auto& entry : _precompiledPrograms)
+    {
+        CC_SAFE_RELEASE(entry.program);
+    }
+
     for( auto it = _programs.begin(); it != _programs.end(); ++it ) {
         (it->second)->release();
     }
@@ -125,6 +154,9 @@ GLProgramCache::~GLProgramCache()
 
 bool GLProgramCache::init()
 {
+    // created on the main thread, before any program
+    ProgramBinaryCache::getInstance();
+
     loadDefaultGLPrograms();
     
     auto listener = EventListenerCustom::create(Configuration::CONFIG_FILE_LOADED, [this](EventCustom* event){
@@ -138,340 +170,136 @@ bool GLProgramCache::init()
 
 void GLProgramCache::loadDefaultGLPrograms()
 {
+    // the programs are compiled when they are first used, see getGLProgram()
+
     // Position Texture Color shader
-    GLProgram *p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_PositionTextureColor);
-    _programs.insert( std::make_pair( GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR, p ) );
+    _defaultProgramTypes[GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR] = kShaderType_PositionTextureColor;
 
     // Position Texture Color without MVP shader
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_PositionTextureColor_noMVP);
-    _programs.insert( std::make_pair( GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_NO_MVP, p ) );
+    _defaultProgramTypes[GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_NO_MVP] = kShaderType_PositionTextureColor_noMVP;
+
+    // Position Texture Color without MVP shader, sampling several textures
+    _defaultProgramTypes[GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_MULTI_TEXTURE_NO_MVP] = kShaderType_PositionTextureColorMultiTexture_noMVP;
 
     // Position Texture Color alpha test
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_PositionTextureColorAlphaTest);
-    _programs.insert( std::make_pair(GLProgram::SHADER_NAME_POSITION_TEXTURE_ALPHA_TEST, p) );
+    _defaultProgramTypes[GLProgram::SHADER_NAME_POSITION_TEXTURE_ALPHA_TEST] = kShaderType_PositionTextureColorAlphaTest;
 
     // Position Texture Color alpha test
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_PositionTextureColorAlphaTestNoMV);
-    _programs.insert( std::make_pair(GLProgram::SHADER_NAME_POSITION_TEXTURE_ALPHA_TEST_NO_MV, p) );
+    _defaultProgramTypes[GLProgram::SHADER_NAME_POSITION_TEXTURE_ALPHA_TEST_NO_MV] = kShaderType_PositionTextureColorAlphaTestNoMV;
     //
     // Position, Color shader
     //
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_PositionColor);
-    _programs.insert( std::make_pair(GLProgram::SHADER_NAME_POSITION_COLOR, p) );
+    _defaultProgramTypes[GLProgram::SHADER_NAME_POSITION_COLOR] = kShaderType_PositionColor;
 
     // Position, Color, PointSize shader
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_PositionColorTextureAsPointsize);
-    _programs.insert( std::make_pair(GLProgram::SHADER_NAME_POSITION_COLOR_TEXASPOINTSIZE, p) );
+    _defaultProgramTypes[GLProgram::SHADER_NAME_POSITION_COLOR_TEXASPOINTSIZE] = kShaderType_PositionColorTextureAsPointsize;
 
     //
     // Position, Color shader no MVP
     //
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_PositionColor_noMVP);
-    _programs.insert( std::make_pair(GLProgram::SHADER_NAME_POSITION_COLOR_NO_MVP, p) );
+    _defaultProgramTypes[GLProgram::SHADER_NAME_POSITION_COLOR_NO_MVP] = kShaderType_PositionColor_noMVP;
 
     //
     // Position Texture shader
     //
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_PositionTexture);
-    _programs.insert( std::make_pair( GLProgram::SHADER_NAME_POSITION_TEXTURE, p) );
+    _defaultProgramTypes[GLProgram::SHADER_NAME_POSITION_TEXTURE] = kShaderType_PositionTexture;
 
     //
     // Position, Texture attribs, 1 Color as uniform shader
     //
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_PositionTexture_uColor);
-    _programs.insert( std::make_pair( GLProgram::SHADER_NAME_POSITION_TEXTURE_U_COLOR, p) );
+    _defaultProgramTypes[GLProgram::SHADER_NAME_POSITION_TEXTURE_U_COLOR] = kShaderType_PositionTexture_uColor;
 
     //
     // Position Texture A8 Color shader
     //
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_PositionTextureA8Color);
-    _programs.insert( std::make_pair(GLProgram::SHADER_NAME_POSITION_TEXTURE_A8_COLOR, p) );
+    _defaultProgramTypes[GLProgram::SHADER_NAME_POSITION_TEXTURE_A8_COLOR] = kShaderType_PositionTextureA8Color;
 
     //
     // Position and 1 color passed as a uniform (to simulate glColor4ub )
     //
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_Position_uColor);
-    _programs.insert( std::make_pair(GLProgram::SHADER_NAME_POSITION_U_COLOR, p) );
+    _defaultProgramTypes[GLProgram::SHADER_NAME_POSITION_U_COLOR] = kShaderType_Position_uColor;
 
     //
     // Position, Length(TexCoords, Color (used by Draw Node basically )
     //
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_PositionLengthTextureColor);
-    _programs.insert( std::make_pair(GLProgram::SHADER_NAME_POSITION_LENGTH_TEXTURE_COLOR, p) );
+    _defaultProgramTypes[GLProgram::SHADER_NAME_POSITION_LENGTH_TEXTURE_COLOR] = kShaderType_PositionLengthTextureColor;
+
+    _defaultProgramTypes[GLProgram::SHADER_NAME_LABEL_DISTANCEFIELD_NORMAL] = kShaderType_LabelDistanceFieldNormal;
 
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_LabelDistanceFieldNormal);
-    _programs.insert( std::make_pair(GLProgram::SHADER_NAME_LABEL_DISTANCEFIELD_NORMAL, p) );
+    _defaultProgramTypes[GLProgram::SHADER_NAME_LABEL_DISTANCEFIELD_GLOW] = kShaderType_LabelDistanceFieldGlow;
 
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_LabelDistanceFieldGlow);
-    _programs.insert( std::make_pair(GLProgram::SHADER_NAME_LABEL_DISTANCEFIELD_GLOW, p) );
+    _defaultProgramTypes[GLProgram::SHADER_NAME_POSITION_GRAYSCALE] = kShaderType_UIGrayScale;
 
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_UIGrayScale);
-    _programs.insert(std::make_pair(GLProgram::SHADER_NAME_POSITION_GRAYSCALE, p));
+    _defaultProgramTypes[GLProgram::SHADER_NAME_LABEL_NORMAL] = kShaderType_LabelNormal;
 
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_LabelNormal);
-    _programs.insert( std::make_pair(GLProgram::SHADER_NAME_LABEL_NORMAL, p) );
+    _defaultProgramTypes[GLProgram::SHADER_NAME_LABEL_OUTLINE] = kShaderType_LabelOutline;
 
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_LabelOutline);
-    _programs.insert( std::make_pair(GLProgram::SHADER_NAME_LABEL_OUTLINE, p) );
+    _defaultProgramTypes[GLProgram::SHADER_3D_POSITION] = kShaderType_3DPosition;
 
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_3DPosition);
-    _programs.insert( std::make_pair(GLProgram::SHADER_3D_POSITION, p) );
+    _defaultProgramTypes[GLProgram::SHADER_3D_POSITION_TEXTURE] = kShaderType_3DPositionTex;
 
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_3DPositionTex);
-    _programs.insert( std::make_pair(GLProgram::SHADER_3D_POSITION_TEXTURE, p) );
+    _defaultProgramTypes[GLProgram::SHADER_3D_POSITION_TEXTURE_INSTANCED] = kShaderType_3DPositionTexInstanced;
 
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_3DSkinPositionTex);
-    _programs.insert(std::make_pair(GLProgram::SHADER_3D_SKINPOSITION_TEXTURE, p));
+    _defaultProgramTypes[GLProgram::SHADER_3D_SKINPOSITION_TEXTURE] = kShaderType_3DSkinPositionTex;
 
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_3DPositionNormal);
-    _programs.insert( std::make_pair(GLProgram::SHADER_3D_POSITION_NORMAL, p) );
+    _defaultProgramTypes[GLProgram::SHADER_3D_POSITION_NORMAL] = kShaderType_3DPositionNormal;
 
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_3DPositionNormalTex);
-    _programs.insert( std::make_pair(GLProgram::SHADER_3D_POSITION_NORMAL_TEXTURE, p) );
+    _defaultProgramTypes[GLProgram::SHADER_3D_POSITION_NORMAL_TEXTURE] = kShaderType_3DPositionNormalTex;
 
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_3DSkinPositionNormalTex);
-    _programs.insert(std::make_pair(GLProgram::SHADER_3D_SKINPOSITION_NORMAL_TEXTURE, p));
+    _defaultProgramTypes[GLProgram::SHADER_3D_SKINPOSITION_NORMAL_TEXTURE] = kShaderType_3DSkinPositionNormalTex;
 
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_3DPositionBumpedNormalTex);
-    _programs.insert(std::make_pair(GLProgram::SHADER_3D_POSITION_BUMPEDNORMAL_TEXTURE, p));
+    _defaultProgramTypes[GLProgram::SHADER_3D_POSITION_BUMPEDNORMAL_TEXTURE] = kShaderType_3DPositionBumpedNormalTex;
 
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_3DSkinPositionBumpedNormalTex);
-    _programs.insert(std::make_pair(GLProgram::SHADER_3D_SKINPOSITION_BUMPEDNORMAL_TEXTURE, p));
+    _defaultProgramTypes[GLProgram::SHADER_3D_SKINPOSITION_BUMPEDNORMAL_TEXTURE] = kShaderType_3DSkinPositionBumpedNormalTex;
 
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_3DParticleColor);
-    _programs.insert(std::make_pair(GLProgram::SHADER_3D_PARTICLE_COLOR, p));
+    _defaultProgramTypes[GLProgram::SHADER_3D_PARTICLE_COLOR] = kShaderType_3DParticleColor;
 
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_3DParticleTex);
-    _programs.insert(std::make_pair(GLProgram::SHADER_3D_PARTICLE_TEXTURE, p));
+    _defaultProgramTypes[GLProgram::SHADER_3D_PARTICLE_TEXTURE] = kShaderType_3DParticleTex;
 
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_3DSkyBox);
-    _programs.insert(std::make_pair(GLProgram::SHADER_3D_SKYBOX, p));
+    _defaultProgramTypes[GLProgram::SHADER_3D_SKYBOX] = kShaderType_3DSkyBox;
 
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_3DTerrain);
-    _programs.insert(std::make_pair(GLProgram::SHADER_3D_TERRAIN, p));
+    _defaultProgramTypes[GLProgram::SHADER_3D_TERRAIN] = kShaderType_3DTerrain;
     
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_CameraClear);
-    _programs.insert(std::make_pair(GLProgram::SHADER_CAMERA_CLEAR, p));
+    _defaultProgramTypes[GLProgram::SHADER_CAMERA_CLEAR] = kShaderType_CameraClear;
 
     /// ETC1 ALPHA supports.
-    p = new(std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_ETC1ASPositionTextureColor);
-    _programs.insert(std::make_pair(GLProgram::SHADER_NAME_ETC1AS_POSITION_TEXTURE_COLOR, p));
+    _defaultProgramTypes[GLProgram::SHADER_NAME_ETC1AS_POSITION_TEXTURE_COLOR] = kShaderType_ETC1ASPositionTextureColor;
 
-    p = new(std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_ETC1ASPositionTextureColor_noMVP);
-    _programs.insert(std::make_pair(GLProgram::SHADER_NAME_ETC1AS_POSITION_TEXTURE_COLOR_NO_MVP, p));
+    _defaultProgramTypes[GLProgram::SHADER_NAME_ETC1AS_POSITION_TEXTURE_COLOR_NO_MVP] = kShaderType_ETC1ASPositionTextureColor_noMVP;
 
     /// ETC1 Gray supports.
-    p = new(std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_ETC1ASPositionTextureGray);
-    _programs.insert(std::make_pair(GLProgram::SHADER_NAME_ETC1AS_POSITION_TEXTURE_GRAY, p));
+    _defaultProgramTypes[GLProgram::SHADER_NAME_ETC1AS_POSITION_TEXTURE_GRAY] = kShaderType_ETC1ASPositionTextureGray;
 
-    p = new(std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_ETC1ASPositionTextureGray_noMVP);
-    _programs.insert(std::make_pair(GLProgram::SHADER_NAME_ETC1AS_POSITION_TEXTURE_GRAY_NO_MVP, p));
+    _defaultProgramTypes[GLProgram::SHADER_NAME_ETC1AS_POSITION_TEXTURE_GRAY_NO_MVP] = kShaderType_ETC1ASPositionTextureGray_noMVP;
 }
 
 void GLProgramCache::reloadDefaultGLPrograms()
 {
-    // reset all programs and reload them
-
-    // Position Texture Color shader
-    GLProgram *p = getGLProgram(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_PositionTextureColor);
-
-    // Position Texture Color without MVP shader
-    p = getGLProgram(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_NO_MVP);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_PositionTextureColor_noMVP);
-
-    // Position Texture Color alpha test
-    p = getGLProgram(GLProgram::SHADER_NAME_POSITION_TEXTURE_ALPHA_TEST);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_PositionTextureColorAlphaTest);
-
-    // Position Texture Color alpha test
-    p = getGLProgram(GLProgram::SHADER_NAME_POSITION_TEXTURE_ALPHA_TEST_NO_MV);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_PositionTextureColorAlphaTestNoMV);
-    //
-    // Position, Color shader
-    //
-    p = getGLProgram(GLProgram::SHADER_NAME_POSITION_COLOR);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_PositionColor);
-
-    // Position, Color, PointSize shader
-    p = getGLProgram(GLProgram::SHADER_NAME_POSITION_COLOR_TEXASPOINTSIZE);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_PositionColorTextureAsPointsize);
-
-    //
-    // Position, Color shader no MVP
-    //
-    p = getGLProgram(GLProgram::SHADER_NAME_POSITION_COLOR_NO_MVP);
-    loadDefaultGLProgram(p, kShaderType_PositionColor_noMVP);
-
-    //
-    // Position Texture shader
-    //
-    p = getGLProgram(GLProgram::SHADER_NAME_POSITION_TEXTURE);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_PositionTexture);
-
-    //
-    // Position, Texture attribs, 1 Color as uniform shader
-    //
-    p = getGLProgram(GLProgram::SHADER_NAME_POSITION_TEXTURE_U_COLOR);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_PositionTexture_uColor);
-
-    //
-    // Position Texture A8 Color shader
-    //
-    p = getGLProgram(GLProgram::SHADER_NAME_POSITION_TEXTURE_A8_COLOR);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_PositionTextureA8Color);
-
-    //
-    // Position and 1 color passed as a uniform (to simulate glColor4ub )
-    //
-    p = getGLProgram(GLProgram::SHADER_NAME_POSITION_U_COLOR);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_Position_uColor);
-
-    //
-    // Position, Length(TexCoords, Color (used by Draw Node basically )
-    //
-    p = getGLProgram(GLProgram::SHADER_NAME_POSITION_LENGTH_TEXTURE_COLOR);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_PositionLengthTextureColor);
-
-    p = getGLProgram(GLProgram::SHADER_NAME_LABEL_DISTANCEFIELD_NORMAL);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_LabelDistanceFieldNormal);
-
-    p = getGLProgram(GLProgram::SHADER_NAME_LABEL_DISTANCEFIELD_GLOW);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_LabelDistanceFieldGlow);
-
-    p = getGLProgram(GLProgram::SHADER_NAME_POSITION_GRAYSCALE);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_UIGrayScale);
-
-    p = getGLProgram(GLProgram::SHADER_NAME_LABEL_NORMAL);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_LabelNormal);
-
-    p = getGLProgram(GLProgram::SHADER_NAME_LABEL_OUTLINE);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_LabelOutline);
-
-    p = getGLProgram(GLProgram::SHADER_3D_POSITION);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_3DPosition);
-
-    p = getGLProgram(GLProgram::SHADER_3D_POSITION_TEXTURE);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_3DPositionTex);
-
-    p = getGLProgram(GLProgram::SHADER_3D_SKINPOSITION_TEXTURE);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_3DSkinPositionTex);
-
-    p = getGLProgram(GLProgram::SHADER_3D_POSITION_NORMAL);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_3DPositionNormal);
-
-    p = getGLProgram(GLProgram::SHADER_3D_POSITION_NORMAL_TEXTURE);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_3DPositionNormalTex);
-
-    p = getGLProgram(GLProgram::SHADER_3D_SKINPOSITION_NORMAL_TEXTURE);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_3DSkinPositionNormalTex);
-
-    p = getGLProgram(GLProgram::SHADER_3D_POSITION_BUMPEDNORMAL_TEXTURE);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_3DPositionBumpedNormalTex);
-
-    p = getGLProgram(GLProgram::SHADER_3D_SKINPOSITION_BUMPEDNORMAL_TEXTURE);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_3DSkinPositionBumpedNormalTex);
-
-    p = getGLProgram(GLProgram::SHADER_3D_PARTICLE_TEXTURE);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_3DParticleTex);
-
-    p = getGLProgram(GLProgram::SHADER_3D_PARTICLE_COLOR);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_3DParticleColor);
-
-    p = getGLProgram(GLProgram::SHADER_3D_SKYBOX);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_3DSkyBox);
-
-    p = getGLProgram(GLProgram::SHADER_3D_TERRAIN);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_3DTerrain);
-    
-    p = getGLProgram(GLProgram::SHADER_CAMERA_CLEAR);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_CameraClear);
+    // reset the programs already compiled and reload them
+    for (const auto& defaultProgram : _defaultProgramTypes)
+    {
+        reloadDefaultGLProgram(defaultProgram.first, defaultProgram.second);
+    }
 }
 
 void GLProgramCache::reloadDefaultGLProgramsRelativeToLights()
 {
-    GLProgram *p = getGLProgram(GLProgram::SHADER_3D_POSITION_NORMAL);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_3DPositionNormal);
-    
-    p = getGLProgram(GLProgram::SHADER_3D_POSITION_NORMAL_TEXTURE);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_3DPositionNormalTex);
-    
-    p = getGLProgram(GLProgram::SHADER_3D_SKINPOSITION_NORMAL_TEXTURE);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_3DSkinPositionNormalTex);
+    reloadDefaultGLProgram(GLProgram::SHADER_3D_POSITION_NORMAL, kShaderType_3DPositionNormal);
+    reloadDefaultGLProgram(GLProgram::SHADER_3D_POSITION_NORMAL_TEXTURE, kShaderType_3DPositionNormalTex);
+    reloadDefaultGLProgram(GLProgram::SHADER_3D_SKINPOSITION_NORMAL_TEXTURE, kShaderType_3DSkinPositionNormalTex);
+    reloadDefaultGLProgram(GLProgram::SHADER_3D_POSITION_BUMPEDNORMAL_TEXTURE, kShaderType_3DPositionBumpedNormalTex);
+    reloadDefaultGLProgram(GLProgram::SHADER_3D_SKINPOSITION_BUMPEDNORMAL_TEXTURE, kShaderType_3DSkinPositionBumpedNormalTex);
+}
 
-    p = getGLProgram(GLProgram::SHADER_3D_POSITION_BUMPEDNORMAL_TEXTURE);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_3DPositionBumpedNormalTex);
+void GLProgramCache::reloadDefaultGLProgram(const std::string& key, int type)
+{
+    // the programs not used yet are compiled with the current settings when they are
+    auto it = _programs.find(key);
+    if (it == _programs.end())
+        return;
 
-    p = getGLProgram(GLProgram::SHADER_3D_SKINPOSITION_BUMPEDNORMAL_TEXTURE);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_3DSkinPositionBumpedNormalTex);
+    it->second->reset();
+    loadDefaultGLProgram(it->second, type);
 }
 
 void GLProgramCache::loadDefaultGLProgram(GLProgram *p, int type)
@@ -483,6 +311,9 @@ void GLProgramCache::loadDefaultGLProgram(GLProgram *p, int type)
         case kShaderType_PositionTextureColor_noMVP:
             p->initWithByteArrays(ccPositionTextureColor_noMVP_vert, ccPositionTextureColor_noMVP_frag);
             break;
+        case kShaderType_PositionTextureColorMultiTexture_noMVP:
+            p->initWithByteArrays(ccPositionTextureColorMultiTexture_noMVP_vert, ccPositionTextureColorMultiTexture_noMVP_frag);
+            break;
         case kShaderType_PositionTextureColorAlphaTest:
             p->initWithByteArrays(ccPositionTextureColor_vert, ccPositionTextureColorAlphaTest_frag);
             break;
@@ -536,6 +367,9 @@ void GLProgramCache::loadDefaultGLProgram(GLProgram *p, int type)
         case kShaderType_3DPositionTex:
             p->initWithByteArrays(cc3D_PositionTex_vert, cc3D_ColorTex_frag);
             break;
+        case kShaderType_3DPositionTexInstanced:
+            p->initWithByteArrays(cc3D_PositionTexInstanced_vert, cc3D_ColorTexInstanced_frag);
+            break;
         case kShaderType_3DSkinPositionTex:
             p->initWithByteArrays(cc3D_SkinPositionTex_vert, cc3D_ColorTex_frag);
             break;
@@ -610,6 +444,15 @@ void GLProgramCache::loadDefaultGLProgram(GLProgram *p, int type)
     p->link();
     p->updateUniforms();
 
+    if (type == kShaderType_PositionTextureColorMultiTexture_noMVP)
+    {
+        // CC_Texture0 to CC_Texture3 are bound to their units by updateUniforms()
+        p->setUniformLocationWith1i(p->getUniformLocation("u_texture4"), 4);
+        p->setUniformLocationWith1i(p->getUniformLocation("u_texture5"), 5);
+        p->setUniformLocationWith1i(p->getUniformLocation("u_texture6"), 6);
+        p->setUniformLocationWith1i(p->getUniformLocation("u_texture7"), 7);
+    }
+
     CHECK_GL_ERROR_DEBUG();
 }
 
@@ -618,18 +461,216 @@ GLProgram* GLProgramCache::getGLProgram(const std::string &key)
     auto it = _programs.find(key);
     if( it != _programs.end() )
         return it->second;
+
+    // default programs are compiled when first used
+    auto typeIt = _defaultProgramTypes.find(key);
+    if (typeIt != _defaultProgramTypes.end())
+    {
+        GLProgram *p = new (std::nothrow) GLProgram();
+        loadDefaultGLProgram(p, typeIt->second);
+        _programs.insert(std::make_pair(key, p));
+        return p;
+    }
     return nullptr;
 }
 
-void GLProgramCache::addGLProgram(GLProgram* program, const std::string &key)
+void GLProgramCache::precompileGLProgramsAsync(const std::string& manifestFilename, const std::function<void()>& callback)
+{
+    precompileGLProgramsAsync(FileUtils::getInstance()->getValueVectorFromFile(manifestFilename), callback);
+}
+
+void GLProgramCache::precompileGLProgramsAsync(const ValueVector& manifest, const std::function<void()>& callback)
+{
+    waitForPrecompiledGLPrograms();
+
+    auto fileUtils = FileUtils::getInstance();
+    for (const auto& value : manifest)
+    {
+        PrecompiledProgram entry;
+        entry.type = -1;
+        entry.program = nullptr;
+
+        if (value.getType() == Value::Type::STRING)
+        {
+            entry.key = value.asString();
+            auto typeIt = _defaultProgramTypes.find(entry.key);
+            if (typeIt == _defaultProgramTypes.end())
+            {
+                CCLOG("cocos2d: GLProgramCache: unknown default program %s", entry.key.c_str());
+                continue;
+            }
+            entry.type = typeIt->second;
+        }
+        else if (value.getType() == Value::Type::MAP)
+        {
+            const auto& map = value.asValueMap();
+            auto vertexIt = map.find("vertex");
+            auto fragmentIt = map.find("fragment");
+            auto definesIt = map.find("defines");
+            if (vertexIt == map.end() || fragmentIt == map.end())
+            {
+                CCLOG("cocos2d: GLProgramCache: a program of the manifest has no vertex or fragment shader");
+                continue;
+            }
+
+            // same key as GLProgramState::getOrCreateWithShaders()
+            const std::string& vertexFilename = vertexIt->second.asString();
+            const std::string& fragmentFilename = fragmentIt->second.asString();
+            entry.defines = definesIt != map.end() ? definesIt->second.asString() : "";
+            entry.key = vertexFilename + "+" + fragmentFilename + "+" + entry.defines;
+
+            // read here, FileUtils isn't thread safe
+            entry.vertexSource = fileUtils->getStringFromFile(fileUtils->fullPathForFilename(vertexFilename));
+            entry.fragmentSource = fileUtils->getStringFromFile(fileUtils->fullPathForFilename(fragmentFilename));
+        }
+        else
+        {
+            CCLOG("cocos2d: GLProgramCache: invalid program in the manifest");
+            continue;
+        }
+
+        if (_programs.find(entry.key) == _programs.end())
+        {
+            _precompiledPrograms.push_back(entry);
+        }
+    }
+
+    _precompileCallback = callback;
+    _precompileIndex = 0;
+    _precompileGeneration = ++s_precompileGenerations;
+
+    auto director = Director::getInstance();
+    auto glview = director->getOpenGLView();
+    if (_precompiledPrograms.empty())
+    {
+        finishPrecompile();
+    }
+    else if (glview && !director->getRenderer()->isPipelineEnabled() && glview->createSharedContext())
+    {
+        // the state cache is only used by the main thread while the thread compiles
+        GL::setStateCacheThread(std::this_thread::get_id());
+
+        const unsigned int generation = _precompileGeneration;
+        _precompileThread = new (std::nothrow) std::thread([this, glview, generation]() {
+            glview->makeContextCurrent(true);
+            for (auto& entry : _precompiledPrograms)
+            {
+                compileProgram(entry);
+            }
+            // the programs have to be complete before the context of the view uses them
+            glFinish();
+            glview->releaseCurrentContext();
+
+            Director::getInstance()->getScheduler()->performFunctionInCocosThread([generation]() {
+                if (_sharedGLProgramCache && _sharedGLProgramCache->_precompileGeneration == generation)
+                {
+                    _sharedGLProgramCache->finishPrecompile();
+                }
+            });
+        });
+    }
+    else
+    {
+        director->getScheduler()->schedule(CC_CALLBACK_1(GLProgramCache::precompileNextProgram, this), this, 0, false, PRECOMPILE_SCHEDULE_KEY);
+    }
+}
+
+void GLProgramCache::waitForPrecompiledGLPrograms()
 {
-    // release old one
-    auto prev = getGLProgram(key);
-    if( prev == program )
+    if (!_precompileGeneration)
         return;
 
-    _programs.erase(key);
-    CC_SAFE_RELEASE_NULL(prev);
+    if (!_precompileThread)
+    {
+        for (; _precompileIndex < _precompiledPrograms.size(); ++_precompileIndex)
+        {
+            compileProgram(_precompiledPrograms[_precompileIndex]);
+        }
+    }
+    finishPrecompile();
+}
+
+void GLProgramCache::compileProgram(PrecompiledProgram& entry)
+{
+    GLProgram *p = new (std::nothrow) GLProgram();
+    if (entry.type >= 0)
+    {
+        loadDefaultGLProgram(p, entry.type);
+    }
+    else if (p->initWithByteArrays(entry.vertexSource.c_str(), entry.fragmentSource.c_str(), entry.defines))
+    {
+        p->link();
+        p->updateUniforms();
+    }
+    else
+    {
+        CCLOG("cocos2d: GLProgramCache: couldn't compile %s", entry.key.c_str());
+        CC_SAFE_RELEASE_NULL(p);
+    }
+    entry.program = p;
+}
+
+void GLProgramCache::precompileNextProgram(float /*dt*/)
+{
+    if (_precompileIndex < _precompiledPrograms.size())
+    {
+        compileProgram(_precompiledPrograms[_precompileIndex++]);
+    }
+
+    if (_precompileIndex == _precompiledPrograms.size())
+    {
+        finishPrecompile();
+    }
+}
+
+void GLProgramCache::finishPrecompile()
+{
+    if (_precompileThread)
+    {
+        _precompileThread->join();
+        CC_SAFE_DELETE(_precompileThread);
+        GL::setStateCacheThread(std::thread::id());
+    }
+    else if (!_precompiledPrograms.empty())
+    {
+        Director::getInstance()->getScheduler()->unschedule(PRECOMPILE_SCHEDULE_KEY, this);
+    }
+
+    for (auto& entry : _precompiledPrograms)
+    {
+        if (!entry.program)
+            continue;
+
+        // the programs which failed to link, or were compiled on the main thread meanwhile, are dropped
+        if (entry.program->getProgram() != 0 && _programs.find(entry.key) == _programs.end())
+        {
+            addGLProgram(entry.program, entry.key);
+        }
+        entry.program->release();
+    }
+    _precompiledPrograms.clear();
+    _precompileGeneration = 0;
+
+    auto callback = _precompileCallback;
+    _precompileCallback = nullptr;
+    if (callback)
+    {
+        callback();
+    }
+}
+
+void GLProgramCache::addGLProgram(GLProgram* program, const std::string &key)
+{
+    // release old one, without compiling the default program of the key
+    auto it = _programs.find(key);
+    if (it != _programs.end())
+    {
+        if (it->second == program)
+            return;
+
+        CC_SAFE_RELEASE(it->second);
+        _programs.erase(it);
+    }
 
     if (program)
         program->retain();
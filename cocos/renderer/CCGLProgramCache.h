@@ -28,10 +28,14 @@ THE SOFTWARE.
 #ifndef __CCGLPROGRAMCACHE_H__
 #define __CCGLPROGRAMCACHE_H__
 
+#include <functional>
 #include <string>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
 #include "base/CCRef.h"
+#include "base/CCValue.h"
 
 /**
  * @addtogroup renderer
@@ -73,7 +77,7 @@ public:
     /** @deprecated Use destroyInstance() instead */
     CC_DEPRECATED_ATTRIBUTE static void purgeSharedShaderCache();
 
-    /** loads the default shaders */
+    /** registers the default shaders, they are compiled when getGLProgram() first returns them */
     void loadDefaultGLPrograms();
     CC_DEPRECATED_ATTRIBUTE void loadDefaultShaders() { loadDefaultGLPrograms(); }
 
@@ -94,6 +98,32 @@ public:
     /** reload default programs these are relative to light */
     void reloadDefaultGLProgramsRelativeToLights();
 
+    /** Compiles programs in the background, so that they are ready when they are first used.
+     *
+     * The manifest lists the names of default programs, like GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR,
+     * and dictionaries with the "vertex" and "fragment" filenames and the optional "defines" of the programs
+     * created by GLProgramState::getOrCreateWithShaders().
+     *
+     * A thread compiles them with the shared context of the view, see GLView::createSharedContext(). When the view
+     * can't share its context, or while the Renderer is pipelined, one program is compiled per frame instead.
+     * The programs compiled before are loaded from the ProgramBinaryCache.
+     *
+     * @param manifest The programs to compile. The ones already in the cache are skipped.
+     * @param callback Called on the main thread once the programs were added to the cache.
+     * @since v3.13
+     */
+    void precompileGLProgramsAsync(const ValueVector& manifest, const std::function<void()>& callback = nullptr);
+
+    /** Compiles in the background the programs listed in a plist file holding an array, see above.
+     * @since v3.13
+     */
+    void precompileGLProgramsAsync(const std::string& manifestFilename, const std::function<void()>& callback = nullptr);
+
+    /** Blocks until the programs being precompiled are added to the cache.
+     * @since v3.13
+     */
+    void waitForPrecompiledGLPrograms();
+
 private:
     /**
     @{
@@ -101,15 +131,41 @@ private:
     */
     bool init();
     void loadDefaultGLProgram(GLProgram *program, int type);
+    void reloadDefaultGLProgram(const std::string& key, int type);
     /**
     @}
     */
 
+    /** A program of the manifest given to precompileGLProgramsAsync() */
+    struct PrecompiledProgram
+    {
+        std::string key;
+        // type of a default program, or -1
+        int type;
+        std::string vertexSource;
+        std::string fragmentSource;
+        std::string defines;
+        GLProgram* program;
+    };
+    void compileProgram(PrecompiledProgram& entry);
+    void precompileNextProgram(float dt);
+    void finishPrecompile();
+
     /**Get macro define for lights in current openGL driver.*/
     std::string getShaderMacrosForLight() const;
 
     /**Predefined shaders.*/
     std::unordered_map<std::string, GLProgram*> _programs;
+    /**Types of the default programs, by name.*/
+    std::unordered_map<std::string, int> _defaultProgramTypes;
+
+    std::vector<PrecompiledProgram> _precompiledPrograms;
+    std::function<void()> _precompileCallback;
+    // compiles the programs with the shared context, or nullptr if they are compiled one per frame
+    std::thread* _precompileThread;
+    size_t _precompileIndex;
+    // identifies the precompilation in progress, 0 if there is none
+    unsigned int _precompileGeneration;
 };
 
 NS_CC_END
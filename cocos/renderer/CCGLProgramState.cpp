@@ -28,6 +28,8 @@ THE SOFTWARE.
 
 #include "renderer/CCGLProgramState.h"
 
+#include <algorithm>
+
 #include "renderer/CCGLProgram.h"
 #include "renderer/CCGLProgramStateCache.h"
 #include "renderer/CCGLProgramCache.h"
@@ -374,6 +376,9 @@ GLProgramState* GLProgramState::getOrCreateWithShaders(const std::string& vertex
 
 GLProgramState::GLProgramState()
 : _uniformAttributeValueDirty(true)
+, _uniformsDirtyBegin(0)
+, _uniformsDirtyEnd(0)
+, _uniformsVersion(0)
 , _textureUnitIndex(4)  // first 4 textures unites are reserved for CC_Texture0-3
 , _vertexAttribsFlags(0)
 , _glprogram(nullptr)
@@ -415,8 +420,12 @@ GLProgramState* GLProgramState::clone() const
 
     // copy uniforms
     glprogramstate->_uniformsByName = this->_uniformsByName;
+    glprogramstate->_uniformsByLocation = this->_uniformsByLocation;
     glprogramstate->_uniforms = this->_uniforms;
     glprogramstate->_uniformAttributeValueDirty = this->_uniformAttributeValueDirty;
+    // the clone never applied its uniforms
+    glprogramstate->_uniformsDirtyBegin = 0;
+    glprogramstate->_uniformsDirtyEnd = (int)this->_uniforms.size();
 
     // copy textures
     glprogramstate->_textureUnitIndex = this->_textureUnitIndex;
@@ -445,12 +454,27 @@ bool GLProgramState::init(GLProgram* glprogram)
         _attributes[attrib.first] = value;
     }
 
+    // pack the uniforms by location, so that they are applied in the same order by all the states of a program
+    std::vector<Uniform*> uniforms;
+    uniforms.reserve(_glprogram->_userUniforms.size());
     for(auto &uniform : _glprogram->_userUniforms) {
-        UniformValue value(&uniform.second, _glprogram);
-        _uniforms[uniform.second.location] = value;
-        _uniformsByName[uniform.first] = uniform.second.location;
+        uniforms.push_back(&uniform.second);
+    }
+    std::sort(uniforms.begin(), uniforms.end(), [](const Uniform* a, const Uniform* b) {
+        return a->location < b->location;
+    });
+
+    _uniforms.reserve(uniforms.size());
+    for(auto uniform : uniforms) {
+        int index = (int)_uniforms.size();
+        _uniforms.push_back(UniformValue(uniform, _glprogram));
+        _uniformsByName[uniform->name] = index;
+        _uniformsByLocation[uniform->location] = index;
     }
 
+    _uniformsDirtyBegin = 0;
+    _uniformsDirtyEnd = (int)_uniforms.size();
+
     return true;
 }
 
@@ -459,6 +483,9 @@ void GLProgramState::resetGLProgram()
     CC_SAFE_RELEASE(_glprogram);
     _glprogram = nullptr;
     _uniforms.clear();
+    _uniformsByName.clear();
+    _uniformsByLocation.clear();
+    _uniformsDirtyBegin = _uniformsDirtyEnd = 0;
     _attributes.clear();
     // first texture is GL_TEXTURE1
     _textureUnitIndex = 1;
@@ -479,10 +506,16 @@ void GLProgramState::updateUniformsAndAttributes()
     CCASSERT(_glprogram, "invalid glprogram");
     if(_uniformAttributeValueDirty)
     {
-        for(auto& uniformLocation : _uniformsByName)
+        // the program may have been relinked with other locations
+        _uniformsByLocation.clear();
+        for(auto& uniformIndex : _uniformsByName)
         {
-            _uniforms[uniformLocation.second]._uniform = _glprogram->getUniform(uniformLocation.first);
+            auto& value = _uniforms[uniformIndex.second];
+            value._uniform = _glprogram->getUniform(uniformIndex.first);
+            _uniformsByLocation[value._uniform->location] = uniformIndex.second;
         }
+        _uniformsDirtyBegin = 0;
+        _uniformsDirtyEnd = (int)_uniforms.size();
         
         _vertexAttribsFlags = 0;
         for(auto& attributeValue : _attributes)
@@ -526,9 +559,30 @@ void GLProgramState::applyUniforms()
 {
     // set uniforms
     updateUniformsAndAttributes();
-    for(auto& uniform : _uniforms) {
-        uniform.second.apply();
+
+    // another state uploaded its uniforms to the program since, upload all of them
+    if (_uniformsVersion != _glprogram->_uniformsVersion)
+    {
+        _uniformsDirtyBegin = 0;
+        _uniformsDirtyEnd = (int)_uniforms.size();
     }
+
+    const int count = (int)_uniforms.size();
+    for (int i = 0; i < count; ++i)
+    {
+        auto& uniform = _uniforms[i];
+        // values pointed to may have changed and textures need to be bound again,
+        // other values are only uploaded if they were set
+        bool dirty = (i >= _uniformsDirtyBegin && i < _uniformsDirtyEnd)
+            || uniform._type != UniformValue::Type::VALUE
+            || uniform._uniform->type == GL_SAMPLER_2D
+            || uniform._uniform->type == GL_SAMPLER_CUBE;
+        if (dirty)
+            uniform.apply();
+    }
+
+    _uniformsDirtyBegin = _uniformsDirtyEnd = 0;
+    _uniformsVersion = _glprogram->_uniformsVersion;
 }
 
 void GLProgramState::setGLProgram(GLProgram *glprogram)
@@ -551,12 +605,29 @@ ssize_t GLProgramState::getVertexAttribCount() const
     return _attributes.size();
 }
 
+void GLProgramState::markUniformDirty(int index)
+{
+    if (_uniformsDirtyBegin == _uniformsDirtyEnd)
+    {
+        _uniformsDirtyBegin = index;
+        _uniformsDirtyEnd = index + 1;
+    }
+    else
+    {
+        _uniformsDirtyBegin = std::min(_uniformsDirtyBegin, index);
+        _uniformsDirtyEnd = std::max(_uniformsDirtyEnd, index + 1);
+    }
+}
+
 UniformValue* GLProgramState::getUniformValue(GLint uniformLocation)
 {
     updateUniformsAndAttributes();
-    const auto itr = _uniforms.find(uniformLocation);
-    if (itr != _uniforms.end())
-        return &itr->second;
+    const auto itr = _uniformsByLocation.find(uniformLocation);
+    if (itr != _uniformsByLocation.end())
+    {
+        markUniformDirty(itr->second);
+        return &_uniforms[itr->second];
+    }
     return nullptr;
 }
 
@@ -565,10 +636,41 @@ UniformValue* GLProgramState::getUniformValue(const std::string& name)
     updateUniformsAndAttributes();
     const auto itr = _uniformsByName.find(name);
     if (itr != _uniformsByName.end())
+    {
+        markUniformDirty(itr->second);
         return &_uniforms[itr->second];
+    }
     return nullptr;
 }
 
+UniformValue* GLProgramState::getUniformValue(const UniformHandle& handle)
+{
+    updateUniformsAndAttributes();
+    if (handle.index >= 0 && handle.index < (int)_uniforms.size())
+    {
+        markUniformDirty(handle.index);
+        return &_uniforms[handle.index];
+    }
+    return nullptr;
+}
+
+UniformHandle GLProgramState::getUniformHandle(const std::string& uniformName)
+{
+    const auto itr = _uniformsByName.find(uniformName);
+    if (itr != _uniformsByName.end())
+        return UniformHandle(itr->second);
+    return UniformHandle();
+}
+
+UniformHandle GLProgramState::getUniformHandle(GLint uniformLocation)
+{
+    updateUniformsAndAttributes();
+    const auto itr = _uniformsByLocation.find(uniformLocation);
+    if (itr != _uniformsByLocation.end())
+        return UniformHandle(itr->second);
+    return UniformHandle();
+}
+
 VertexAttribValue* GLProgramState::getVertexAttribValue(const std::string& name)
 {
     updateUniformsAndAttributes();
@@ -825,44 +927,150 @@ void GLProgramState::setUniformTexture(const std::string& uniformName, GLuint te
 {
     auto v = getUniformValue(uniformName);
     if (v)
-    {
-        if (_boundTextureUnits.find(uniformName) != _boundTextureUnits.end())
-        {
-            v->setTexture(textureId, _boundTextureUnits[uniformName]);
-        }
-        else
-        {
-            v->setTexture(textureId, _textureUnitIndex);
-            _boundTextureUnits[uniformName] = _textureUnitIndex++;
-        }
-    }
+        setUniformTexture(v, textureId);
     else
-    {
         CCLOG("cocos2d: warning: Uniform not found: %s", uniformName.c_str());
-    }
 }
 
 void GLProgramState::setUniformTexture(GLint uniformLocation, GLuint textureId)
 {
     auto v = getUniformValue(uniformLocation);
     if (v)
+        setUniformTexture(v, textureId);
+    else
+        CCLOG("cocos2d: warning: Uniform at location not found: %i", uniformLocation);
+}
+
+void GLProgramState::setUniformTexture(UniformValue* v, GLuint textureId)
+{
+    auto itr = _boundTextureUnits.find(v->_uniform->name);
+    if (itr != _boundTextureUnits.end())
     {
-        if (_boundTextureUnits.find(v->_uniform->name) != _boundTextureUnits.end())
-        {
-            v->setTexture(textureId, _boundTextureUnits[v->_uniform->name]);
-        }
-        else
-        {
-            v->setTexture(textureId, _textureUnitIndex);
-            _boundTextureUnits[v->_uniform->name] = _textureUnitIndex++;
-        }
+        v->setTexture(textureId, itr->second);
     }
     else
     {
-        CCLOG("cocos2d: warning: Uniform at location not found: %i", uniformLocation);
+        v->setTexture(textureId, _textureUnitIndex);
+        _boundTextureUnits[v->_uniform->name] = _textureUnitIndex++;
     }
 }
 
+// Uniform Setters by handle
+
+void GLProgramState::setUniformInt(const UniformHandle& handle, int value)
+{
+    auto v = getUniformValue(handle);
+    if (v)
+        v->setInt(value);
+    else
+        CCLOG("cocos2d: warning: Uniform handle not valid: %d", handle.index);
+}
+
+void GLProgramState::setUniformFloat(const UniformHandle& handle, float value)
+{
+    auto v = getUniformValue(handle);
+    if (v)
+        v->setFloat(value);
+    else
+        CCLOG("cocos2d: warning: Uniform handle not valid: %d", handle.index);
+}
+
+void GLProgramState::setUniformFloatv(const UniformHandle& handle, ssize_t size, const float* pointer)
+{
+    auto v = getUniformValue(handle);
+    if (v)
+        v->setFloatv(size, pointer);
+    else
+        CCLOG("cocos2d: warning: Uniform handle not valid: %d", handle.index);
+}
+
+void GLProgramState::setUniformVec2(const UniformHandle& handle, const Vec2& value)
+{
+    auto v = getUniformValue(handle);
+    if (v)
+        v->setVec2(value);
+    else
+        CCLOG("cocos2d: warning: Uniform handle not valid: %d", handle.index);
+}
+
+void GLProgramState::setUniformVec2v(const UniformHandle& handle, ssize_t size, const Vec2* pointer)
+{
+    auto v = getUniformValue(handle);
+    if (v)
+        v->setVec2v(size, pointer);
+    else
+        CCLOG("cocos2d: warning: Uniform handle not valid: %d", handle.index);
+}
+
+void GLProgramState::setUniformVec3(const UniformHandle& handle, const Vec3& value)
+{
+    auto v = getUniformValue(handle);
+    if (v)
+        v->setVec3(value);
+    else
+        CCLOG("cocos2d: warning: Uniform handle not valid: %d", handle.index);
+}
+
+void GLProgramState::setUniformVec3v(const UniformHandle& handle, ssize_t size, const Vec3* pointer)
+{
+    auto v = getUniformValue(handle);
+    if (v)
+        v->setVec3v(size, pointer);
+    else
+        CCLOG("cocos2d: warning: Uniform handle not valid: %d", handle.index);
+}
+
+void GLProgramState::setUniformVec4(const UniformHandle& handle, const Vec4& value)
+{
+    auto v = getUniformValue(handle);
+    if (v)
+        v->setVec4(value);
+    else
+        CCLOG("cocos2d: warning: Uniform handle not valid: %d", handle.index);
+}
+
+void GLProgramState::setUniformVec4v(const UniformHandle& handle, ssize_t size, const Vec4* pointer)
+{
+    auto v = getUniformValue(handle);
+    if (v)
+        v->setVec4v(size, pointer);
+    else
+        CCLOG("cocos2d: warning: Uniform handle not valid: %d", handle.index);
+}
+
+void GLProgramState::setUniformMat4(const UniformHandle& handle, const Mat4& value)
+{
+    auto v = getUniformValue(handle);
+    if (v)
+        v->setMat4(value);
+    else
+        CCLOG("cocos2d: warning: Uniform handle not valid: %d", handle.index);
+}
+
+void GLProgramState::setUniformCallback(const UniformHandle& handle, const std::function<void(GLProgram*, Uniform*)> &callback)
+{
+    auto v = getUniformValue(handle);
+    if (v)
+        v->setCallback(callback);
+    else
+        CCLOG("cocos2d: warning: Uniform handle not valid: %d", handle.index);
+}
+
+void GLProgramState::setUniformTexture(const UniformHandle& handle, Texture2D *texture)
+{
+    CCASSERT(texture, "Invalid texture");
+    setUniformTexture(handle, texture->getName());
+}
+
+void GLProgramState::setUniformTexture(const UniformHandle& handle, GLuint textureId)
+{
+    auto v = getUniformValue(handle);
+    if (v)
+        setUniformTexture(v, textureId);
+    else
+        CCLOG("cocos2d: warning: Uniform handle not valid: %d", handle.index);
+}
+
 // Auto bindings
 void GLProgramState::setParameterAutoBinding(const std::string& uniformName, const std::string& autoBinding)
 {
@@ -28,6 +28,7 @@ THE SOFTWARE.
 #define __CCGLPROGRAMSTATE_H__
 
 #include <unordered_map>
+#include <vector>
 
 #include "base/ccTypes.h"
 #include "base/CCVector.h"
@@ -232,6 +233,24 @@ protected:
 };
 
 
+/**
+ * @brief UniformHandle is the position of a user defined uniform in the packed uniforms of a GLProgramState.
+ * It is resolved once with GLProgramState::getUniformHandle(), so that the uniform can be set every frame
+ * without looking it up by name. It stays valid until the GLProgram of the GLProgramState changes.
+ * @since v3.13
+ */
+struct CC_DLL UniformHandle
+{
+    UniformHandle() : index(-1) {}
+    explicit UniformHandle(int uniformIndex) : index(uniformIndex) {}
+
+    /** Returns false if the uniform wasn't found. */
+    bool isValid() const { return index >= 0; }
+
+    /** Index of the uniform in the packed uniforms */
+    int index;
+};
+
 /**
  GLProgramState holds the 'state' (uniforms and attributes) of the GLProgram.
  A GLProgram can be used by thousands of Nodes, but if different uniform values 
@@ -338,6 +357,33 @@ public:
     void setUniformTexture(GLint uniformLocation, GLuint textureId);
     /**@}*/
 
+    /**
+     Returns the handle of a user defined uniform, or an invalid handle if the GLProgram doesn't have it.
+     Setting a uniform by handle doesn't hash its name every time, use it for the uniforms set every frame.
+     @since v3.13
+     */
+    UniformHandle getUniformHandle(const std::string& uniformName);
+    UniformHandle getUniformHandle(GLint uniformLocation);
+
+    /** @{
+     Setting user defined uniforms by the handle returned by getUniformHandle().
+     @since v3.13
+     */
+    void setUniformInt(const UniformHandle& handle, int value);
+    void setUniformFloat(const UniformHandle& handle, float value);
+    void setUniformFloatv(const UniformHandle& handle, ssize_t size, const float* pointer);
+    void setUniformVec2(const UniformHandle& handle, const Vec2& value);
+    void setUniformVec2v(const UniformHandle& handle, ssize_t size, const Vec2* pointer);
+    void setUniformVec3(const UniformHandle& handle, const Vec3& value);
+    void setUniformVec3v(const UniformHandle& handle, ssize_t size, const Vec3* pointer);
+    void setUniformVec4(const UniformHandle& handle, const Vec4& value);
+    void setUniformVec4v(const UniformHandle& handle, ssize_t size, const Vec4* pointer);
+    void setUniformMat4(const UniformHandle& handle, const Mat4& value);
+    void setUniformCallback(const UniformHandle& handle, const std::function<void(GLProgram*, Uniform*)> &callback);
+    void setUniformTexture(const UniformHandle& handle, Texture2D *texture);
+    void setUniformTexture(const UniformHandle& handle, GLuint textureId);
+    /**@}*/
+
     /** 
      * Returns the Node bound to the GLProgramState
      */
@@ -445,13 +491,23 @@ protected:
     void resetGLProgram();
     void updateUniformsAndAttributes();
     VertexAttribValue* getVertexAttribValue(const std::string& attributeName);
+    // the uniform values returned are marked as dirty, they are only used to be set
     UniformValue* getUniformValue(const std::string& uniformName);
     UniformValue* getUniformValue(GLint uniformLocation);
+    UniformValue* getUniformValue(const UniformHandle& handle);
+    void setUniformTexture(UniformValue* value, GLuint textureId);
+    void markUniformDirty(int index);
 
 
     bool _uniformAttributeValueDirty;
-    std::unordered_map<std::string, GLint> _uniformsByName;
-    std::unordered_map<GLint, UniformValue> _uniforms;
+    // user uniforms packed by location, with the range set since they were last applied
+    std::vector<UniformValue> _uniforms;
+    std::unordered_map<std::string, int> _uniformsByName;
+    std::unordered_map<GLint, int> _uniformsByLocation;
+    int _uniformsDirtyBegin;
+    int _uniformsDirtyEnd;
+    // GLProgram::_uniformsVersion when the uniforms were last applied
+    unsigned int _uniformsVersion;
     std::unordered_map<std::string, VertexAttribValue> _attributes;
     std::unordered_map<std::string, int> _boundTextureUnits;
 
@@ -54,6 +54,9 @@ MeshCommand::MeshCommand()
 , _vao(0)
 , _material(nullptr)
 , _stateBlock(nullptr)
+, _instanced(false)
+, _instanceKey(0)
+, _instanceColor(1.0f, 1.0f, 1.0f, 1.0f)
 {
     _type = RenderCommand::Type::MESH_COMMAND;
 
@@ -89,6 +92,9 @@ void MeshCommand::init(float globalZOrder,
     _mv.set(mv);
 
     _is3D = true;
+
+    if (_instanced)
+        genInstanceKey();
 }
 
 void MeshCommand::init(float globalZOrder,
@@ -125,6 +131,8 @@ void MeshCommand::init(float globalZOrder,
     
     _is3D = true;
 
+    if (_instanced)
+        genInstanceKey();
 }
 
 
@@ -185,6 +193,138 @@ uint32_t MeshCommand::getMaterialID() const
     return _materialID;
 }
 
+void MeshCommand::genInstanceKey()
+{
+    GLProgram* glProgram = nullptr;
+    GLuint textureID = _textureID;
+    uint32_t stateHash = 0;
+    ssize_t passCount = 1;
+
+    if (_material)
+    {
+        auto& passes = _material->_currentTechnique->_passes;
+        auto pass = passes.at(0);
+        glProgram = pass->getGLProgramState()->getGLProgram();
+        textureID = pass->getTexture() ? pass->getTexture()->getName() : 0;
+        stateHash = _material->getStateBlock()->getHash() ^ pass->getStateBlock()->getHash();
+        passCount = passes.size();
+    }
+    else
+    {
+        glProgram = _glProgramState->getGLProgram();
+        stateHash = _stateBlock->getHash();
+    }
+
+    uint32_t key[7];
+    key[0] = (uint32_t)_vertexBuffer;
+    key[1] = (uint32_t)_indexBuffer;
+    key[2] = (uint32_t)_primitive;
+    key[3] = (uint32_t)_indexCount;
+    key[4] = (uint32_t)textureID;
+    key[5] = stateHash;
+    key[6] = (uint32_t)passCount;
+    // the program pointer may be 64 bits wide, it seeds the hash of the other fields
+    const uint32_t programHash = XXH32((const void*)&glProgram, sizeof(glProgram), 0);
+    _instanceKey = XXH32((const void*)key, sizeof(key), programHash);
+}
+
+void MeshCommand::getInstanceData(InstanceData* data) const
+{
+    data->modelView = _mv;
+    data->color = _instanceColor;
+}
+
+void MeshCommand::applyInstanceAttributes(GLProgram* glProgram)
+{
+    auto modelView = glProgram->getVertexAttrib(GLProgram::ATTRIBUTE_NAME_INSTANCE_MODELVIEW);
+    if (modelView)
+    {
+        // a mat4 attribute takes one location per column
+        for (GLuint i = 0; i < 4; ++i)
+            glVertexAttrib4fv(modelView->index + i, &_mv.m[i * 4]);
+    }
+
+    auto color = glProgram->getVertexAttrib(GLProgram::ATTRIBUTE_NAME_INSTANCE_COLOR);
+    if (color)
+        glVertexAttrib4fv(color->index, &_instanceColor.x);
+}
+
+void MeshCommand::drawInstances(GLProgram* glProgram, GLuint instanceBuffer, ssize_t instanceCount)
+{
+#if CC_USE_INSTANCING
+    auto modelView = glProgram->getVertexAttrib(GLProgram::ATTRIBUTE_NAME_INSTANCE_MODELVIEW);
+    auto color = glProgram->getVertexAttrib(GLProgram::ATTRIBUTE_NAME_INSTANCE_COLOR);
+    CCASSERT(modelView, "Instanced programs must read the a_instanceModelView attribute");
+
+    const GLsizei stride = sizeof(InstanceData);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    for (GLuint i = 0; i < 4; ++i)
+    {
+        glEnableVertexAttribArray(modelView->index + i);
+        glVertexAttribPointer(modelView->index + i, 4, GL_FLOAT, GL_FALSE, stride, (GLvoid*)(offsetof(InstanceData, modelView) + sizeof(GLfloat) * 4 * i));
+        glVertexAttribDivisor(modelView->index + i, 1);
+    }
+    if (color)
+    {
+        glEnableVertexAttribArray(color->index);
+        glVertexAttribPointer(color->index, 4, GL_FLOAT, GL_FALSE, stride, (GLvoid*)offsetof(InstanceData, color));
+        glVertexAttribDivisor(color->index, 1);
+    }
+
+    glDrawElementsInstanced(_primitive, (GLsizei)_indexCount, _indexFormat, 0, (GLsizei)instanceCount);
+    CC_INCREMENT_GL_DRAWN_BATCHES_AND_VERTICES(1, _indexCount * instanceCount);
+
+    // restore the attributes, GL::enableVertexAttribs() doesn't know about them
+    for (GLuint i = 0; i < 4; ++i)
+    {
+        glVertexAttribDivisor(modelView->index + i, 0);
+        glDisableVertexAttribArray(modelView->index + i);
+    }
+    if (color)
+    {
+        glVertexAttribDivisor(color->index, 0);
+        glDisableVertexAttribArray(color->index);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, _vertexBuffer);
+#else
+    CC_UNUSED_PARAM(glProgram);
+    CC_UNUSED_PARAM(instanceBuffer);
+    CC_UNUSED_PARAM(instanceCount);
+    CCASSERT(false, "Instanced drawing is disabled, see CC_USE_INSTANCING");
+#endif
+}
+
+void MeshCommand::drawInstanced(GLuint instanceBuffer, ssize_t instanceCount)
+{
+    CCASSERT(_instanced, "Only instanced commands can be drawn with instancing");
+
+    glBindBuffer(GL_ARRAY_BUFFER, _vertexBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _indexBuffer);
+
+    if (_material)
+    {
+        for(const auto& pass: _material->_currentTechnique->_passes)
+        {
+            pass->bind(_mv, true);
+
+            drawInstances(pass->getGLProgramState()->getGLProgram(), instanceBuffer, instanceCount);
+
+            pass->unbind();
+        }
+    }
+    else
+    {
+        _glProgramState->apply(_mv);
+
+        applyRenderState();
+
+        drawInstances(_glProgramState->getGLProgram(), instanceBuffer, instanceCount);
+    }
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
 void MeshCommand::preBatchDraw()
 {
     // Do nothing if using material since each pass needs to bind its own VAO
@@ -217,6 +357,8 @@ void MeshCommand::batchDraw()
         for(const auto& pass: _material->_currentTechnique->_passes)
         {
             pass->bind(_mv);
+            if (_instanced)
+                applyInstanceAttributes(pass->getGLProgramState()->getGLProgram());
 
             glDrawElements(_primitive, (GLsizei)_indexCount, _indexFormat, 0);
             CC_INCREMENT_GL_DRAWN_BATCHES_AND_VERTICES(1, _indexCount);
@@ -227,6 +369,8 @@ void MeshCommand::batchDraw()
     else
     {
         _glProgramState->applyGLProgram(_mv);
+        if (_instanced)
+            applyInstanceAttributes(_glProgramState->getGLProgram());
 
         // set render state
         applyRenderState();
@@ -268,6 +412,8 @@ void MeshCommand::execute()
         for(const auto& pass: _material->_currentTechnique->_passes)
         {
             pass->bind(_mv, true);
+            if (_instanced)
+                applyInstanceAttributes(pass->getGLProgramState()->getGLProgram());
 
             glDrawElements(_primitive, (GLsizei)_indexCount, _indexFormat, 0);
             CC_INCREMENT_GL_DRAWN_BATCHES_AND_VERTICES(1, _indexCount);
@@ -279,6 +425,8 @@ void MeshCommand::execute()
     {
         // set render state
         _glProgramState->apply(_mv);
+        if (_instanced)
+            applyInstanceAttributes(_glProgramState->getGLProgram());
 
         applyRenderState();
 
@@ -322,9 +470,8 @@ void MeshCommand::releaseVAO()
 {
     if (_vao)
     {
-        glDeleteVertexArrays(1, &_vao);
+        GL::deleteVertexArrays(1, &_vao);
         _vao = 0;
-        GL::bindVAO(0);
     }
 }
 
@@ -42,6 +42,13 @@ class Material;
 class CC_DLL MeshCommand : public RenderCommand
 {
 public:
+    /** The per instance data read by instanced programs, laid out as the instance attributes */
+    struct InstanceData
+    {
+        Mat4 modelView;
+        Vec4 color;
+    };
+
 
     MeshCommand();
     virtual ~MeshCommand();
@@ -55,6 +62,23 @@ public:
     void setMatrixPaletteSize(int size);
     void setLightMask(unsigned int lightmask);
 
+    /**
+     Marks the command as instanced: its programs read the model view matrix and the color from the
+     `a_instanceModelView` and `a_instanceColor` attributes instead of uniforms.
+     Consecutive instanced commands with the same instance key are drawn by the Renderer with a single
+     instanced draw call if the GPU supports it, which assumes that they only differ by those attributes.
+     */
+    void setInstanced(bool instanced) { _instanced = instanced; }
+    bool isInstanced() const { return _instanced; }
+    /** Sets the color passed in the `a_instanceColor` attribute */
+    void setInstanceColor(const Vec4& color) { _instanceColor = color; }
+    /** Returns the key shared by the instanced commands that can be drawn together. Valid after init() */
+    uint32_t getInstanceKey() const { return _instanceKey; }
+    /** Fills the data of this instance */
+    void getInstanceData(InstanceData* data) const;
+    /** Draws `instanceCount` instances of the mesh, reading the instance data from `instanceBuffer` */
+    void drawInstanced(GLuint instanceBuffer, ssize_t instanceCount);
+
     void execute();
     
     //used for batch
@@ -78,6 +102,13 @@ protected:
     // apply renderstate, not used when using material
     void applyRenderState();
 
+    // hashes everything that instanced commands must share to be drawn together
+    void genInstanceKey();
+    // sets the instance attributes as constant values when drawing a single instance
+    void applyInstanceAttributes(GLProgram* glProgram);
+    // draws the instances with the program already bound
+    void drawInstances(GLProgram* glProgram, GLuint instanceBuffer, ssize_t instanceCount);
+
 
     Vec4 _displayColor; // in order to support tint and fade in fade out
     
@@ -95,6 +126,10 @@ protected:
     GLenum _indexFormat;
     ssize_t _indexCount;
     
+    bool _instanced;
+    uint32_t _instanceKey;
+    Vec4 _instanceColor;
+
     // States, default value all false
 
 
@@ -0,0 +1,359 @@
+/****************************************************************************
+ Copyright (c) 2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "renderer/CCOcclusionCuller.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#include "2d/CCCamera.h"
+#include "2d/CCNode.h"
+#include "base/ccMacros.h"
+
+NS_CC_BEGIN
+
+// the 12 triangles of a box, indexing the corners returned by AABB::getCorners()
+static const unsigned char s_boxIndices[36] = {
+    0, 1, 2,  0, 2, 3,     // front
+    4, 5, 6,  4, 6, 7,     // back
+    0, 3, 4,  0, 4, 7,     // top
+    1, 2, 5,  1, 5, 6,     // bottom
+    0, 1, 6,  0, 6, 7,     // left
+    3, 2, 5,  3, 5, 4,     // right
+};
+
+static bool isPowerOfTwo(int value)
+{
+    return value > 0 && (value & (value - 1)) == 0;
+}
+
+OcclusionCuller::OcclusionCuller()
+: _width(0)
+, _height(0)
+, _enabled(true)
+, _ready(false)
+, _culledCount(0)
+{
+    setResolution(DEFAULT_WIDTH, DEFAULT_HEIGHT);
+}
+
+OcclusionCuller::~OcclusionCuller()
+{
+}
+
+void OcclusionCuller::setEnabled(bool enabled)
+{
+    _enabled = enabled;
+    _ready = _ready && enabled;
+}
+
+void OcclusionCuller::setResolution(int width, int height)
+{
+    CCASSERT(isPowerOfTwo(width) && isPowerOfTwo(height), "The resolution must be powers of two");
+
+    _width = width;
+    _height = height;
+    _ready = false;
+
+    _levels.clear();
+    while (true)
+    {
+        _levels.push_back(std::vector<float>(width * height, 1.0f));
+        if (width == 1 && height == 1)
+            break;
+        width = std::max(width / 2, 1);
+        height = std::max(height / 2, 1);
+    }
+}
+
+void OcclusionCuller::addOccluder(Node* node, const AABB& localBounds)
+{
+    CCASSERT(node, "Invalid occluder");
+
+    for (auto& occluder : _occluders)
+    {
+        if (occluder.node == node)
+        {
+            occluder.bounds = localBounds;
+            return;
+        }
+    }
+
+    Occluder occluder;
+    occluder.node = node;
+    occluder.bounds = localBounds;
+    _occluders.push_back(occluder);
+}
+
+void OcclusionCuller::removeOccluder(Node* node)
+{
+    _occluders.erase(std::remove_if(_occluders.begin(), _occluders.end(), [node](const Occluder& occluder) {
+        return occluder.node == node;
+    }), _occluders.end());
+}
+
+void OcclusionCuller::prepare(const Camera* camera)
+{
+    _ready = false;
+    _culledCount = 0;
+    if (!_enabled || _occluders.empty() || !camera)
+        return;
+
+    _viewProjection = camera->getViewProjectionMatrix();
+    auto& depth = _levels[0];
+    std::fill(depth.begin(), depth.end(), 1.0f);
+
+    const unsigned short cameraFlag = (unsigned short)camera->getCameraFlag();
+    bool rasterized = false;
+    for (const auto& occluder : _occluders)
+    {
+        Node* node = occluder.node;
+        if (!node->isRunning() || !(node->getCameraMask() & cameraFlag) || occluder.bounds.isEmpty())
+            continue;
+
+        bool visible = true;
+        for (Node* parent = node; parent && visible; parent = parent->getParent())
+            visible = parent->isVisible();
+        if (!visible)
+            continue;
+
+        rasterizeBox(occluder.bounds, _viewProjection * node->getNodeToWorldTransform());
+        rasterized = true;
+    }
+
+    if (rasterized)
+    {
+        buildHierarchy();
+        _ready = true;
+    }
+}
+
+void OcclusionCuller::reset()
+{
+    _ready = false;
+    _viewProjection = Mat4::IDENTITY;
+}
+
+OcclusionCuller::ScreenVertex OcclusionCuller::toScreen(const Vec4& clip) const
+{
+    ScreenVertex vertex;
+    const float invW = 1.0f / clip.w;
+    vertex.x = (clip.x * invW * 0.5f + 0.5f) * _width;
+    vertex.y = (clip.y * invW * 0.5f + 0.5f) * _height;
+    vertex.depth = clampf(clip.z * invW * 0.5f + 0.5f, 0.0f, 1.0f);
+    return vertex;
+}
+
+void OcclusionCuller::rasterizeBox(const AABB& bounds, const Mat4& modelViewProjection)
+{
+    Vec3 corners[8];
+    bounds.getCorners(corners);
+
+    Vec4 clip[8];
+    for (int i = 0; i < 8; ++i)
+    {
+        modelViewProjection.transformVector(Vec4(corners[i].x, corners[i].y, corners[i].z, 1.0f), &clip[i]);
+    }
+
+    for (int t = 0; t < 36; t += 3)
+    {
+        // clip the triangle by the near plane, where z == -w
+        Vec4 polygon[4];
+        int count = 0;
+        for (int i = 0; i < 3; ++i)
+        {
+            const Vec4& a = clip[s_boxIndices[t + i]];
+            const Vec4& b = clip[s_boxIndices[t + (i + 1) % 3]];
+            const float da = a.z + a.w;
+            const float db = b.z + b.w;
+
+            if (da >= 0)
+                polygon[count++] = a;
+            if ((da >= 0) != (db >= 0))
+            {
+                const float s = da / (da - db);
+                polygon[count++] = a + (b - a) * s;
+            }
+        }
+
+        if (count < 3)
+            continue;
+
+        const ScreenVertex first = toScreen(polygon[0]);
+        for (int i = 1; i + 1 < count; ++i)
+        {
+            rasterizeTriangle(first, toScreen(polygon[i]), toScreen(polygon[i + 1]));
+        }
+    }
+}
+
+void OcclusionCuller::rasterizeTriangle(const ScreenVertex& v0, const ScreenVertex& v1, const ScreenVertex& v2)
+{
+    float area = (v1.x - v0.x) * (v2.y - v0.y) - (v2.x - v0.x) * (v1.y - v0.y);
+    if (std::fabs(area) < 1e-6f)
+        return;
+
+    // both windings are rasterized, the nearest depth is kept
+    const ScreenVertex& a = v0;
+    const ScreenVertex& b = area > 0 ? v1 : v2;
+    const ScreenVertex& c = area > 0 ? v2 : v1;
+    area = std::fabs(area);
+
+    const int minX = std::max(0, (int)std::floor(std::min(std::min(a.x, b.x), c.x)));
+    const int maxX = std::min(_width - 1, (int)std::ceil(std::max(std::max(a.x, b.x), c.x)));
+    const int minY = std::max(0, (int)std::floor(std::min(std::min(a.y, b.y), c.y)));
+    const int maxY = std::min(_height - 1, (int)std::ceil(std::max(std::max(a.y, b.y), c.y)));
+    if (minX > maxX || minY > maxY)
+        return;
+
+    // The buffer must never be nearer than the occluders, or it would cull what they don't hide: only the texels
+    // fully inside the triangle are written, with the farthest depth of the triangle over them.
+    // Each edge function is linear, so its minimum over a texel is its value at the center minus
+    // half a texel times the sum of its absolute gradients, and the same goes for the maximum of the depth.
+    const float margin0 = 0.5f * (std::fabs(b.y - c.y) + std::fabs(c.x - b.x));
+    const float margin1 = 0.5f * (std::fabs(c.y - a.y) + std::fabs(a.x - c.x));
+    const float margin2 = 0.5f * (std::fabs(a.y - b.y) + std::fabs(b.x - a.x));
+
+    const float invArea = 1.0f / area;
+    const float depthDx = ((b.y - c.y) * a.depth + (c.y - a.y) * b.depth + (a.y - b.y) * c.depth) * invArea;
+    const float depthDy = ((c.x - b.x) * a.depth + (a.x - c.x) * b.depth + (b.x - a.x) * c.depth) * invArea;
+    const float depthMargin = 0.5f * (std::fabs(depthDx) + std::fabs(depthDy));
+
+    auto& depth = _levels[0];
+    for (int y = minY; y <= maxY; ++y)
+    {
+        const float py = y + 0.5f;
+        for (int x = minX; x <= maxX; ++x)
+        {
+            const float px = x + 0.5f;
+            const float w0 = (b.x - px) * (c.y - py) - (c.x - px) * (b.y - py);
+            const float w1 = (c.x - px) * (a.y - py) - (a.x - px) * (c.y - py);
+            const float w2 = (a.x - px) * (b.y - py) - (b.x - px) * (a.y - py);
+            if (w0 < margin0 || w1 < margin1 || w2 < margin2)
+                continue;
+
+            // the depth is affine in screen space after the perspective divide
+            const float z = (w0 * a.depth + w1 * b.depth + w2 * c.depth) * invArea + depthMargin;
+            float& texel = depth[y * _width + x];
+            texel = std::min(texel, z);
+        }
+    }
+}
+
+void OcclusionCuller::buildHierarchy()
+{
+    int width = _width;
+    int height = _height;
+    for (size_t level = 1; level < _levels.size(); ++level)
+    {
+        const auto& src = _levels[level - 1];
+        auto& dst = _levels[level];
+        const int dstWidth = std::max(width / 2, 1);
+        const int dstHeight = std::max(height / 2, 1);
+
+        for (int y = 0; y < dstHeight; ++y)
+        {
+            const int y0 = std::min(y * 2, height - 1);
+            const int y1 = std::min(y * 2 + 1, height - 1);
+            for (int x = 0; x < dstWidth; ++x)
+            {
+                const int x0 = std::min(x * 2, width - 1);
+                const int x1 = std::min(x * 2 + 1, width - 1);
+                dst[y * dstWidth + x] = std::max(std::max(src[y0 * width + x0], src[y0 * width + x1]),
+                                                 std::max(src[y1 * width + x0], src[y1 * width + x1]));
+            }
+        }
+
+        width = dstWidth;
+        height = dstHeight;
+    }
+}
+
+bool OcclusionCuller::isOccluded(const AABB& worldBounds) const
+{
+    if (!_ready || worldBounds.isEmpty())
+        return false;
+
+    Vec3 corners[8];
+    worldBounds.getCorners(corners);
+
+    float minX = FLT_MAX;
+    float minY = FLT_MAX;
+    float maxX = -FLT_MAX;
+    float maxY = -FLT_MAX;
+    float nearest = FLT_MAX;
+    for (int i = 0; i < 8; ++i)
+    {
+        Vec4 clip;
+        _viewProjection.transformVector(Vec4(corners[i].x, corners[i].y, corners[i].z, 1.0f), &clip);
+        // boxes crossing the near plane are never occluded
+        if (clip.w <= 0 || clip.z < -clip.w)
+            return false;
+
+        const ScreenVertex vertex = toScreen(clip);
+        minX = std::min(minX, vertex.x);
+        maxX = std::max(maxX, vertex.x);
+        minY = std::min(minY, vertex.y);
+        maxY = std::max(maxY, vertex.y);
+        nearest = std::min(nearest, vertex.depth);
+    }
+
+    // out of the screen, the frustum culling handles it
+    if (maxX < 0 || maxY < 0 || minX >= _width || minY >= _height)
+        return false;
+
+    int x0 = std::max(0, (int)minX);
+    int y0 = std::max(0, (int)minY);
+    int x1 = std::min(_width - 1, (int)maxX);
+    int y1 = std::min(_height - 1, (int)maxY);
+
+    // the level where the box covers at most 2x2 texels
+    size_t level = 0;
+    while (level + 1 < _levels.size() && ((x1 >> level) - (x0 >> level) > 1 || (y1 >> level) - (y0 >> level) > 1))
+        ++level;
+
+    const int levelWidth = std::max(_width >> level, 1);
+    const int levelHeight = std::max(_height >> level, 1);
+    const auto& depth = _levels[level];
+    x0 = std::min(x0 >> level, levelWidth - 1);
+    x1 = std::min(x1 >> level, levelWidth - 1);
+    y0 = std::min(y0 >> level, levelHeight - 1);
+    y1 = std::min(y1 >> level, levelHeight - 1);
+
+    for (int y = y0; y <= y1; ++y)
+    {
+        for (int x = x0; x <= x1; ++x)
+        {
+            if (depth[y * levelWidth + x] >= nearest)
+                return false;
+        }
+    }
+
+    ++_culledCount;
+    return true;
+}
+
+NS_CC_END
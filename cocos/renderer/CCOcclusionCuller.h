@@ -0,0 +1,148 @@
+/****************************************************************************
+ Copyright (c) 2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef __CC_OCCLUSION_CULLER_H__
+#define __CC_OCCLUSION_CULLER_H__
+
+#include <atomic>
+#include <vector>
+
+#include "3d/CCAABB.h"
+#include "math/CCMath.h"
+
+NS_CC_BEGIN
+
+class Camera;
+class Node;
+
+/**
+ * @addtogroup renderer
+ * @{
+ */
+
+/** @brief OcclusionCuller tells whether a box is hidden by the occluders, before its draw commands are emitted.
+ *
+ * Before each camera visits the scene, the bounds of the occluders are rasterized on the CPU into a low
+ * resolution depth buffer. Only the texels fully covered by an occluder are written, so the low resolution
+ * never makes an occluder hide more than it does. A hierarchical-Z pyramid keeping the farthest depth of each region is built
+ * from it. A box is then occluded if its nearest point is behind the farthest occluder depth of all the
+ * texels it covers, which only takes a few reads from the level of the pyramid matching the box size.
+ *
+ * Occluders are usually large static meshes, such as walls and buildings, see Sprite3D::setOccluder().
+ * Their bounds must be inside what they draw, otherwise objects which should be visible are culled:
+ * the bounding box of a mesh is usually too large, only a box shaped mesh fills it.
+ *
+ * It is owned by the Renderer, see Renderer::getOcclusionCuller().
+ * @since v3.13
+ * @js NA
+ * @lua NA
+ */
+class CC_DLL OcclusionCuller
+{
+public:
+    /** Default width of the depth buffer, in texels */
+    static const int DEFAULT_WIDTH = 256;
+    /** Default height of the depth buffer, in texels */
+    static const int DEFAULT_HEIGHT = 128;
+
+    OcclusionCuller();
+    ~OcclusionCuller();
+
+    /** Sets whether the occlusion culling is enabled. It is enabled by default, and only culls when there are occluders. */
+    void setEnabled(bool enabled);
+    /** Returns whether the occlusion culling is enabled. */
+    bool isEnabled() const { return _enabled; }
+
+    /** Sets the size of the depth buffer. Both must be powers of two. */
+    void setResolution(int width, int height);
+
+    /** Adds an occluder, or updates its bounds if it was already added.
+     *
+     * @param node The node, which isn't retained. Remove it before it is destroyed.
+     * @param localBounds A box inside what the node draws, in the node's space.
+     */
+    void addOccluder(Node* node, const AABB& localBounds);
+
+    /** Removes an occluder. */
+    void removeOccluder(Node* node);
+
+    /** Returns the number of occluders. */
+    ssize_t getOccluderCount() const { return _occluders.size(); }
+
+    /** Rasterizes the visible occluders as seen by the camera. The Scene calls it before each camera visits it. */
+    void prepare(const Camera* camera);
+
+    /** Forgets the occluders rasterized by prepare(), so that nothing is occluded until it is called again.
+     * The Scene calls it once the camera was rendered.
+     */
+    void reset();
+
+    /** Returns whether a box is hidden by the occluders rasterized by the last call to prepare(), if reset() wasn't called since.
+     * It can be called by several threads at once.
+     *
+     * @param worldBounds A box in world space.
+     */
+    bool isOccluded(const AABB& worldBounds) const;
+
+    /** Returns the number of boxes found occluded since the last call to prepare(). */
+    unsigned int getCulledCount() const { return _culledCount; }
+
+protected:
+    struct Occluder
+    {
+        Node* node;
+        AABB bounds;
+    };
+
+    struct ScreenVertex
+    {
+        float x;
+        float y;
+        float depth;
+    };
+
+    void rasterizeBox(const AABB& bounds, const Mat4& modelViewProjection);
+    void rasterizeTriangle(const ScreenVertex& v0, const ScreenVertex& v1, const ScreenVertex& v2);
+    void buildHierarchy();
+    ScreenVertex toScreen(const Vec4& clip) const;
+
+    std::vector<Occluder> _occluders;
+    // level 0 is the depth buffer, each following level keeps the farthest depth of 2x2 texels
+    std::vector<std::vector<float>> _levels;
+    Mat4 _viewProjection;
+
+    int _width;
+    int _height;
+    bool _enabled;
+    bool _ready;
+    mutable std::atomic<unsigned int> _culledCount;
+};
+
+// end of renderer group
+/// @}
+
+NS_CC_END
+
+#endif // __CC_OCCLUSION_CULLER_H__
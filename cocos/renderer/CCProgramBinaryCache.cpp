@@ -0,0 +1,224 @@
+/****************************************************************************
+ Copyright (c) 2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "renderer/CCProgramBinaryCache.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "xxhash.h"
+
+#include "base/ccMacros.h"
+#include "base/CCConfiguration.h"
+#include "platform/CCFileUtils.h"
+
+NS_CC_BEGIN
+
+// header of the saved binaries
+struct ProgramBinaryHeader
+{
+    char magic[4];
+    unsigned int version;
+    unsigned int format;
+    unsigned int length;
+};
+
+static const char PROGRAM_BINARY_MAGIC[4] = {'C', 'C', 'P', 'B'};
+static const unsigned int PROGRAM_BINARY_VERSION = 1;
+
+static ProgramBinaryCache* s_sharedProgramBinaryCache = nullptr;
+
+ProgramBinaryCache* ProgramBinaryCache::getInstance()
+{
+    if (!s_sharedProgramBinaryCache)
+    {
+        s_sharedProgramBinaryCache = new (std::nothrow) ProgramBinaryCache();
+    }
+    return s_sharedProgramBinaryCache;
+}
+
+void ProgramBinaryCache::destroyInstance()
+{
+    CC_SAFE_DELETE(s_sharedProgramBinaryCache);
+}
+
+ProgramBinaryCache::ProgramBinaryCache()
+: _driverHash(0)
+, _enabled(false)
+, _loadedCount(0)
+, _savedCount(0)
+{
+    auto conf = Configuration::getInstance();
+    const std::string driver = conf->getValue("gl.renderer").asString()
+        + conf->getValue("gl.version").asString()
+        + conf->getValue("cocos2d.x.version").asString();
+    _driverHash = XXH32(driver.c_str(), (int)driver.size(), 0);
+
+    _directory = FileUtils::getInstance()->getWritablePath() + "shadercache/";
+    setEnabled(conf->supportsProgramBinary());
+}
+
+void ProgramBinaryCache::setEnabled(bool enabled)
+{
+    if (enabled && !Configuration::getInstance()->supportsProgramBinary())
+    {
+        CCLOG("cocos2d: ProgramBinaryCache: the driver doesn't support program binaries");
+        return;
+    }
+
+    if (enabled && !FileUtils::getInstance()->isDirectoryExist(_directory) && !FileUtils::getInstance()->createDirectory(_directory))
+    {
+        CCLOG("cocos2d: ProgramBinaryCache: couldn't create %s", _directory.c_str());
+        return;
+    }
+
+    _enabled = enabled;
+}
+
+std::string ProgramBinaryCache::getKey(const std::string& sources) const
+{
+    // two seeds, so that a collision needs both hashes to collide
+    char key[32];
+    snprintf(key, sizeof(key), "%08x%08x",
+             XXH32(sources.c_str(), (int)sources.size(), 0),
+             XXH32(sources.c_str(), (int)sources.size(), _driverHash));
+    return key;
+}
+
+std::string ProgramBinaryCache::getPath(const std::string& key) const
+{
+    return _directory + key + ".bin";
+}
+
+bool ProgramBinaryCache::loadProgram(GLuint program, const std::string& key)
+{
+#if CC_USE_PROGRAM_BINARY_CACHE
+    if (!_enabled)
+        return false;
+
+    ProgramBinaryHeader header;
+    std::vector<unsigned char> binary;
+    const std::string path = FileUtils::getInstance()->getSuitableFOpen(getPath(key));
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        FILE* fp = fopen(path.c_str(), "rb");
+        if (!fp)
+            return false;
+
+        bool valid = fread(&header, sizeof(header), 1, fp) == 1
+            && memcmp(header.magic, PROGRAM_BINARY_MAGIC, sizeof(header.magic)) == 0
+            && header.version == PROGRAM_BINARY_VERSION;
+        if (valid)
+        {
+            binary.resize(header.length);
+            valid = fread(binary.data(), 1, header.length, fp) == header.length;
+        }
+        fclose(fp);
+
+        if (!valid)
+        {
+            CCLOG("cocos2d: ProgramBinaryCache: invalid binary %s", path.c_str());
+            remove(path.c_str());
+            return false;
+        }
+    }
+
+    glProgramBinary(program, header.format, binary.data(), (GLsizei)binary.size());
+
+    GLint status = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &status);
+    if (status == GL_FALSE)
+    {
+        // the driver changed in a way it can't load its old binaries
+        CCLOG("cocos2d: ProgramBinaryCache: the driver rejected %s", path.c_str());
+        std::lock_guard<std::mutex> lock(_mutex);
+        remove(path.c_str());
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    ++_loadedCount;
+    return true;
+#else
+    return false;
+#endif
+}
+
+void ProgramBinaryCache::saveProgram(GLuint program, const std::string& key)
+{
+#if CC_USE_PROGRAM_BINARY_CACHE
+    if (!_enabled)
+        return;
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+
+    ProgramBinaryHeader header;
+    memcpy(header.magic, PROGRAM_BINARY_MAGIC, sizeof(header.magic));
+    header.version = PROGRAM_BINARY_VERSION;
+
+    std::vector<unsigned char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &length, &format, binary.data());
+    header.format = format;
+    header.length = length;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    const std::string path = FileUtils::getInstance()->getSuitableFOpen(getPath(key));
+    FILE* fp = fopen(path.c_str(), "wb");
+    if (!fp)
+    {
+        CCLOG("cocos2d: ProgramBinaryCache: couldn't write %s", path.c_str());
+        return;
+    }
+
+    const bool written = fwrite(&header, sizeof(header), 1, fp) == 1
+        && fwrite(binary.data(), 1, header.length, fp) == header.length;
+    fclose(fp);
+
+    if (!written)
+    {
+        // a partial binary would be rejected when loaded anyway
+        remove(path.c_str());
+        return;
+    }
+    ++_savedCount;
+#endif
+}
+
+void ProgramBinaryCache::removeAllPrograms()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto fileUtils = FileUtils::getInstance();
+    fileUtils->removeDirectory(_directory);
+    if (_enabled && !fileUtils->createDirectory(_directory))
+    {
+        _enabled = false;
+    }
+}
+
+NS_CC_END
@@ -0,0 +1,112 @@
+/****************************************************************************
+ Copyright (c) 2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CC_PROGRAM_BINARY_CACHE_H__
+#define __CC_PROGRAM_BINARY_CACHE_H__
+
+#include <mutex>
+#include <string>
+
+#include "platform/CCGL.h"
+#include "platform/CCPlatformMacros.h"
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup renderer
+ * @{
+ */
+
+/** @brief ProgramBinaryCache saves the binaries of the linked GL programs to the writable path.
+ *
+ * GLProgram looks for the binary of its sources before compiling them, and loads it with glProgramBinary()
+ * instead, which is much faster than compiling and linking the shaders. When the program had to be compiled,
+ * its binary is saved with glGetProgramBinary() for the next launch.
+ *
+ * The binaries are keyed by the hash of the sources, including the compile time defines, of the GL renderer
+ * and version, and of the engine version: a driver update makes the old binaries unused, and the ones the driver
+ * rejects are deleted.
+ *
+ * It can be used by several threads, see GLProgramCache::precompileGLProgramsAsync().
+ * @since v3.13
+ */
+class CC_DLL ProgramBinaryCache
+{
+public:
+    /** Returns the shared instance. */
+    static ProgramBinaryCache* getInstance();
+
+    /** Destroys the shared instance. The saved binaries are kept. */
+    static void destroyInstance();
+
+    /** Enables or disables the cache. It is enabled when Configuration::supportsProgramBinary() is true. */
+    void setEnabled(bool enabled);
+
+    /** Whether the programs are loaded from, and saved to, the cache. */
+    bool isEnabled() const { return _enabled; }
+
+    /** Returns the key of a program, from the concatenation of its sources and defines. */
+    std::string getKey(const std::string& sources) const;
+
+    /** Loads the binary saved for the key into the program.
+     *
+     * @return True if the program is linked. Otherwise it can still be compiled and linked as usual.
+     */
+    bool loadProgram(GLuint program, const std::string& key);
+
+    /** Saves the binary of a linked program for the key. */
+    void saveProgram(GLuint program, const std::string& key);
+
+    /** Deletes all the saved binaries. */
+    void removeAllPrograms();
+
+    /** Returns the directory where the binaries are saved. */
+    const std::string& getDirectory() const { return _directory; }
+
+    /** Returns the number of programs loaded from their binaries. */
+    unsigned int getLoadedCount() const { return _loadedCount; }
+
+    /** Returns the number of binaries saved. */
+    unsigned int getSavedCount() const { return _savedCount; }
+
+protected:
+    ProgramBinaryCache();
+
+    std::string getPath(const std::string& key) const;
+
+    // serializes the file accesses of the threads compiling programs
+    std::mutex _mutex;
+    std::string _directory;
+    unsigned int _driverHash;
+    bool _enabled;
+    unsigned int _loadedCount;
+    unsigned int _savedCount;
+};
+
+// end of renderer group
+/// @}
+
+NS_CC_END
+
+#endif //__CC_PROGRAM_BINARY_CACHE_H__
@@ -36,6 +36,7 @@ RenderCommand::RenderCommand()
 , _skipBatching(false)
 , _is3D(false)
 , _depth(0)
+, _sortKey(0)
 {
 }
 
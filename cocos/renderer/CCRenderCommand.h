@@ -97,8 +97,16 @@ public:
     void set3D(bool value) { _is3D = value; }
     /**Get the depth by current model view matrix.*/
     float getDepth() const { return _depth; }
+    /**
+     Get the sort key, built when the command is pushed into a render queue.
+     The high 32 bits hold the order of the command in its queue group (global Z order, or depth for
+     transparent 3D commands), the low 32 bits hold the material ID for commands which may be reordered by it.
+     */
+    uint64_t getSortKey() const { return _sortKey; }
     
 protected:
+    friend class RenderQueue;
+
     /**Constructor.*/
     RenderCommand();
     /**Destructor.*/
@@ -126,6 +134,9 @@ protected:
     
     /** Depth from the model view matrix.*/
     float _depth;
+
+    /** Key used to sort the command in its render queue. */
+    uint64_t _sortKey;
 };
 
 NS_CC_END
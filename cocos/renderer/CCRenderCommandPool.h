@@ -27,6 +27,7 @@
 /// @cond DO_NOT_SHOW
 
 #include <list>
+#include <vector>
 
 #include "platform/CCPlatformMacros.h"
 
@@ -79,6 +80,24 @@ public:
         //_usedPool.erase(ptr);
         
     }
+
+    // Returns a command which is used for a whole frame, it is given back by recycleFrameCommands()
+    T* generateFrameCommand()
+    {
+        T* result = generateCommand();
+        _frameCommands.push_back(result);
+        return result;
+    }
+
+    // Gives back all the commands returned by generateFrameCommand()
+    void recycleFrameCommands()
+    {
+        for (auto command : _frameCommands)
+        {
+            _freePool.push_back(command);
+        }
+        _frameCommands.clear();
+    }
 private:
     void AllocateCommands()
     {
@@ -93,6 +112,7 @@ private:
 
     std::list<T*> _allocatedPoolBlocks;
     std::list<T*> _freePool;
+    std::vector<T*> _frameCommands;
     //std::set<T*> _usedPool;
 };
 
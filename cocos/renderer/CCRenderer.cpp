@@ -25,6 +25,10 @@
 #include "renderer/CCRenderer.h"
 
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
 
 #include "renderer/CCTrianglesCommand.h"
 #include "renderer/CCBatchCommand.h"
@@ -32,6 +36,8 @@
 #include "renderer/CCGroupCommand.h"
 #include "renderer/CCPrimitiveCommand.h"
 #include "renderer/CCMeshCommand.h"
+#include "renderer/CCOcclusionCuller.h"
+#include "renderer/CCBatchDiagnostics.h"
 #include "renderer/CCGLProgramCache.h"
 #include "renderer/CCMaterial.h"
 #include "renderer/CCTechnique.h"
@@ -44,20 +50,258 @@
 #include "base/CCEventDispatcher.h"
 #include "base/CCEventListenerCustom.h"
 #include "base/CCEventType.h"
+#include "platform/CCGLView.h"
 #include "2d/CCCamera.h"
+#include "2d/CCNode.h"
 #include "2d/CCScene.h"
 
 NS_CC_BEGIN
 
+// Threads used to record render commands in parallel.
+// Tasks are handed out through a shared counter, so idle threads keep taking the remaining
+// tasks until all of them are done. The calling thread works as recording thread 0.
+class RenderRecordingPool
+{
+public:
+    typedef std::function<void(ssize_t task, int thread)> Job;
+
+    explicit RenderRecordingPool(int threadCount)
+    : _taskCount(0)
+    , _busyThreads(0)
+    , _generation(0)
+    , _stop(false)
+    {
+        _nextTask = 0;
+        for (int i = 0; i < threadCount; ++i)
+        {
+            _threads.push_back(std::thread(&RenderRecordingPool::workerLoop, this, i + 1));
+        }
+    }
+
+    ~RenderRecordingPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+        _wakeUp.notify_all();
+        for (auto& thread : _threads)
+        {
+            thread.join();
+        }
+    }
+
+    int getThreadCount() const { return (int)_threads.size(); }
+
+    std::thread::id getThreadID(int thread) const { return _threads[thread - 1].get_id(); }
+
+    // Runs job for every task in [0, taskCount) and returns when all of them are done
+    void run(ssize_t taskCount, const Job& job)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _job = job;
+            _taskCount = taskCount;
+            _nextTask = 0;
+            _busyThreads = (int)_threads.size();
+            ++_generation;
+        }
+        _wakeUp.notify_all();
+
+        runTasks(0);
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        _done.wait(lock, [this]{ return _busyThreads == 0; });
+        _job = nullptr;
+    }
+
+protected:
+    void runTasks(int thread)
+    {
+        for (ssize_t task = _nextTask++; task < _taskCount; task = _nextTask++)
+        {
+            _job(task, thread);
+        }
+    }
+
+    void workerLoop(int thread)
+    {
+        unsigned int generation = 0;
+        for (;;)
+        {
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _wakeUp.wait(lock, [&]{ return _stop || _generation != generation; });
+                if (_stop)
+                    return;
+                generation = _generation;
+            }
+
+            runTasks(thread);
+
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (--_busyThreads == 0)
+            {
+                _done.notify_one();
+            }
+        }
+    }
+
+    std::vector<std::thread> _threads;
+    std::mutex _mutex;
+    std::condition_variable _wakeUp;
+    std::condition_variable _done;
+    Job _job;
+    std::atomic<ssize_t> _nextTask;
+    ssize_t _taskCount;
+    int _busyThreads;
+    unsigned int _generation;
+    bool _stop;
+};
+
+// Render thread of the pipelined rendering.
+// It owns the GL context of the view and runs the steps queued by the main thread in order.
+class RenderPipeline
+{
+public:
+    typedef std::function<void()> Step;
+
+    explicit RenderPipeline(GLView* view)
+    : _view(view)
+    , _queuedSteps(0)
+    , _doneSteps(0)
+    , _stop(false)
+    {
+        _thread = std::thread(&RenderPipeline::threadLoop, this);
+    }
+
+    // Runs the queued steps and stops the thread
+    ~RenderPipeline()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+        _wakeUp.notify_one();
+        _thread.join();
+    }
+
+    std::thread::id getThreadID() const { return _thread.get_id(); }
+
+    // Queues a step and returns its number
+    unsigned int push(const Step& step)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _steps.push_back(step);
+        _wakeUp.notify_one();
+        return ++_queuedSteps;
+    }
+
+    // Returns once the given step was run
+    void wait(unsigned int step)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _done.wait(lock, [&]{ return _doneSteps >= step; });
+    }
+
+    unsigned int getQueuedSteps()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _queuedSteps;
+    }
+
+protected:
+    void threadLoop()
+    {
+        _view->makeContextCurrent(false);
+
+        for (;;)
+        {
+            Step step;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _wakeUp.wait(lock, [this]{ return _stop || !_steps.empty(); });
+                if (_steps.empty())
+                    break;
+                step = std::move(_steps.front());
+                _steps.pop_front();
+            }
+
+            step();
+
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                ++_doneSteps;
+            }
+            _done.notify_all();
+        }
+
+        // the main thread gets the context back
+        glFinish();
+        _view->releaseCurrentContext();
+    }
+
+    GLView* _view;
+    std::thread _thread;
+    std::mutex _mutex;
+    std::condition_variable _wakeUp;
+    std::condition_variable _done;
+    std::deque<Step> _steps;
+    unsigned int _queuedSteps;
+    unsigned int _doneSteps;
+    bool _stop;
+};
+
 // helper
-static bool compareRenderCommand(RenderCommand* a, RenderCommand* b)
+// maps a float to an unsigned integer with the same ordering
+static uint32_t orderedFloatBits(float value)
 {
-    return a->getGlobalOrder() < b->getGlobalOrder();
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return (bits & 0x80000000) ? ~bits : (bits | 0x80000000);
 }
 
-static bool compare3DCommand(RenderCommand* a, RenderCommand* b)
+template <typename Entry>
+static void radixSort(std::vector<Entry>& entries, std::vector<Entry>& scratch)
 {
-    return  a->getDepth() > b->getDepth();
+    // LSD radix sort of the 64-bit keys, 8 bits per pass. It is stable, so entries
+    // with the same key keep their order of arrival.
+    // Passes in which every key has the same digit are skipped.
+    const size_t count = entries.size();
+    scratch.resize(count);
+
+    Entry* src = entries.data();
+    Entry* dst = scratch.data();
+    for (int shift = 0; shift < 64; shift += 8)
+    {
+        size_t offsets[256] = {0};
+        for (size_t i = 0; i < count; ++i)
+        {
+            ++offsets[(src[i].key >> shift) & 0xff];
+        }
+
+        if (offsets[(src[0].key >> shift) & 0xff] == count)
+            continue;
+
+        size_t offset = 0;
+        for (int digit = 0; digit < 256; ++digit)
+        {
+            size_t digitCount = offsets[digit];
+            offsets[digit] = offset;
+            offset += digitCount;
+        }
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            dst[offsets[(src[i].key >> shift) & 0xff]++] = src[i];
+        }
+        std::swap(src, dst);
+    }
+
+    if (src != entries.data())
+    {
+        std::copy(src, src + count, entries.data());
+    }
 }
 
 // queue
@@ -71,10 +315,12 @@ void RenderQueue::push_back(RenderCommand* command)
     float z = command->getGlobalOrder();
     if(z < 0)
     {
+        command->_sortKey = (uint64_t)orderedFloatBits(z) << 32;
         _commands[QUEUE_GROUP::GLOBALZ_NEG].push_back(command);
     }
     else if(z > 0)
     {
+        command->_sortKey = (uint64_t)orderedFloatBits(z) << 32;
         _commands[QUEUE_GROUP::GLOBALZ_POS].push_back(command);
     }
     else
@@ -83,15 +329,29 @@ void RenderQueue::push_back(RenderCommand* command)
         {
             if(command->isTransparent())
             {
+                // back to front
+                command->_sortKey = (uint64_t)~orderedFloatBits(command->getDepth()) << 32;
                 _commands[QUEUE_GROUP::TRANSPARENT_3D].push_back(command);
             }
             else
             {
+                // opaque meshes are grouped by material so they can be batched, other commands keep their place
+                if (command->getType() == RenderCommand::Type::MESH_COMMAND)
+                {
+                    // instances of the same mesh are kept next to each other to be drawn together
+                    auto meshCommand = static_cast<MeshCommand*>(command);
+                    command->_sortKey = meshCommand->isInstanced() ? meshCommand->getInstanceKey() : meshCommand->getMaterialID();
+                }
+                else
+                {
+                    command->_sortKey = 0;
+                }
                 _commands[QUEUE_GROUP::OPAQUE_3D].push_back(command);
             }
         }
         else
         {
+            command->_sortKey = 0;
             _commands[QUEUE_GROUP::GLOBALZ_ZERO].push_back(command);
         }
     }
@@ -111,9 +371,53 @@ ssize_t RenderQueue::size() const
 void RenderQueue::sort()
 {
     // Don't sort _queue0, it already comes sorted
-    std::sort(std::begin(_commands[QUEUE_GROUP::TRANSPARENT_3D]), std::end(_commands[QUEUE_GROUP::TRANSPARENT_3D]), compare3DCommand);
-    std::sort(std::begin(_commands[QUEUE_GROUP::GLOBALZ_NEG]), std::end(_commands[QUEUE_GROUP::GLOBALZ_NEG]), compareRenderCommand);
-    std::sort(std::begin(_commands[QUEUE_GROUP::GLOBALZ_POS]), std::end(_commands[QUEUE_GROUP::GLOBALZ_POS]), compareRenderCommand);
+    sortSubQueue(QUEUE_GROUP::OPAQUE_3D);
+    sortSubQueue(QUEUE_GROUP::TRANSPARENT_3D);
+    sortSubQueue(QUEUE_GROUP::GLOBALZ_NEG);
+    sortSubQueue(QUEUE_GROUP::GLOBALZ_POS);
+}
+
+void RenderQueue::sortSubQueue(QUEUE_GROUP group)
+{
+    auto& commands = _commands[group];
+    if (group != QUEUE_GROUP::OPAQUE_3D)
+    {
+        sortCommands(commands, 0, commands.size());
+        return;
+    }
+
+    // only the runs of meshes are sorted: a custom command (e.g. a terrain) may depend
+    // on what was drawn before it, so it is kept between the same meshes
+    size_t begin = 0;
+    for (size_t i = 0, count = commands.size(); i <= count; ++i)
+    {
+        if (i == count || commands[i]->getType() != RenderCommand::Type::MESH_COMMAND)
+        {
+            sortCommands(commands, begin, i);
+            begin = i + 1;
+        }
+    }
+}
+
+void RenderQueue::sortCommands(std::vector<RenderCommand*>& commands, size_t begin, size_t end)
+{
+    if (end < begin + 2)
+        return;
+
+    // gather the keys once, so that sorting doesn't need to read the commands
+    _sortEntries.resize(end - begin);
+    for (size_t i = begin; i < end; ++i)
+    {
+        _sortEntries[i - begin].key = commands[i]->_sortKey;
+        _sortEntries[i - begin].command = commands[i];
+    }
+
+    radixSort(_sortEntries, _sortScratch);
+
+    for (size_t i = begin; i < end; ++i)
+    {
+        commands[i] = _sortEntries[i - begin].command;
+    }
 }
 
 RenderCommand* RenderQueue::operator[](ssize_t index) const
@@ -149,11 +453,19 @@ void RenderQueue::realloc(size_t reserveSize)
     }
 }
 
+void RenderQueue::append(const RenderQueue& other)
+{
+    for(int i = 0; i < QUEUE_COUNT; ++i)
+    {
+        _commands[i].insert(_commands[i].end(), other._commands[i].begin(), other._commands[i].end());
+    }
+}
+
 void RenderQueue::saveRenderState()
 {
-    _isDepthEnabled = glIsEnabled(GL_DEPTH_TEST) != GL_FALSE;
-    _isCullEnabled = glIsEnabled(GL_CULL_FACE) != GL_FALSE;
-    glGetBooleanv(GL_DEPTH_WRITEMASK, &_isDepthWrite);
+    _isDepthEnabled = GL::isEnabled(GL_DEPTH_TEST);
+    _isCullEnabled = GL::isEnabled(GL_CULL_FACE);
+    _isDepthWrite = GL::getDepthMask();
     
     CHECK_GL_ERROR_DEBUG();
 }
@@ -162,27 +474,27 @@ void RenderQueue::restoreRenderState()
 {
     if (_isCullEnabled)
     {
-        glEnable(GL_CULL_FACE);
+        GL::enable(GL_CULL_FACE);
         RenderState::StateBlock::_defaultState->setCullFace(true);
     }
     else
     {
-        glDisable(GL_CULL_FACE);
+        GL::disable(GL_CULL_FACE);
         RenderState::StateBlock::_defaultState->setCullFace(false);
     }
 
     if (_isDepthEnabled)
     {
-        glEnable(GL_DEPTH_TEST);
+        GL::enable(GL_DEPTH_TEST);
         RenderState::StateBlock::_defaultState->setDepthTest(true);
     }
     else
     {
-        glDisable(GL_DEPTH_TEST);
+        GL::disable(GL_DEPTH_TEST);
         RenderState::StateBlock::_defaultState->setDepthTest(false);
     }
     
-    glDepthMask(_isDepthWrite);
+    GL::depthMask(_isDepthWrite);
     RenderState::StateBlock::_defaultState->setDepthWrite(_isDepthEnabled);
 
     CHECK_GL_ERROR_DEBUG();
@@ -198,6 +510,7 @@ static const int DEFAULT_RENDER_QUEUE = 0;
 //
 Renderer::Renderer()
 :_lastBatchedMeshCommand(nullptr)
+,_instanceVBO(0)
 ,_filledVertex(0)
 ,_filledIndex(0)
 ,_glViewAssigned(false)
@@ -205,11 +518,21 @@ Renderer::Renderer()
 ,_isDepthTestFor2D(false)
 ,_triBatchesToDraw(nullptr)
 ,_triBatchesToDrawCapacity(-1)
+,_currentBuffer(0)
+,_multiTextureProgram(nullptr)
+,_spriteProgram(nullptr)
+,_batchDiagnostics(nullptr)
+,_recordingPool(nullptr)
+,_isRecordingInParallel(false)
+,_pipeline(nullptr)
+,_recordedFrames(0)
+,_executingSegment(nullptr)
 #if CC_ENABLE_CACHE_TEXTURE_DATA
 ,_cacheTextureListener(nullptr)
 #endif
 {
     _groupCommandManager = new (std::nothrow) GroupCommandManager();
+    _occlusionCuller = new (std::nothrow) OcclusionCuller();
     
     _commandGroupStack.push(DEFAULT_RENDER_QUEUE);
     
@@ -223,20 +546,54 @@ Renderer::Renderer()
     // for the batched TriangleCommand
     _triBatchesToDrawCapacity = 500;
     _triBatchesToDraw = (TriBatchToDraw*) malloc(sizeof(_triBatchesToDraw[0]) * _triBatchesToDrawCapacity);
+
+    _drawnBatches = _drawnVertices = 0;
+    _frameStats.drawnBatches = _frameStats.drawnVertices = 0;
+    _frameStats.stateCache = GL::StateCacheStats{0, 0, 0, 0};
+
+    for (auto& frame : _pipelineFrames)
+    {
+        frame.usedSegments = 0;
+        frame.lastStep = 0;
+    }
 }
 
 Renderer::~Renderer()
 {
+    setPipelineEnabled(false);
+    for (auto& frame : _pipelineFrames)
+    {
+        for (auto segment : frame.segments)
+        {
+            delete segment;
+        }
+        for (auto arena : frame.arenas)
+        {
+            delete arena;
+        }
+    }
+    for (auto arena : _frameArenas)
+    {
+        delete arena;
+    }
+
+    delete _recordingPool;
     _renderGroups.clear();
     _groupCommandManager->release();
+    delete _occlusionCuller;
+    delete _batchDiagnostics;
     
-    glDeleteBuffers(2, _buffersVBO);
+    glDeleteBuffers(VBO_RING_SIZE * 2, &_buffersVBO[0][0]);
+    glDeleteBuffers(VBO_RING_SIZE, _textureIndexVBO);
+    glDeleteBuffers(1, &_instanceVBO);
+    CC_SAFE_RELEASE(_multiTextureProgram);
+    CC_SAFE_RELEASE(_spriteProgram);
 
     free(_triBatchesToDraw);
 
     if (Configuration::getInstance()->supportsShareableVAO())
     {
-        glDeleteVertexArrays(1, &_buffersVAO);
+        glDeleteVertexArrays(VBO_RING_SIZE, _buffersVAO);
         GL::bindVAO(0);
     }
 #if CC_ENABLE_CACHE_TEXTURE_DATA
@@ -262,6 +619,15 @@ void Renderer::initGLView()
 
 void Renderer::setupBuffer()
 {
+    // texture indices of the multi texture batches, they are only uploaded by the flushes which draw such a batch
+    glGenBuffers(VBO_RING_SIZE, _textureIndexVBO);
+    for (int i = 0; i < VBO_RING_SIZE; ++i)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, _textureIndexVBO[i]);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(_textureIndices[0]) * VBO_SIZE, nullptr, GL_DYNAMIC_DRAW);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
     if(Configuration::getInstance()->supportsShareableVAO())
     {
         setupVBOAndVAO();
@@ -270,18 +636,35 @@ void Renderer::setupBuffer()
     {
         setupVBO();
     }
+
+    // per instance data of the instanced meshes, filled on every flush
+    if (Configuration::getInstance()->supportsInstancing())
+        glGenBuffers(1, &_instanceVBO);
 }
 
 void Renderer::setupVBOAndVAO()
 {
     //generate vbo and vao for trianglesCommand
-    glGenVertexArrays(1, &_buffersVAO);
-    GL::bindVAO(_buffersVAO);
+    glGenVertexArrays(VBO_RING_SIZE, _buffersVAO);
+    glGenBuffers(VBO_RING_SIZE * 2, &_buffersVBO[0][0]);
+    _currentBuffer = 0;
+
+    // Every buffer of the ring keeps its size and usage for its whole lifetime, so that they can be
+    // mapped and rewritten without being reallocated by the driver.
+    for (int i = 0; i < VBO_RING_SIZE; ++i)
+    {
+        setupVAO(_buffersVAO[i], _buffersVBO[i], _textureIndexVBO[i]);
+    }
 
-    glGenBuffers(2, &_buffersVBO[0]);
+    CHECK_GL_ERROR_DEBUG();
+}
+
+void Renderer::setupVAO(GLuint vao, const GLuint* vbo, GLuint textureIndexVBO)
+{
+    GL::bindVAO(vao);
 
-    glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(_verts[0]) * VBO_SIZE, _verts, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo[0]);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(_verts[0]) * VBO_SIZE, nullptr, GL_DYNAMIC_DRAW);
 
     // vertices
     glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_POSITION);
@@ -295,20 +678,24 @@ void Renderer::setupVBOAndVAO()
     glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_TEX_COORD);
     glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, sizeof(V3F_C4B_T2F), (GLvoid*) offsetof( V3F_C4B_T2F, texCoords));
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_indices[0]) * INDEX_VBO_SIZE, _indices, GL_STATIC_DRAW);
+    // texture indices, only read by the multi texture program
+    glBindBuffer(GL_ARRAY_BUFFER, textureIndexVBO);
+    glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_TEXTURE_INDEX);
+    glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEXTURE_INDEX, 1, GL_FLOAT, GL_FALSE, sizeof(GLfloat), (GLvoid*) 0);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vbo[1]);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_indices[0]) * INDEX_VBO_SIZE, nullptr, GL_DYNAMIC_DRAW);
 
     // Must unbind the VAO before changing the element buffer.
     GL::bindVAO(0);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-    CHECK_GL_ERROR_DEBUG();
 }
 
 void Renderer::setupVBO()
 {
-    glGenBuffers(2, &_buffersVBO[0]);
+    glGenBuffers(VBO_RING_SIZE * 2, &_buffersVBO[0][0]);
+    _currentBuffer = 0;
     // Issue #15652
     // Should not initialzie VBO with a large size (VBO_SIZE=65536),
     // it may cause low FPS on some Android devices like LG G4 & Nexus 5X.
@@ -324,15 +711,16 @@ void Renderer::mapBuffers()
     // Avoid changing the element buffer for whatever VAO might be bound.
     GL::bindVAO(0);
 
-    glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(_verts[0]) * VBO_SIZE, _verts, GL_DYNAMIC_DRAW);
-    
-
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    for (int i = 0; i < VBO_RING_SIZE; ++i)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[i][0]);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(_verts[0]) * VBO_SIZE, _verts, GL_DYNAMIC_DRAW);
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_indices[0]) * INDEX_VBO_SIZE, _indices, GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[i][1]);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_indices[0]) * INDEX_VBO_SIZE, _indices, GL_DYNAMIC_DRAW);
+    }
 
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
     CHECK_GL_ERROR_DEBUG();
@@ -340,6 +728,13 @@ void Renderer::mapBuffers()
 
 void Renderer::addCommand(RenderCommand* command)
 {
+    if (_isRecordingInParallel)
+    {
+        auto recorded = getRecordedCommands();
+        addCommand(command, recorded->groupStack.top());
+        return;
+    }
+
     int renderQueue =_commandGroupStack.top();
     addCommand(command, renderQueue);
 }
@@ -350,28 +745,212 @@ void Renderer::addCommand(RenderCommand* command, int renderQueue)
     CCASSERT(renderQueue >=0, "Invalid render queue");
     CCASSERT(command->getType() != RenderCommand::Type::UNKNOWN_COMMAND, "Invalid Command Type");
 
+    if (_isRecordingInParallel)
+    {
+        getRecordedCommands()->push_back(command, renderQueue);
+        return;
+    }
+
+    if (_batchDiagnostics)
+    {
+        _batchDiagnostics->addCommand(command);
+    }
+
     _renderGroups[renderQueue].push_back(command);
 }
 
 void Renderer::pushGroup(int renderQueueID)
 {
     CCASSERT(!_isRendering, "Cannot change render queue while rendering");
+    if (_isRecordingInParallel)
+    {
+        getRecordedCommands()->groupStack.push(renderQueueID);
+        return;
+    }
     _commandGroupStack.push(renderQueueID);
 }
 
 void Renderer::popGroup()
 {
     CCASSERT(!_isRendering, "Cannot change render queue while rendering");
+    if (_isRecordingInParallel)
+    {
+        getRecordedCommands()->groupStack.pop();
+        return;
+    }
     _commandGroupStack.pop();
 }
 
 int Renderer::createRenderQueue()
 {
+    std::lock_guard<std::mutex> lock(_renderQueueMutex);
     RenderQueue newRenderQueue;
     _renderGroups.push_back(newRenderQueue);
     return (int)_renderGroups.size() - 1;
 }
 
+void Renderer::RecordedCommands::push_back(RenderCommand* command, int renderQueueID)
+{
+    for (auto& queue : queues)
+    {
+        if (queue.first == renderQueueID)
+        {
+            queue.second.push_back(command);
+            return;
+        }
+    }
+
+    queues.push_back(std::make_pair(renderQueueID, RenderQueue()));
+    queues.back().second.push_back(command);
+}
+
+void Renderer::RecordedCommands::clear()
+{
+    // keep the queues around, their storage is reused on the next frame
+    for (auto& queue : queues)
+    {
+        queue.second.clear();
+    }
+}
+
+Renderer::RecordedCommands* Renderer::getRecordedCommands()
+{
+    auto threadID = std::this_thread::get_id();
+    for (const auto& thread : _recordingThreads)
+    {
+        if (thread.first == threadID)
+            return thread.second;
+    }
+
+    CCASSERT(false, "Render commands can only be added by the recording threads while recording in parallel");
+    return nullptr;
+}
+
+void Renderer::prepareFrameArenas(std::vector<FrameArena*>& arenas)
+{
+    size_t count = _recordingThreads.empty() ? 1 : _recordingThreads.size();
+    while (arenas.size() < count)
+    {
+        arenas.push_back(new (std::nothrow) FrameArena());
+    }
+}
+
+std::vector<FrameArena*>& Renderer::getFrameArenas()
+{
+    return _pipeline ? _pipelineFrames[_recordedFrames % PIPELINE_FRAMES].arenas : _frameArenas;
+}
+
+FrameArena* Renderer::getFrameArena()
+{
+    auto& arenas = getFrameArenas();
+    if (!_isRecordingInParallel)
+    {
+        // the arenas of the other threads are only created by visitInParallel()
+        if (arenas.empty())
+        {
+            arenas.push_back(new (std::nothrow) FrameArena());
+        }
+        return arenas[0];
+    }
+
+    auto threadID = std::this_thread::get_id();
+    for (size_t i = 0; i < _recordingThreads.size(); ++i)
+    {
+        if (_recordingThreads[i].first == threadID)
+            return arenas[i];
+    }
+
+    CCASSERT(false, "The frame arenas can only be used by the recording threads while recording in parallel");
+    return nullptr;
+}
+
+void Renderer::setRecordingThreadCount(int count)
+{
+    CCASSERT(!_isRecordingInParallel, "Cannot change the recording threads while recording");
+    CCASSERT(count >= 0, "Invalid number of recording threads");
+
+    if (count == getRecordingThreadCount())
+        return;
+
+    delete _recordingPool;
+    _recordingPool = nullptr;
+    _recordingThreads.clear();
+
+    if (count > 0)
+    {
+        _recordingPool = new (std::nothrow) RenderRecordingPool(count);
+        _recordingThreads.resize(count + 1);
+        for (int i = 1; i <= count; ++i)
+        {
+            _recordingThreads[i].first = _recordingPool->getThreadID(i);
+        }
+    }
+}
+
+int Renderer::getRecordingThreadCount() const
+{
+    return _recordingPool ? _recordingPool->getThreadCount() : 0;
+}
+
+void Renderer::visitInParallel(const Vector<Node*>& nodes, ssize_t first, ssize_t last, const Mat4& parentTransform, uint32_t parentFlags)
+{
+    ssize_t count = last - first;
+
+    // nested parallel visits are done by the thread that is already recording,
+    // and the batch diagnostics attribute the commands to the node drawn by the main thread
+    if (_recordingPool == nullptr || _isRecordingInParallel || _batchDiagnostics || count < 2)
+    {
+        for (ssize_t i = first; i < last; ++i)
+        {
+            nodes.at(i)->visit(this, parentTransform, parentFlags);
+        }
+        return;
+    }
+
+    // the subtrees which use the Director matrix stack are visited by this thread, in node order
+    for (ssize_t i = first; i < last; ++i)
+    {
+        if (!nodes.at(i)->isParallelVisitSafe())
+        {
+            visitInParallel(nodes, first, i, parentTransform, parentFlags);
+            nodes.at(i)->visit(this, parentTransform, parentFlags);
+            visitInParallel(nodes, i + 1, last, parentTransform, parentFlags);
+            return;
+        }
+    }
+
+    if ((ssize_t)_recordedCommands.size() < count)
+    {
+        _recordedCommands.resize(count);
+    }
+
+    int parentQueueID = _commandGroupStack.top();
+    _recordingThreads[0].first = std::this_thread::get_id();
+    prepareFrameArenas(getFrameArenas());
+
+    _isRecordingInParallel = true;
+    _recordingPool->run(count, [&](ssize_t task, int thread) {
+        auto& recorded = _recordedCommands[task];
+        _recordingThreads[thread].second = &recorded;
+
+        recorded.groupStack.push(parentQueueID);
+        nodes.at(first + task)->visit(this, parentTransform, parentFlags);
+        recorded.groupStack.pop();
+    });
+    _isRecordingInParallel = false;
+
+    // merge in node order, so that the queues are the same as the ones of a serial visit
+    for (ssize_t task = 0; task < count; ++task)
+    {
+        auto& recorded = _recordedCommands[task];
+        for (const auto& queue : recorded.queues)
+        {
+            _renderGroups[queue.first].append(queue.second);
+        }
+        recorded.clear();
+    }
+}
+
 void Renderer::processRenderCommand(RenderCommand* command)
 {
     auto commandType = command->getType();
@@ -388,6 +967,9 @@ void Renderer::processRenderCommand(RenderCommand* command)
             CCASSERT(cmd->getVertexCount()>= 0 && cmd->getVertexCount() < VBO_SIZE, "VBO for vertex is not big enough, please break the data down or use customized render command");
             CCASSERT(cmd->getIndexCount()>= 0 && cmd->getIndexCount() < INDEX_VBO_SIZE, "VBO for index is not big enough, please break the data down or use customized render command");
             drawBatchedTriangles();
+
+            if (_batchDiagnostics)
+                _batchDiagnostics->setPendingReason(BatchDiagnostics::BreakReason::BUFFER_FULL);
         }
         
         // queue it
@@ -400,10 +982,20 @@ void Renderer::processRenderCommand(RenderCommand* command)
         flush2D();
         auto cmd = static_cast<MeshCommand*>(command);
         
-        if (cmd->isSkipBatching() || _lastBatchedMeshCommand == nullptr || _lastBatchedMeshCommand->getMaterialID() != cmd->getMaterialID())
+        if (cmd->isInstanced() && !cmd->isSkipBatching() && _instanceVBO != 0)
+        {
+            // queue consecutive instances of the same mesh, they are drawn together by flush3D()
+            if (_queuedInstancedMeshCommands.empty() || _queuedInstancedMeshCommands.front()->getInstanceKey() != cmd->getInstanceKey())
+                flush3D();
+            _queuedInstancedMeshCommands.push_back(cmd);
+        }
+        else if (cmd->isSkipBatching() || _lastBatchedMeshCommand == nullptr || _lastBatchedMeshCommand->getMaterialID() != cmd->getMaterialID())
         {
             flush3D();
 
+            if (_batchDiagnostics)
+                _batchDiagnostics->addDraw(cmd, cmd->isSkipBatching() ? BatchDiagnostics::BreakReason::SKIP_BATCHING : BatchDiagnostics::BreakReason::MESH_COMMAND);
+
             CCGL_DEBUG_INSERT_EVENT_MARKER("RENDERER_MESH_COMMAND");
 
             if(cmd->isSkipBatching())
@@ -424,15 +1016,27 @@ void Renderer::processRenderCommand(RenderCommand* command)
         {
             CCGL_DEBUG_INSERT_EVENT_MARKER("RENDERER_MESH_COMMAND");
             cmd->batchDraw();
+
+            if (_batchDiagnostics)
+                _batchDiagnostics->addDraw(cmd, BatchDiagnostics::BreakReason::MESH_COMMAND);
         }
+
+        // the next triangles are drawn after a mesh, flush2D() set the reason to a queue change
+        if (_batchDiagnostics)
+            _batchDiagnostics->setPendingReason(BatchDiagnostics::BreakReason::MESH_COMMAND);
     }
     else if(RenderCommand::Type::GROUP_COMMAND == commandType)
     {
         flush();
         int renderQueueID = ((GroupCommand*) command)->getRenderQueueID();
+        auto& renderGroups = _executingSegment ? _executingSegment->queues : _renderGroups;
+        if (_batchDiagnostics)
+            _batchDiagnostics->setPendingReason(BatchDiagnostics::BreakReason::GROUP_COMMAND);
         CCGL_DEBUG_PUSH_GROUP_MARKER("RENDERER_GROUP_COMMAND");
-        visitRenderQueue(_renderGroups[renderQueueID]);
+        visitRenderQueue(renderGroups[renderQueueID]);
         CCGL_DEBUG_POP_GROUP_MARKER();
+        if (_batchDiagnostics)
+            _batchDiagnostics->setPendingReason(BatchDiagnostics::BreakReason::GROUP_COMMAND);
     }
     else if(RenderCommand::Type::CUSTOM_COMMAND == commandType)
     {
@@ -440,6 +1044,14 @@ void Renderer::processRenderCommand(RenderCommand* command)
         auto cmd = static_cast<CustomCommand*>(command);
         CCGL_DEBUG_INSERT_EVENT_MARKER("RENDERER_CUSTOM_COMMAND");
         cmd->execute();
+        // the callback may have changed the GL state without the cache
+        GL::invalidateRenderStateCache();
+
+        if (_batchDiagnostics)
+        {
+            _batchDiagnostics->addDraw(cmd, BatchDiagnostics::BreakReason::CUSTOM_COMMAND);
+            _batchDiagnostics->setPendingReason(BatchDiagnostics::BreakReason::CUSTOM_COMMAND);
+        }
     }
     else if(RenderCommand::Type::BATCH_COMMAND == commandType)
     {
@@ -447,6 +1059,12 @@ void Renderer::processRenderCommand(RenderCommand* command)
         auto cmd = static_cast<BatchCommand*>(command);
         CCGL_DEBUG_INSERT_EVENT_MARKER("RENDERER_BATCH_COMMAND");
         cmd->execute();
+
+        if (_batchDiagnostics)
+        {
+            _batchDiagnostics->addDraw(cmd, BatchDiagnostics::BreakReason::BATCH_COMMAND);
+            _batchDiagnostics->setPendingReason(BatchDiagnostics::BreakReason::BATCH_COMMAND);
+        }
     }
     else if(RenderCommand::Type::PRIMITIVE_COMMAND == commandType)
     {
@@ -454,6 +1072,12 @@ void Renderer::processRenderCommand(RenderCommand* command)
         auto cmd = static_cast<PrimitiveCommand*>(command);
         CCGL_DEBUG_INSERT_EVENT_MARKER("RENDERER_PRIMITIVE_COMMAND");
         cmd->execute();
+
+        if (_batchDiagnostics)
+        {
+            _batchDiagnostics->addDraw(cmd, BatchDiagnostics::BreakReason::PRIMITIVE_COMMAND);
+            _batchDiagnostics->setPendingReason(BatchDiagnostics::BreakReason::PRIMITIVE_COMMAND);
+        }
     }
     else
     {
@@ -473,23 +1097,23 @@ void Renderer::visitRenderQueue(RenderQueue& queue)
     {
         if(_isDepthTestFor2D)
         {
-            glEnable(GL_DEPTH_TEST);
-            glDepthMask(true);
-            glEnable(GL_BLEND);
+            GL::enable(GL_DEPTH_TEST);
+            GL::depthMask(true);
+            GL::enable(GL_BLEND);
             RenderState::StateBlock::_defaultState->setDepthTest(true);
             RenderState::StateBlock::_defaultState->setDepthWrite(true);
             RenderState::StateBlock::_defaultState->setBlend(true);
         }
         else
         {
-            glDisable(GL_DEPTH_TEST);
-            glDepthMask(false);
-            glEnable(GL_BLEND);
+            GL::disable(GL_DEPTH_TEST);
+            GL::depthMask(false);
+            GL::enable(GL_BLEND);
             RenderState::StateBlock::_defaultState->setDepthTest(false);
             RenderState::StateBlock::_defaultState->setDepthWrite(false);
             RenderState::StateBlock::_defaultState->setBlend(true);
         }
-        glDisable(GL_CULL_FACE);
+        GL::disable(GL_CULL_FACE);
         RenderState::StateBlock::_defaultState->setCullFace(false);
         
         for (auto it = zNegQueue.cbegin(); it != zNegQueue.cend(); ++it)
@@ -506,10 +1130,10 @@ void Renderer::visitRenderQueue(RenderQueue& queue)
     if (opaqueQueue.size() > 0)
     {
         //Clear depth to achieve layered rendering
-        glEnable(GL_DEPTH_TEST);
-        glDepthMask(true);
-        glDisable(GL_BLEND);
-        glEnable(GL_CULL_FACE);
+        GL::enable(GL_DEPTH_TEST);
+        GL::depthMask(true);
+        GL::disable(GL_BLEND);
+        GL::enable(GL_CULL_FACE);
         RenderState::StateBlock::_defaultState->setDepthTest(true);
         RenderState::StateBlock::_defaultState->setDepthWrite(true);
         RenderState::StateBlock::_defaultState->setBlend(false);
@@ -529,10 +1153,10 @@ void Renderer::visitRenderQueue(RenderQueue& queue)
     const auto& transQueue = queue.getSubQueue(RenderQueue::QUEUE_GROUP::TRANSPARENT_3D);
     if (transQueue.size() > 0)
     {
-        glEnable(GL_DEPTH_TEST);
-        glDepthMask(false);
-        glEnable(GL_BLEND);
-        glEnable(GL_CULL_FACE);
+        GL::enable(GL_DEPTH_TEST);
+        GL::depthMask(false);
+        GL::enable(GL_BLEND);
+        GL::enable(GL_CULL_FACE);
 
         RenderState::StateBlock::_defaultState->setDepthTest(true);
         RenderState::StateBlock::_defaultState->setDepthWrite(false);
@@ -555,9 +1179,9 @@ void Renderer::visitRenderQueue(RenderQueue& queue)
     {
         if(_isDepthTestFor2D)
         {
-            glEnable(GL_DEPTH_TEST);
-            glDepthMask(true);
-            glEnable(GL_BLEND);
+            GL::enable(GL_DEPTH_TEST);
+            GL::depthMask(true);
+            GL::enable(GL_BLEND);
 
             RenderState::StateBlock::_defaultState->setDepthTest(true);
             RenderState::StateBlock::_defaultState->setDepthWrite(true);
@@ -565,15 +1189,15 @@ void Renderer::visitRenderQueue(RenderQueue& queue)
         }
         else
         {
-            glDisable(GL_DEPTH_TEST);
-            glDepthMask(false);
-            glEnable(GL_BLEND);
+            GL::disable(GL_DEPTH_TEST);
+            GL::depthMask(false);
+            GL::enable(GL_BLEND);
 
             RenderState::StateBlock::_defaultState->setDepthTest(false);
             RenderState::StateBlock::_defaultState->setDepthWrite(false);
             RenderState::StateBlock::_defaultState->setBlend(true);
         }
-        glDisable(GL_CULL_FACE);
+        GL::disable(GL_CULL_FACE);
         RenderState::StateBlock::_defaultState->setCullFace(false);
         
         for (auto it = zZeroQueue.cbegin(); it != zZeroQueue.cend(); ++it)
@@ -591,9 +1215,9 @@ void Renderer::visitRenderQueue(RenderQueue& queue)
     {
         if(_isDepthTestFor2D)
         {
-            glEnable(GL_DEPTH_TEST);
-            glDepthMask(true);
-            glEnable(GL_BLEND);
+            GL::enable(GL_DEPTH_TEST);
+            GL::depthMask(true);
+            GL::enable(GL_BLEND);
             
             RenderState::StateBlock::_defaultState->setDepthTest(true);
             RenderState::StateBlock::_defaultState->setDepthWrite(true);
@@ -601,15 +1225,15 @@ void Renderer::visitRenderQueue(RenderQueue& queue)
         }
         else
         {
-            glDisable(GL_DEPTH_TEST);
-            glDepthMask(false);
-            glEnable(GL_BLEND);
+            GL::disable(GL_DEPTH_TEST);
+            GL::depthMask(false);
+            GL::enable(GL_BLEND);
             
             RenderState::StateBlock::_defaultState->setDepthTest(false);
             RenderState::StateBlock::_defaultState->setDepthWrite(false);
             RenderState::StateBlock::_defaultState->setBlend(true);
         }
-        glDisable(GL_CULL_FACE);
+        GL::disable(GL_CULL_FACE);
         RenderState::StateBlock::_defaultState->setCullFace(false);
         
         for (auto it = zPosQueue.cbegin(); it != zPosQueue.cend(); ++it)
@@ -624,6 +1248,16 @@ void Renderer::visitRenderQueue(RenderQueue& queue)
 
 void Renderer::render()
 {
+    // the commands added from now on are not drawn by a node
+    BatchDiagnostics::setDrawingNode(nullptr);
+
+    if (_glViewAssigned && !isRenderThread())
+    {
+        // the render thread executes them while the next ones are recorded
+        queueRenderGroups();
+        return;
+    }
+
     //Uncomment this once everything is rendered by new renderer
     //glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
@@ -662,65 +1296,357 @@ void Renderer::clean()
     _filledVertex = 0;
     _filledIndex = 0;
     _lastBatchedMeshCommand = nullptr;
+    _queuedInstancedMeshCommands.clear();
+
+    // the commands allocated from the arenas were rendered
+    for (auto arena : _frameArenas)
+    {
+        arena->reset();
+    }
 }
 
 void Renderer::clear()
 {
-    //Enable Depth mask to make sure glClear clear the depth buffer correctly
-    glDepthMask(true);
-    glClearColor(_clearColor.r, _clearColor.g, _clearColor.b, _clearColor.a);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    glDepthMask(false);
+    const Color4F clearColor = _clearColor;
+    runOnRenderThread([clearColor]() {
+        // what raw GL calls changed in the last frame is issued again
+        GL::invalidateRenderStateCache();
+        //Enable Depth mask to make sure glClear clear the depth buffer correctly
+        GL::depthMask(true);
+        glClearColor(clearColor.r, clearColor.g, clearColor.b, clearColor.a);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        GL::depthMask(false);
 
-    RenderState::StateBlock::_defaultState->setDepthWrite(false);
+        RenderState::StateBlock::_defaultState->setDepthWrite(false);
+    });
 }
 
 void Renderer::setDepthTest(bool enable)
 {
-    if (enable)
-    {
-        glClearDepth(1.0f);
-        glEnable(GL_DEPTH_TEST);
-        glDepthFunc(GL_LEQUAL);
+    runOnRenderThread([this, enable]() {
+        if (enable)
+        {
+            glClearDepth(1.0f);
+            GL::enable(GL_DEPTH_TEST);
+            GL::depthFunc(GL_LEQUAL);
 
-        RenderState::StateBlock::_defaultState->setDepthTest(true);
-        RenderState::StateBlock::_defaultState->setDepthFunction(RenderState::DEPTH_LEQUAL);
+            RenderState::StateBlock::_defaultState->setDepthTest(true);
+            RenderState::StateBlock::_defaultState->setDepthFunction(RenderState::DEPTH_LEQUAL);
+
+//            glHint(GL_PERSPECTIVE_CORRECTION_HINT, GL_NICEST);
+        }
+        else
+        {
+            GL::disable(GL_DEPTH_TEST);
+
+            RenderState::StateBlock::_defaultState->setDepthTest(false);
+        }
+
+        _isDepthTestFor2D = enable;
+        CHECK_GL_ERROR_DEBUG();
+    });
+}
 
-//        glHint(GL_PERSPECTIVE_CORRECTION_HINT, GL_NICEST);
+void Renderer::setPipelineEnabled(bool enabled)
+{
+    if (enabled == isPipelineEnabled())
+        return;
+
+    // the programs being precompiled use the shared context
+    GLProgramCache::getInstance()->waitForPrecompiledGLPrograms();
+
+    auto glview = Director::getInstance()->getOpenGLView();
+    if (enabled)
+    {
+        if (!_glViewAssigned || !glview || !glview->createSharedContext())
+        {
+            CCLOG("cocos2d: Renderer: the view can't create a shared context, the rendering isn't pipelined");
+            return;
+        }
+
+        // the render thread takes the context of the view, the main thread uses the shared one
+        glFinish();
+        glview->releaseCurrentContext();
+        _pipeline = new (std::nothrow) RenderPipeline(glview);
+        GL::setStateCacheThread(_pipeline->getThreadID());
+        glview->makeContextCurrent(true);
+        _recordedFrames = 0;
     }
     else
     {
-        glDisable(GL_DEPTH_TEST);
+        // the queued frames are rendered before the thread stops
+        glFinish();
+        delete _pipeline;
+        _pipeline = nullptr;
+        GL::setStateCacheThread(std::thread::id());
+        if (glview)
+        {
+            glview->makeContextCurrent(false);
+        }
 
-        RenderState::StateBlock::_defaultState->setDepthTest(false);
+        for (auto& frame : _pipelineFrames)
+        {
+            recycleFrame(frame);
+        }
     }
+}
 
-    _isDepthTestFor2D = enable;
-    CHECK_GL_ERROR_DEBUG();
+bool Renderer::isRenderThread() const
+{
+    return _pipeline == nullptr || std::this_thread::get_id() == _pipeline->getThreadID();
+}
+
+void Renderer::runOnRenderThread(const std::function<void()>& func, bool wait)
+{
+    if (isRenderThread())
+    {
+        func();
+        return;
+    }
+
+    auto step = _pipeline->push(func);
+    if (wait)
+    {
+        _pipeline->wait(step);
+    }
+}
+
+void Renderer::snapshotFrameStats()
+{
+    std::lock_guard<std::mutex> lock(_frameStatsMutex);
+    _frameStats.drawnBatches = _drawnBatches;
+    _frameStats.drawnVertices = _drawnVertices;
+    _frameStats.stateCache = GL::getStateCacheStats();
+}
+
+Renderer::FrameStats Renderer::getFrameStats() const
+{
+    std::lock_guard<std::mutex> lock(_frameStatsMutex);
+    return _frameStats;
+}
+
+void Renderer::retainForFrame(Ref* ref)
+{
+    if (!isRenderThread())
+    {
+        _pipelineFrames[_recordedFrames % PIPELINE_FRAMES].retained.pushBack(ref);
+    }
+}
+
+void Renderer::endFrame()
+{
+    if (_batchDiagnostics)
+    {
+        _batchDiagnostics->endFrame();
+    }
+
+    if (!_pipeline)
+        return;
+
+    _pipelineFrames[_recordedFrames % PIPELINE_FRAMES].lastStep = _pipeline->getQueuedSteps();
+    ++_recordedFrames;
+
+    // the next frame is recorded into the storage of the previous one
+    auto& frame = _pipelineFrames[_recordedFrames % PIPELINE_FRAMES];
+    _pipeline->wait(frame.lastStep);
+    recycleFrame(frame);
+}
+
+void Renderer::waitForRenderThread()
+{
+    if (_pipeline)
+    {
+        _pipeline->wait(_pipeline->getQueuedSteps());
+    }
+}
+
+const Mat4& Renderer::getProjectionMatrix() const
+{
+    if (_pipeline && isRenderThread() && _executingSegment && !_executingSegment->synchronous)
+        return _executingSegment->projection;
+
+    return Director::getInstance()->getMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_PROJECTION);
+}
+
+void Renderer::queueRenderGroups()
+{
+    auto& frame = _pipelineFrames[_recordedFrames % PIPELINE_FRAMES];
+    if (frame.usedSegments == frame.segments.size())
+    {
+        frame.segments.push_back(new (std::nothrow) RenderSegment());
+    }
+    auto segment = frame.segments[frame.usedSegments++];
+
+    // the segment takes the queues, the ones it had were cleared by the render thread
+    segment->queues.swap(_renderGroups);
+    _renderGroups.resize(segment->queues.size());
+    segment->projection = Director::getInstance()->getMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_PROJECTION);
+    // the batch diagnostics look the commands up by address, they are not copied
+    segment->synchronous = (_batchDiagnostics != nullptr);
+
+    // Only the triangles commands without uniforms can be copied, the other ones read
+    // the state of their node when they are executed
+    size_t vertexCount = 0;
+    size_t indexCount = 0;
+    for (auto& queue : segment->queues)
+    {
+        for (int group = 0; group < RenderQueue::QUEUE_COUNT && !segment->synchronous; ++group)
+        {
+            for (const auto command : queue.getSubQueue((RenderQueue::QUEUE_GROUP)group))
+            {
+                auto type = command->getType();
+                if (type == RenderCommand::Type::TRIANGLES_COMMAND && static_cast<TrianglesCommand*>(command)->getGLProgramState()->getUniformCount() == 0)
+                {
+                    auto cmd = static_cast<TrianglesCommand*>(command);
+                    vertexCount += cmd->getVertexCount();
+                    indexCount += cmd->getIndexCount();
+                }
+                else if (type != RenderCommand::Type::GROUP_COMMAND)
+                {
+                    segment->synchronous = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    if (!segment->synchronous)
+    {
+        segment->vertices.resize(vertexCount);
+        segment->indices.resize(indexCount);
+        V3F_C4B_T2F* vertices = segment->vertices.data();
+        unsigned short* indices = segment->indices.data();
+
+        for (auto& queue : segment->queues)
+        {
+            for (int group = 0; group < RenderQueue::QUEUE_COUNT; ++group)
+            {
+                for (auto& command : queue.getSubQueue((RenderQueue::QUEUE_GROUP)group))
+                {
+                    if (command->getType() != RenderCommand::Type::TRIANGLES_COMMAND)
+                        continue;
+
+                    auto cmd = static_cast<TrianglesCommand*>(command);
+                    auto copy = frame.commandPool.generateFrameCommand();
+                    *copy = *cmd;
+
+                    TrianglesCommand::Triangles triangles = cmd->getTriangles();
+                    memcpy(vertices, triangles.verts, sizeof(V3F_C4B_T2F) * triangles.vertCount);
+                    memcpy(indices, triangles.indices, sizeof(unsigned short) * triangles.indexCount);
+                    triangles.verts = vertices;
+                    triangles.indices = indices;
+                    vertices += triangles.vertCount;
+                    indices += triangles.indexCount;
+                    copy->setTriangles(triangles);
+
+                    // consecutive commands usually share their state
+                    auto glProgramState = copy->getGLProgramState();
+                    if (frame.retained.empty() || frame.retained.back() != glProgramState)
+                    {
+                        frame.retained.pushBack(glProgramState);
+                    }
+                    command = copy;
+                }
+            }
+        }
+    }
+
+    // makes the objects created by the main thread visible to the render thread
+    glFlush();
+    runOnRenderThread([this, segment]() {
+        executeSegment(segment);
+    }, segment->synchronous);
 }
 
-void Renderer::fillVerticesAndIndices(const TrianglesCommand* cmd)
+void Renderer::executeSegment(RenderSegment* segment)
 {
-    memcpy(&_verts[_filledVertex], cmd->getVertices(), sizeof(V3F_C4B_T2F) * cmd->getVertexCount());
+    _executingSegment = segment;
 
-    // fill vertex, and convert them to world coordinates
+    for (auto& queue : segment->queues)
+    {
+        queue.sort();
+    }
+    visitRenderQueue(segment->queues[0]);
+
+    for (auto& queue : segment->queues)
+    {
+        queue.clear();
+    }
+    _queuedTriangleCommands.clear();
+    _filledVertex = 0;
+    _filledIndex = 0;
+    _lastBatchedMeshCommand = nullptr;
+    _queuedInstancedMeshCommands.clear();
+
+    _executingSegment = nullptr;
+}
+
+void Renderer::recycleFrame(PipelineFrame& frame)
+{
+    frame.commandPool.recycleFrameCommands();
+    frame.usedSegments = 0;
+    frame.retained.clear();
+    for (auto arena : frame.arenas)
+    {
+        arena->reset();
+    }
+    frame.lastStep = 0;
+}
+
+void Renderer::fillVerticesAndIndices(const TrianglesCommand* cmd, V3F_C4B_T2F* vertices, GLushort* indices)
+{
+    // fill vertex, and convert them to world coordinates.
+    // The destination may be mapped GPU memory, so it is only written, and written in order.
     const Mat4& modelView = cmd->getModelView();
+    const V3F_C4B_T2F* src = cmd->getVertices();
+    V3F_C4B_T2F* dst = vertices + _filledVertex;
     for(ssize_t i=0; i < cmd->getVertexCount(); ++i)
     {
-        modelView.transformPoint(&(_verts[i + _filledVertex].vertices));
+        V3F_C4B_T2F vertex = src[i];
+        modelView.transformPoint(&vertex.vertices);
+        dst[i] = vertex;
     }
 
     // fill index
-    const unsigned short* indices = cmd->getIndices();
+    const unsigned short* cmdIndices = cmd->getIndices();
     for(ssize_t i=0; i< cmd->getIndexCount(); ++i)
     {
-        _indices[_filledIndex + i] = _filledVertex + indices[i];
+        indices[_filledIndex + i] = _filledVertex + cmdIndices[i];
     }
 
     _filledVertex += cmd->getVertexCount();
     _filledIndex += cmd->getIndexCount();
 }
 
+bool Renderer::mapStreamBuffers(V3F_C4B_T2F** vertices, GLushort** indices)
+{
+    GL::bindVAO(_buffersVAO[_currentBuffer]);
+
+    // The buffers were last drawn VBO_RING_SIZE flushes ago, so the GPU is usually done reading them
+    // and mapping doesn't wait. The element buffer is part of the VAO state.
+    glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[_currentBuffer][0]);
+    *vertices = (V3F_C4B_T2F*) glMapBuffer(GL_ARRAY_BUFFER, GL_WRITE_ONLY);
+    *indices = (GLushort*) glMapBuffer(GL_ELEMENT_ARRAY_BUFFER, GL_WRITE_ONLY);
+
+    if (*vertices && *indices)
+        return true;
+
+    // fall back to the client side copy
+    if (*vertices)
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+    if (*indices)
+        glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return false;
+}
+
+void Renderer::unmapStreamBuffers()
+{
+    glUnmapBuffer(GL_ARRAY_BUFFER);
+    glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
 void Renderer::drawBatchedTriangles()
 {
     if(_queuedTriangleCommands.empty())
@@ -731,6 +1657,22 @@ void Renderer::drawBatchedTriangles()
     _filledVertex = 0;
     _filledIndex = 0;
 
+    auto conf = Configuration::getInstance();
+
+    // Advance the ring, the buffers written by the previous flushes may still be read by the GPU
+    _currentBuffer = (_currentBuffer + 1) % VBO_RING_SIZE;
+
+    // With VAO and map buffer support the commands are written straight into the stream buffers,
+    // otherwise they are gathered in _verts and _indices first and uploaded afterwards.
+    V3F_C4B_T2F* vertices = _verts;
+    GLushort* indices = _indices;
+    bool mapped = conf->supportsShareableVAO() && conf->supportsMapBuffer() && mapStreamBuffers(&vertices, &indices);
+    if (!mapped)
+    {
+        vertices = _verts;
+        indices = _indices;
+    }
+
     /************** 1: Setup up vertices/indices *************/
 
     _triBatchesToDraw[0].offset = 0;
@@ -739,20 +1681,39 @@ void Renderer::drawBatchedTriangles()
 
     int batchesTotal = 0;
     int prevMaterialID = -1;
+    bool prevMultiTexture = false;
     bool firstCommand = true;
+    bool multiTextureUsed = false;
 
     for(auto it = std::begin(_queuedTriangleCommands); it != std::end(_queuedTriangleCommands); ++it)
     {
         const auto& cmd = *it;
-        auto currentMaterialID = cmd->getMaterialID();
         const bool batchable = !cmd->isSkipBatching();
+        const bool multiTexture = isMultiTextureBatchable(cmd);
 
-        fillVerticesAndIndices(cmd);
+        // the multi texture batches share the program, only the blend function splits them
+        const auto& blend = cmd->getBlendType();
+        auto currentMaterialID = multiTexture ? ((uint32_t)blend.src << 16 | blend.dst) : cmd->getMaterialID();
 
         // in the same batch ?
-        if (batchable && (prevMaterialID == currentMaterialID || firstCommand))
+        bool sameBatch = batchable && !firstCommand && prevMaterialID == currentMaterialID && prevMultiTexture == multiTexture;
+        int textureUnit = 0;
+        if (sameBatch && multiTexture)
         {
-            CC_ASSERT(firstCommand || _triBatchesToDraw[batchesTotal].cmd->getMaterialID() == cmd->getMaterialID() && "argh... error in logic");
+            textureUnit = addBatchTexture(batchesTotal, cmd->getTextureID());
+            sameBatch = textureUnit >= 0;
+        }
+
+        if (_batchDiagnostics && !sameBatch)
+        {
+            auto reason = firstCommand ? _batchDiagnostics->getPendingReason()
+                : (textureUnit < 0 ? BatchDiagnostics::BreakReason::TEXTURE : getBreakReason(_triBatchesToDraw[batchesTotal].cmd, cmd));
+            _batchDiagnostics->addDraw(cmd, reason);
+        }
+
+        if (sameBatch)
+        {
+            CC_ASSERT((multiTexture || _triBatchesToDraw[batchesTotal].cmd->getMaterialID() == cmd->getMaterialID()) && "argh... error in logic");
             _triBatchesToDraw[batchesTotal].indicesToDraw += cmd->getIndexCount();
             _triBatchesToDraw[batchesTotal].cmd = cmd;
         }
@@ -764,14 +1725,28 @@ void Renderer::drawBatchedTriangles()
                 _triBatchesToDraw[batchesTotal].offset = _triBatchesToDraw[batchesTotal-1].offset + _triBatchesToDraw[batchesTotal-1].indicesToDraw;
             }
 
-            _triBatchesToDraw[batchesTotal].cmd = cmd;
-            _triBatchesToDraw[batchesTotal].indicesToDraw = (int) cmd->getIndexCount();
+            auto& batch = _triBatchesToDraw[batchesTotal];
+            batch.cmd = cmd;
+            batch.indicesToDraw = (int) cmd->getIndexCount();
+            batch.multiTexture = multiTexture;
+            batch.textureCount = 1;
+            batch.textures[0] = cmd->getTextureID();
+            textureUnit = 0;
 
             // is this a single batch ? Prevent creating a batch group then
             if (!batchable)
                 currentMaterialID = -1;
         }
 
+        if (multiTexture)
+        {
+            // before fillVerticesAndIndices() moves _filledVertex
+            std::fill(_textureIndices + _filledVertex, _textureIndices + _filledVertex + cmd->getVertexCount(), (GLfloat)textureUnit);
+            multiTextureUsed = true;
+        }
+
+        fillVerticesAndIndices(cmd, vertices, indices);
+
         // capacity full ?
         if (batchesTotal + 1 >= _triBatchesToDrawCapacity) {
             _triBatchesToDrawCapacity *= 1.4;
@@ -779,48 +1754,38 @@ void Renderer::drawBatchedTriangles()
         }
 
         prevMaterialID = currentMaterialID;
+        prevMultiTexture = multiTexture;
         firstCommand = false;
     }
     batchesTotal++;
 
     /************** 2: Copy vertices/indices to GL objects *************/
-    auto conf = Configuration::getInstance();
-    if (conf->supportsShareableVAO() && conf->supportsMapBuffer())
+    if (mapped)
+    {
+        // VAO is still bound
+        unmapStreamBuffers();
+    }
+    else if (conf->supportsShareableVAO())
     {
         //Bind VAO
-        GL::bindVAO(_buffersVAO);
-        //Set VBO data
-        glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
-
-        // option 1: subdata
-//        glBufferSubData(GL_ARRAY_BUFFER, sizeof(_quads[0])*start, sizeof(_quads[0]) * n , &_quads[start] );
-
-        // option 2: data
-//        glBufferData(GL_ARRAY_BUFFER, sizeof(_verts[0]) * _filledVertex, _verts, GL_STATIC_DRAW);
-
-        // option 3: orphaning + glMapBuffer
-        // FIXME: in order to work as fast as possible, it must "and the exact same size and usage hints it had before."
-        //  source: https://www.opengl.org/wiki/Buffer_Object_Streaming#Explicit_multiple_buffering
-        // so most probably we won't have any benefit of using it
-        glBufferData(GL_ARRAY_BUFFER, sizeof(_verts[0]) * _filledVertex, nullptr, GL_STATIC_DRAW);
-        void *buf = glMapBuffer(GL_ARRAY_BUFFER, GL_WRITE_ONLY);
-        memcpy(buf, _verts, sizeof(_verts[0]) * _filledVertex);
-        glUnmapBuffer(GL_ARRAY_BUFFER);
+        GL::bindVAO(_buffersVAO[_currentBuffer]);
 
+        // The buffer keeps its size, only the used part is updated
+        glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[_currentBuffer][0]);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(_verts[0]) * _filledVertex, _verts);
         glBindBuffer(GL_ARRAY_BUFFER, 0);
-        
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_indices[0]) * _filledIndex, _indices, GL_STATIC_DRAW);
+
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, sizeof(_indices[0]) * _filledIndex, _indices);
     }
     else
     {
         // Client Side Arrays
 #define kQuadSize sizeof(_verts[0])
-        glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[0]);
+        glBindBuffer(GL_ARRAY_BUFFER, _buffersVBO[_currentBuffer][0]);
 
         glBufferData(GL_ARRAY_BUFFER, sizeof(_verts[0]) * _filledVertex , _verts, GL_DYNAMIC_DRAW);
 
-        GL::enableVertexAttribs(GL::VERTEX_ATTRIB_FLAG_POS_COLOR_TEX);
+        GL::enableVertexAttribs(GL::VERTEX_ATTRIB_FLAG_POS_COLOR_TEX | (multiTextureUsed ? 1 << GLProgram::VERTEX_ATTRIB_TEXTURE_INDEX : 0));
 
         // vertices
         glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 3, GL_FLOAT, GL_FALSE, kQuadSize, (GLvoid*) offsetof(V3F_C4B_T2F, vertices));
@@ -831,15 +1796,44 @@ void Renderer::drawBatchedTriangles()
         // tex coords
         glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEX_COORD, 2, GL_FLOAT, GL_FALSE, kQuadSize, (GLvoid*) offsetof(V3F_C4B_T2F, texCoords));
 
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[1]);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_indices[0]) * _filledIndex, _indices, GL_STATIC_DRAW);
+        if (multiTextureUsed)
+        {
+            glBindBuffer(GL_ARRAY_BUFFER, _textureIndexVBO[_currentBuffer]);
+            glBufferData(GL_ARRAY_BUFFER, sizeof(_textureIndices[0]) * _filledVertex, _textureIndices, GL_DYNAMIC_DRAW);
+            glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_TEXTURE_INDEX, 1, GL_FLOAT, GL_FALSE, sizeof(GLfloat), (GLvoid*) 0);
+        }
+
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _buffersVBO[_currentBuffer][1]);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(_indices[0]) * _filledIndex, _indices, GL_DYNAMIC_DRAW);
+    }
+
+    if (multiTextureUsed && conf->supportsShareableVAO())
+    {
+        // the VAO already points to the buffer
+        glBindBuffer(GL_ARRAY_BUFFER, _textureIndexVBO[_currentBuffer]);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(_textureIndices[0]) * _filledVertex, _textureIndices);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
     }
 
     /************** 3: Draw *************/
     for (int i=0; i<batchesTotal; ++i)
     {
-        CC_ASSERT(_triBatchesToDraw[i].cmd && "Invalid batch");
-        _triBatchesToDraw[i].cmd->useMaterial();
+        const auto& batch = _triBatchesToDraw[i];
+        CC_ASSERT(batch.cmd && "Invalid batch");
+        if (batch.multiTexture)
+        {
+            for (int unit = 0; unit < batch.textureCount; ++unit)
+            {
+                GL::bindTexture2DN(unit, batch.textures[unit]);
+            }
+            GL::blendFunc(batch.cmd->getBlendType().src, batch.cmd->getBlendType().dst);
+            _multiTextureProgram->use();
+            _multiTextureProgram->setUniformsForBuiltins(batch.cmd->getModelView());
+        }
+        else
+        {
+            batch.cmd->useMaterial();
+        }
         glDrawElements(GL_TRIANGLES, (GLsizei) _triBatchesToDraw[i].indicesToDraw, GL_UNSIGNED_SHORT, (GLvoid*) (_triBatchesToDraw[i].offset*sizeof(_indices[0])) );
         _drawnBatches++;
         _drawnVertices += _triBatchesToDraw[i].indicesToDraw;
@@ -860,6 +1854,93 @@ void Renderer::drawBatchedTriangles()
     _queuedTriangleCommands.clear();
     _filledVertex = 0;
     _filledIndex = 0;
+
+    // unless the caller tells otherwise, the next triangles are in another render queue
+    if (_batchDiagnostics)
+        _batchDiagnostics->setPendingReason(BatchDiagnostics::BreakReason::QUEUE_CHANGE);
+}
+
+bool Renderer::isMultiTextureBatchable(const TrianglesCommand* cmd) const
+{
+    if (!_multiTextureProgram)
+        return false;
+
+    auto glProgramState = cmd->getGLProgramState();
+    return glProgramState->getGLProgram() == _spriteProgram && glProgramState->getUniformCount() == 0;
+}
+
+int Renderer::addBatchTexture(int batch, GLuint textureID)
+{
+    auto& textures = _triBatchesToDraw[batch].textures;
+    auto& textureCount = _triBatchesToDraw[batch].textureCount;
+    for (int unit = 0; unit < textureCount; ++unit)
+    {
+        if (textures[unit] == textureID)
+            return unit;
+    }
+
+    if (textureCount == MULTI_TEXTURE_UNITS)
+        return -1;
+
+    textures[textureCount] = textureID;
+    return textureCount++;
+}
+
+void Renderer::setMultiTextureBatchingEnabled(bool enabled)
+{
+    if (enabled == isMultiTextureBatchingEnabled())
+        return;
+
+    // the render thread might be flushing triangles
+    waitForRenderThread();
+    if (enabled)
+    {
+        auto glProgramCache = GLProgramCache::getInstance();
+        _multiTextureProgram = glProgramCache->getGLProgram(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_MULTI_TEXTURE_NO_MVP);
+        _spriteProgram = glProgramCache->getGLProgram(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_NO_MVP);
+        CC_SAFE_RETAIN(_multiTextureProgram);
+        CC_SAFE_RETAIN(_spriteProgram);
+    }
+    else
+    {
+        CC_SAFE_RELEASE_NULL(_multiTextureProgram);
+        CC_SAFE_RELEASE_NULL(_spriteProgram);
+    }
+}
+
+BatchDiagnostics::BreakReason Renderer::getBreakReason(const TrianglesCommand* previous, const TrianglesCommand* command) const
+{
+    if (previous->isSkipBatching() || command->isSkipBatching())
+        return BatchDiagnostics::BreakReason::SKIP_BATCHING;
+    if (previous->getTextureID() != command->getTextureID())
+        return BatchDiagnostics::BreakReason::TEXTURE;
+    if (previous->getGLProgramState()->getGLProgram() != command->getGLProgramState()->getGLProgram())
+        return BatchDiagnostics::BreakReason::PROGRAM;
+
+    const auto& previousBlend = previous->getBlendType();
+    const auto& blend = command->getBlendType();
+    if (previousBlend.src != blend.src || previousBlend.dst != blend.dst)
+        return BatchDiagnostics::BreakReason::BLEND;
+
+    return BatchDiagnostics::BreakReason::MATERIAL;
+}
+
+void Renderer::setBatchDiagnosticsEnabled(bool enabled)
+{
+    if (enabled == (_batchDiagnostics != nullptr))
+        return;
+
+    // the render thread might be drawing the commands of a frame recorded without them
+    waitForRenderThread();
+    if (enabled)
+    {
+        _batchDiagnostics = new (std::nothrow) BatchDiagnostics();
+    }
+    else
+    {
+        delete _batchDiagnostics;
+        _batchDiagnostics = nullptr;
+    }
 }
 
 void Renderer::flush()
@@ -882,6 +1963,41 @@ void Renderer::flush3D()
         _lastBatchedMeshCommand->postBatchDraw();
         _lastBatchedMeshCommand = nullptr;
     }
+
+    drawInstancedMeshes();
+}
+
+void Renderer::drawInstancedMeshes()
+{
+    auto count = _queuedInstancedMeshCommands.size();
+    if (count == 0)
+        return;
+
+    CCGL_DEBUG_INSERT_EVENT_MARKER("RENDERER_INSTANCED_MESH");
+
+    if (_batchDiagnostics)
+        _batchDiagnostics->addDraw(_queuedInstancedMeshCommands[0], BatchDiagnostics::BreakReason::MESH_COMMAND);
+
+    if (count == 1)
+    {
+        // nothing to share, the instance attributes are set as constant values
+        _queuedInstancedMeshCommands[0]->execute();
+    }
+    else
+    {
+        _instanceData.resize(count);
+        for (size_t i = 0; i < count; ++i)
+            _queuedInstancedMeshCommands[i]->getInstanceData(&_instanceData[i]);
+
+        // orphan the previous data, it might still be used by the GPU
+        glBindBuffer(GL_ARRAY_BUFFER, _instanceVBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(_instanceData[0]) * count, nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(_instanceData[0]) * count, _instanceData.data());
+
+        _queuedInstancedMeshCommands[0]->drawInstanced(_instanceVBO, count);
+    }
+
+    _queuedInstancedMeshCommands.clear();
 }
 
 void Renderer::flushTriangles()
@@ -26,12 +26,23 @@
 #ifndef __CC_RENDERER_H_
 #define __CC_RENDERER_H_
 
+#include <atomic>
+#include <functional>
 #include <vector>
 #include <stack>
+#include <mutex>
+#include <thread>
 
 #include "platform/CCPlatformMacros.h"
+#include "base/CCVector.h"
 #include "renderer/CCRenderCommand.h"
+#include "renderer/CCRenderCommandPool.h"
+#include "renderer/CCFrameArena.h"
+#include "renderer/CCBatchDiagnostics.h"
+#include "renderer/CCMeshCommand.h"
+#include "renderer/CCTrianglesCommand.h"
 #include "renderer/CCGLProgram.h"
+#include "renderer/ccGLStateCache.h"
 #include "platform/CCGL.h"
 
 #if !defined(NDEBUG) && CC_TARGET_PLATFORM == CC_PLATFORM_IOS
@@ -59,13 +70,17 @@
 NS_CC_BEGIN
 
 class EventListenerCustom;
-class TrianglesCommand;
-class MeshCommand;
+class Node;
+class RenderRecordingPool;
+class RenderPipeline;
+class OcclusionCuller;
 
 /** Class that knows how to sort `RenderCommand` objects.
  Since the commands that have `z == 0` are "pushed back" in
  the correct order, the only `RenderCommand` objects that need to be sorted,
- are the ones that have `z < 0` and `z > 0`.
+ are the ones that have `z < 0` and `z > 0`, the transparent 3D ones by depth, and the opaque 3D ones by material.
+ Commands are sorted by their sort key with a stable radix sort, so commands with the same key keep their order.
+ Opaque 3D commands that are not meshes keep their place, only the meshes between them are sorted.
 */
 class RenderQueue {
 public:
@@ -102,6 +117,8 @@ public:
     void clear();
     /**Realloc command queues and reserve with given size. Note: this clears any existing commands.*/
     void realloc(size_t reserveSize);
+    /**Append the commands of another queue after the ones of this queue, keeping their order.*/
+    void append(const RenderQueue& other);
     /**Get a sub group of the render queue.*/
     std::vector<RenderCommand*>& getSubQueue(QUEUE_GROUP group) { return _commands[group]; }
     /**Get the number of render commands contained in a subqueue.*/
@@ -113,8 +130,20 @@ public:
     void restoreRenderState();
     
 protected:
+    struct SortEntry
+    {
+        uint64_t key;
+        RenderCommand* command;
+    };
+
+    void sortSubQueue(QUEUE_GROUP group);
+    void sortCommands(std::vector<RenderCommand*>& commands, size_t begin, size_t end);
+
     /**The commands in the render queue.*/
     std::vector<RenderCommand*> _commands[QUEUE_COUNT];
+    /**Storage used while sorting, kept to avoid allocations on every frame.*/
+    std::vector<SortEntry> _sortEntries;
+    std::vector<SortEntry> _sortScratch;
     
     /**Cull state.*/
     bool _isCullEnabled;
@@ -144,10 +173,23 @@ public:
     static const int VBO_SIZE = 65536;
     /**The max number of indices in a index buffer.*/
     static const int INDEX_VBO_SIZE = VBO_SIZE * 6 / 4;
+    /**The number of vertex buffers the batched triangles are streamed through, in turn.*/
+    static const int VBO_RING_SIZE = 3;
     /**The rendercommands which can be batched will be saved into a list, this is the reserved size of this list.*/
     static const int BATCH_TRIAGCOMMAND_RESERVED_SIZE = 64;
     /**Reserved for material id, which means that the command could not be batched.*/
     static const int MATERIAL_ID_DO_NOT_BATCH = 0;
+    /**The max number of textures sampled by a multi texture batch.*/
+    static const int MULTI_TEXTURE_UNITS = 8;
+
+    /** Counters of a rendered frame, see getFrameStats(). @since v3.13 */
+    struct FrameStats
+    {
+        ssize_t drawnBatches;
+        ssize_t drawnVertices;
+        GL::StateCacheStats stateCache;
+    };
+
     /**Constructor.*/
     Renderer();
     /**Destructor.*/
@@ -193,6 +235,19 @@ public:
     /* clear draw stats */
     void clearDrawStats() { _drawnBatches = _drawnVertices = 0; }
 
+    /**
+     * Copies the draw and GL state cache counters of the frame, which getFrameStats() returns.
+     * The Director queues it on the render thread once the frame is rendered.
+     * @since v3.13
+     */
+    void snapshotFrameStats();
+    /**
+     * Returns the counters of the last frame the render thread is done with. Unlike getDrawnBatches(),
+     * it can be called by the main thread while the rendering is pipelined.
+     * @since v3.13
+     */
+    FrameStats getFrameStats() const;
+
     /**
      * Enable/Disable depth test
      * For 3D object depth test is enabled by default and can not be changed
@@ -206,15 +261,173 @@ public:
     /** returns whether or not a rectangle is visible or not */
     bool checkVisibility(const Mat4& transform, const Size& size);
 
+    /** Returns the occlusion culler, which tests the bounds of the 3D nodes against the occluders.
+     * @since v3.13
+     */
+    OcclusionCuller* getOcclusionCuller() const { return _occlusionCuller; }
+
+    /**
+     * Enables or disables the batch diagnostics, which record why each draw call couldn't be merged with the
+     * previous one and which node issued it. They slow down the recording and the rendering.
+     * @since v3.13
+     */
+    void setBatchDiagnosticsEnabled(bool enabled);
+    /**
+     * Enables or disables the multi texture batching.
+     * When it is enabled, the consecutive triangles commands drawn with the default sprite program and the same
+     * blend function are batched even if their textures differ: up to MULTI_TEXTURE_UNITS textures are bound at
+     * once, and a per vertex texture index selects the one each vertex samples.
+     * Sprites with custom programs or uniforms, and ETC1 sprites with an alpha texture, are batched as before.
+     * @since v3.13
+     */
+    void setMultiTextureBatchingEnabled(bool enabled);
+    /** Whether the multi texture batching is enabled. @since v3.13 */
+    bool isMultiTextureBatchingEnabled() const { return _multiTextureProgram != nullptr; }
+
+    /** Returns the batch diagnostics, or nullptr when they are disabled. @since v3.13 */
+    BatchDiagnostics* getBatchDiagnostics() const { return _batchDiagnostics; }
+
+    /**
+     * Sets the number of worker threads used by `visitInParallel()`.
+     * The calling thread always takes part in the visit, so 0 disables parallel recording.
+     */
+    void setRecordingThreadCount(int count);
+    /** Returns the number of worker threads used by `visitInParallel()`. */
+    int getRecordingThreadCount() const;
+
+    /**
+     * Visits the nodes in [first, last) on the recording threads.
+     * Every node records its commands into its own queue, and the queues are merged into the
+     * current render queue in node order once all the nodes were visited, so the result does not
+     * depend on the thread that visited each node.
+     * The visited subtrees must not issue GL calls nor rely on the Director matrix stack while visiting,
+     * the nodes whose subtree does are visited by the calling thread, see Node::isParallelVisitSafe().
+     */
+    void visitInParallel(const Vector<Node*>& nodes, ssize_t first, ssize_t last, const Mat4& parentTransform, uint32_t parentFlags);
+
+    /** Whether render commands are being recorded by several threads at the moment. */
+    bool isRecordingInParallel() const { return _isRecordingInParallel; }
+
+    /**
+     * Returns the arena the commands and the transient vertices of the frame being recorded can be allocated from.
+     * What is allocated from it lives until the commands were rendered: the arena is reset by clean(), or, when
+     * the rendering is pipelined, once the render thread is done with the frame.
+     * Every recording thread gets its own arena, so it has to be requested again by each visit() rather than kept.
+     * @since v3.13
+     */
+    FrameArena* getFrameArena();
+
+    /**
+     * Enables or disables the pipelined rendering.
+     * When it is enabled, the render queues recorded for a frame are executed by a render thread, which
+     * owns the GL context of the view, while the main thread updates and visits the next frame.
+     * The main thread keeps a context which shares the textures, buffers and programs with it, so resources
+     * can still be created while updating.
+     * Triangles and quads commands are copied into per-frame storage, which is double buffered, so the frame
+     * being recorded never writes into the one being drawn. The render queues with other commands, which read
+     * the state of their nodes when they are executed, are executed while the main thread waits.
+     * Only the views that can create a shared context support it, see GLView::createSharedContext().
+     * @since v3.13
+     */
+    void setPipelineEnabled(bool enabled);
+    /** Whether the rendering is pipelined. @since v3.13 */
+    bool isPipelineEnabled() const { return _pipeline != nullptr; }
+
+    /** Whether the calling thread is the render thread. Any thread is when the rendering isn't pipelined. @since v3.13 */
+    bool isRenderThread() const;
+
+    /**
+     * Runs func on the render thread, after the work already queued for it.
+     * It is run immediately when the rendering isn't pipelined or when called by the render thread.
+     * @param wait Whether to return only once func was run. Calls that use objects which aren't shared
+     * between contexts, like frame buffer objects and VAOs, must wait.
+     * @since v3.13
+     */
+    void runOnRenderThread(const std::function<void()>& func, bool wait = false);
+
+    /** Keeps ref alive until the render thread is done with the frame being recorded. @since v3.13 */
+    void retainForFrame(Ref* ref);
+
+    /**
+     * Ends the recorded frame. When the rendering is pipelined, it waits until the render thread is done
+     * with the previous frame, so it is never more than one frame behind.
+     * @since v3.13
+     */
+    void endFrame();
+
+    /** Waits until the render thread ran all the work queued for it. @since v3.13 */
+    void waitForRenderThread();
+
+    /**
+     * Returns the projection matrix of the commands being executed.
+     * The render thread uses the one captured when the commands were queued, since the Director already
+     * updates its matrix stack for the next frame.
+     * @since v3.13
+     */
+    const Mat4& getProjectionMatrix() const;
+
 protected:
+    // Commands recorded by one node visited in parallel, grouped by render queue ID
+    struct RecordedCommands
+    {
+        std::vector<std::pair<int, RenderQueue>> queues;
+        std::stack<int> groupStack;
+
+        void push_back(RenderCommand* command, int renderQueueID);
+        void clear();
+    };
+
+    RecordedCommands* getRecordedCommands();
+
+    // Makes sure there is an arena for each recording thread
+    void prepareFrameArenas(std::vector<FrameArena*>& arenas);
+    // Returns the arenas of the frame being recorded
+    std::vector<FrameArena*>& getFrameArenas();
+
+    // Render queues of a render() call, executed by the render thread
+    struct RenderSegment
+    {
+        std::vector<RenderQueue> queues;
+        Mat4 projection;
+        // copies of the triangles of the commands
+        std::vector<V3F_C4B_T2F> vertices;
+        std::vector<unsigned short> indices;
+        // whether the main thread waits until the segment is executed
+        bool synchronous;
+    };
+
+    // Storage of a frame recorded while the rendering is pipelined, reused once the render thread is done with it
+    struct PipelineFrame
+    {
+        RenderCommandPool<TrianglesCommand> commandPool;
+        std::vector<RenderSegment*> segments;
+        size_t usedSegments;
+        Vector<Ref*> retained;
+        // arenas of the frame, indexed by recording thread
+        std::vector<FrameArena*> arenas;
+        // last step queued for the frame
+        unsigned int lastStep;
+    };
+
+    static const int PIPELINE_FRAMES = 2;
+
+    // Hands the render queues to the render thread
+    void queueRenderGroups();
+    void executeSegment(RenderSegment* segment);
+    void recycleFrame(PipelineFrame& frame);
 
     //Setup VBO or VAO based on OpenGL extensions
     void setupBuffer();
     void setupVBOAndVAO();
+    void setupVAO(GLuint vao, const GLuint* vbo, GLuint textureIndexVBO);
     void setupVBO();
     void mapBuffers();
     void drawBatchedTriangles();
 
+    // Maps the current buffers of the ring, returns false if they couldn't be mapped
+    bool mapStreamBuffers(V3F_C4B_T2F** vertices, GLushort** indices);
+    void unmapStreamBuffers();
+
     //Draw the previews queued triangles and flush previous context
     void flush();
     
@@ -224,10 +437,21 @@ protected:
 
     void flushTriangles();
 
+    // Draws the queued instanced mesh commands with a single instanced draw call
+    void drawInstancedMeshes();
+
     void processRenderCommand(RenderCommand* command);
     void visitRenderQueue(RenderQueue& queue);
 
-    void fillVerticesAndIndices(const TrianglesCommand* cmd);
+    void fillVerticesAndIndices(const TrianglesCommand* cmd, V3F_C4B_T2F* vertices, GLushort* indices);
+
+    // Whether the command can be drawn by a multi texture batch
+    bool isMultiTextureBatchable(const TrianglesCommand* cmd) const;
+    // Returns the unit of the texture in the batch, adding it if needed, or -1 if all the units are used
+    int addBatchTexture(int batch, GLuint textureID);
+
+    // Why two consecutive triangles commands couldn't be drawn by the same draw call
+    BatchDiagnostics::BreakReason getBreakReason(const TrianglesCommand* previous, const TrianglesCommand* command) const;
 
 
     /* clear color set outside be used in setGLDefaultValues() */
@@ -238,19 +462,36 @@ protected:
     std::vector<RenderQueue> _renderGroups;
 
     MeshCommand* _lastBatchedMeshCommand;
+    std::vector<MeshCommand*> _queuedInstancedMeshCommands;
+    std::vector<MeshCommand::InstanceData> _instanceData;
+    GLuint _instanceVBO;
     std::vector<TrianglesCommand*> _queuedTriangleCommands;
 
     //for TrianglesCommand
     V3F_C4B_T2F _verts[VBO_SIZE];
     GLushort _indices[INDEX_VBO_SIZE];
-    GLuint _buffersVAO;
-    GLuint _buffersVBO[2]; //0: vertex  1: indices
+    GLuint _buffersVAO[VBO_RING_SIZE];
+    GLuint _buffersVBO[VBO_RING_SIZE][2]; //0: vertex  1: indices
+    // index in the ring of the buffers used by the last flush
+    int _currentBuffer;
+
+    // multi texture batching, the program is used without a GLProgramState: the state would bind
+    // its sampler uniforms to texture 0 after the textures of the batch are bound
+    GLProgram* _multiTextureProgram;
+    // the commands batched with the multi texture program are the ones using this program without uniforms
+    GLProgram* _spriteProgram;
+    GLfloat _textureIndices[VBO_SIZE];
+    GLuint _textureIndexVBO[VBO_RING_SIZE];
 
     // Internal structure that has the information for the batches
     struct TriBatchToDraw {
         TrianglesCommand* cmd;  // needed for the Material
         GLushort indicesToDraw;
         GLushort offset;
+        // textures bound to the first units when the batch draws with the multi texture program
+        bool multiTexture;
+        int textureCount;
+        GLuint textures[MULTI_TEXTURE_UNITS];
     };
     // capacity of the array of TriBatches
     int _triBatchesToDrawCapacity;
@@ -262,15 +503,39 @@ protected:
 
     bool _glViewAssigned;
 
-    // stats
-    ssize_t _drawnBatches;
-    ssize_t _drawnVertices;
+    // stats, updated by the render thread
+    std::atomic<ssize_t> _drawnBatches;
+    std::atomic<ssize_t> _drawnVertices;
+    // counters of the last rendered frame, read by the main thread
+    FrameStats _frameStats;
+    mutable std::mutex _frameStatsMutex;
     //the flag for checking whether renderer is rendering
     bool _isRendering;
     
     bool _isDepthTestFor2D;
     
     GroupCommandManager* _groupCommandManager;
+
+    OcclusionCuller* _occlusionCuller;
+
+    BatchDiagnostics* _batchDiagnostics;
+
+    // parallel recording
+    RenderRecordingPool* _recordingPool;
+    std::vector<RecordedCommands> _recordedCommands;
+    // the commands each recording thread is writing into, indexed by recording thread
+    std::vector<std::pair<std::thread::id, RecordedCommands*>> _recordingThreads;
+    std::mutex _renderQueueMutex;
+    bool _isRecordingInParallel;
+
+    // arenas of the frame, indexed by recording thread, when the rendering isn't pipelined
+    std::vector<FrameArena*> _frameArenas;
+
+    // pipelined rendering
+    RenderPipeline* _pipeline;
+    PipelineFrame _pipelineFrames[PIPELINE_FRAMES];
+    unsigned int _recordedFrames;
+    RenderSegment* _executingSegment;
     
 #if CC_ENABLE_CACHE_TEXTURE_DATA
     EventListenerCustom* _cacheTextureListener;
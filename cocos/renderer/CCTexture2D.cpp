@@ -33,6 +33,10 @@ THE SOFTWARE.
 
 #include "renderer/CCTexture2D.h"
 
+#include <algorithm>
+#include <cmath>
+#include <climits>
+
 #include "platform/CCGL.h"
 #include "platform/CCImage.h"
 #include "base/ccUtils.h"
@@ -46,7 +50,9 @@ THE SOFTWARE.
 #include "renderer/CCGLProgram.h"
 #include "renderer/ccGLStateCache.h"
 #include "renderer/CCGLProgramCache.h"
+#include "renderer/CCTextureStreamer.h"
 #include "base/CCNinePatchImageParser.h"
+#include "math/MathUtil.h"
 
 #if CC_ENABLE_CACHE_TEXTURE_DATA
     #include "renderer/CCTextureCache.h"
@@ -120,12 +126,250 @@ const Texture2D::PixelFormatInfoMap Texture2D::_pixelFormatInfoTables(TexturePix
 // Default is: RGBA8888 (32-bit textures)
 static Texture2D::PixelFormat g_defaultAlphaPixelFormat = Texture2D::PixelFormat::DEFAULT;
 
+//////////////////////////////////////////////////////////////////////////
+// SIMD convertor functions
+//
+// The kernels only convert between RGBA8888 and the other formats, the other
+// conversions go through RGBA8888 by blocks small enough to stay in the cache.
+
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_IOS) || (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
+    #if defined (__arm64__) || defined (__aarch64__) || defined (__ARM_NEON__)
+    #define INCLUDE_NEON
+    #endif
+#endif
+
+#if defined (__SSE2__) || defined (_M_X64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 2)
+#define INCLUDE_SSE2
+    #if (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32) || (CC_TARGET_PLATFORM == CC_PLATFORM_LINUX) || (CC_TARGET_PLATFORM == CC_PLATFORM_MAC)
+        #if (defined (_MSC_VER) && _MSC_VER >= 1800) || defined (__GNUC__)
+        #define INCLUDE_AVX2
+        #endif
+    #endif
+#endif
+
+namespace {
+    // converts all the pixels
+    typedef void (*PixelKernel)(const unsigned char* in, ssize_t pixels, unsigned char* out);
+
+    struct PixelKernels
+    {
+        const char* name;
+        PixelKernel i8ToRGBA8888;
+        PixelKernel ai88ToRGBA8888;
+        PixelKernel rgb888ToRGBA8888;
+        PixelKernel rgba8888ToRGB888;
+        PixelKernel rgba8888ToRGB565;
+        PixelKernel rgba8888ToRGBA4444;
+        PixelKernel rgba8888ToRGB5A1;
+        PixelKernel rgba8888ToA8;
+        PixelKernel rgba8888ToI8;
+        PixelKernel rgba8888ToAI88;
+        // in and out can be the same
+        PixelKernel premultiplyAlpha;
+    };
+
+    // the SIMD kernels finish the pixels which don't fill a vector with these ones
+    void scalarI8ToRGBA8888(const unsigned char* in, ssize_t pixels, unsigned char* out)
+    {
+        for (ssize_t i = 0; i < pixels; ++i, out += 4)
+        {
+            out[0] = out[1] = out[2] = in[i];
+            out[3] = 0xFF;
+        }
+    }
+
+    void scalarAI88ToRGBA8888(const unsigned char* in, ssize_t pixels, unsigned char* out)
+    {
+        for (ssize_t i = 0; i < pixels; ++i, in += 2, out += 4)
+        {
+            out[0] = out[1] = out[2] = in[0];
+            out[3] = in[1];
+        }
+    }
+
+    void scalarRGB888ToRGBA8888(const unsigned char* in, ssize_t pixels, unsigned char* out)
+    {
+        for (ssize_t i = 0; i < pixels; ++i, in += 3, out += 4)
+        {
+            out[0] = in[0];
+            out[1] = in[1];
+            out[2] = in[2];
+            out[3] = 0xFF;
+        }
+    }
+
+    void scalarRGBA8888ToRGB888(const unsigned char* in, ssize_t pixels, unsigned char* out)
+    {
+        for (ssize_t i = 0; i < pixels; ++i, in += 4, out += 3)
+        {
+            out[0] = in[0];
+            out[1] = in[1];
+            out[2] = in[2];
+        }
+    }
+
+    void scalarRGBA8888ToRGB565(const unsigned char* in, ssize_t pixels, unsigned char* out)
+    {
+        unsigned short* out16 = (unsigned short*)out;
+        for (ssize_t i = 0; i < pixels; ++i, in += 4)
+        {
+            *out16++ = (in[0] & 0x00F8) << 8 | (in[1] & 0x00FC) << 3 | (in[2] & 0x00F8) >> 3;
+        }
+    }
+
+    void scalarRGBA8888ToRGBA4444(const unsigned char* in, ssize_t pixels, unsigned char* out)
+    {
+        unsigned short* out16 = (unsigned short*)out;
+        for (ssize_t i = 0; i < pixels; ++i, in += 4)
+        {
+            *out16++ = (in[0] & 0x00F0) << 8 | (in[1] & 0x00F0) << 4 | (in[2] & 0x00F0) | (in[3] & 0x00F0) >> 4;
+        }
+    }
+
+    void scalarRGBA8888ToRGB5A1(const unsigned char* in, ssize_t pixels, unsigned char* out)
+    {
+        unsigned short* out16 = (unsigned short*)out;
+        for (ssize_t i = 0; i < pixels; ++i, in += 4)
+        {
+            *out16++ = (in[0] & 0x00F8) << 8 | (in[1] & 0x00F8) << 3 | (in[2] & 0x00F8) >> 2 | (in[3] & 0x0080) >> 7;
+        }
+    }
+
+    void scalarRGBA8888ToA8(const unsigned char* in, ssize_t pixels, unsigned char* out)
+    {
+        for (ssize_t i = 0; i < pixels; ++i, in += 4)
+        {
+            *out++ = in[3];
+        }
+    }
+
+    void scalarRGBA8888ToI8(const unsigned char* in, ssize_t pixels, unsigned char* out)
+    {
+        for (ssize_t i = 0; i < pixels; ++i, in += 4)
+        {
+            *out++ = (in[0] * 299 + in[1] * 587 + in[2] * 114 + 500) / 1000;
+        }
+    }
+
+    void scalarRGBA8888ToAI88(const unsigned char* in, ssize_t pixels, unsigned char* out)
+    {
+        for (ssize_t i = 0; i < pixels; ++i, in += 4)
+        {
+            *out++ = (in[0] * 299 + in[1] * 587 + in[2] * 114 + 500) / 1000;
+            *out++ = in[3];
+        }
+    }
+
+    void scalarPremultiplyAlpha(const unsigned char* in, ssize_t pixels, unsigned char* out)
+    {
+        unsigned int* out32 = (unsigned int*)out;
+        for (ssize_t i = 0; i < pixels; ++i, in += 4)
+        {
+            out32[i] = CC_RGB_PREMULTIPLY_ALPHA(in[0], in[1], in[2], in[3]);
+        }
+    }
+
+    const PixelKernels SCALAR_KERNELS = {
+        "",
+        scalarI8ToRGBA8888, scalarAI88ToRGBA8888, scalarRGB888ToRGBA8888, scalarRGBA8888ToRGB888,
+        scalarRGBA8888ToRGB565, scalarRGBA8888ToRGBA4444, scalarRGBA8888ToRGB5A1,
+        scalarRGBA8888ToA8, scalarRGBA8888ToI8, scalarRGBA8888ToAI88, scalarPremultiplyAlpha
+    };
+}
+
+#ifdef INCLUDE_SSE2
+#include "renderer/CCTexture2DSSE.inl"
+#endif
+
+#ifdef INCLUDE_NEON
+#include "renderer/CCTexture2DNeon.inl"
+#endif
+
+namespace {
+    const PixelKernels* selectSIMDKernels()
+    {
+#if defined (INCLUDE_AVX2)
+        if (isAVX2Supported())
+            return &AVX2_KERNELS;
+#endif
+#if defined (INCLUDE_SSE2)
+        return &SSE2_KERNELS;
+#elif defined (INCLUDE_NEON)
+        if (MathUtil::isNeon32Enabled() || MathUtil::isNeon64Enabled())
+            return &NEON_KERNELS;
+        return nullptr;
+#else
+        return nullptr;
+#endif
+    }
+
+    bool g_SIMDConversionEnabled = true;
+
+    const PixelKernels* getSIMDKernels()
+    {
+        static const PixelKernels* kernels = selectSIMDKernels();
+        return g_SIMDConversionEnabled ? kernels : nullptr;
+    }
+
+    // pixels converted through RGBA8888 at once, 4KB
+    const ssize_t BLOCK_PIXELS = 1024;
+
+    // expand or pack is nullptr when the source or the destination is RGBA8888
+    bool convertWithSIMD(PixelKernel PixelKernels::*expand, PixelKernel PixelKernels::*pack,
+        const unsigned char* data, ssize_t dataLen, ssize_t inBytes, unsigned char* outData, ssize_t outBytes)
+    {
+        const PixelKernels* kernels = getSIMDKernels();
+        if (!kernels)
+            return false;
+
+        const ssize_t pixels = dataLen / inBytes;
+        if (!expand)
+        {
+            (kernels->*pack)(data, pixels, outData);
+        }
+        else if (!pack)
+        {
+            (kernels->*expand)(data, pixels, outData);
+        }
+        else
+        {
+            unsigned char block[BLOCK_PIXELS * 4];
+            for (ssize_t i = 0; i < pixels; i += BLOCK_PIXELS)
+            {
+                const ssize_t count = std::min(BLOCK_PIXELS, pixels - i);
+                (kernels->*expand)(data + i * inBytes, count, block);
+                (kernels->*pack)(block, count, outData + i * outBytes);
+            }
+        }
+        return true;
+    }
+}
+
+void Texture2D::premultiplyAlpha(unsigned char* data, ssize_t dataLen)
+{
+    const PixelKernels* kernels = getSIMDKernels();
+    (kernels ? kernels : &SCALAR_KERNELS)->premultiplyAlpha(data, dataLen / 4, data);
+}
+
+void Texture2D::setSIMDConversionEnabled(bool enabled)
+{
+    g_SIMDConversionEnabled = enabled;
+}
+
+const char* Texture2D::getSIMDConversionName()
+{
+    const PixelKernels* kernels = getSIMDKernels();
+    return kernels ? kernels->name : SCALAR_KERNELS.name;
+}
+
 //////////////////////////////////////////////////////////////////////////
 //convertor function
 
 // IIIIIIII -> RRRRRRRRGGGGGGGGGBBBBBBBB
 void Texture2D::convertI8ToRGB888(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
+    if (convertWithSIMD(&PixelKernels::i8ToRGBA8888, &PixelKernels::rgba8888ToRGB888, data, dataLen, 1, outData, 3))
+        return;
     for (ssize_t i=0; i < dataLen; ++i)
     {
         *outData++ = data[i];     //R
@@ -137,6 +381,8 @@ void Texture2D::convertI8ToRGB888(const unsigned char* data, ssize_t dataLen, un
 // IIIIIIIIAAAAAAAA -> RRRRRRRRGGGGGGGGBBBBBBBB
 void Texture2D::convertAI88ToRGB888(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
+    if (convertWithSIMD(&PixelKernels::ai88ToRGBA8888, &PixelKernels::rgba8888ToRGB888, data, dataLen, 2, outData, 3))
+        return;
     for (ssize_t i = 0, l = dataLen - 1; i < l; i += 2)
     {
         *outData++ = data[i];     //R
@@ -148,6 +394,8 @@ void Texture2D::convertAI88ToRGB888(const unsigned char* data, ssize_t dataLen,
 // IIIIIIII -> RRRRRRRRGGGGGGGGGBBBBBBBBAAAAAAAA
 void Texture2D::convertI8ToRGBA8888(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
+    if (convertWithSIMD(&PixelKernels::i8ToRGBA8888, nullptr, data, dataLen, 1, outData, 4))
+        return;
     for (ssize_t i = 0; i < dataLen; ++i)
     {
         *outData++ = data[i];     //R
@@ -160,6 +408,8 @@ void Texture2D::convertI8ToRGBA8888(const unsigned char* data, ssize_t dataLen,
 // IIIIIIIIAAAAAAAA -> RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA
 void Texture2D::convertAI88ToRGBA8888(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
+    if (convertWithSIMD(&PixelKernels::ai88ToRGBA8888, nullptr, data, dataLen, 2, outData, 4))
+        return;
     for (ssize_t i = 0, l = dataLen - 1; i < l; i += 2)
     {
         *outData++ = data[i];     //R
@@ -172,6 +422,8 @@ void Texture2D::convertAI88ToRGBA8888(const unsigned char* data, ssize_t dataLen
 // IIIIIIII -> RRRRRGGGGGGBBBBB
 void Texture2D::convertI8ToRGB565(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
+    if (convertWithSIMD(&PixelKernels::i8ToRGBA8888, &PixelKernels::rgba8888ToRGB565, data, dataLen, 1, outData, 2))
+        return;
     unsigned short* out16 = (unsigned short*)outData;
     for (int i = 0; i < dataLen; ++i)
     {
@@ -184,6 +436,8 @@ void Texture2D::convertI8ToRGB565(const unsigned char* data, ssize_t dataLen, un
 // IIIIIIIIAAAAAAAA -> RRRRRGGGGGGBBBBB
 void Texture2D::convertAI88ToRGB565(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
+    if (convertWithSIMD(&PixelKernels::ai88ToRGBA8888, &PixelKernels::rgba8888ToRGB565, data, dataLen, 2, outData, 2))
+        return;
     unsigned short* out16 = (unsigned short*)outData;
     for (ssize_t i = 0, l = dataLen - 1; i < l; i += 2)
     {
@@ -196,6 +450,8 @@ void Texture2D::convertAI88ToRGB565(const unsigned char* data, ssize_t dataLen,
 // IIIIIIII -> RRRRGGGGBBBBAAAA
 void Texture2D::convertI8ToRGBA4444(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
+    if (convertWithSIMD(&PixelKernels::i8ToRGBA8888, &PixelKernels::rgba8888ToRGBA4444, data, dataLen, 1, outData, 2))
+        return;
     unsigned short* out16 = (unsigned short*)outData;
     for (ssize_t i = 0; i < dataLen; ++i)
     {
@@ -209,6 +465,8 @@ void Texture2D::convertI8ToRGBA4444(const unsigned char* data, ssize_t dataLen,
 // IIIIIIIIAAAAAAAA -> RRRRGGGGBBBBAAAA
 void Texture2D::convertAI88ToRGBA4444(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
+    if (convertWithSIMD(&PixelKernels::ai88ToRGBA8888, &PixelKernels::rgba8888ToRGBA4444, data, dataLen, 2, outData, 2))
+        return;
     unsigned short* out16 = (unsigned short*)outData;
     for (ssize_t i = 0, l = dataLen - 1; i < l; i += 2)
     {
@@ -222,6 +480,8 @@ void Texture2D::convertAI88ToRGBA4444(const unsigned char* data, ssize_t dataLen
 // IIIIIIII -> RRRRRGGGGGBBBBBA
 void Texture2D::convertI8ToRGB5A1(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
+    if (convertWithSIMD(&PixelKernels::i8ToRGBA8888, &PixelKernels::rgba8888ToRGB5A1, data, dataLen, 1, outData, 2))
+        return;
     unsigned short* out16 = (unsigned short*)outData;
     for (int i = 0; i < dataLen; ++i)
     {
@@ -235,6 +495,8 @@ void Texture2D::convertI8ToRGB5A1(const unsigned char* data, ssize_t dataLen, un
 // IIIIIIIIAAAAAAAA -> RRRRRGGGGGBBBBBA
 void Texture2D::convertAI88ToRGB5A1(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
+    if (convertWithSIMD(&PixelKernels::ai88ToRGBA8888, &PixelKernels::rgba8888ToRGB5A1, data, dataLen, 2, outData, 2))
+        return;
     unsigned short* out16 = (unsigned short*)outData;
     for (ssize_t i = 0, l = dataLen - 1; i < l; i += 2)
     {
@@ -248,6 +510,8 @@ void Texture2D::convertAI88ToRGB5A1(const unsigned char* data, ssize_t dataLen,
 // IIIIIIII -> IIIIIIIIAAAAAAAA
 void Texture2D::convertI8ToAI88(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
+    if (convertWithSIMD(&PixelKernels::i8ToRGBA8888, &PixelKernels::rgba8888ToAI88, data, dataLen, 1, outData, 2))
+        return;
     unsigned short* out16 = (unsigned short*)outData;
     for (ssize_t i = 0; i < dataLen; ++i)
     {
@@ -259,6 +523,8 @@ void Texture2D::convertI8ToAI88(const unsigned char* data, ssize_t dataLen, unsi
 // IIIIIIIIAAAAAAAA -> AAAAAAAA
 void Texture2D::convertAI88ToA8(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
+    if (convertWithSIMD(&PixelKernels::ai88ToRGBA8888, &PixelKernels::rgba8888ToA8, data, dataLen, 2, outData, 1))
+        return;
     for (ssize_t i = 1; i < dataLen; i += 2)
     {
         *outData++ = data[i]; //A
@@ -268,6 +534,8 @@ void Texture2D::convertAI88ToA8(const unsigned char* data, ssize_t dataLen, unsi
 // IIIIIIIIAAAAAAAA -> IIIIIIII
 void Texture2D::convertAI88ToI8(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
+    if (convertWithSIMD(&PixelKernels::ai88ToRGBA8888, &PixelKernels::rgba8888ToI8, data, dataLen, 2, outData, 1))
+        return;
     for (ssize_t i = 0, l = dataLen - 1; i < l; i += 2)
     {
         *outData++ = data[i]; //R
@@ -277,6 +545,8 @@ void Texture2D::convertAI88ToI8(const unsigned char* data, ssize_t dataLen, unsi
 // RRRRRRRRGGGGGGGGBBBBBBBB -> RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA
 void Texture2D::convertRGB888ToRGBA8888(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
+    if (convertWithSIMD(&PixelKernels::rgb888ToRGBA8888, nullptr, data, dataLen, 3, outData, 4))
+        return;
     for (ssize_t i = 0, l = dataLen - 2; i < l; i += 3)
     {
         *outData++ = data[i];         //R
@@ -289,6 +559,8 @@ void Texture2D::convertRGB888ToRGBA8888(const unsigned char* data, ssize_t dataL
 // RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA -> RRRRRRRRGGGGGGGGBBBBBBBB
 void Texture2D::convertRGBA8888ToRGB888(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
+    if (convertWithSIMD(nullptr, &PixelKernels::rgba8888ToRGB888, data, dataLen, 4, outData, 3))
+        return;
     for (ssize_t i = 0, l = dataLen - 3; i < l; i += 4)
     {
         *outData++ = data[i];         //R
@@ -300,6 +572,8 @@ void Texture2D::convertRGBA8888ToRGB888(const unsigned char* data, ssize_t dataL
 // RRRRRRRRGGGGGGGGBBBBBBBB -> RRRRRGGGGGGBBBBB
 void Texture2D::convertRGB888ToRGB565(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
+    if (convertWithSIMD(&PixelKernels::rgb888ToRGBA8888, &PixelKernels::rgba8888ToRGB565, data, dataLen, 3, outData, 2))
+        return;
     unsigned short* out16 = (unsigned short*)outData;
     for (ssize_t i = 0, l = dataLen - 2; i < l; i += 3)
     {
@@ -312,6 +586,8 @@ void Texture2D::convertRGB888ToRGB565(const unsigned char* data, ssize_t dataLen
 // RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA -> RRRRRGGGGGGBBBBB
 void Texture2D::convertRGBA8888ToRGB565(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
+    if (convertWithSIMD(nullptr, &PixelKernels::rgba8888ToRGB565, data, dataLen, 4, outData, 2))
+        return;
     unsigned short* out16 = (unsigned short*)outData;
     for (ssize_t i = 0, l = dataLen - 3; i < l; i += 4)
     {
@@ -324,6 +600,9 @@ void Texture2D::convertRGBA8888ToRGB565(const unsigned char* data, ssize_t dataL
 // RRRRRRRRGGGGGGGGBBBBBBBB -> AAAAAAAA
 void Texture2D::convertRGB888ToA8(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
+    // the alpha is the intensity
+    if (convertWithSIMD(&PixelKernels::rgb888ToRGBA8888, &PixelKernels::rgba8888ToI8, data, dataLen, 3, outData, 1))
+        return;
     for (ssize_t i = 0, l = dataLen - 2; i < l; i += 3)
     {
         *outData++ = (data[i] * 299 + data[i + 1] * 587 + data[i + 2] * 114 + 500) / 1000;  //A =  (R*299 + G*587 + B*114 + 500) / 1000
@@ -333,6 +612,8 @@ void Texture2D::convertRGB888ToA8(const unsigned char* data, ssize_t dataLen, un
 // RRRRRRRRGGGGGGGGBBBBBBBB -> IIIIIIII
 void Texture2D::convertRGB888ToI8(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
+    if (convertWithSIMD(&PixelKernels::rgb888ToRGBA8888, &PixelKernels::rgba8888ToI8, data, dataLen, 3, outData, 1))
+        return;
     for (ssize_t i = 0, l = dataLen - 2; i < l; i += 3)
     {
         *outData++ = (data[i] * 299 + data[i + 1] * 587 + data[i + 2] * 114 + 500) / 1000;  //I =  (R*299 + G*587 + B*114 + 500) / 1000
@@ -342,6 +623,8 @@ void Texture2D::convertRGB888ToI8(const unsigned char* data, ssize_t dataLen, un
 // RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA -> IIIIIIII
 void Texture2D::convertRGBA8888ToI8(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
+    if (convertWithSIMD(nullptr, &PixelKernels::rgba8888ToI8, data, dataLen, 4, outData, 1))
+        return;
     for (ssize_t i = 0, l = dataLen - 3; i < l; i += 4)
     {
         *outData++ = (data[i] * 299 + data[i + 1] * 587 + data[i + 2] * 114 + 500) / 1000;  //I =  (R*299 + G*587 + B*114 + 500) / 1000
@@ -351,6 +634,8 @@ void Texture2D::convertRGBA8888ToI8(const unsigned char* data, ssize_t dataLen,
 // RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA -> AAAAAAAA
 void Texture2D::convertRGBA8888ToA8(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
+    if (convertWithSIMD(nullptr, &PixelKernels::rgba8888ToA8, data, dataLen, 4, outData, 1))
+        return;
     for (ssize_t i = 0, l = dataLen -3; i < l; i += 4)
     {
         *outData++ = data[i + 3]; //A
@@ -360,6 +645,8 @@ void Texture2D::convertRGBA8888ToA8(const unsigned char* data, ssize_t dataLen,
 // RRRRRRRRGGGGGGGGBBBBBBBB -> IIIIIIIIAAAAAAAA
 void Texture2D::convertRGB888ToAI88(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
+    if (convertWithSIMD(&PixelKernels::rgb888ToRGBA8888, &PixelKernels::rgba8888ToAI88, data, dataLen, 3, outData, 2))
+        return;
     for (ssize_t i = 0, l = dataLen - 2; i < l; i += 3)
     {
         *outData++ = (data[i] * 299 + data[i + 1] * 587 + data[i + 2] * 114 + 500) / 1000;  //I =  (R*299 + G*587 + B*114 + 500) / 1000
@@ -371,6 +658,8 @@ void Texture2D::convertRGB888ToAI88(const unsigned char* data, ssize_t dataLen,
 // RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA -> IIIIIIIIAAAAAAAA
 void Texture2D::convertRGBA8888ToAI88(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
+    if (convertWithSIMD(nullptr, &PixelKernels::rgba8888ToAI88, data, dataLen, 4, outData, 2))
+        return;
     for (ssize_t i = 0, l = dataLen - 3; i < l; i += 4)
     {
         *outData++ = (data[i] * 299 + data[i + 1] * 587 + data[i + 2] * 114 + 500) / 1000;  //I =  (R*299 + G*587 + B*114 + 500) / 1000
@@ -381,6 +670,8 @@ void Texture2D::convertRGBA8888ToAI88(const unsigned char* data, ssize_t dataLen
 // RRRRRRRRGGGGGGGGBBBBBBBB -> RRRRGGGGBBBBAAAA
 void Texture2D::convertRGB888ToRGBA4444(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
+    if (convertWithSIMD(&PixelKernels::rgb888ToRGBA8888, &PixelKernels::rgba8888ToRGBA4444, data, dataLen, 3, outData, 2))
+        return;
     unsigned short* out16 = (unsigned short*)outData;
     for (ssize_t i = 0, l = dataLen - 2; i < l; i += 3)
     {
@@ -394,6 +685,8 @@ void Texture2D::convertRGB888ToRGBA4444(const unsigned char* data, ssize_t dataL
 // RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA -> RRRRGGGGBBBBAAAA
 void Texture2D::convertRGBA8888ToRGBA4444(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
+    if (convertWithSIMD(nullptr, &PixelKernels::rgba8888ToRGBA4444, data, dataLen, 4, outData, 2))
+        return;
     unsigned short* out16 = (unsigned short*)outData;
     for (ssize_t i = 0, l = dataLen - 3; i < l; i += 4)
     {
@@ -407,6 +700,8 @@ void Texture2D::convertRGBA8888ToRGBA4444(const unsigned char* data, ssize_t dat
 // RRRRRRRRGGGGGGGGBBBBBBBB -> RRRRRGGGGGBBBBBA
 void Texture2D::convertRGB888ToRGB5A1(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
+    if (convertWithSIMD(&PixelKernels::rgb888ToRGBA8888, &PixelKernels::rgba8888ToRGB5A1, data, dataLen, 3, outData, 2))
+        return;
     unsigned short* out16 = (unsigned short*)outData;
     for (ssize_t i = 0, l = dataLen - 2; i < l; i += 3)
     {
@@ -420,6 +715,8 @@ void Texture2D::convertRGB888ToRGB5A1(const unsigned char* data, ssize_t dataLen
 // RRRRRRRRGGGGGGGGBBBBBBBB -> RRRRRGGGGGBBBBBA
 void Texture2D::convertRGBA8888ToRGB5A1(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
+    if (convertWithSIMD(nullptr, &PixelKernels::rgba8888ToRGB5A1, data, dataLen, 4, outData, 2))
+        return;
     unsigned short* out16 = (unsigned short*)outData;
     for (ssize_t i = 0, l = dataLen - 2; i < l; i += 4)
     {
@@ -446,6 +743,9 @@ Texture2D::Texture2D()
 , _ninePatchInfo(nullptr)
 , _valid(true)
 , _alphaTexture(nullptr)
+, _lod(0)
+, _requestedLOD(INT_MAX)
+, _streamer(nullptr)
 {
 }
 
@@ -454,6 +754,9 @@ Texture2D::~Texture2D()
 #if CC_ENABLE_CACHE_TEXTURE_DATA
     VolatileTextureMgr::removeTexture(this);
 #endif
+    if (_streamer)
+        _streamer->removeTexture(this);
+
     CC_SAFE_RELEASE_NULL(_alphaTexture); // ETC1 ALPHA support.
 
     CCLOGINFO("deallocing Texture2D: %p - id=%u", this, _name);
@@ -706,6 +1009,7 @@ bool Texture2D::initWithMipmaps(MipmapInfo* mipmaps, int mipmapsNum, PixelFormat
 
     _hasPremultipliedAlpha = false;
     _hasMipmaps = mipmapsNum > 1;
+    _lod = 0;
 
     // shader
     setGLProgram(GLProgramCache::getInstance()->getGLProgram(GLProgram::SHADER_NAME_POSITION_TEXTURE));
@@ -725,6 +1029,91 @@ bool Texture2D::updateWithData(const void *data,int offsetX,int offsetY,int widt
     return false;
 }
 
+bool Texture2D::updateWithImageLOD(Image* image, int lod)
+{
+    const int width = std::max(_pixelsWide >> lod, 1);
+    const int height = std::max(_pixelsHigh >> lod, 1);
+    if (!_name || !image || image->isCompressed() || image->getNumberOfMipmaps() > 1
+        || image->getWidth() != width || image->getHeight() != height)
+    {
+        return false;
+    }
+
+    const PixelFormatInfo& info = _pixelFormatInfoTables.at(_pixelFormat);
+    if (info.compressed)
+    {
+        return false;
+    }
+
+    unsigned char* data = nullptr;
+    ssize_t dataLen = 0;
+    convertDataToFormat(image->getData(), image->getDataLen(), image->getRenderFormat(), _pixelFormat, &data, &dataLen);
+
+    unsigned int bytesPerRow = width * info.bpp / 8;
+    if (bytesPerRow % 8 == 0)
+    {
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 8);
+    }
+    else if (bytesPerRow % 4 == 0)
+    {
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    }
+    else if (bytesPerRow % 2 == 0)
+    {
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 2);
+    }
+    else
+    {
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    }
+
+    // same texture name, so the texture parameters are kept
+    GL::bindTexture2D(_name);
+    glTexImage2D(GL_TEXTURE_2D, 0, info.internalFormat, (GLsizei)width, (GLsizei)height, 0, info.format, info.type, data);
+    if (_hasMipmaps)
+    {
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+
+    if (data != image->getData())
+    {
+        free(data);
+    }
+
+    GLenum err = glGetError();
+    if (err != GL_NO_ERROR)
+    {
+        CCLOG("cocos2d: Texture2D: Error uploading level of detail %d: glError: 0x%04X", lod, err);
+        return false;
+    }
+
+    _lod = lod;
+    return true;
+}
+
+void Texture2D::requestLOD(float texelsPerPixel)
+{
+    if (!_streamer)
+    {
+        return;
+    }
+
+    // the level where a texel covers at least a pixel: floor(log2(texelsPerPixel))
+    int lod = 0;
+    if (texelsPerPixel >= 2)
+    {
+        int exponent = 0;
+        frexpf(std::min(texelsPerPixel, 65536.0f), &exponent);
+        lod = exponent - 1;
+    }
+
+    // atomic minimum, the nodes of a frame are visited by several threads
+    int requested = _requestedLOD.load(std::memory_order_relaxed);
+    while (lod < requested && !_requestedLOD.compare_exchange_weak(requested, lod, std::memory_order_relaxed))
+    {
+    }
+}
+
 std::string Texture2D::getDescription() const
 {
     return StringUtils::format("<Texture2D | Name = %u | Dimensions = %ld x %ld | Coordinates = (%.2f, %.2f)>", _name, (long)_pixelsWide, (long)_pixelsHigh, _maxS, _maxT);
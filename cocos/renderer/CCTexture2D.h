@@ -30,6 +30,7 @@ THE SOFTWARE.
 #include <string>
 #include <map>
 #include <unordered_map>
+#include <atomic>
 
 #include "base/CCRef.h"
 #include "math/CCGeometry.h"
@@ -40,6 +41,7 @@ NS_CC_BEGIN
 class Image;
 class NinePatchInfo;
 class SpriteFrame;
+class TextureStreamer;
 typedef struct _MipmapInfo MipmapInfo;
 
 namespace ui
@@ -413,9 +415,52 @@ public:
     void setAlphaTexture(Texture2D* alphaTexture);
 
     GLuint getAlphaTextureName() const;
+
+    /** Returns the level of detail the texture is uploaded with: its width and height are divided by 2^lod.
+     * It is 0 unless the texture is streamed by the TextureStreamer.
+     * @since v3.13
+     */
+    int getLOD() const { return _lod; }
+
+    /** Whether or not the TextureStreamer changes the resolution of the texture.
+     * @since v3.13
+     */
+    bool isStreamed() const { return _streamer != nullptr; }
+
+    /** Reports that the texture is drawn this frame, with the given number of texels of its full
+     * resolution for each pixel on screen. The TextureStreamer uploads the lowest level of detail
+     * which still has at least one texel per pixel. Nodes which don't know how large they draw the texture
+     * request 0, its full resolution. Does nothing if the texture isn't streamed.
+     * It may be called from several threads at once.
+     * @since v3.13
+     */
+    void requestLOD(float texelsPerPixel);
 public:
     /** Get pixel info map, the key-value pairs is PixelFormat and PixelFormatInfo.*/
     static const PixelFormatInfoMap& getPixelFormatInfoMap();
+
+    /**
+    Convert the format to the format param you specified, if the format is PixelFormat::Automatic, it will detect it automatically and convert to the closest format for you.
+    It will return the converted format to you. if the outData != data, you must free() it manually.
+    */
+    static PixelFormat convertDataToFormat(const unsigned char* data, ssize_t dataLen, PixelFormat originFormat, PixelFormat format, unsigned char** outData, ssize_t* outDataLen);
+
+    /** Multiplies the color of RGBA8888 pixels by their alpha, in place.
+     * @since v3.13
+     */
+    static void premultiplyAlpha(unsigned char* data, ssize_t dataLen);
+
+    /** Enables or disables the SIMD pixel format conversions. They are enabled by default,
+     * and used when the CPU supports AVX2, SSE2 or NEON.
+     * @since v3.13
+     */
+    static void setSIMDConversionEnabled(bool enabled);
+
+    /** Returns the instruction set of the pixel format conversions: "AVX2", "SSE2", "NEON",
+     * or an empty string when they are scalar.
+     * @since v3.13
+     */
+    static const char* getSIMDConversionName();
     
 private:
     /**
@@ -463,12 +508,6 @@ private:
 
     /**convert functions*/
 
-    /**
-    Convert the format to the format param you specified, if the format is PixelFormat::Automatic, it will detect it automatically and convert to the closest format for you.
-    It will return the converted format to you. if the outData != data, you must delete it manually.
-    */
-    static PixelFormat convertDataToFormat(const unsigned char* data, ssize_t dataLen, PixelFormat originFormat, PixelFormat format, unsigned char** outData, ssize_t* outDataLen);
-
     static PixelFormat convertI8ToFormat(const unsigned char* data, ssize_t dataLen, PixelFormat format, unsigned char** outData, ssize_t* outDataLen);
     static PixelFormat convertAI88ToFormat(const unsigned char* data, ssize_t dataLen, PixelFormat format, unsigned char** outData, ssize_t* outDataLen);
     static PixelFormat convertRGB888ToFormat(const unsigned char* data, ssize_t dataLen, PixelFormat format, unsigned char** outData, ssize_t* outDataLen);
@@ -510,6 +549,9 @@ private:
     static void convertRGBA8888ToRGB5A1(const unsigned char* data, ssize_t dataLen, unsigned char* outData);
 
 protected:
+    // uploads the image, whose size is the full size of the texture divided by 2^lod, keeping the texture parameters
+    bool updateWithImageLOD(Image* image, int lod);
+
     /** pixel format of the texture */
     Texture2D::PixelFormat _pixelFormat;
 
@@ -547,11 +589,18 @@ protected:
     friend class SpriteFrameCache;
     friend class TextureCache;
     friend class ui::Scale9Sprite;
+    friend class TextureStreamer;
 
     bool _valid;
     std::string _filePath;
 
     Texture2D* _alphaTexture;
+
+    /** level of detail the texture is uploaded with */
+    int _lod;
+    /** lowest level of detail requested since the last update of the streamer, requested from the recording threads */
+    std::atomic<int> _requestedLOD;
+    TextureStreamer* _streamer;
 };
 
 
@@ -0,0 +1,210 @@
+/****************************************************************************
+ Copyright (c) 2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include <arm_neon.h>
+
+namespace {
+
+// the interleaved loads and stores split the channels, 16 pixels at once
+void i8ToRGBA8888Neon(const unsigned char* in, ssize_t pixels, unsigned char* out)
+{
+    ssize_t i = 0;
+    for (; i + 16 <= pixels; i += 16)
+    {
+        uint8x16_t v = vld1q_u8(in + i);
+        uint8x16x4_t p = {{ v, v, v, vdupq_n_u8(0xFF) }};
+        vst4q_u8(out + i * 4, p);
+    }
+    scalarI8ToRGBA8888(in + i, pixels - i, out + i * 4);
+}
+
+void ai88ToRGBA8888Neon(const unsigned char* in, ssize_t pixels, unsigned char* out)
+{
+    ssize_t i = 0;
+    for (; i + 16 <= pixels; i += 16)
+    {
+        uint8x16x2_t v = vld2q_u8(in + i * 2);
+        uint8x16x4_t p = {{ v.val[0], v.val[0], v.val[0], v.val[1] }};
+        vst4q_u8(out + i * 4, p);
+    }
+    scalarAI88ToRGBA8888(in + i * 2, pixels - i, out + i * 4);
+}
+
+void rgb888ToRGBA8888Neon(const unsigned char* in, ssize_t pixels, unsigned char* out)
+{
+    ssize_t i = 0;
+    for (; i + 16 <= pixels; i += 16)
+    {
+        uint8x16x3_t v = vld3q_u8(in + i * 3);
+        uint8x16x4_t p = {{ v.val[0], v.val[1], v.val[2], vdupq_n_u8(0xFF) }};
+        vst4q_u8(out + i * 4, p);
+    }
+    scalarRGB888ToRGBA8888(in + i * 3, pixels - i, out + i * 4);
+}
+
+void rgba8888ToRGB888Neon(const unsigned char* in, ssize_t pixels, unsigned char* out)
+{
+    ssize_t i = 0;
+    for (; i + 16 <= pixels; i += 16)
+    {
+        uint8x16x4_t p = vld4q_u8(in + i * 4);
+        uint8x16x3_t v = {{ p.val[0], p.val[1], p.val[2] }};
+        vst3q_u8(out + i * 3, v);
+    }
+    scalarRGBA8888ToRGB888(in + i * 4, pixels - i, out + i * 3);
+}
+
+inline uint16x8_t toRGB565Neon(uint8x8_t r, uint8x8_t g, uint8x8_t b, uint8x8_t /*a*/)
+{
+    uint16x8_t out = vshll_n_u8(vand_u8(r, vdup_n_u8(0xF8)), 8);
+    out = vorrq_u16(out, vshlq_n_u16(vmovl_u8(vand_u8(g, vdup_n_u8(0xFC))), 3));
+    return vorrq_u16(out, vmovl_u8(vshr_n_u8(b, 3)));
+}
+
+inline uint16x8_t toRGBA4444Neon(uint8x8_t r, uint8x8_t g, uint8x8_t b, uint8x8_t a)
+{
+    const uint8x8_t mask = vdup_n_u8(0xF0);
+    uint16x8_t out = vshll_n_u8(vand_u8(r, mask), 8);
+    out = vorrq_u16(out, vshlq_n_u16(vmovl_u8(vand_u8(g, mask)), 4));
+    out = vorrq_u16(out, vmovl_u8(vand_u8(b, mask)));
+    return vorrq_u16(out, vmovl_u8(vshr_n_u8(a, 4)));
+}
+
+inline uint16x8_t toRGB5A1Neon(uint8x8_t r, uint8x8_t g, uint8x8_t b, uint8x8_t a)
+{
+    const uint8x8_t mask = vdup_n_u8(0xF8);
+    uint16x8_t out = vshll_n_u8(vand_u8(r, mask), 8);
+    out = vorrq_u16(out, vshlq_n_u16(vmovl_u8(vand_u8(g, mask)), 3));
+    out = vorrq_u16(out, vshlq_n_u16(vmovl_u8(vshr_n_u8(b, 3)), 1));
+    return vorrq_u16(out, vmovl_u8(vshr_n_u8(a, 7)));
+}
+
+// (R * 299 + G * 587 + B * 114 + 500) / 1000
+inline uint32x4_t luminanceNeon(uint16x4_t r, uint16x4_t g, uint16x4_t b)
+{
+    uint32x4_t sum = vmlal_n_u16(vmlal_n_u16(vmull_n_u16(r, 299), g, 587), b, 114);
+    sum = vaddq_u32(sum, vdupq_n_u32(500));
+    // x / 1000 == (x / 8) * 33555 >> 22 for x <= 255500, without overflowing
+    return vshrq_n_u32(vmulq_n_u32(vshrq_n_u32(sum, 3), 33555), 22);
+}
+
+inline uint8x16_t luminanceNeon(const uint8x16x4_t& p)
+{
+    uint16x8_t rLow = vmovl_u8(vget_low_u8(p.val[0]));
+    uint16x8_t gLow = vmovl_u8(vget_low_u8(p.val[1]));
+    uint16x8_t bLow = vmovl_u8(vget_low_u8(p.val[2]));
+    uint16x8_t rHigh = vmovl_u8(vget_high_u8(p.val[0]));
+    uint16x8_t gHigh = vmovl_u8(vget_high_u8(p.val[1]));
+    uint16x8_t bHigh = vmovl_u8(vget_high_u8(p.val[2]));
+
+    uint16x8_t low = vcombine_u16(
+        vmovn_u32(luminanceNeon(vget_low_u16(rLow), vget_low_u16(gLow), vget_low_u16(bLow))),
+        vmovn_u32(luminanceNeon(vget_high_u16(rLow), vget_high_u16(gLow), vget_high_u16(bLow))));
+    uint16x8_t high = vcombine_u16(
+        vmovn_u32(luminanceNeon(vget_low_u16(rHigh), vget_low_u16(gHigh), vget_low_u16(bHigh))),
+        vmovn_u32(luminanceNeon(vget_high_u16(rHigh), vget_high_u16(gHigh), vget_high_u16(bHigh))));
+    return vcombine_u8(vmovn_u16(low), vmovn_u16(high));
+}
+
+template <uint16x8_t (*PACK)(uint8x8_t, uint8x8_t, uint8x8_t, uint8x8_t), PixelKernel TAIL>
+void rgba8888To16BitsNeon(const unsigned char* in, ssize_t pixels, unsigned char* out)
+{
+    ssize_t i = 0;
+    for (; i + 16 <= pixels; i += 16)
+    {
+        uint8x16x4_t p = vld4q_u8(in + i * 4);
+        uint16_t* out16 = (uint16_t*)(out + i * 2);
+        vst1q_u16(out16, PACK(vget_low_u8(p.val[0]), vget_low_u8(p.val[1]), vget_low_u8(p.val[2]), vget_low_u8(p.val[3])));
+        vst1q_u16(out16 + 8, PACK(vget_high_u8(p.val[0]), vget_high_u8(p.val[1]), vget_high_u8(p.val[2]), vget_high_u8(p.val[3])));
+    }
+    TAIL(in + i * 4, pixels - i, out + i * 2);
+}
+
+void rgba8888ToA8Neon(const unsigned char* in, ssize_t pixels, unsigned char* out)
+{
+    ssize_t i = 0;
+    for (; i + 16 <= pixels; i += 16)
+    {
+        vst1q_u8(out + i, vld4q_u8(in + i * 4).val[3]);
+    }
+    scalarRGBA8888ToA8(in + i * 4, pixels - i, out + i);
+}
+
+void rgba8888ToI8Neon(const unsigned char* in, ssize_t pixels, unsigned char* out)
+{
+    ssize_t i = 0;
+    for (; i + 16 <= pixels; i += 16)
+    {
+        vst1q_u8(out + i, luminanceNeon(vld4q_u8(in + i * 4)));
+    }
+    scalarRGBA8888ToI8(in + i * 4, pixels - i, out + i);
+}
+
+void rgba8888ToAI88Neon(const unsigned char* in, ssize_t pixels, unsigned char* out)
+{
+    ssize_t i = 0;
+    for (; i + 16 <= pixels; i += 16)
+    {
+        uint8x16x4_t p = vld4q_u8(in + i * 4);
+        uint8x16x2_t v = {{ luminanceNeon(p), p.val[3] }};
+        vst2q_u8(out + i * 2, v);
+    }
+    scalarRGBA8888ToAI88(in + i * 4, pixels - i, out + i * 2);
+}
+
+// c * (a + 1) >> 8 == (c * a + c) >> 8, like CC_RGB_PREMULTIPLY_ALPHA
+inline uint8x16_t premultiplyNeon(uint8x16_t c, uint8x16_t a)
+{
+    uint8x8_t low = vshrn_n_u16(vaddw_u8(vmull_u8(vget_low_u8(c), vget_low_u8(a)), vget_low_u8(c)), 8);
+    uint8x8_t high = vshrn_n_u16(vaddw_u8(vmull_u8(vget_high_u8(c), vget_high_u8(a)), vget_high_u8(c)), 8);
+    return vcombine_u8(low, high);
+}
+
+void premultiplyAlphaNeon(const unsigned char* in, ssize_t pixels, unsigned char* out)
+{
+    ssize_t i = 0;
+    for (; i + 16 <= pixels; i += 16)
+    {
+        uint8x16x4_t p = vld4q_u8(in + i * 4);
+        p.val[0] = premultiplyNeon(p.val[0], p.val[3]);
+        p.val[1] = premultiplyNeon(p.val[1], p.val[3]);
+        p.val[2] = premultiplyNeon(p.val[2], p.val[3]);
+        vst4q_u8(out + i * 4, p);
+    }
+    scalarPremultiplyAlpha(in + i * 4, pixels - i, out + i * 4);
+}
+
+const PixelKernels NEON_KERNELS = {
+    "NEON",
+    i8ToRGBA8888Neon, ai88ToRGBA8888Neon, rgb888ToRGBA8888Neon, rgba8888ToRGB888Neon,
+    rgba8888To16BitsNeon<toRGB565Neon, scalarRGBA8888ToRGB565>,
+    rgba8888To16BitsNeon<toRGBA4444Neon, scalarRGBA8888ToRGBA4444>,
+    rgba8888To16BitsNeon<toRGB5A1Neon, scalarRGBA8888ToRGB5A1>,
+    rgba8888ToA8Neon,
+    rgba8888ToI8Neon,
+    rgba8888ToAI88Neon,
+    premultiplyAlphaNeon
+};
+
+}
@@ -0,0 +1,438 @@
+/****************************************************************************
+ Copyright (c) 2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include <emmintrin.h>
+#include <string.h>
+
+#ifdef INCLUDE_AVX2
+#include <immintrin.h>
+#if defined (_MSC_VER)
+#include <intrin.h>
+#define CC_AVX2_FUNCTION
+#else
+#include <cpuid.h>
+#define CC_AVX2_FUNCTION __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace {
+
+//
+// SSE2
+//
+// the 16 bits pixels in the low halves of the 32 bits lanes of a and b
+inline __m128i packLanes16SSE2(__m128i a, __m128i b)
+{
+    // sign extended, so that the saturation of the pack keeps them
+    a = _mm_srai_epi32(_mm_slli_epi32(a, 16), 16);
+    b = _mm_srai_epi32(_mm_slli_epi32(b, 16), 16);
+    return _mm_packs_epi32(a, b);
+}
+
+inline __m128i toRGB565SSE2(__m128i p)
+{
+    return _mm_or_si128(_mm_or_si128(
+        _mm_slli_epi32(_mm_and_si128(p, _mm_set1_epi32(0xF8)), 8),
+        _mm_and_si128(_mm_srli_epi32(p, 5), _mm_set1_epi32(0x7E0))),
+        _mm_and_si128(_mm_srli_epi32(p, 19), _mm_set1_epi32(0x1F)));
+}
+
+inline __m128i toRGBA4444SSE2(__m128i p)
+{
+    return _mm_or_si128(_mm_or_si128(
+        _mm_slli_epi32(_mm_and_si128(p, _mm_set1_epi32(0xF0)), 8),
+        _mm_and_si128(_mm_srli_epi32(p, 4), _mm_set1_epi32(0xF00))),
+        _mm_or_si128(_mm_and_si128(_mm_srli_epi32(p, 16), _mm_set1_epi32(0xF0)), _mm_srli_epi32(p, 28)));
+}
+
+inline __m128i toRGB5A1SSE2(__m128i p)
+{
+    return _mm_or_si128(_mm_or_si128(
+        _mm_slli_epi32(_mm_and_si128(p, _mm_set1_epi32(0xF8)), 8),
+        _mm_and_si128(_mm_srli_epi32(p, 5), _mm_set1_epi32(0x7C0))),
+        _mm_or_si128(_mm_and_si128(_mm_srli_epi32(p, 18), _mm_set1_epi32(0x3E)), _mm_srli_epi32(p, 31)));
+}
+
+// (R * 299 + G * 587 + B * 114 + 500) / 1000 in the 32 bits lanes
+inline __m128i luminanceSSE2(__m128i p)
+{
+    const __m128i mask = _mm_set1_epi32(0x00FF00FF);
+    __m128i rb = _mm_and_si128(p, mask);
+    __m128i ga = _mm_and_si128(_mm_srli_epi32(p, 8), mask);
+    __m128i sum = _mm_add_epi32(_mm_madd_epi16(rb, _mm_set1_epi32(114 << 16 | 299)), _mm_madd_epi16(ga, _mm_set1_epi32(587)));
+    sum = _mm_add_epi32(sum, _mm_set1_epi32(500));
+    // the rounded quotient never reaches the next integer, so the truncation is exact
+    return _mm_cvttps_epi32(_mm_div_ps(_mm_cvtepi32_ps(sum), _mm_set1_ps(1000.0f)));
+}
+
+inline __m128i toAI88SSE2(__m128i p)
+{
+    return _mm_or_si128(luminanceSSE2(p), _mm_and_si128(_mm_srli_epi32(p, 16), _mm_set1_epi32(0xFF00)));
+}
+
+inline __m128i toA8SSE2(__m128i p)
+{
+    return _mm_srli_epi32(p, 24);
+}
+
+template <__m128i (*PACK)(__m128i), PixelKernel TAIL>
+void rgba8888To16BitsSSE2(const unsigned char* in, ssize_t pixels, unsigned char* out)
+{
+    ssize_t i = 0;
+    for (; i + 8 <= pixels; i += 8)
+    {
+        __m128i a = _mm_loadu_si128((const __m128i*)(in + i * 4));
+        __m128i b = _mm_loadu_si128((const __m128i*)(in + i * 4 + 16));
+        _mm_storeu_si128((__m128i*)(out + i * 2), packLanes16SSE2(PACK(a), PACK(b)));
+    }
+    TAIL(in + i * 4, pixels - i, out + i * 2);
+}
+
+template <__m128i (*PACK)(__m128i), PixelKernel TAIL>
+void rgba8888To8BitsSSE2(const unsigned char* in, ssize_t pixels, unsigned char* out)
+{
+    ssize_t i = 0;
+    for (; i + 16 <= pixels; i += 16)
+    {
+        __m128i a = PACK(_mm_loadu_si128((const __m128i*)(in + i * 4)));
+        __m128i b = PACK(_mm_loadu_si128((const __m128i*)(in + i * 4 + 16)));
+        __m128i c = PACK(_mm_loadu_si128((const __m128i*)(in + i * 4 + 32)));
+        __m128i d = PACK(_mm_loadu_si128((const __m128i*)(in + i * 4 + 48)));
+        _mm_storeu_si128((__m128i*)(out + i), _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d)));
+    }
+    TAIL(in + i * 4, pixels - i, out + i);
+}
+
+void i8ToRGBA8888SSE2(const unsigned char* in, ssize_t pixels, unsigned char* out)
+{
+    const __m128i alpha = _mm_set1_epi8((char)0xFF);
+    ssize_t i = 0;
+    for (; i + 16 <= pixels; i += 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)(in + i));
+        __m128i iiLow = _mm_unpacklo_epi8(v, v);
+        __m128i iiHigh = _mm_unpackhi_epi8(v, v);
+        __m128i iaLow = _mm_unpacklo_epi8(v, alpha);
+        __m128i iaHigh = _mm_unpackhi_epi8(v, alpha);
+        _mm_storeu_si128((__m128i*)(out + i * 4), _mm_unpacklo_epi16(iiLow, iaLow));
+        _mm_storeu_si128((__m128i*)(out + i * 4 + 16), _mm_unpackhi_epi16(iiLow, iaLow));
+        _mm_storeu_si128((__m128i*)(out + i * 4 + 32), _mm_unpacklo_epi16(iiHigh, iaHigh));
+        _mm_storeu_si128((__m128i*)(out + i * 4 + 48), _mm_unpackhi_epi16(iiHigh, iaHigh));
+    }
+    scalarI8ToRGBA8888(in + i, pixels - i, out + i * 4);
+}
+
+void ai88ToRGBA8888SSE2(const unsigned char* in, ssize_t pixels, unsigned char* out)
+{
+    ssize_t i = 0;
+    for (; i + 8 <= pixels; i += 8)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)(in + i * 2));
+        __m128i intensity = _mm_and_si128(v, _mm_set1_epi16(0xFF));
+        __m128i ii = _mm_or_si128(intensity, _mm_slli_epi16(intensity, 8));
+        _mm_storeu_si128((__m128i*)(out + i * 4), _mm_unpacklo_epi16(ii, v));
+        _mm_storeu_si128((__m128i*)(out + i * 4 + 16), _mm_unpackhi_epi16(ii, v));
+    }
+    scalarAI88ToRGBA8888(in + i * 2, pixels - i, out + i * 4);
+}
+
+void rgb888ToRGBA8888SSE2(const unsigned char* in, ssize_t pixels, unsigned char* out)
+{
+    const __m128i lowPixel = _mm_set_epi32(0, 0xFFFFFF, 0, 0xFFFFFF);
+    const __m128i highPixel = _mm_set_epi32(0xFFFFFF, 0, 0xFFFFFF, 0);
+    const __m128i alpha = _mm_set1_epi32(0xFF000000);
+    ssize_t i = 0;
+    // 16 bytes are loaded for 4 pixels, stop before reading past the end
+    for (; i + 6 <= pixels; i += 4)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)(in + i * 3));
+        // bytes 0-7 in the low 64 bits, bytes 6-13 in the high 64 bits: two pixels in each
+        __m128i q = _mm_unpacklo_epi64(v, _mm_srli_si128(v, 6));
+        __m128i p = _mm_or_si128(_mm_and_si128(q, lowPixel), _mm_and_si128(_mm_slli_epi64(q, 8), highPixel));
+        _mm_storeu_si128((__m128i*)(out + i * 4), _mm_or_si128(p, alpha));
+    }
+    scalarRGB888ToRGBA8888(in + i * 3, pixels - i, out + i * 4);
+}
+
+void rgba8888ToRGB888SSE2(const unsigned char* in, ssize_t pixels, unsigned char* out)
+{
+    const __m128i lowPixel = _mm_set_epi32(0, 0xFFFFFF, 0, 0xFFFFFF);
+    const __m128i highPixel = _mm_set_epi32(0xFFFF, 0xFF000000, 0xFFFF, 0xFF000000);
+    ssize_t i = 0;
+    for (; i + 4 <= pixels; i += 4)
+    {
+        __m128i p = _mm_loadu_si128((const __m128i*)(in + i * 4));
+        // 6 bytes at the beginning of each 64 bits half
+        __m128i q = _mm_or_si128(_mm_and_si128(p, lowPixel), _mm_and_si128(_mm_srli_epi64(p, 8), highPixel));
+        __m128i rgb = _mm_or_si128(_mm_move_epi64(q), _mm_slli_si128(_mm_srli_si128(q, 8), 6));
+        _mm_storel_epi64((__m128i*)(out + i * 3), rgb);
+        int last = _mm_cvtsi128_si32(_mm_srli_si128(rgb, 8));
+        memcpy(out + i * 3 + 8, &last, 4);
+    }
+    scalarRGBA8888ToRGB888(in + i * 4, pixels - i, out + i * 3);
+}
+
+void premultiplyAlphaSSE2(const unsigned char* in, ssize_t pixels, unsigned char* out)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi16(1);
+    const __m128i alphaMask = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+    ssize_t i = 0;
+    for (; i + 4 <= pixels; i += 4)
+    {
+        __m128i p = _mm_loadu_si128((const __m128i*)(in + i * 4));
+        __m128i low = _mm_unpacklo_epi8(p, zero);
+        __m128i high = _mm_unpackhi_epi8(p, zero);
+        __m128i alphaLow = _mm_shufflehi_epi16(_mm_shufflelo_epi16(low, 0xFF), 0xFF);
+        __m128i alphaHigh = _mm_shufflehi_epi16(_mm_shufflelo_epi16(high, 0xFF), 0xFF);
+        // c * (a + 1) >> 8, like CC_RGB_PREMULTIPLY_ALPHA, and the alpha unchanged
+        __m128i mulLow = _mm_srli_epi16(_mm_mullo_epi16(low, _mm_add_epi16(alphaLow, one)), 8);
+        __m128i mulHigh = _mm_srli_epi16(_mm_mullo_epi16(high, _mm_add_epi16(alphaHigh, one)), 8);
+        low = _mm_or_si128(_mm_andnot_si128(alphaMask, mulLow), _mm_and_si128(alphaMask, low));
+        high = _mm_or_si128(_mm_andnot_si128(alphaMask, mulHigh), _mm_and_si128(alphaMask, high));
+        _mm_storeu_si128((__m128i*)(out + i * 4), _mm_packus_epi16(low, high));
+    }
+    scalarPremultiplyAlpha(in + i * 4, pixels - i, out + i * 4);
+}
+
+const PixelKernels SSE2_KERNELS = {
+    "SSE2",
+    i8ToRGBA8888SSE2, ai88ToRGBA8888SSE2, rgb888ToRGBA8888SSE2, rgba8888ToRGB888SSE2,
+    rgba8888To16BitsSSE2<toRGB565SSE2, scalarRGBA8888ToRGB565>,
+    rgba8888To16BitsSSE2<toRGBA4444SSE2, scalarRGBA8888ToRGBA4444>,
+    rgba8888To16BitsSSE2<toRGB5A1SSE2, scalarRGBA8888ToRGB5A1>,
+    rgba8888To8BitsSSE2<toA8SSE2, scalarRGBA8888ToA8>,
+    rgba8888To8BitsSSE2<luminanceSSE2, scalarRGBA8888ToI8>,
+    rgba8888To16BitsSSE2<toAI88SSE2, scalarRGBA8888ToAI88>,
+    premultiplyAlphaSSE2
+};
+
+#ifdef INCLUDE_AVX2
+//
+// AVX2, selected at runtime
+//
+bool isAVX2Supported()
+{
+    unsigned int regs[4];
+#if defined (_MSC_VER)
+    __cpuid((int*)regs, 0);
+    if (regs[0] < 7)
+        return false;
+    __cpuid((int*)regs, 1);
+    // AVX and OSXSAVE, then the OS saves the YMM registers
+    if ((regs[2] & (1 << 28 | 1 << 27)) != (1 << 28 | 1 << 27) || (_xgetbv(0) & 6) != 6)
+        return false;
+    __cpuidex((int*)regs, 7, 0);
+#else
+    __cpuid(0, regs[0], regs[1], regs[2], regs[3]);
+    if (regs[0] < 7)
+        return false;
+    __cpuid(1, regs[0], regs[1], regs[2], regs[3]);
+    if ((regs[2] & (1 << 28 | 1 << 27)) != (1 << 28 | 1 << 27))
+        return false;
+    unsigned int xcr0, xcr0High;
+    __asm__ ("xgetbv" : "=a" (xcr0), "=d" (xcr0High) : "c" (0));
+    if ((xcr0 & 6) != 6)
+        return false;
+    __cpuid_count(7, 0, regs[0], regs[1], regs[2], regs[3]);
+#endif
+    return (regs[1] & (1 << 5)) != 0;
+}
+
+CC_AVX2_FUNCTION inline __m256i packLanes16AVX2(__m256i a, __m256i b)
+{
+    a = _mm256_srai_epi32(_mm256_slli_epi32(a, 16), 16);
+    b = _mm256_srai_epi32(_mm256_slli_epi32(b, 16), 16);
+    // the pack interleaves the 128 bits lanes of a and b
+    return _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), 0xD8);
+}
+
+CC_AVX2_FUNCTION inline __m256i toRGB565AVX2(__m256i p)
+{
+    return _mm256_or_si256(_mm256_or_si256(
+        _mm256_slli_epi32(_mm256_and_si256(p, _mm256_set1_epi32(0xF8)), 8),
+        _mm256_and_si256(_mm256_srli_epi32(p, 5), _mm256_set1_epi32(0x7E0))),
+        _mm256_and_si256(_mm256_srli_epi32(p, 19), _mm256_set1_epi32(0x1F)));
+}
+
+CC_AVX2_FUNCTION inline __m256i toRGBA4444AVX2(__m256i p)
+{
+    return _mm256_or_si256(_mm256_or_si256(
+        _mm256_slli_epi32(_mm256_and_si256(p, _mm256_set1_epi32(0xF0)), 8),
+        _mm256_and_si256(_mm256_srli_epi32(p, 4), _mm256_set1_epi32(0xF00))),
+        _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi32(p, 16), _mm256_set1_epi32(0xF0)), _mm256_srli_epi32(p, 28)));
+}
+
+CC_AVX2_FUNCTION inline __m256i toRGB5A1AVX2(__m256i p)
+{
+    return _mm256_or_si256(_mm256_or_si256(
+        _mm256_slli_epi32(_mm256_and_si256(p, _mm256_set1_epi32(0xF8)), 8),
+        _mm256_and_si256(_mm256_srli_epi32(p, 5), _mm256_set1_epi32(0x7C0))),
+        _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi32(p, 18), _mm256_set1_epi32(0x3E)), _mm256_srli_epi32(p, 31)));
+}
+
+CC_AVX2_FUNCTION inline __m256i luminanceAVX2(__m256i p)
+{
+    const __m256i mask = _mm256_set1_epi32(0x00FF00FF);
+    __m256i rb = _mm256_and_si256(p, mask);
+    __m256i ga = _mm256_and_si256(_mm256_srli_epi32(p, 8), mask);
+    __m256i sum = _mm256_add_epi32(_mm256_madd_epi16(rb, _mm256_set1_epi32(114 << 16 | 299)), _mm256_madd_epi16(ga, _mm256_set1_epi32(587)));
+    sum = _mm256_add_epi32(sum, _mm256_set1_epi32(500));
+    return _mm256_cvttps_epi32(_mm256_div_ps(_mm256_cvtepi32_ps(sum), _mm256_set1_ps(1000.0f)));
+}
+
+CC_AVX2_FUNCTION inline __m256i toAI88AVX2(__m256i p)
+{
+    return _mm256_or_si256(luminanceAVX2(p), _mm256_and_si256(_mm256_srli_epi32(p, 16), _mm256_set1_epi32(0xFF00)));
+}
+
+CC_AVX2_FUNCTION inline __m256i toA8AVX2(__m256i p)
+{
+    return _mm256_srli_epi32(p, 24);
+}
+
+template <__m256i (*PACK)(__m256i), PixelKernel TAIL>
+CC_AVX2_FUNCTION void rgba8888To16BitsAVX2(const unsigned char* in, ssize_t pixels, unsigned char* out)
+{
+    ssize_t i = 0;
+    for (; i + 16 <= pixels; i += 16)
+    {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(in + i * 4));
+        __m256i b = _mm256_loadu_si256((const __m256i*)(in + i * 4 + 32));
+        _mm256_storeu_si256((__m256i*)(out + i * 2), packLanes16AVX2(PACK(a), PACK(b)));
+    }
+    TAIL(in + i * 4, pixels - i, out + i * 2);
+}
+
+template <__m256i (*PACK)(__m256i), PixelKernel TAIL>
+CC_AVX2_FUNCTION void rgba8888To8BitsAVX2(const unsigned char* in, ssize_t pixels, unsigned char* out)
+{
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    ssize_t i = 0;
+    for (; i + 32 <= pixels; i += 32)
+    {
+        __m256i a = PACK(_mm256_loadu_si256((const __m256i*)(in + i * 4)));
+        __m256i b = PACK(_mm256_loadu_si256((const __m256i*)(in + i * 4 + 32)));
+        __m256i c = PACK(_mm256_loadu_si256((const __m256i*)(in + i * 4 + 64)));
+        __m256i d = PACK(_mm256_loadu_si256((const __m256i*)(in + i * 4 + 96)));
+        __m256i packed = _mm256_packus_epi16(_mm256_packs_epi32(a, b), _mm256_packs_epi32(c, d));
+        _mm256_storeu_si256((__m256i*)(out + i), _mm256_permutevar8x32_epi32(packed, order));
+    }
+    TAIL(in + i * 4, pixels - i, out + i);
+}
+
+CC_AVX2_FUNCTION void i8ToRGBA8888AVX2(const unsigned char* in, ssize_t pixels, unsigned char* out)
+{
+    const __m256i gray = _mm256_set1_epi32(0x010101);
+    const __m256i alpha = _mm256_set1_epi32(0xFF000000);
+    ssize_t i = 0;
+    for (; i + 16 <= pixels; i += 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)(in + i));
+        __m256i low = _mm256_cvtepu8_epi32(v);
+        __m256i high = _mm256_cvtepu8_epi32(_mm_srli_si128(v, 8));
+        _mm256_storeu_si256((__m256i*)(out + i * 4), _mm256_or_si256(_mm256_mullo_epi32(low, gray), alpha));
+        _mm256_storeu_si256((__m256i*)(out + i * 4 + 32), _mm256_or_si256(_mm256_mullo_epi32(high, gray), alpha));
+    }
+    scalarI8ToRGBA8888(in + i, pixels - i, out + i * 4);
+}
+
+CC_AVX2_FUNCTION void ai88ToRGBA8888AVX2(const unsigned char* in, ssize_t pixels, unsigned char* out)
+{
+    const __m256i gray = _mm256_set1_epi32(0x010101);
+    ssize_t i = 0;
+    for (; i + 8 <= pixels; i += 8)
+    {
+        __m256i v = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)(in + i * 2)));
+        __m256i intensity = _mm256_mullo_epi32(_mm256_and_si256(v, _mm256_set1_epi32(0xFF)), gray);
+        __m256i alpha = _mm256_slli_epi32(_mm256_srli_epi32(v, 8), 24);
+        _mm256_storeu_si256((__m256i*)(out + i * 4), _mm256_or_si256(intensity, alpha));
+    }
+    scalarAI88ToRGBA8888(in + i * 2, pixels - i, out + i * 4);
+}
+
+// the RGB888 conversions are shuffles, AVX2 CPUs have SSSE3
+CC_AVX2_FUNCTION void rgb888ToRGBA8888AVX2(const unsigned char* in, ssize_t pixels, unsigned char* out)
+{
+    const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m128i alpha = _mm_set1_epi32(0xFF000000);
+    ssize_t i = 0;
+    for (; i + 6 <= pixels; i += 4)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)(in + i * 3));
+        _mm_storeu_si128((__m128i*)(out + i * 4), _mm_or_si128(_mm_shuffle_epi8(v, shuffle), alpha));
+    }
+    scalarRGB888ToRGBA8888(in + i * 3, pixels - i, out + i * 4);
+}
+
+CC_AVX2_FUNCTION void rgba8888ToRGB888AVX2(const unsigned char* in, ssize_t pixels, unsigned char* out)
+{
+    const __m128i shuffle = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    ssize_t i = 0;
+    // 16 bytes are stored for 4 pixels, stop before writing past the end
+    for (; i + 6 <= pixels; i += 4)
+    {
+        __m128i p = _mm_loadu_si128((const __m128i*)(in + i * 4));
+        _mm_storeu_si128((__m128i*)(out + i * 3), _mm_shuffle_epi8(p, shuffle));
+    }
+    scalarRGBA8888ToRGB888(in + i * 4, pixels - i, out + i * 3);
+}
+
+CC_AVX2_FUNCTION void premultiplyAlphaAVX2(const unsigned char* in, ssize_t pixels, unsigned char* out)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi16(1);
+    const __m256i alphaMask = _mm256_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0);
+    ssize_t i = 0;
+    for (; i + 8 <= pixels; i += 8)
+    {
+        __m256i p = _mm256_loadu_si256((const __m256i*)(in + i * 4));
+        // unpacked and packed inside the 128 bits lanes, so the order is kept
+        __m256i low = _mm256_unpacklo_epi8(p, zero);
+        __m256i high = _mm256_unpackhi_epi8(p, zero);
+        __m256i alphaLow = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(low, 0xFF), 0xFF);
+        __m256i alphaHigh = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(high, 0xFF), 0xFF);
+        __m256i mulLow = _mm256_srli_epi16(_mm256_mullo_epi16(low, _mm256_add_epi16(alphaLow, one)), 8);
+        __m256i mulHigh = _mm256_srli_epi16(_mm256_mullo_epi16(high, _mm256_add_epi16(alphaHigh, one)), 8);
+        low = _mm256_or_si256(_mm256_andnot_si256(alphaMask, mulLow), _mm256_and_si256(alphaMask, low));
+        high = _mm256_or_si256(_mm256_andnot_si256(alphaMask, mulHigh), _mm256_and_si256(alphaMask, high));
+        _mm256_storeu_si256((__m256i*)(out + i * 4), _mm256_packus_epi16(low, high));
+    }
+    scalarPremultiplyAlpha(in + i * 4, pixels - i, out + i * 4);
+}
+
+const PixelKernels AVX2_KERNELS = {
+    "AVX2",
+    i8ToRGBA8888AVX2, ai88ToRGBA8888AVX2, rgb888ToRGBA8888AVX2, rgba8888ToRGB888AVX2,
+    rgba8888To16BitsAVX2<toRGB565AVX2, scalarRGBA8888ToRGB565>,
+    rgba8888To16BitsAVX2<toRGBA4444AVX2, scalarRGBA8888ToRGBA4444>,
+    rgba8888To16BitsAVX2<toRGB5A1AVX2, scalarRGBA8888ToRGB5A1>,
+    rgba8888To8BitsAVX2<toA8AVX2, scalarRGBA8888ToA8>,
+    rgba8888To8BitsAVX2<luminanceAVX2, scalarRGBA8888ToI8>,
+    rgba8888To16BitsAVX2<toAI88AVX2, scalarRGBA8888ToAI88>,
+    premultiplyAlphaAVX2
+};
+#endif // INCLUDE_AVX2
+
+}
@@ -70,8 +70,7 @@ TextureAtlas::~TextureAtlas()
 
     if (Configuration::getInstance()->supportsShareableVAO())
     {
-        glDeleteVertexArrays(1, &_VAOname);
-        GL::bindVAO(0);
+        GL::deleteVertexArrays(1, &_VAOname);
     }
     CC_SAFE_RELEASE(_texture);
     
@@ -254,6 +253,16 @@ void TextureAtlas::setupIndices()
 
 void TextureAtlas::setupVBOandVAO()
 {
+    // set up by the render thread, see GL::genVertexArrays()
+    auto renderer = Director::getInstance()->getRenderer();
+    if (!renderer->isRenderThread())
+    {
+        renderer->runOnRenderThread([this]() {
+            setupVBOandVAO();
+        }, true);
+        return;
+    }
+
     glGenVertexArrays(1, &_VAOname);
     GL::bindVAO(_VAOname);
 
@@ -27,16 +27,19 @@ THE SOFTWARE.
 
 #include "renderer/CCTextureCache.h"
 
+#include <algorithm>
 #include <errno.h>
 #include <stack>
 #include <cctype>
 #include <list>
+#include <vector>
 
 #include "renderer/CCTexture2D.h"
 #include "base/ccMacros.h"
 #include "base/ccUTF8.h"
 #include "base/CCDirector.h"
 #include "base/CCScheduler.h"
+#include "base/CCEventDispatcher.h"
 #include "platform/CCFileUtils.h"
 #include "base/ccUtils.h"
 #include "base/CCNinePatchImageParser.h"
@@ -49,6 +52,8 @@ NS_CC_BEGIN
 
 std::string TextureCache::s_etc1AlphaFileSuffix = "@alpha";
 
+const char* TextureCache::EVENT_TEXTURE_EVICTED = "texture_cache_texture_evicted";
+
 // implementation TextureCache
 
 void TextureCache::setETC1AlphaFileSuffix(const std::string& suffix)
@@ -65,6 +70,10 @@ TextureCache::TextureCache()
 : _loadingThread(nullptr)
 , _needQuit(false)
 , _asyncRefCount(0)
+, _dynamicAtlas(nullptr)
+, _transcodingMinSize(0)
+, _textureStreamer(nullptr)
+, _memoryBudget(0)
 {
 }
 
@@ -75,6 +84,10 @@ TextureCache::~TextureCache()
     for (auto it = _textures.begin(); it != _textures.end(); ++it)
         (it->second)->release();
 
+    CC_SAFE_RELEASE(_dynamicAtlas);
+    if (_textureStreamer)
+        _textureStreamer->removeAllTextures();
+    CC_SAFE_RELEASE(_textureStreamer);
     CC_SAFE_DELETE(_loadingThread);
 }
 
@@ -99,13 +112,15 @@ std::string TextureCache::getDescription() const
 struct TextureCache::AsyncStruct
 {
 public:
-    AsyncStruct(const std::string& fn, std::function<void(Texture2D*)> f) : filename(fn), callback(f), pixelFormat(Texture2D::getDefaultAlphaPixelFormat()), loadSuccess(false) {}
+    AsyncStruct(const std::string& fn, std::function<void(Texture2D*)> f) : filename(fn), callback(f), pixelFormat(Texture2D::getDefaultAlphaPixelFormat()), transcodingMinSize(0), streamingMinSize(0), loadSuccess(false) {}
 
     std::string filename;
     std::function<void(Texture2D*)> callback;
     Image image;
     Image imageAlpha;
     Texture2D::PixelFormat pixelFormat;
+    int transcodingMinSize;
+    int streamingMinSize;
     bool loadSuccess;
 };
 
@@ -147,6 +162,7 @@ void TextureCache::addImageAsync(const std::string &path, const std::function<vo
 
     if (texture != nullptr)
     {
+        markTextureUsed(texture);
         if (callback) callback(texture);
         return;
     }
@@ -174,6 +190,9 @@ void TextureCache::addImageAsync(const std::string &path, const std::function<vo
 
     // generate async struct
     AsyncStruct *data = new (std::nothrow) AsyncStruct(fullpath, callback);
+    data->transcodingMinSize = getTranscodingMinSize(fullpath, data->pixelFormat);
+    if (_textureStreamer && !NinePatchImageParser::isNinePatchImage(fullpath))
+        data->streamingMinSize = _textureStreamer->getMinSize();
 
     // add async struct into queue
     _asyncStructQueue.push_back(data);
@@ -241,6 +260,12 @@ void TextureCache::loadImage()
         // load image
         asyncStruct->loadSuccess = asyncStruct->image.initWithImageFileThreadSafe(asyncStruct->filename);
 
+        // off the main thread, the opaque images can be encoded to ETC1, the streamed ones are downsampled instead
+        auto& image = asyncStruct->image;
+        const bool streamed = asyncStruct->streamingMinSize > 0 && std::max(image.getWidth(), image.getHeight()) >= asyncStruct->streamingMinSize;
+        if (asyncStruct->loadSuccess && !streamed && isTranscodable(image, asyncStruct->transcodingMinSize))
+            image.transcode(true);
+
         // ETC1 ALPHA supports.
         if (asyncStruct->loadSuccess && asyncStruct->image.getFileType() == Image::Format::ETC && !s_etc1AlphaFileSuffix.empty())
         { // check whether alpha texture exists & load it
@@ -295,11 +320,18 @@ void TextureCache::addImageAsyncCallBack(float dt)
             {
                 Image* image = &(asyncStruct->image);
                 // generate texture in render thread
-                texture = new (std::nothrow) Texture2D();
+                texture = createStreamedTexture(image, asyncStruct->filename, asyncStruct->pixelFormat);
+                if (!texture)
+                {
+                    texture = new (std::nothrow) Texture2D();
 
-                texture->initWithImage(image, asyncStruct->pixelFormat);
-                //parse 9-patch info
-                this->parseNinePatchImage(image, texture, asyncStruct->filename);
+                    texture->initWithImage(image, asyncStruct->pixelFormat);
+                    //parse 9-patch info
+                    this->parseNinePatchImage(image, texture, asyncStruct->filename);
+
+                    if (_dynamicAtlas && !NinePatchImageParser::isNinePatchImage(asyncStruct->filename))
+                        _dynamicAtlas->addTexture(texture, image);
+                }
 #if CC_ENABLE_CACHE_TEXTURE_DATA
                 // cache the texture file name
                 VolatileTextureMgr::addImageTexture(texture, asyncStruct->filename);
@@ -324,6 +356,9 @@ void TextureCache::addImageAsyncCallBack(float dt)
             }
         }
 
+        if (texture)
+            markTextureUsed(texture);
+
         // call callback function
         if (asyncStruct->callback)
         {
@@ -335,6 +370,8 @@ void TextureCache::addImageAsyncCallBack(float dt)
         --_asyncRefCount;
     }
 
+    applyMemoryBudget();
+
     if (0 == _asyncRefCount)
     {
         Director::getInstance()->getScheduler()->unschedule(CC_SCHEDULE_SELECTOR(TextureCache::addImageAsyncCallBack), this);
@@ -356,7 +393,10 @@ Texture2D * TextureCache::addImage(const std::string &path)
     }
     auto it = _textures.find(fullpath);
     if (it != _textures.end())
+    {
         texture = it->second;
+        markTextureUsed(texture);
+    }
 
     if (!texture)
     {
@@ -369,6 +409,20 @@ Texture2D * TextureCache::addImage(const std::string &path)
             bool bRet = image->initWithImageFile(fullpath);
             CC_BREAK_IF(!bRet);
 
+            texture = createStreamedTexture(image, fullpath, Texture2D::getDefaultAlphaPixelFormat());
+            if (texture)
+            {
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+                // cache the texture file name
+                VolatileTextureMgr::addImageTexture(texture, fullpath);
+#endif
+                _textures.insert(std::make_pair(fullpath, texture));
+                break;
+            }
+
+            if (isTranscodable(*image, getTranscodingMinSize(fullpath, Texture2D::getDefaultAlphaPixelFormat())))
+                image->transcode(false);
+
             texture = new (std::nothrow) Texture2D();
 
             if (texture && texture->initWithImage(image))
@@ -397,6 +451,9 @@ Texture2D * TextureCache::addImage(const std::string &path)
 
                 //parse 9-patch info
                 this->parseNinePatchImage(image, texture, path);
+
+                if (_dynamicAtlas && !NinePatchImageParser::isNinePatchImage(path))
+                    _dynamicAtlas->addTexture(texture, image);
             }
             else
             {
@@ -405,6 +462,12 @@ Texture2D * TextureCache::addImage(const std::string &path)
                 texture = nullptr;
             }
         } while (0);
+
+        if (texture)
+        {
+            markTextureUsed(texture);
+            applyMemoryBudget();
+        }
     }
 
     CC_SAFE_RELEASE(image);
@@ -460,6 +523,12 @@ Texture2D* TextureCache::addImage(Image *image, const std::string &key)
 
     } while (0);
 
+    if (texture)
+    {
+        markTextureUsed(texture);
+        applyMemoryBudget();
+    }
+
 #if CC_ENABLE_CACHE_TEXTURE_DATA
     VolatileTextureMgr::addImage(texture, image);
 #endif
@@ -497,7 +566,13 @@ bool TextureCache::reloadTexture(const std::string& fileName)
             bool bRet = image->initWithImageFile(fullpath);
             CC_BREAK_IF(!bRet);
 
+            if (isTranscodable(*image, getTranscodingMinSize(fullpath, Texture2D::getDefaultAlphaPixelFormat())))
+                image->transcode(false);
+
             ret = texture->initWithImage(image);
+
+            if (ret && _dynamicAtlas && !NinePatchImageParser::isNinePatchImage(fullpath))
+                _dynamicAtlas->addTexture(texture, image);
         } while (0);
     }
 
@@ -514,15 +589,20 @@ void TextureCache::removeAllTextures()
         (it->second)->release();
     }
     _textures.clear();
+    _lastUsedFrames.clear();
+
+    if (_dynamicAtlas)
+        _dynamicAtlas->removeAllTextures();
 }
 
 void TextureCache::removeUnusedTextures()
 {
     for (auto it = _textures.cbegin(); it != _textures.cend(); /* nothing */) {
         Texture2D *tex = it->second;
-        if (tex->getReferenceCount() == 1) {
+        if (isTextureUnused(tex)) {
             CCLOG("cocos2d: TextureCache: removing unused texture: %s", it->first.c_str());
 
+            forgetTexture(tex);
             tex->release();
             it = _textures.erase(it);
         }
@@ -542,6 +622,7 @@ void TextureCache::removeTexture(Texture2D* texture)
 
     for (auto it = _textures.cbegin(); it != _textures.cend(); /* nothing */) {
         if (it->second == texture) {
+            forgetTexture(texture);
             it->second->release();
             it = _textures.erase(it);
             break;
@@ -562,6 +643,7 @@ void TextureCache::removeTextureForKey(const std::string &textureKeyName)
     }
 
     if (it != _textures.end()) {
+        forgetTexture(it->second);
         it->second->release();
         _textures.erase(it);
     }
@@ -578,7 +660,10 @@ Texture2D* TextureCache::getTextureForKey(const std::string &textureKeyName) con
     }
 
     if (it != _textures.end())
+    {
+        markTextureUsed(it->second);
         return it->second;
+    }
     return nullptr;
 }
 
@@ -603,6 +688,157 @@ std::string TextureCache::getTextureFilePath(cocos2d::Texture2D* texture) const
     return "";
 }
 
+void TextureCache::setTranscodingEnabled(bool enabled, int minSize)
+{
+    _transcodingMinSize = enabled ? std::max(minSize, 1) : 0;
+}
+
+int TextureCache::getTranscodingMinSize(const std::string& path, Texture2D::PixelFormat pixelFormat) const
+{
+    // the 9-patch parser reads RGBA8888 pixels, and other formats were chosen explicitly
+    if (!_transcodingMinSize
+        || (pixelFormat != Texture2D::PixelFormat::RGBA8888 && pixelFormat != Texture2D::PixelFormat::AUTO)
+        || NinePatchImageParser::isNinePatchImage(path))
+    {
+        return 0;
+    }
+    return _transcodingMinSize;
+}
+
+bool TextureCache::isTranscodable(Image& image, int minSize)
+{
+    return minSize > 0 && image.getWidth() >= minSize && image.getHeight() >= minSize;
+}
+
+void TextureCache::setDynamicAtlasEnabled(bool enabled)
+{
+    if (enabled == (_dynamicAtlas != nullptr))
+        return;
+
+    if (enabled)
+    {
+        // only the images loaded from now on are packed
+        _dynamicAtlas = new (std::nothrow) DynamicAtlas();
+    }
+    else
+    {
+        CC_SAFE_RELEASE_NULL(_dynamicAtlas);
+    }
+}
+
+Texture2D* TextureCache::createStreamedTexture(Image* image, const std::string& path, Texture2D::PixelFormat pixelFormat)
+{
+    if (!_textureStreamer || NinePatchImageParser::isNinePatchImage(path) || !_textureStreamer->isStreamable(image))
+        return nullptr;
+
+    return _textureStreamer->createTexture(image, path, pixelFormat);
+}
+
+void TextureCache::setStreamingEnabled(bool enabled)
+{
+    if (enabled == (_textureStreamer != nullptr))
+        return;
+
+    if (enabled)
+    {
+        // only the images loaded from now on are streamed
+        _textureStreamer = new (std::nothrow) TextureStreamer();
+    }
+    else
+    {
+        _textureStreamer->removeAllTextures();
+        CC_SAFE_RELEASE_NULL(_textureStreamer);
+    }
+}
+
+void TextureCache::setMemoryBudget(size_t budget)
+{
+    _memoryBudget = budget;
+    applyMemoryBudget();
+}
+
+size_t TextureCache::getTextureMemorySize(Texture2D* texture)
+{
+    // the streamed textures are uploaded with a reduced resolution
+    const size_t width = std::max(texture->getPixelsWide() >> texture->getLOD(), 1);
+    const size_t height = std::max(texture->getPixelsHigh() >> texture->getLOD(), 1);
+    size_t size = width * height * texture->getBitsPerPixelForFormat() / 8;
+    if (texture->hasMipmaps())
+        size += size / 3;
+    return size;
+}
+
+size_t TextureCache::getMemoryUsage() const
+{
+    size_t usage = 0;
+    for (const auto& item : _textures)
+    {
+        usage += getTextureMemorySize(item.second);
+    }
+    return usage;
+}
+
+void TextureCache::markTextureUsed(Texture2D* texture) const
+{
+    _lastUsedFrames[texture] = Director::getInstance()->getTotalFrames();
+}
+
+void TextureCache::forgetTexture(Texture2D* texture)
+{
+    _lastUsedFrames.erase(texture);
+    if (_dynamicAtlas)
+        _dynamicAtlas->removeTexture(texture);
+}
+
+bool TextureCache::isTextureUnused(Texture2D* texture) const
+{
+    // adding the image again would pack a copy of it while its region is still drawn
+    return texture->getReferenceCount() == 1 && !(_dynamicAtlas && _dynamicAtlas->isPageInUse(texture));
+}
+
+void TextureCache::applyMemoryBudget()
+{
+    if (_memoryBudget == 0)
+        return;
+
+    size_t usage = getMemoryUsage();
+    if (usage <= _memoryBudget)
+        return;
+
+    // the textures only referenced by the cache, the least recently used first
+    const unsigned int frame = Director::getInstance()->getTotalFrames();
+    std::vector<std::pair<unsigned int, std::string>> candidates;
+    for (const auto& item : _textures)
+    {
+        auto used = _lastUsedFrames.find(item.second);
+        const unsigned int lastUsed = (used != _lastUsedFrames.end()) ? used->second : 0;
+        if (isTextureUnused(item.second) && lastUsed != frame)
+            candidates.push_back(std::make_pair(lastUsed, item.first));
+    }
+    std::sort(candidates.begin(), candidates.end());
+
+    for (const auto& candidate : candidates)
+    {
+        if (usage <= _memoryBudget)
+            break;
+
+        // the listeners may have changed the cache
+        auto it = _textures.find(candidate.second);
+        if (it == _textures.end() || !isTextureUnused(it->second))
+            continue;
+
+        Texture2D* texture = it->second;
+        CCLOG("cocos2d: TextureCache: evicting unused texture: %s", candidate.second.c_str());
+        usage -= std::min(usage, getTextureMemorySize(texture));
+
+        Director::getInstance()->getEventDispatcher()->dispatchCustomEvent(EVENT_TEXTURE_EVICTED, texture);
+
+        forgetTexture(texture);
+        _textures.erase(candidate.second);
+        texture->release();
+    }
+}
+
 void TextureCache::waitForQuit()
 {
     // notify sub thread to quick
@@ -626,8 +862,8 @@ std::string TextureCache::getCachedTextureInfo() const
 
         Texture2D* tex = it->second;
         unsigned int bpp = tex->getBitsPerPixelForFormat();
-        // Each texture takes up width * height * bytesPerPixel bytes.
-        auto bytes = tex->getPixelsWide() * tex->getPixelsHigh() * bpp / 8;
+        // Each texture takes up width * height * bytesPerPixel bytes, and a third more with its mipmaps.
+        auto bytes = getTextureMemorySize(tex);
         totalBytes += bytes;
         count++;
         snprintf(buftmp, sizeof(buftmp) - 1, "\"%s\" rc=%lu id=%lu %lu x %lu @ %ld bpp => %lu KB\n",
@@ -669,6 +905,10 @@ void TextureCache::renameTextureWithKey(const std::string& srcName, const std::s
             if (ret)
             {
                 tex->initWithImage(image);
+                if (_dynamicAtlas)
+                    _dynamicAtlas->removeTexture(tex);
+                if (_textureStreamer)
+                    _textureStreamer->removeTexture(tex);
                 _textures.insert(std::make_pair(fullpath, tex));
                 _textures.erase(it);
             }
@@ -818,6 +1058,9 @@ void VolatileTextureMgr::removeTexture(Texture2D *t)
 
 void VolatileTextureMgr::reloadAllTextures()
 {
+    // the textures over the budget would be evicted right after being reloaded
+    Director::getInstance()->getTextureCache()->applyMemoryBudget();
+
     _isReloading = true;
 
     // we need to release all of the glTextures to avoid collisions of texture id's when reloading the textures onto the GPU
@@ -843,6 +1086,11 @@ void VolatileTextureMgr::reloadAllTextures()
 
             if (image && image->initWithImageData(data.getBytes(), data.getSize()))
             {
+                // without the ETC1 encoder, which would block the main thread
+                auto textureCache = Director::getInstance()->getTextureCache();
+                if (TextureCache::isTranscodable(*image, textureCache->getTranscodingMinSize(vt->_fileName, vt->_pixelFormat)))
+                    image->transcode(false);
+
                 Texture2D::PixelFormat oldPixelFormat = Texture2D::getDefaultAlphaPixelFormat();
                 Texture2D::setDefaultAlphaPixelFormat(vt->_pixelFormat);
                 vt->_texture->initWithImage(image);
@@ -39,6 +39,8 @@ THE SOFTWARE.
 #include "base/CCRef.h"
 #include "renderer/CCTexture2D.h"
 #include "platform/CCImage.h"
+#include "renderer/CCDynamicAtlas.h"
+#include "renderer/CCTextureStreamer.h"
 
 #if CC_ENABLE_CACHE_TEXTURE_DATA
     #include <list>
@@ -85,6 +87,12 @@ public:
     // ETC1 ALPHA supports.
     static void setETC1AlphaFileSuffix(const std::string& suffix);
 
+    /** Event dispatched when a texture is evicted to stay under the memory budget, before it is released.
+     * The user data of the EventCustom is the Texture2D.
+     * @since v3.13
+     */
+    static const char* EVENT_TEXTURE_EVICTED;
+
 public:
     /**
      * @js ctor
@@ -169,7 +177,8 @@ public:
     void removeAllTextures();
 
     /** Removes unused textures.
-    * Textures that have a retain count of 1 will be deleted.
+    * Textures that have a retain count of 1 will be deleted, unless they are packed in a dynamic atlas page
+    * which is still in use.
     * It is convenient to call this method after when starting a new Scene.
     * @since v0.8
     */
@@ -215,11 +224,91 @@ public:
     */
     void renameTextureWithKey(const std::string& srcName, const std::string& dstName);
 
+    /** Packs the small images loaded from files into shared atlas pages, see DynamicAtlas.
+    * Sprites and SpriteFrames created from image files then use the pages, so they can be batched together.
+    * Since their texture rects are offset in the pages, it shouldn't be enabled if the game relies on
+    * sprites created from files using the whole standalone texture.
+    * Disabling it releases the pages that aren't used anymore. Disabled by default.
+    *
+    * @since v3.13
+    */
+    void setDynamicAtlasEnabled(bool enabled);
+    bool isDynamicAtlasEnabled() const { return _dynamicAtlas != nullptr; }
+
+    /** Returns the dynamic atlas, or nullptr if it is disabled.
+    * @since v3.13
+    */
+    DynamicAtlas* getDynamicAtlas() const { return _dynamicAtlas; }
+
+    /** Converts the large images loaded from files to formats which take less memory, see Image::transcode().
+    * The images loaded by addImageAsync() are converted by the loading thread, which also encodes the opaque
+    * ones to ETC1 when the GPU supports it. The ones loaded by addImage() are only converted to 16 bits formats,
+    * so that the main thread isn't blocked by the encoder.
+    * 9-patch images, images whose width or height is less than minSize, and the ones loaded while the default
+    * alpha pixel format isn't RGBA8888 are kept as they are. The textures reloaded when the GL context is
+    * recreated are converted again, to 16 bits formats. Disabled by default.
+    *
+    * @since v3.13
+    */
+    void setTranscodingEnabled(bool enabled, int minSize = 512);
+    bool isTranscodingEnabled() const { return _transcodingMinSize > 0; }
+
+    /** Streams the resolution of the large images loaded from files, see TextureStreamer.
+    * Their textures are created with a low resolution, which is raised while they're drawn large enough,
+    * within the memory budget of the streamer. 9-patch images and compressed images are loaded as usual,
+    * and the streamed images aren't transcoded.
+    * Disabling it stops streaming, the textures keep their current resolution. Disabled by default.
+    *
+    * @since v3.13
+    */
+    void setStreamingEnabled(bool enabled);
+    bool isStreamingEnabled() const { return _textureStreamer != nullptr; }
+
+    /** Returns the texture streamer, or nullptr if streaming is disabled.
+    * @since v3.13
+    */
+    TextureStreamer* getTextureStreamer() const { return _textureStreamer; }
+
+    /** Sets the memory budget of the cached textures, in bytes, or 0 to disable it.
+    * When the textures take more memory, the ones which are only referenced by the cache are released,
+    * the least recently used first. A texture is used when it is added or looked up in the cache, and the
+    * textures used during the current frame are never evicted. EVENT_TEXTURE_EVICTED is dispatched for
+    * each evicted texture. Disabled by default.
+    *
+    * @since v3.13
+    */
+    void setMemoryBudget(size_t budget);
+    size_t getMemoryBudget() const { return _memoryBudget; }
+
+    /** Returns the memory taken by the cached textures in GL, in bytes.
+    * @since v3.13
+    */
+    size_t getMemoryUsage() const;
+
+    /** Evicts the least recently used textures until the memory usage fits the budget.
+    * It is called when textures are added, and before the textures are reloaded once the GL context is lost.
+    * @since v3.13
+    */
+    void applyMemoryBudget();
+
 
 private:
     void addImageAsyncCallBack(float dt);
     void loadImage();
     void parseNinePatchImage(Image* image, Texture2D* texture, const std::string& path);
+    // the minimum width and height of the images loaded from the file to transcode them, or 0
+    int getTranscodingMinSize(const std::string& path, Texture2D::PixelFormat pixelFormat) const;
+    // whether the image is large enough to be transcoded, a minSize of 0 never is
+    static bool isTranscodable(Image& image, int minSize);
+    // memory taken by the texture in GL, with its current level of detail and its mipmaps
+    static size_t getTextureMemorySize(Texture2D* texture);
+    void markTextureUsed(Texture2D* texture) const;
+    // forgets what the cache knows about a texture which is removed
+    void forgetTexture(Texture2D* texture);
+    // whether only the cache references the texture, and the sprites don't draw it from a dynamic atlas page
+    bool isTextureUnused(Texture2D* texture) const;
+    // creates a streamed texture if the image can be streamed, or returns nullptr
+    Texture2D* createStreamedTexture(Image* image, const std::string& path, Texture2D::PixelFormat pixelFormat);
 public:
 protected:
     struct AsyncStruct;
@@ -241,7 +330,17 @@ protected:
 
     std::unordered_map<std::string, Texture2D*> _textures;
 
+    DynamicAtlas* _dynamicAtlas;
+    int _transcodingMinSize;
+    TextureStreamer* _textureStreamer;
+    size_t _memoryBudget;
+    // frame when each texture was last added or looked up
+    mutable std::unordered_map<Texture2D*, unsigned int> _lastUsedFrames;
+
     static std::string s_etc1AlphaFileSuffix;
+
+    // the reloaded textures are transcoded like when they were loaded
+    friend class VolatileTextureMgr;
 };
 
 #if CC_ENABLE_CACHE_TEXTURE_DATA
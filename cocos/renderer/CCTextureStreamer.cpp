@@ -0,0 +1,402 @@
+/****************************************************************************
+ Copyright (c) 2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "renderer/CCTextureStreamer.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+
+#include "2d/CCCamera.h"
+#include "3d/CCAABB.h"
+#include "base/CCAsyncTaskPool.h"
+#include "base/CCConfiguration.h"
+#include "base/CCDirector.h"
+#include "base/CCScheduler.h"
+#include "base/ccMacros.h"
+#include "platform/CCImage.h"
+#include "renderer/ccGLStateCache.h"
+
+#ifndef GL_TEXTURE_MAX_ANISOTROPY_EXT
+#define GL_TEXTURE_MAX_ANISOTROPY_EXT 0x84FE
+#endif
+#ifndef GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT
+#define GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT 0x84FF
+#endif
+
+NS_CC_BEGIN
+
+// frames after which a texture which isn't drawn goes back to its lowest level of detail
+static const unsigned int UNUSED_FRAMES = 120;
+// images loaded at the same time
+static const int MAX_LOADS = 2;
+
+TextureStreamer::TextureStreamer(size_t budget, int minSize, int lowestSize)
+: _budget(budget)
+, _minSize(minSize)
+, _lowestSize(std::max(lowestSize, 1))
+, _maxAnisotropy(1)
+, _frame(0)
+, _loadingCount(0)
+{
+    Director::getInstance()->getScheduler()->scheduleUpdate(this, 0, false);
+}
+
+TextureStreamer::~TextureStreamer()
+{
+    Director::getInstance()->getScheduler()->unscheduleUpdate(this);
+    removeAllTextures();
+}
+
+bool TextureStreamer::isStreamable(Image* image) const
+{
+    switch (image->getRenderFormat())
+    {
+    case Texture2D::PixelFormat::RGBA8888:
+    case Texture2D::PixelFormat::RGB888:
+    case Texture2D::PixelFormat::AI88:
+    case Texture2D::PixelFormat::I8:
+    case Texture2D::PixelFormat::A8:
+        break;
+    default:
+        return false;
+    }
+
+    return !image->isCompressed()
+        && image->getNumberOfMipmaps() <= 1
+        && std::max(image->getWidth(), image->getHeight()) >= _minSize;
+}
+
+Texture2D* TextureStreamer::createTexture(Image* image, const std::string& path, Texture2D::PixelFormat format)
+{
+    CCASSERT(image && isStreamable(image), "Invalid image");
+
+    const int width = image->getWidth();
+    const int height = image->getHeight();
+    const int maxLOD = getMaxLOD(width, height);
+
+    auto texture = new (std::nothrow) Texture2D();
+    if (!texture || !image->downsample(maxLOD) || !texture->initWithImage(image, format))
+    {
+        CCLOG("cocos2d: TextureStreamer: couldn't create a texture for %s", path.c_str());
+        CC_SAFE_RELEASE(texture);
+        return nullptr;
+    }
+
+    // the texture has the size of the full resolution, only the uploaded pixels are smaller
+    texture->_pixelsWide = width;
+    texture->_pixelsHigh = height;
+    texture->_contentSize = Size((float)width, (float)height);
+    texture->_lod = maxLOD;
+
+    track(texture, path, maxLOD);
+    return texture;
+}
+
+bool TextureStreamer::addTexture(Texture2D* texture, const std::string& path)
+{
+    CCASSERT(texture, "Invalid texture");
+
+    if (texture->_streamer == this)
+        return true;
+
+    const int width = texture->getPixelsWide();
+    const int height = texture->getPixelsHigh();
+    if (texture->_streamer
+        || Texture2D::getPixelFormatInfoMap().at(texture->getPixelFormat()).compressed
+        || std::max(width, height) < _minSize)
+    {
+        return false;
+    }
+
+    track(texture, path, getMaxLOD(width, height));
+    return true;
+}
+
+void TextureStreamer::track(Texture2D* texture, const std::string& path, int maxLOD)
+{
+    StreamedTexture entry;
+    entry.path = path;
+    entry.maxLOD = maxLOD;
+    entry.targetLOD = texture->getLOD();
+    entry.loadingLOD = -1;
+    entry.lastDrawn = _frame;
+    entry.requested = false;
+    _textures[texture] = entry;
+
+    texture->_streamer = this;
+    texture->_requestedLOD = INT_MAX;
+    applyMaxAnisotropy(texture);
+}
+
+void TextureStreamer::removeTexture(Texture2D* texture)
+{
+    // a texture being loaded is ignored once its image is loaded
+    if (_textures.erase(texture))
+    {
+        texture->_streamer = nullptr;
+        texture->_requestedLOD = INT_MAX;
+    }
+}
+
+void TextureStreamer::removeAllTextures()
+{
+    for (auto& item : _textures)
+    {
+        item.first->_streamer = nullptr;
+        item.first->_requestedLOD = INT_MAX;
+    }
+    _textures.clear();
+}
+
+size_t TextureStreamer::getMemoryUsage() const
+{
+    size_t total = 0;
+    for (const auto& item : _textures)
+    {
+        total += getMemorySize(item.first, item.first->getLOD());
+    }
+    return total;
+}
+
+void TextureStreamer::setMaxAnisotropy(float anisotropy)
+{
+    _maxAnisotropy = std::max(anisotropy, 1.0f);
+    for (const auto& item : _textures)
+    {
+        applyMaxAnisotropy(item.first);
+    }
+}
+
+void TextureStreamer::applyMaxAnisotropy(Texture2D* texture) const
+{
+    static const bool supported = Configuration::getInstance()->checkForGLExtension("GL_EXT_texture_filter_anisotropic");
+    if (!supported || !texture->hasMipmaps())
+        return;
+
+    GLfloat maxSupported = 1;
+    glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &maxSupported);
+
+    GL::bindTexture2D(texture->getName());
+    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, std::min(_maxAnisotropy, maxSupported));
+}
+
+float TextureStreamer::getPixelWorldSize(const Camera* camera, float distance)
+{
+    const float viewportHeight = Camera::getDefaultViewport()._height;
+    const float focal = camera->getProjectionMatrix().m[5];
+    if (viewportHeight <= 0 || focal == 0)
+        return 0;
+
+    // height of the view at that distance
+    const float viewHeight = (camera->getType() == Camera::Type::PERSPECTIVE ? 2 * distance : 2) / focal;
+    return viewHeight / viewportHeight;
+}
+
+void TextureStreamer::requestLOD(Texture2D* texture, const Camera* camera, const AABB& bounds, float repeat)
+{
+    if (!texture || !texture->isStreamed() || !camera || bounds.isEmpty() || repeat <= 0)
+        return;
+
+    const Mat4 cameraTransform = camera->getNodeToWorldTransform();
+    const Vec3 eye(cameraTransform.m[12], cameraTransform.m[13], cameraTransform.m[14]);
+    const Vec3 closest(clampf(eye.x, bounds._min.x, bounds._max.x),
+                       clampf(eye.y, bounds._min.y, bounds._max.y),
+                       clampf(eye.z, bounds._min.z, bounds._max.z));
+    const float distance = std::max(eye.distance(closest), camera->getNearPlane());
+
+    const Vec3 size = bounds._max - bounds._min;
+    const float span = std::max(size.x, std::max(size.y, size.z)) / repeat;
+    if (span <= 0)
+        return;
+
+    const float texelWorldSize = span / std::max(texture->getPixelsWide(), texture->getPixelsHigh());
+    texture->requestLOD(getPixelWorldSize(camera, distance) / texelWorldSize);
+}
+
+int TextureStreamer::getMaxLOD(int width, int height) const
+{
+    int lod = 0;
+    while ((std::max(width, height) >> (lod + 1)) >= _lowestSize)
+    {
+        ++lod;
+    }
+    return lod;
+}
+
+size_t TextureStreamer::getMemorySize(Texture2D* texture, int lod)
+{
+    const size_t width = std::max(texture->getPixelsWide() >> lod, 1);
+    const size_t height = std::max(texture->getPixelsHigh() >> lod, 1);
+    size_t size = width * height * texture->getBitsPerPixelForFormat() / 8;
+    if (texture->hasMipmaps())
+        size += size / 3;
+    return size;
+}
+
+void TextureStreamer::update(float dt)
+{
+    ++_frame;
+
+    for (auto& item : _textures)
+    {
+        Texture2D* texture = item.first;
+        StreamedTexture& entry = item.second;
+
+        int requestedLOD = texture->_requestedLOD.exchange(INT_MAX);
+        if (requestedLOD != INT_MAX)
+        {
+            entry.targetLOD = std::min(requestedLOD, entry.maxLOD);
+            entry.lastDrawn = _frame;
+            entry.requested = true;
+        }
+        else if (!entry.requested)
+        {
+            // it may be drawn by nodes which don't request a level of detail
+            entry.targetLOD = 0;
+        }
+        else if (_frame - entry.lastDrawn > UNUSED_FRAMES)
+        {
+            entry.targetLOD = entry.maxLOD;
+        }
+    }
+
+    fitBudget();
+
+    while (_loadingCount < MAX_LOADS)
+    {
+        Texture2D* next = nullptr;
+        int nextPriority = 0;
+        for (const auto& item : _textures)
+        {
+            const StreamedTexture& entry = item.second;
+            const int lod = item.first->getLOD();
+            if (entry.loadingLOD >= 0 || entry.targetLOD == lod)
+                continue;
+
+            // downgrades release memory, so they go first, then the largest changes
+            const int priority = (entry.targetLOD > lod ? 100 : 0) + std::abs(entry.targetLOD - lod);
+            if (priority > nextPriority)
+            {
+                next = item.first;
+                nextPriority = priority;
+            }
+        }
+
+        if (!next)
+            break;
+
+        StreamedTexture& entry = _textures[next];
+        load(next, entry, entry.targetLOD);
+    }
+}
+
+void TextureStreamer::fitBudget()
+{
+    size_t total = 0;
+    for (const auto& item : _textures)
+    {
+        total += getMemorySize(item.first, item.second.targetLOD);
+    }
+
+    while (total > _budget)
+    {
+        StreamedTexture* largest = nullptr;
+        size_t largestSize = 0;
+        size_t saved = 0;
+        for (auto& item : _textures)
+        {
+            StreamedTexture& entry = item.second;
+            if (!entry.requested || entry.targetLOD >= entry.maxLOD)
+                continue;
+
+            const size_t size = getMemorySize(item.first, entry.targetLOD);
+            if (size > largestSize)
+            {
+                largest = &entry;
+                largestSize = size;
+                saved = size - getMemorySize(item.first, entry.targetLOD + 1);
+            }
+        }
+
+        if (!largest)
+            break;
+
+        ++largest->targetLOD;
+        total -= saved;
+    }
+}
+
+void TextureStreamer::load(Texture2D* texture, StreamedTexture& entry, int lod)
+{
+    entry.loadingLOD = lod;
+    ++_loadingCount;
+
+    // both are released once the image is uploaded
+    retain();
+    texture->retain();
+
+    auto request = new (std::nothrow) LoadRequest();
+    request->texture = texture;
+    request->path = entry.path;
+    request->lod = lod;
+    request->image = nullptr;
+
+    AsyncTaskPool::getInstance()->enqueue(AsyncTaskPool::TaskType::TASK_IO, [this](void* param) {
+        onLoaded(static_cast<LoadRequest*>(param));
+    }, request, [request]() {
+        auto image = new (std::nothrow) Image();
+        if (image && image->initWithImageFileThreadSafe(request->path) && image->downsample(request->lod))
+            request->image = image;
+        else
+            CC_SAFE_RELEASE(image);
+    });
+}
+
+void TextureStreamer::onLoaded(LoadRequest* request)
+{
+    --_loadingCount;
+
+    Texture2D* texture = request->texture;
+    auto it = _textures.find(texture);
+    if (it != _textures.end() && it->second.loadingLOD == request->lod)
+    {
+        it->second.loadingLOD = -1;
+        if (!texture->updateWithImageLOD(request->image, request->lod))
+        {
+            // it would fail again, so it keeps its current level of detail
+            CCLOG("cocos2d: TextureStreamer: couldn't load the level of detail %d of %s", request->lod, request->path.c_str());
+            removeTexture(texture);
+        }
+    }
+
+    CC_SAFE_RELEASE(request->image);
+    texture->release();
+    delete request;
+
+    // the last reference may be the one of the request
+    release();
+}
+
+NS_CC_END
@@ -0,0 +1,189 @@
+/****************************************************************************
+ Copyright (c) 2016 Chukong Technologies Inc.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CC_TEXTURE_STREAMER_H__
+#define __CC_TEXTURE_STREAMER_H__
+
+#include <string>
+#include <unordered_map>
+
+#include "base/CCRef.h"
+#include "renderer/CCTexture2D.h"
+
+NS_CC_BEGIN
+
+class Image;
+class Camera;
+class AABB;
+
+/**
+ * @addtogroup _2d
+ * @{
+ */
+
+/** @brief TextureStreamer changes the resolution of large textures with how large they're drawn.
+ *
+ * The streamed textures are created with their lowest level of detail, a copy of the image whose width
+ * and height are halved until they reach the lowest size. The nodes drawing them report how many texels
+ * they show per screen pixel with Texture2D::requestLOD(): sprites from their scale, 3D sprites and
+ * terrains from their distance to the camera. Once per frame, the streamer picks the level of detail
+ * of each texture, reloads the image from its file in the background, and uploads it to the same GL texture.
+ * Textures which aren't drawn for a while go back to their lowest level of detail, and the ones drawn
+ * the largest are downgraded first when the total memory goes over the budget.
+ * Until a texture gets its first request, it is raised to its full resolution and never downgraded,
+ * so the nodes which don't report how large they draw it keep drawing it as before.
+ *
+ * The textures keep the size of their full resolution, so the texture coordinates don't change.
+ * It is owned by the TextureCache, see TextureCache::setStreamingEnabled().
+ * @since v3.13
+ */
+class CC_DLL TextureStreamer : public Ref
+{
+public:
+    /** Default budget of the streamed textures, in bytes */
+    static const int DEFAULT_BUDGET = 64 * 1024 * 1024;
+    /** Default minimum width or height of the streamed images, in pixels */
+    static const int DEFAULT_MIN_SIZE = 512;
+    /** Default width or height of the lowest level of detail, in pixels */
+    static const int DEFAULT_LOWEST_SIZE = 64;
+
+    /**
+     * @js ctor
+     */
+    TextureStreamer(size_t budget = DEFAULT_BUDGET, int minSize = DEFAULT_MIN_SIZE, int lowestSize = DEFAULT_LOWEST_SIZE);
+    /**
+     * @js NA
+     * @lua NA
+     */
+    virtual ~TextureStreamer();
+
+    /** Whether or not the image is large enough to be streamed, and can be downsampled:
+     * only uncompressed images with 8 bits per channel are streamed.
+     */
+    bool isStreamable(Image* image) const;
+
+    /** Returns the minimum width or height of the streamed images, in pixels */
+    int getMinSize() const { return _minSize; }
+
+    /** Creates a streamed texture with the lowest level of detail of the image, which is downsampled in place.
+     *
+     * @param image An image accepted by isStreamable().
+     * @param path The file the image was loaded from, the other levels of detail are loaded from it.
+     * @param format The pixel format of the texture.
+     * @return A texture which isn't autoreleased, or nullptr.
+     */
+    Texture2D* createTexture(Image* image, const std::string& path, Texture2D::PixelFormat format);
+
+    /** Streams a texture created from the file with its full resolution, e.g. the detail maps of a Terrain.
+     * Its texture parameters and mipmaps are kept when its resolution changes.
+     *
+     * @return False if the texture is compressed, or smaller than the minimum size.
+     */
+    bool addTexture(Texture2D* texture, const std::string& path);
+
+    /** Stops streaming the texture, it keeps its current level of detail. */
+    void removeTexture(Texture2D* texture);
+
+    /** Stops streaming all the textures. */
+    void removeAllTextures();
+
+    /** Sets the budget of the streamed textures, in bytes. */
+    void setBudget(size_t budget) { _budget = budget; }
+    size_t getBudget() const { return _budget; }
+
+    /** Returns the memory taken by the streamed textures with their current levels of detail, in bytes. */
+    size_t getMemoryUsage() const;
+
+    /** Returns the number of streamed textures */
+    ssize_t getTextureCount() const { return _textures.size(); }
+
+    /** Sets the maximum anisotropy of the streamed textures with mipmaps, when the GPU supports
+     * GL_EXT_texture_filter_anisotropic. It sharpens the textures seen at grazing angles, like terrains. 1 by default.
+     */
+    void setMaxAnisotropy(float anisotropy);
+    float getMaxAnisotropy() const { return _maxAnisotropy; }
+
+    /** Returns the size of a screen pixel in world units, at the given distance from the camera. */
+    static float getPixelWorldSize(const Camera* camera, float distance);
+
+    /** Requests the level of detail of a texture mapped over a box in world space, like the bounding box
+     * of a mesh, drawn by the camera. The texture is assumed to span the largest side of the box.
+     *
+     * @param repeat How many times the texture is repeated over that side.
+     */
+    static void requestLOD(Texture2D* texture, const Camera* camera, const AABB& bounds, float repeat = 1);
+
+    /** Picks the levels of detail from the requests of the last frame, and starts loading them.
+     * It is scheduled by the constructor.
+     */
+    void update(float dt);
+
+protected:
+    struct StreamedTexture
+    {
+        // the file the levels of detail are loaded from
+        std::string path;
+        int maxLOD;
+        int targetLOD;
+        // level of detail being loaded, or -1
+        int loadingLOD;
+        unsigned int lastDrawn;
+        // whether or not a node reported its level of detail, only those textures are downgraded
+        bool requested;
+    };
+
+    struct LoadRequest
+    {
+        Texture2D* texture;
+        std::string path;
+        int lod;
+        Image* image;
+    };
+
+    void track(Texture2D* texture, const std::string& path, int maxLOD);
+    int getMaxLOD(int width, int height) const;
+    // memory taken by the texture with the given level of detail
+    static size_t getMemorySize(Texture2D* texture, int lod);
+    // lowers the levels of detail of the largest textures until they fit in the budget
+    void fitBudget();
+    void load(Texture2D* texture, StreamedTexture& entry, int lod);
+    void onLoaded(LoadRequest* request);
+    void applyMaxAnisotropy(Texture2D* texture) const;
+
+    std::unordered_map<Texture2D*, StreamedTexture> _textures;
+
+    size_t _budget;
+    int _minSize;
+    int _lowestSize;
+    float _maxAnisotropy;
+    unsigned int _frame;
+    int _loadingCount;
+};
+
+// end of _2d group
+/// @}
+
+NS_CC_END
+
+#endif //__CC_TEXTURE_STREAMER_H__
@@ -80,6 +80,10 @@ public:
     GLuint getTextureID() const { return _textureID; }
     /**Get a const reference of triangles.*/
     const Triangles& getTriangles() const { return _triangles; }
+    /**Replace the triangles, used to give a copy of the command its own vertices and indices.
+     * @since v3.13
+     */
+    void setTriangles(const Triangles& triangles) { _triangles = triangles; }
     /**Get the vertex count in the triangles.*/
     ssize_t getVertexCount() const { return _triangles.vertCount; }
     /**Get the index count of the triangles.*/
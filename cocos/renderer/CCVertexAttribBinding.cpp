@@ -24,6 +24,8 @@
 #include "renderer/ccGLStateCache.h"
 #include "platform/CCGL.h"
 #include "base/CCConfiguration.h"
+#include "base/CCDirector.h"
+#include "renderer/CCRenderer.h"
 #include "3d/CCMeshVertexIndexData.h"
 
 NS_CC_BEGIN
@@ -65,7 +67,7 @@ VertexAttribBinding::~VertexAttribBinding()
 
     if (_handle)
     {
-        glDeleteVertexArrays(1, &_handle);
+        GL::deleteVertexArrays(1, &_handle);
         _handle = 0;
     }
 }
@@ -143,28 +145,31 @@ bool VertexAttribBinding::init(MeshIndexData* meshIndexData, GLProgramState* glP
     // VAO hardware
     if (Configuration::getInstance()->supportsShareableVAO())
     {
-        glGenVertexArrays(1, &_handle);
-        GL::bindVAO(_handle);
-        glBindBuffer(GL_ARRAY_BUFFER, meshVertexData->getVertexBuffer()->getVBO());
-
-        auto flags = _vertexAttribsFlags;
-        for (int i = 0; flags > 0; i++) {
-            int flag = 1 << i;
-            if (flag & flags)
-                glEnableVertexAttribArray(i);
-            flags &= ~flag;
-        }
-
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, meshIndexData->getIndexBuffer()->getVBO());
-
-        for(auto &attribute : _attributes)
-        {
-            attribute.second.apply();
-        }
-
-        GL::bindVAO(0);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        // set up by the render thread, see GL::genVertexArrays()
+        Director::getInstance()->getRenderer()->runOnRenderThread([&]() {
+            glGenVertexArrays(1, &_handle);
+            GL::bindVAO(_handle);
+            glBindBuffer(GL_ARRAY_BUFFER, meshVertexData->getVertexBuffer()->getVBO());
+
+            auto flags = _vertexAttribsFlags;
+            for (int i = 0; flags > 0; i++) {
+                int flag = 1 << i;
+                if (flag & flags)
+                    glEnableVertexAttribArray(i);
+                flags &= ~flag;
+            }
+
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, meshIndexData->getIndexBuffer()->getVBO());
+
+            for(auto &attribute : _attributes)
+            {
+                attribute.second.apply();
+            }
+
+            GL::bindVAO(0);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        }, true);
     }
 
     return true;
@@ -27,7 +27,11 @@ THE SOFTWARE.
 
 #include "renderer/ccGLStateCache.h"
 
+#include <atomic>
+#include <vector>
+
 #include "renderer/CCGLProgram.h"
+#include "renderer/CCRenderer.h"
 #include "renderer/CCRenderState.h"
 #include "base/CCDirector.h"
 #include "base/ccConfig.h"
@@ -43,6 +47,53 @@ namespace
     static GLuint s_currentProjectionMatrix = -1;
     static uint32_t s_attributeFlags = 0;  // 32 attributes max
 
+    // the uniforms are counted by the threads that set them, hence the atomic counters
+    struct StateCacheCounters
+    {
+        std::atomic<unsigned int> issuedCalls;
+        std::atomic<unsigned int> skippedCalls;
+        std::atomic<unsigned int> issuedUniforms;
+        std::atomic<unsigned int> skippedUniforms;
+    };
+    static StateCacheCounters s_stats;
+
+    static void addStat(std::atomic<unsigned int>& counter, unsigned int count = 1)
+    {
+        counter.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    // the thread whose calls go through the cache, any thread when it isn't set
+    static std::thread::id s_cacheThread;
+
+    static bool isCacheThread()
+    {
+        return s_cacheThread == std::thread::id() || s_cacheThread == std::this_thread::get_id();
+    }
+
+    enum
+    {
+        CAPABILITY_BLEND,
+        CAPABILITY_CULL_FACE,
+        CAPABILITY_DEPTH_TEST,
+        CAPABILITY_STENCIL_TEST,
+        CAPABILITY_SCISSOR_TEST,
+        CAPABILITY_COUNT
+    };
+
+    // index of the cached state of a capability, or -1 if it isn't cached
+    static int capabilityIndex(GLenum cap)
+    {
+        switch (cap)
+        {
+            case GL_BLEND:          return CAPABILITY_BLEND;
+            case GL_CULL_FACE:      return CAPABILITY_CULL_FACE;
+            case GL_DEPTH_TEST:     return CAPABILITY_DEPTH_TEST;
+            case GL_STENCIL_TEST:   return CAPABILITY_STENCIL_TEST;
+            case GL_SCISSOR_TEST:   return CAPABILITY_SCISSOR_TEST;
+            default:                return -1;
+        }
+    }
+
 #if CC_ENABLE_GL_STATE_CACHE
 
     static GLuint    s_currentShaderProgram = -1;
@@ -53,7 +104,44 @@ namespace
     static GLuint    s_VAO = 0;
     static GLenum    s_activeTexture = -1;
 
+    // -1: unknown, 0: disabled, 1: enabled
+    static int       s_capabilities[CAPABILITY_COUNT] = {-1, -1, -1, -1, -1};
+    static int       s_depthMask = -1;
+    static GLenum    s_depthFunc = -1;
+    static GLenum    s_cullFace = -1;
+    static GLenum    s_frontFace = -1;
+    static GLenum    s_stencilFunc = -1;
+    static GLint     s_stencilRef = 0;
+    static GLuint    s_stencilValueMask = 0;
+    static GLenum    s_stencilOps[3] = {(GLenum)-1, (GLenum)-1, (GLenum)-1};
+    static bool      s_stencilWriteMaskValid = false;
+    static GLuint    s_stencilWriteMask = 0;
+    static bool      s_scissorValid = false;
+    static GLint     s_scissor[4] = {0, 0, 0, 0};
+
 #endif // CC_ENABLE_GL_STATE_CACHE
+
+    // forgets the state that raw GL calls may change behind the cache
+    static void resetRenderState()
+    {
+#if CC_ENABLE_GL_STATE_CACHE
+        s_blendingSource = -1;
+        s_blendingDest = -1;
+
+        for (int i = 0; i < CAPABILITY_COUNT; i++)
+        {
+            s_capabilities[i] = -1;
+        }
+        s_depthMask = -1;
+        s_depthFunc = -1;
+        s_cullFace = -1;
+        s_frontFace = -1;
+        s_stencilFunc = -1;
+        s_stencilOps[0] = s_stencilOps[1] = s_stencilOps[2] = -1;
+        s_stencilWriteMaskValid = false;
+        s_scissorValid = false;
+#endif // CC_ENABLE_GL_STATE_CACHE
+    }
 }
 
 // GL State Cache functions
@@ -73,16 +161,38 @@ void invalidateStateCache( void )
         s_currentBoundTexture[i] = -1;
     }
 
-    s_blendingSource = -1;
-    s_blendingDest = -1;
     s_GLServerState = 0;
     s_VAO = 0;
-    
 #endif // CC_ENABLE_GL_STATE_CACHE
+
+    resetRenderState();
+}
+
+void invalidateRenderStateCache( void )
+{
+    if (isCacheThread())
+        resetRenderState();
 }
 
 void deleteProgram( GLuint program )
 {
+    if (!isCacheThread())
+    {
+        auto renderer = Director::getInstance()->getRenderer();
+        if (renderer->isRenderThread())
+        {
+            // a thread compiling programs while the rendering isn't pipelined, the cache never used them
+            glDeleteProgram(program);
+            return;
+        }
+
+        // the queued frames may still draw with it
+        renderer->runOnRenderThread([program]() {
+            deleteProgram(program);
+        });
+        return;
+    }
+
 #if CC_ENABLE_GL_STATE_CACHE
     if(program == s_currentShaderProgram)
     {
@@ -95,13 +205,25 @@ void deleteProgram( GLuint program )
 
 void useProgram( GLuint program )
 {
+    if (!isCacheThread())
+    {
+        glUseProgram(program);
+        return;
+    }
+
 #if CC_ENABLE_GL_STATE_CACHE
     if( program != s_currentShaderProgram ) {
         s_currentShaderProgram = program;
         glUseProgram(program);
+        addStat(s_stats.issuedCalls);
+    }
+    else
+    {
+        addStat(s_stats.skippedCalls);
     }
 #else
     glUseProgram(program);
+    addStat(s_stats.issuedCalls);
 #endif // CC_ENABLE_GL_STATE_CACHE
 }
 
@@ -109,13 +231,14 @@ static void SetBlending(GLenum sfactor, GLenum dfactor)
 {
 	if (sfactor == GL_ONE && dfactor == GL_ZERO)
     {
-		glDisable(GL_BLEND);
+		disable(GL_BLEND);
         RenderState::StateBlock::_defaultState->setBlend(false);
 	}
     else
     {
-		glEnable(GL_BLEND);
+		enable(GL_BLEND);
 		glBlendFunc(sfactor, dfactor);
+        addStat(s_stats.issuedCalls);
 
         RenderState::StateBlock::_defaultState->setBlend(true);
         RenderState::StateBlock::_defaultState->setBlendSrc((RenderState::Blend)sfactor);
@@ -125,6 +248,20 @@ static void SetBlending(GLenum sfactor, GLenum dfactor)
 
 void blendFunc(GLenum sfactor, GLenum dfactor)
 {
+    if (!isCacheThread())
+    {
+        if (sfactor == GL_ONE && dfactor == GL_ZERO)
+        {
+            glDisable(GL_BLEND);
+        }
+        else
+        {
+            glEnable(GL_BLEND);
+            glBlendFunc(sfactor, dfactor);
+        }
+        return;
+    }
+
 #if CC_ENABLE_GL_STATE_CACHE
     if (sfactor != s_blendingSource || dfactor != s_blendingDest)
     {
@@ -132,6 +269,10 @@ void blendFunc(GLenum sfactor, GLenum dfactor)
         s_blendingDest = dfactor;
         SetBlending(sfactor, dfactor);
     }
+    else
+    {
+        addStat(s_stats.skippedCalls);
+    }
 #else
     SetBlending( sfactor, dfactor );
 #endif // CC_ENABLE_GL_STATE_CACHE
@@ -163,6 +304,13 @@ void bindTexture2D(Texture2D* texture)
 
 void bindTexture2DN(GLuint textureUnit, GLuint textureId)
 {
+    if (!isCacheThread())
+    {
+        glActiveTexture(GL_TEXTURE0 + textureUnit);
+        glBindTexture(GL_TEXTURE_2D, textureId);
+        return;
+    }
+
 #if CC_ENABLE_GL_STATE_CACHE
 	CCASSERT(textureUnit < MAX_ACTIVE_TEXTURE, "textureUnit is too big");
 	if (s_currentBoundTexture[textureUnit] != textureId)
@@ -170,15 +318,28 @@ void bindTexture2DN(GLuint textureUnit, GLuint textureId)
 		s_currentBoundTexture[textureUnit] = textureId;
 		activeTexture(GL_TEXTURE0 + textureUnit);
 		glBindTexture(GL_TEXTURE_2D, textureId);
+        addStat(s_stats.issuedCalls);
 	}
+    else
+    {
+        addStat(s_stats.skippedCalls);
+    }
 #else
 	glActiveTexture(GL_TEXTURE0 + textureUnit);
 	glBindTexture(GL_TEXTURE_2D, textureId);
+    addStat(s_stats.issuedCalls, 2);
 #endif
 }
 
 void bindTextureN(GLuint textureUnit, GLuint textureId, GLuint textureType/* = GL_TEXTURE_2D*/)
 {
+    if (!isCacheThread())
+    {
+        glActiveTexture(GL_TEXTURE0 + textureUnit);
+        glBindTexture(textureType, textureId);
+        return;
+    }
+
 #if CC_ENABLE_GL_STATE_CACHE
     CCASSERT(textureUnit < MAX_ACTIVE_TEXTURE, "textureUnit is too big");
     if (s_currentBoundTexture[textureUnit] != textureId)
@@ -186,16 +347,31 @@ void bindTextureN(GLuint textureUnit, GLuint textureId, GLuint textureType/* = G
         s_currentBoundTexture[textureUnit] = textureId;
         activeTexture(GL_TEXTURE0 + textureUnit);
         glBindTexture(textureType, textureId);
+        addStat(s_stats.issuedCalls);
+    }
+    else
+    {
+        addStat(s_stats.skippedCalls);
     }
 #else
     glActiveTexture(GL_TEXTURE0 + textureUnit);
     glBindTexture(textureType, textureId);
+    addStat(s_stats.issuedCalls, 2);
 #endif
 }
 
 
 void deleteTexture(GLuint textureId)
 {
+    if (!isCacheThread())
+    {
+        // the queued frames may still draw with it
+        Director::getInstance()->getRenderer()->runOnRenderThread([textureId]() {
+            deleteTexture(textureId);
+        });
+        return;
+    }
+
 #if CC_ENABLE_GL_STATE_CACHE
     for (size_t i = 0; i < MAX_ACTIVE_TEXTURE; ++i)
     {
@@ -216,13 +392,25 @@ void deleteTextureN(GLuint textureUnit, GLuint textureId)
 
 void activeTexture(GLenum texture)
 {
+    if (!isCacheThread())
+    {
+        glActiveTexture(texture);
+        return;
+    }
+
 #if CC_ENABLE_GL_STATE_CACHE
     if(s_activeTexture != texture) {
         s_activeTexture = texture;
         glActiveTexture(s_activeTexture);
+        addStat(s_stats.issuedCalls);
+    }
+    else
+    {
+        addStat(s_stats.skippedCalls);
     }
 #else
     glActiveTexture(texture);
+    addStat(s_stats.issuedCalls);
 #endif
 }
 
@@ -230,26 +418,398 @@ void bindVAO(GLuint vaoId)
 {
     if (Configuration::getInstance()->supportsShareableVAO())
     {
-    
+        if (!isCacheThread())
+        {
+            glBindVertexArray(vaoId);
+            return;
+        }
+
 #if CC_ENABLE_GL_STATE_CACHE
         if (s_VAO != vaoId)
         {
             s_VAO = vaoId;
             glBindVertexArray(vaoId);
+            addStat(s_stats.issuedCalls);
+        }
+        else
+        {
+            addStat(s_stats.skippedCalls);
         }
 #else
         glBindVertexArray(vaoId);
+        addStat(s_stats.issuedCalls);
 #endif // CC_ENABLE_GL_STATE_CACHE
     
     }
 }
 
+void genVertexArrays(GLsizei n, GLuint* arrays)
+{
+    auto renderer = Director::getInstance()->getRenderer();
+    if (!renderer->isRenderThread())
+    {
+        renderer->runOnRenderThread([n, arrays]() {
+            glGenVertexArrays(n, arrays);
+        }, true);
+        return;
+    }
+
+    glGenVertexArrays(n, arrays);
+}
+
+void deleteVertexArrays(GLsizei n, const GLuint* arrays)
+{
+    auto renderer = Director::getInstance()->getRenderer();
+    if (!renderer->isRenderThread())
+    {
+        // the queued frames may still draw with them
+        std::vector<GLuint> names(arrays, arrays + n);
+        renderer->runOnRenderThread([names]() {
+            deleteVertexArrays((GLsizei)names.size(), names.data());
+        });
+        return;
+    }
+
+#if CC_ENABLE_GL_STATE_CACHE
+    // deleting the bound vertex array binds 0
+    for (GLsizei i = 0; i < n && isCacheThread(); ++i)
+    {
+        if (arrays[i] == s_VAO)
+        {
+            s_VAO = 0;
+        }
+    }
+#endif // CC_ENABLE_GL_STATE_CACHE
+
+    glDeleteVertexArrays(n, arrays);
+}
+
+void genFramebuffers(GLsizei n, GLuint* framebuffers)
+{
+    auto renderer = Director::getInstance()->getRenderer();
+    if (!renderer->isRenderThread())
+    {
+        renderer->runOnRenderThread([n, framebuffers]() {
+            glGenFramebuffers(n, framebuffers);
+        }, true);
+        return;
+    }
+
+    glGenFramebuffers(n, framebuffers);
+}
+
+void deleteFramebuffers(GLsizei n, const GLuint* framebuffers)
+{
+    auto renderer = Director::getInstance()->getRenderer();
+    if (!renderer->isRenderThread())
+    {
+        std::vector<GLuint> names(framebuffers, framebuffers + n);
+        renderer->runOnRenderThread([names]() {
+            glDeleteFramebuffers((GLsizei)names.size(), names.data());
+        });
+        return;
+    }
+
+    glDeleteFramebuffers(n, framebuffers);
+}
+
+// GL Capabilities functions
+
+void enable(GLenum cap)
+{
+    if (!isCacheThread())
+    {
+        glEnable(cap);
+        return;
+    }
+
+#if CC_ENABLE_GL_STATE_CACHE
+    int index = capabilityIndex(cap);
+    if (index >= 0)
+    {
+        if (s_capabilities[index] == 1)
+        {
+            addStat(s_stats.skippedCalls);
+            return;
+        }
+        s_capabilities[index] = 1;
+    }
+#endif // CC_ENABLE_GL_STATE_CACHE
+
+    glEnable(cap);
+    addStat(s_stats.issuedCalls);
+}
+
+void disable(GLenum cap)
+{
+    if (!isCacheThread())
+    {
+        glDisable(cap);
+        return;
+    }
+
+#if CC_ENABLE_GL_STATE_CACHE
+    int index = capabilityIndex(cap);
+    if (index >= 0)
+    {
+        if (s_capabilities[index] == 0)
+        {
+            addStat(s_stats.skippedCalls);
+            return;
+        }
+        s_capabilities[index] = 0;
+    }
+#endif // CC_ENABLE_GL_STATE_CACHE
+
+    glDisable(cap);
+    addStat(s_stats.issuedCalls);
+}
+
+bool isEnabled(GLenum cap)
+{
+    if (!isCacheThread())
+    {
+        return glIsEnabled(cap) != GL_FALSE;
+    }
+
+#if CC_ENABLE_GL_STATE_CACHE
+    int index = capabilityIndex(cap);
+    if (index >= 0)
+    {
+        if (s_capabilities[index] < 0)
+        {
+            s_capabilities[index] = glIsEnabled(cap) != GL_FALSE ? 1 : 0;
+        }
+        return s_capabilities[index] == 1;
+    }
+#endif // CC_ENABLE_GL_STATE_CACHE
+
+    return glIsEnabled(cap) != GL_FALSE;
+}
+
+// GL Depth, Cull, Stencil and Scissor functions
+
+void depthMask(GLboolean flag)
+{
+    if (!isCacheThread())
+    {
+        glDepthMask(flag);
+        return;
+    }
+
+#if CC_ENABLE_GL_STATE_CACHE
+    int value = flag ? 1 : 0;
+    if (s_depthMask == value)
+    {
+        addStat(s_stats.skippedCalls);
+        return;
+    }
+    s_depthMask = value;
+#endif // CC_ENABLE_GL_STATE_CACHE
+
+    glDepthMask(flag);
+    addStat(s_stats.issuedCalls);
+}
+
+GLboolean getDepthMask()
+{
+    if (!isCacheThread())
+    {
+        GLboolean flag = GL_FALSE;
+        glGetBooleanv(GL_DEPTH_WRITEMASK, &flag);
+        return flag;
+    }
+
+#if CC_ENABLE_GL_STATE_CACHE
+    if (s_depthMask < 0)
+    {
+        GLboolean flag = GL_FALSE;
+        glGetBooleanv(GL_DEPTH_WRITEMASK, &flag);
+        s_depthMask = flag ? 1 : 0;
+    }
+    return s_depthMask ? GL_TRUE : GL_FALSE;
+#else
+    GLboolean flag = GL_FALSE;
+    glGetBooleanv(GL_DEPTH_WRITEMASK, &flag);
+    return flag;
+#endif // CC_ENABLE_GL_STATE_CACHE
+}
+
+void depthFunc(GLenum func)
+{
+    if (!isCacheThread())
+    {
+        glDepthFunc(func);
+        return;
+    }
+
+#if CC_ENABLE_GL_STATE_CACHE
+    if (s_depthFunc == func)
+    {
+        addStat(s_stats.skippedCalls);
+        return;
+    }
+    s_depthFunc = func;
+#endif // CC_ENABLE_GL_STATE_CACHE
+
+    glDepthFunc(func);
+    addStat(s_stats.issuedCalls);
+}
+
+void cullFace(GLenum mode)
+{
+    if (!isCacheThread())
+    {
+        glCullFace(mode);
+        return;
+    }
+
+#if CC_ENABLE_GL_STATE_CACHE
+    if (s_cullFace == mode)
+    {
+        addStat(s_stats.skippedCalls);
+        return;
+    }
+    s_cullFace = mode;
+#endif // CC_ENABLE_GL_STATE_CACHE
+
+    glCullFace(mode);
+    addStat(s_stats.issuedCalls);
+}
+
+void frontFace(GLenum mode)
+{
+    if (!isCacheThread())
+    {
+        glFrontFace(mode);
+        return;
+    }
+
+#if CC_ENABLE_GL_STATE_CACHE
+    if (s_frontFace == mode)
+    {
+        addStat(s_stats.skippedCalls);
+        return;
+    }
+    s_frontFace = mode;
+#endif // CC_ENABLE_GL_STATE_CACHE
+
+    glFrontFace(mode);
+    addStat(s_stats.issuedCalls);
+}
+
+void stencilFunc(GLenum func, GLint ref, GLuint mask)
+{
+    if (!isCacheThread())
+    {
+        glStencilFunc(func, ref, mask);
+        return;
+    }
+
+#if CC_ENABLE_GL_STATE_CACHE
+    if (s_stencilFunc == func && s_stencilRef == ref && s_stencilValueMask == mask)
+    {
+        addStat(s_stats.skippedCalls);
+        return;
+    }
+    s_stencilFunc = func;
+    s_stencilRef = ref;
+    s_stencilValueMask = mask;
+#endif // CC_ENABLE_GL_STATE_CACHE
+
+    glStencilFunc(func, ref, mask);
+    addStat(s_stats.issuedCalls);
+}
+
+void stencilOp(GLenum sfail, GLenum dpfail, GLenum dppass)
+{
+    if (!isCacheThread())
+    {
+        glStencilOp(sfail, dpfail, dppass);
+        return;
+    }
+
+#if CC_ENABLE_GL_STATE_CACHE
+    if (s_stencilOps[0] == sfail && s_stencilOps[1] == dpfail && s_stencilOps[2] == dppass)
+    {
+        addStat(s_stats.skippedCalls);
+        return;
+    }
+    s_stencilOps[0] = sfail;
+    s_stencilOps[1] = dpfail;
+    s_stencilOps[2] = dppass;
+#endif // CC_ENABLE_GL_STATE_CACHE
+
+    glStencilOp(sfail, dpfail, dppass);
+    addStat(s_stats.issuedCalls);
+}
+
+void stencilMask(GLuint mask)
+{
+    if (!isCacheThread())
+    {
+        glStencilMask(mask);
+        return;
+    }
+
+#if CC_ENABLE_GL_STATE_CACHE
+    if (s_stencilWriteMaskValid && s_stencilWriteMask == mask)
+    {
+        addStat(s_stats.skippedCalls);
+        return;
+    }
+    s_stencilWriteMaskValid = true;
+    s_stencilWriteMask = mask;
+#endif // CC_ENABLE_GL_STATE_CACHE
+
+    glStencilMask(mask);
+    addStat(s_stats.issuedCalls);
+}
+
+void scissor(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    if (!isCacheThread())
+    {
+        glScissor(x, y, width, height);
+        return;
+    }
+
+#if CC_ENABLE_GL_STATE_CACHE
+    if (s_scissorValid && s_scissor[0] == x && s_scissor[1] == y && s_scissor[2] == width && s_scissor[3] == height)
+    {
+        addStat(s_stats.skippedCalls);
+        return;
+    }
+    s_scissorValid = true;
+    s_scissor[0] = x;
+    s_scissor[1] = y;
+    s_scissor[2] = width;
+    s_scissor[3] = height;
+#endif // CC_ENABLE_GL_STATE_CACHE
+
+    glScissor(x, y, width, height);
+    addStat(s_stats.issuedCalls);
+}
+
 // GL Vertex Attrib functions
 
 void enableVertexAttribs(uint32_t flags)
 {
     bindVAO(0);
 
+    if (!isCacheThread())
+    {
+        for (int i = 0; i < MAX_ATTRIBUTES; i++)
+        {
+            if (flags & (1 << i))
+                glEnableVertexAttribArray(i);
+            else
+                glDisableVertexAttribArray(i);
+        }
+        addStat(s_stats.issuedCalls, MAX_ATTRIBUTES);
+        return;
+    }
+
     // hardcoded!
     for(int i=0; i < MAX_ATTRIBUTES; i++) {
         unsigned int bit = 1 << i;
@@ -262,6 +822,11 @@ void enableVertexAttribs(uint32_t flags)
                 glEnableVertexAttribArray(i);
             else
                 glDisableVertexAttribArray(i);
+            addStat(s_stats.issuedCalls);
+        }
+        else
+        {
+            addStat(s_stats.skippedCalls);
         }
     }
     s_attributeFlags = flags;
@@ -274,6 +839,36 @@ void setProjectionMatrixDirty( void )
     s_currentProjectionMatrix = -1;
 }
 
+// GL State Cache statistics
+
+StateCacheStats getStateCacheStats()
+{
+    StateCacheStats stats;
+    stats.issuedCalls = s_stats.issuedCalls.load(std::memory_order_relaxed);
+    stats.skippedCalls = s_stats.skippedCalls.load(std::memory_order_relaxed);
+    stats.issuedUniforms = s_stats.issuedUniforms.load(std::memory_order_relaxed);
+    stats.skippedUniforms = s_stats.skippedUniforms.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void countUniform(bool uploaded)
+{
+    addStat(uploaded ? s_stats.issuedUniforms : s_stats.skippedUniforms);
+}
+
+void setStateCacheThread(const std::thread::id& thread)
+{
+    s_cacheThread = thread;
+}
+
+void resetStateCacheStats()
+{
+    s_stats.issuedCalls.store(0, std::memory_order_relaxed);
+    s_stats.skippedCalls.store(0, std::memory_order_relaxed);
+    s_stats.issuedUniforms.store(0, std::memory_order_relaxed);
+    s_stats.skippedUniforms.store(0, std::memory_order_relaxed);
+}
+
 } // Namespace GL
 
 NS_CC_END
@@ -29,6 +29,7 @@ THE SOFTWARE.
 #define __CCGLSTATE_H__
 
 #include <cstdint>
+#include <thread>
 
 #include "platform/CCGL.h"
 #include "platform/CCPlatformMacros.h"
@@ -66,6 +67,14 @@ enum {
  */
 void CC_DLL invalidateStateCache(void);
 
+/**
+ * Forgets the cached blend, cull, depth, stencil and scissor state, so that the next calls are issued.
+ * The Renderer calls it at the start of each frame and after each CustomCommand, whose callbacks may
+ * change that state with raw GL calls.
+ * @since v3.13
+ */
+void CC_DLL invalidateRenderStateCache(void);
+
 /** 
  * Uses the GL program in case program is different than the current one.
 
@@ -182,6 +191,175 @@ void CC_DLL activeTexture(GLenum texture);
  */
 void CC_DLL bindVAO(GLuint vaoId);
 
+/**
+ * Generates vertex array objects.
+ * VAOs and frame buffer objects aren't shared between GL contexts, so when the rendering is pipelined they
+ * are generated and deleted by the render thread, which draws with them, see Renderer::setPipelineEnabled().
+ * The calling thread waits until they are generated, and what sets them up has to run on the render thread too.
+ * @since v3.13
+ */
+void CC_DLL genVertexArrays(GLsizei n, GLuint* arrays);
+
+/**
+ * Deletes vertex array objects, once the frames already queued are drawn. If one of them is bound, it invalidates the cached one.
+ * @since v3.13
+ */
+void CC_DLL deleteVertexArrays(GLsizei n, const GLuint* arrays);
+
+/**
+ * Generates frame buffer objects, see genVertexArrays().
+ * @since v3.13
+ */
+void CC_DLL genFramebuffers(GLsizei n, GLuint* framebuffers);
+
+/**
+ * Deletes frame buffer objects, once the frames already queued are drawn.
+ * @since v3.13
+ */
+void CC_DLL deleteFramebuffers(GLsizei n, const GLuint* framebuffers);
+
+/**
+ * If the capability is not already enabled, it enables it.
+ * GL_BLEND, GL_CULL_FACE, GL_DEPTH_TEST, GL_STENCIL_TEST and GL_SCISSOR_TEST are cached,
+ * other capabilities are always enabled.
+ * The cached states shouldn't be changed by calling glEnable() or glDisable() directly.
+ *
+ * If CC_ENABLE_GL_STATE_CACHE is disabled, it will call glEnable() directly.
+ * @since v3.13
+ */
+void CC_DLL enable(GLenum cap);
+
+/**
+ * If the capability is not already disabled, it disables it.
+ *
+ * If CC_ENABLE_GL_STATE_CACHE is disabled, it will call glDisable() directly.
+ * @since v3.13
+ */
+void CC_DLL disable(GLenum cap);
+
+/**
+ * Returns whether the capability is enabled, without querying GL when its state is cached.
+ * @since v3.13
+ */
+bool CC_DLL isEnabled(GLenum cap);
+
+/**
+ * If the depth write mask is not already set, it sets it.
+ *
+ * If CC_ENABLE_GL_STATE_CACHE is disabled, it will call glDepthMask() directly.
+ * @since v3.13
+ */
+void CC_DLL depthMask(GLboolean flag);
+
+/**
+ * Returns the depth write mask, without querying GL when it is cached.
+ * @since v3.13
+ */
+GLboolean CC_DLL getDepthMask();
+
+/**
+ * If the depth function is not already set, it sets it.
+ *
+ * If CC_ENABLE_GL_STATE_CACHE is disabled, it will call glDepthFunc() directly.
+ * @since v3.13
+ */
+void CC_DLL depthFunc(GLenum func);
+
+/**
+ * If the culled face is not already set, it sets it.
+ *
+ * If CC_ENABLE_GL_STATE_CACHE is disabled, it will call glCullFace() directly.
+ * @since v3.13
+ */
+void CC_DLL cullFace(GLenum mode);
+
+/**
+ * If the front face winding is not already set, it sets it.
+ *
+ * If CC_ENABLE_GL_STATE_CACHE is disabled, it will call glFrontFace() directly.
+ * @since v3.13
+ */
+void CC_DLL frontFace(GLenum mode);
+
+/**
+ * If the stencil function is not already set, it sets it.
+ *
+ * If CC_ENABLE_GL_STATE_CACHE is disabled, it will call glStencilFunc() directly.
+ * @since v3.13
+ */
+void CC_DLL stencilFunc(GLenum func, GLint ref, GLuint mask);
+
+/**
+ * If the stencil operations are not already set, it sets them.
+ *
+ * If CC_ENABLE_GL_STATE_CACHE is disabled, it will call glStencilOp() directly.
+ * @since v3.13
+ */
+void CC_DLL stencilOp(GLenum sfail, GLenum dpfail, GLenum dppass);
+
+/**
+ * If the stencil write mask is not already set, it sets it.
+ *
+ * If CC_ENABLE_GL_STATE_CACHE is disabled, it will call glStencilMask() directly.
+ * @since v3.13
+ */
+void CC_DLL stencilMask(GLuint mask);
+
+/**
+ * If the scissor box is not already set, it sets it.
+ *
+ * If CC_ENABLE_GL_STATE_CACHE is disabled, it will call glScissor() directly.
+ * @since v3.13
+ */
+void CC_DLL scissor(GLint x, GLint y, GLsizei width, GLsizei height);
+
+/** @struct StateCacheStats
+ * Counters of the state changes sent to GL and of the redundant ones skipped by the state cache.
+ * @since v3.13
+ */
+struct CC_DLL StateCacheStats
+{
+    /** State calls sent to GL */
+    unsigned int issuedCalls;
+    /** State calls skipped because GL already had that state */
+    unsigned int skippedCalls;
+    /** Uniforms uploaded to GL */
+    unsigned int issuedUniforms;
+    /** Uniforms not uploaded because the program already had that value */
+    unsigned int skippedUniforms;
+};
+
+/**
+ * Returns a copy of the counters since the last call to resetStateCacheStats().
+ * The Director resets them at the beginning of each frame.
+ * @since v3.13
+ */
+StateCacheStats CC_DLL getStateCacheStats();
+
+/**
+ * Counts a uniform set on a program, called by GLProgram from any thread.
+ *
+ * @param uploaded False if the program already had that value.
+ * @since v3.13
+ */
+void CC_DLL countUniform(bool uploaded);
+
+/**
+ * Resets the counters returned by getStateCacheStats().
+ * @since v3.13
+ */
+void CC_DLL resetStateCacheStats();
+
+/**
+ * Sets the thread whose calls go through the state cache, which is the render thread when the
+ * Renderer is pipelined. The other threads use a context that shares its objects with the one of
+ * that thread: their texture, program and VAO calls are sent to GL directly, and the textures and
+ * programs they delete are deleted on the render thread after the frames already queued.
+ * The default std::thread::id lets every thread use the cache.
+ * @since v3.13
+ */
+void CC_DLL setStateCacheThread(const std::thread::id& thread);
+
 // end of support group
 /// @}
 
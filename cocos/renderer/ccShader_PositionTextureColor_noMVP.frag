@@ -37,3 +37,44 @@ void main()
 }
 );
 
+
+const char* ccPositionTextureColorMultiTexture_noMVP_frag = STRINGIFY(
+\n#ifdef GL_ES\n
+precision lowp float;
+varying mediump float v_textureIndex;
+\n#else\n
+varying float v_textureIndex;
+\n#endif\n
+
+varying vec4 v_fragmentColor;
+varying vec2 v_texCoord;
+
+uniform sampler2D u_texture4;
+uniform sampler2D u_texture5;
+uniform sampler2D u_texture6;
+uniform sampler2D u_texture7;
+
+void main()
+{
+    // samplers can't be indexed by a varying in GLSL ES 1.0
+    vec4 texColor;
+    if (v_textureIndex < 0.5)
+        texColor = texture2D(CC_Texture0, v_texCoord);
+    else if (v_textureIndex < 1.5)
+        texColor = texture2D(CC_Texture1, v_texCoord);
+    else if (v_textureIndex < 2.5)
+        texColor = texture2D(CC_Texture2, v_texCoord);
+    else if (v_textureIndex < 3.5)
+        texColor = texture2D(CC_Texture3, v_texCoord);
+    else if (v_textureIndex < 4.5)
+        texColor = texture2D(u_texture4, v_texCoord);
+    else if (v_textureIndex < 5.5)
+        texColor = texture2D(u_texture5, v_texCoord);
+    else if (v_textureIndex < 6.5)
+        texColor = texture2D(u_texture6, v_texCoord);
+    else
+        texColor = texture2D(u_texture7, v_texCoord);
+
+    gl_FragColor = v_fragmentColor * texColor;
+}
+);
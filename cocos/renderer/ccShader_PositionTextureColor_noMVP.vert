@@ -43,3 +43,28 @@ void main()
     v_texCoord = a_texCoord;
 }
 );
+
+const char* ccPositionTextureColorMultiTexture_noMVP_vert = STRINGIFY(
+attribute vec4 a_position;
+attribute vec2 a_texCoord;
+attribute vec4 a_color;
+attribute float a_textureIndex;
+
+\n#ifdef GL_ES\n
+varying lowp vec4 v_fragmentColor;
+varying mediump vec2 v_texCoord;
+varying mediump float v_textureIndex;
+\n#else\n
+varying vec4 v_fragmentColor;
+varying vec2 v_texCoord;
+varying float v_textureIndex;
+\n#endif\n
+
+void main()
+{
+    gl_Position = CC_PMatrix * a_position;
+    v_fragmentColor = a_color;
+    v_texCoord = a_texCoord;
+    v_textureIndex = a_textureIndex;
+}
+);
@@ -57,6 +57,8 @@ extern CC_DLL const GLchar * ccPositionTextureColor_vert;
 
 extern CC_DLL const GLchar * ccPositionTextureColor_noMVP_frag;
 extern CC_DLL const GLchar * ccPositionTextureColor_noMVP_vert;
+extern CC_DLL const GLchar * ccPositionTextureColorMultiTexture_noMVP_frag;
+extern CC_DLL const GLchar * ccPositionTextureColorMultiTexture_noMVP_vert;
 
 extern CC_DLL const GLchar * ccPositionTextureColorAlphaTest_frag;
 
@@ -76,8 +78,10 @@ extern CC_DLL const GLchar * ccLabelOutline_frag;
 extern CC_DLL const GLchar * ccLabel_vert;
 
 extern CC_DLL const GLchar * cc3D_PositionTex_vert;
+extern CC_DLL const GLchar * cc3D_PositionTexInstanced_vert;
 extern CC_DLL const GLchar * cc3D_SkinPositionTex_vert;
 extern CC_DLL const GLchar * cc3D_ColorTex_frag;
+extern CC_DLL const GLchar * cc3D_ColorTexInstanced_frag;
 extern CC_DLL const GLchar * cc3D_Color_frag;
 extern CC_DLL const GLchar * cc3D_PositionNormalTex_vert;
 extern CC_DLL const GLchar * cc3D_SkinPositionNormalTex_vert;
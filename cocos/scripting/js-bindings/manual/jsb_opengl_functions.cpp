@@ -14,6 +14,7 @@
 #include "scripting/js-bindings/manual/js_manual_conversions.h"
 #include "scripting/js-bindings/manual/jsb_opengl_functions.h"
 #include "platform/CCGL.h"
+#include "renderer/ccGLStateCache.h"
 
 // Arguments: GLenum
 // Ret value: void
@@ -515,7 +516,7 @@ bool JSB_glCullFace(JSContext *cx, uint32_t argc, jsval *vp) {
     ok &= jsval_to_uint32( cx, args.get(0), &arg0 );
     JSB_PRECONDITION2(ok, cx, false, "Error processing arguments");
 
-    glCullFace((GLenum)arg0  );
+    cocos2d::GL::cullFace((GLenum)arg0  );
     args.rval().setUndefined();
     return true;
 }
@@ -563,7 +564,7 @@ bool JSB_glDepthFunc(JSContext *cx, uint32_t argc, jsval *vp) {
     ok &= jsval_to_uint32( cx, args.get(0), &arg0 );
     JSB_PRECONDITION2(ok, cx, false, "Error processing arguments");
 
-    glDepthFunc((GLenum)arg0  );
+    cocos2d::GL::depthFunc((GLenum)arg0  );
     args.rval().setUndefined();
     return true;
 }
@@ -579,7 +580,7 @@ bool JSB_glDepthMask(JSContext *cx, uint32_t argc, jsval *vp) {
     ok &= jsval_to_uint16( cx, args.get(0), &arg0 );
     JSB_PRECONDITION2(ok, cx, false, "Error processing arguments");
 
-    glDepthMask((GLboolean)arg0  );
+    cocos2d::GL::depthMask((GLboolean)arg0  );
     args.rval().setUndefined();
     return true;
 }
@@ -629,7 +630,7 @@ bool JSB_glDisable(JSContext *cx, uint32_t argc, jsval *vp) {
     ok &= jsval_to_uint32( cx, args.get(0), &arg0 );
     JSB_PRECONDITION2(ok, cx, false, "Error processing arguments");
 
-    glDisable((GLenum)arg0  );
+    cocos2d::GL::disable((GLenum)arg0  );
     args.rval().setUndefined();
     return true;
 }
@@ -699,7 +700,7 @@ bool JSB_glEnable(JSContext *cx, uint32_t argc, jsval *vp) {
     ok &= jsval_to_uint32( cx, args.get(0), &arg0 );
     JSB_PRECONDITION2(ok, cx, false, "Error processing arguments");
 
-    glEnable((GLenum)arg0  );
+    cocos2d::GL::enable((GLenum)arg0  );
     args.rval().setUndefined();
     return true;
 }
@@ -790,7 +791,7 @@ bool JSB_glFrontFace(JSContext *cx, uint32_t argc, jsval *vp) {
     ok &= jsval_to_uint32( cx, args.get(0), &arg0 );
     JSB_PRECONDITION2(ok, cx, false, "Error processing arguments");
 
-    glFrontFace((GLenum)arg0  );
+    cocos2d::GL::frontFace((GLenum)arg0  );
     args.rval().setUndefined();
     return true;
 }
@@ -1145,7 +1146,7 @@ bool JSB_glScissor(JSContext *cx, uint32_t argc, jsval *vp) {
     ok &= jsval_to_int32( cx, args.get(3), &arg3 );
     JSB_PRECONDITION2(ok, cx, false, "Error processing arguments");
 
-    glScissor((GLint)arg0 , (GLint)arg1 , (GLsizei)arg2 , (GLsizei)arg3  );
+    cocos2d::GL::scissor((GLint)arg0 , (GLint)arg1 , (GLsizei)arg2 , (GLsizei)arg3  );
     args.rval().setUndefined();
     return true;
 }
@@ -1163,7 +1164,7 @@ bool JSB_glStencilFunc(JSContext *cx, uint32_t argc, jsval *vp) {
     ok &= jsval_to_uint32( cx, args.get(2), &arg2 );
     JSB_PRECONDITION2(ok, cx, false, "Error processing arguments");
 
-    glStencilFunc((GLenum)arg0 , (GLint)arg1 , (GLuint)arg2  );
+    cocos2d::GL::stencilFunc((GLenum)arg0 , (GLint)arg1 , (GLuint)arg2  );
     args.rval().setUndefined();
     return true;
 }
@@ -1198,7 +1199,7 @@ bool JSB_glStencilMask(JSContext *cx, uint32_t argc, jsval *vp) {
     ok &= jsval_to_uint32( cx, args.get(0), &arg0 );
     JSB_PRECONDITION2(ok, cx, false, "Error processing arguments");
 
-    glStencilMask((GLuint)arg0  );
+    cocos2d::GL::stencilMask((GLuint)arg0  );
     args.rval().setUndefined();
     return true;
 }
@@ -1233,7 +1234,7 @@ bool JSB_glStencilOp(JSContext *cx, uint32_t argc, jsval *vp) {
     ok &= jsval_to_uint32( cx, args.get(2), &arg2 );
     JSB_PRECONDITION2(ok, cx, false, "Error processing arguments");
 
-    glStencilOp((GLenum)arg0 , (GLenum)arg1 , (GLenum)arg2  );
+    cocos2d::GL::stencilOp((GLenum)arg0 , (GLenum)arg1 , (GLenum)arg2  );
     args.rval().setUndefined();
     return true;
 }
@@ -1079,7 +1079,7 @@ static int tolua_Cocos2d_glCullFace00(lua_State* tolua_S)
 #endif
     {
         unsigned int mode   = (unsigned int)tolua_tonumber(tolua_S,1,0);
-        glCullFace((GLenum)mode  );
+        GL::cullFace((GLenum)mode  );
     }
     return 0;
 #ifndef TOLUA_RELEASE
@@ -1261,7 +1261,7 @@ static int tolua_Cocos2d_glDepthFunc00(lua_State* tolua_S)
 #endif
     {
         unsigned int func   = (unsigned int)tolua_tonumber(tolua_S,1,0);
-        glDepthFunc((GLenum)func);
+        GL::depthFunc((GLenum)func);
     }
     return 0;
 #ifndef TOLUA_RELEASE
@@ -1287,7 +1287,7 @@ static int tolua_Cocos2d_glDepthMask00(lua_State* tolua_S)
 #endif
     {
         unsigned char flag   = (unsigned char)tolua_tonumber(tolua_S,1,0);
-        glDepthMask((GLboolean)flag  );
+        GL::depthMask((GLboolean)flag  );
     }
     return 0;
 #ifndef TOLUA_RELEASE
@@ -1369,7 +1369,7 @@ static int tolua_Cocos2d_glDisable00(lua_State* tolua_S)
 #endif
     {
         unsigned int cap   = (unsigned int)tolua_tonumber(tolua_S,1,0);
-        glDisable((GLenum)cap );
+        GL::disable((GLenum)cap );
     }
     return 0;
 #ifndef TOLUA_RELEASE
@@ -1552,7 +1552,7 @@ static int tolua_Cocos2d_glEnable00(lua_State* tolua_S)
 #endif
     {
         unsigned int cap   = (unsigned int)tolua_tonumber(tolua_S,1,0);
-        glEnable((GLenum)cap);
+        GL::enable((GLenum)cap);
     }
     return 0;
 #ifndef TOLUA_RELEASE
@@ -1718,7 +1718,7 @@ static int tolua_Cocos2d_glFrontFace00(lua_State* tolua_S)
 #endif
     {
         unsigned int mode = (unsigned int)tolua_tonumber(tolua_S, 1, 0);
-        glFrontFace((GLenum)mode);
+        GL::frontFace((GLenum)mode);
     }
     return 0;
 #ifndef TOLUA_RELEASE
@@ -2864,7 +2864,7 @@ static int tolua_Cocos2d_glScissor00(lua_State* tolua_S)
         int arg1 = (int)tolua_tonumber(tolua_S, 2, 0);
         int arg2 = (int)tolua_tonumber(tolua_S, 3, 0);
         int arg3 = (int)tolua_tonumber(tolua_S, 4, 0);
-        glScissor((GLint)arg0 , (GLint)arg1 , (GLsizei)arg2 , (GLsizei)arg3  );
+        GL::scissor((GLint)arg0 , (GLint)arg1 , (GLsizei)arg2 , (GLsizei)arg3  );
     }
     return 0;
 #ifndef TOLUA_RELEASE
@@ -2922,7 +2922,7 @@ static int tolua_Cocos2d_glStencilFunc00(lua_State* tolua_S)
         unsigned int arg0 = (unsigned int)tolua_tonumber(tolua_S, 1, 0);
         int arg1 = (int)tolua_tonumber(tolua_S, 2, 0);
         unsigned int arg2 = (unsigned int)tolua_tonumber(tolua_S, 3, 0);
-        glStencilFunc((GLenum)arg0 , (GLint)arg1 , (GLuint)arg2  );
+        GL::stencilFunc((GLenum)arg0 , (GLint)arg1 , (GLuint)arg2  );
     }
     return 0;
 #ifndef TOLUA_RELEASE
@@ -2980,7 +2980,7 @@ static int tolua_Cocos2d_glStencilMask00(lua_State* tolua_S)
 #endif
     {
         unsigned int arg0 = (unsigned int)tolua_tonumber(tolua_S, 1, 0);
-        glStencilMask((GLuint)arg0);
+        GL::stencilMask((GLuint)arg0);
     }
     return 0;
 #ifndef TOLUA_RELEASE
@@ -3038,7 +3038,7 @@ static int tolua_Cocos2d_glStencilOp00(lua_State* tolua_S)
         unsigned int arg0 = (unsigned int)tolua_tonumber(tolua_S, 1, 0);
         unsigned int arg1 = (unsigned int)tolua_tonumber(tolua_S, 2, 0);
         unsigned int arg2 = (unsigned int)tolua_tonumber(tolua_S, 3, 0);
-        glStencilOp((GLenum)arg0 , (GLenum)arg1 , (GLenum)arg2  );
+        GL::stencilOp((GLenum)arg0 , (GLenum)arg1 , (GLenum)arg2  );
     }
     return 0;
 #ifndef TOLUA_RELEASE
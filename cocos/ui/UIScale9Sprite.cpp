@@ -864,6 +864,7 @@ namespace ui {
 
         //we must invalid the transform when toggling scale9enabled
         _transformUpdated = _transformDirty = _inverseDirty = true;
+        markTransformChanged();
 
         if (_scale9Enabled)
         {
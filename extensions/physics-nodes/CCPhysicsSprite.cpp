@@ -444,6 +444,7 @@ void PhysicsSprite::afterUpdate(EventCustom *event)
     
     _transformDirty = false;
     _transformUpdated = true;
+    markTransformChanged();
     setDirtyRecursively(true);
 }
 
@@ -40,6 +40,8 @@ NewRendererTests::NewRendererTests()
     ADD_TEST_CASE(RendererBatchQuadTri);
     ADD_TEST_CASE(RendererUniformBatch);
     ADD_TEST_CASE(RendererUniformBatch2);
+    ADD_TEST_CASE(RendererParallelVisit);
+    ADD_TEST_CASE(RendererMultiTextureBatch);
 };
 
 std::string MultiSceneTest::title() const
@@ -773,3 +775,101 @@ std::string RendererUniformBatch2::subtitle() const
 {
     return "Mixing different shader states should work ok";
 }
+
+//
+//
+// RendererParallelVisit
+//
+
+RendererParallelVisit::RendererParallelVisit()
+{
+    Size s = Director::getInstance()->getWinSize();
+
+    auto layers = Node::create();
+    layers->setParallelVisitEnabled(true);
+    addChild(layers);
+
+    for (int l=0; l<8; ++l)
+    {
+        auto layer = Node::create();
+        layers->addChild(layer, l - 4);
+
+        for (int i=0; i<250; ++i)
+        {
+            auto sprite = Sprite::create("Images/grossini_dance_01.png");
+            sprite->setPosition(Vec2(CCRANDOM_0_1() * s.width, CCRANDOM_0_1() * s.height));
+            sprite->setColor(l % 2 ? Color3B::RED : Color3B::GREEN);
+            sprite->runAction(RepeatForever::create(RotateBy::create(2, 360)));
+            layer->addChild(sprite);
+        }
+    }
+}
+
+void RendererParallelVisit::onEnter()
+{
+    MultiSceneTest::onEnter();
+    Director::getInstance()->getRenderer()->setRecordingThreadCount(3);
+}
+
+void RendererParallelVisit::onExit()
+{
+    Director::getInstance()->getRenderer()->setRecordingThreadCount(0);
+    MultiSceneTest::onExit();
+}
+
+std::string RendererParallelVisit::title() const
+{
+    return "RendererParallelVisit";
+}
+
+std::string RendererParallelVisit::subtitle() const
+{
+    return "8 layers of sprites visited by 4 threads";
+}
+
+//
+// RendererMultiTextureBatch
+//
+
+RendererMultiTextureBatch::RendererMultiTextureBatch()
+: _wasEnabled(false)
+{
+    Size s = Director::getInstance()->getWinSize();
+
+    // 8 textures, each column has to show another dancer: the units 4 to 7 are used too
+    const int textureCount = 8;
+    for (int t = 0; t < textureCount; ++t)
+    {
+        auto file = StringUtils::format("Images/grossini_dance_0%d.png", t + 1);
+        for (int i = 0; i < 4; ++i)
+        {
+            auto sprite = Sprite::create(file);
+            sprite->setPosition(Vec2(s.width * (t + 0.5f) / textureCount, s.height * (i + 1) / 6));
+            addChild(sprite);
+        }
+    }
+}
+
+void RendererMultiTextureBatch::onEnter()
+{
+    MultiSceneTest::onEnter();
+    auto renderer = Director::getInstance()->getRenderer();
+    _wasEnabled = renderer->isMultiTextureBatchingEnabled();
+    renderer->setMultiTextureBatchingEnabled(true);
+}
+
+void RendererMultiTextureBatch::onExit()
+{
+    Director::getInstance()->getRenderer()->setMultiTextureBatchingEnabled(_wasEnabled);
+    MultiSceneTest::onExit();
+}
+
+std::string RendererMultiTextureBatch::title() const
+{
+    return "RendererMultiTextureBatch";
+}
+
+std::string RendererMultiTextureBatch::subtitle() const
+{
+    return "8 textures in one batch, each column shows another dancer";
+}
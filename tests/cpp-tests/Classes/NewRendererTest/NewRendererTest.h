@@ -192,4 +192,29 @@ protected:
     cocos2d::GLProgramState* createSepiaGLProgramState();
 };
 
+class RendererParallelVisit : public MultiSceneTest
+{
+public:
+    CREATE_FUNC(RendererParallelVisit);
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+    virtual void onEnter() override;
+    virtual void onExit() override;
+protected:
+    RendererParallelVisit();
+};
+
+class RendererMultiTextureBatch : public MultiSceneTest
+{
+public:
+    CREATE_FUNC(RendererMultiTextureBatch);
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+    virtual void onEnter() override;
+    virtual void onExit() override;
+protected:
+    RendererMultiTextureBatch();
+    bool _wasEnabled;
+};
+
 #endif //__NewRendererTest_H_
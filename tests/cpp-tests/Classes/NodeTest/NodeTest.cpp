@@ -71,6 +71,7 @@ CocosNodeTests::CocosNodeTests()
     ADD_TEST_CASE(NodeNormalizedPositionTest2);
     ADD_TEST_CASE(NodeNormalizedPositionBugTest);
     ADD_TEST_CASE(NodeNameTest);
+    ADD_TEST_CASE(NodeAddRemoveChildrenTest);
     ADD_TEST_CASE(Issue16100Test);
 }
 
@@ -1447,6 +1448,101 @@ void NodeNameTest::test(float dt)
     CCAssert(findChildren.size() == 50, "");
 }
 
+//------------------------------------------------------------------
+//
+// NodeAddRemoveChildrenTest
+//
+//------------------------------------------------------------------
+void NodeAddRemoveChildrenTest::onEnter()
+{
+    TestCocosNodeDemo::onEnter();
+
+    this->scheduleOnce(CC_CALLBACK_1(NodeAddRemoveChildrenTest::test, this), 0.05f, "test_key");
+}
+
+void NodeAddRemoveChildrenTest::onExit()
+{
+    TestCocosNodeDemo::onExit();
+}
+
+void NodeAddRemoveChildrenTest::test(float dt)
+{
+    // addChildren()
+    auto parent = Node::create();
+    Vector<Node*> children;
+    for (int i = 0; i < 20; ++i)
+    {
+        auto node = Node::create();
+        node->setTag(i);
+        children.pushBack(node);
+    }
+    parent->addChildren(children);
+    CCAssert(parent->getChildrenCount() == 20, "");
+    for (const auto& child : children)
+    {
+        CCAssert(child->getParent() == parent, "");
+    }
+
+    // removeChildren() keeps the order of the other children, and ignores the nodes which aren't children
+    Vector<Node*> removed;
+    for (int i = 0; i < 20; i += 2)
+    {
+        removed.pushBack(children.at(i));
+    }
+    removed.pushBack(Node::create());
+    parent->removeChildren(removed, false);
+    CCAssert(parent->getChildrenCount() == 10, "");
+    for (int i = 0; i < 10; ++i)
+    {
+        CCAssert(parent->getChildren().at(i)->getTag() == i * 2 + 1, "");
+        CCAssert(children.at(i * 2)->getParent() == nullptr, "");
+    }
+
+    // the children removed with cleanup are cleaned up at the end of the frame
+    auto node = children.at(1);
+    node->runAction(RepeatForever::create(RotateBy::create(1, 360)));
+    node->retain();
+    parent->removeChildren(Vector<Node*>{ node }, true);
+    CCAssert(parent->getChildrenCount() == 9, "");
+    CCAssert(node->getNumberOfRunningActions() == 1, "");
+    this->scheduleOnce([node](float dt) {
+        CCAssert(node->getNumberOfRunningActions() == 0, "");
+        node->release();
+    }, 0.05f, "cleanup_key");
+
+    // the particle systems left in a ParticleBatchNode keep following each other in its atlas
+    auto texture = Director::getInstance()->getTextureCache()->addImage("Images/fire.png");
+    auto batch = ParticleBatchNode::createWithTexture(texture);
+    Vector<Node*> systems;
+    for (int i = 0; i < 4; ++i)
+    {
+        auto system = ParticleSystemQuad::createWithTotalParticles(10 + i);
+        system->setTexture(texture);
+        systems.pushBack(system);
+    }
+    batch->addChildren(systems);
+    batch->removeChildren(Vector<Node*>{ systems.at(0), systems.at(2) }, true);
+
+    auto first = static_cast<ParticleSystem*>(systems.at(1));
+    auto second = static_cast<ParticleSystem*>(systems.at(3));
+    CCAssert(batch->getChildrenCount() == 2, "");
+    CCAssert(first->getAtlasIndex() == 0, "");
+    CCAssert(second->getAtlasIndex() == first->getTotalParticles(), "");
+    CCAssert(batch->getTextureAtlas()->getTotalQuads() == first->getTotalParticles() + second->getTotalParticles(), "");
+
+    log("NodeAddRemoveChildrenTest: all the checks passed");
+}
+
+std::string NodeAddRemoveChildrenTest::title() const
+{
+    return "Node::addChildren() / removeChildren()";
+}
+
+std::string NodeAddRemoveChildrenTest::subtitle() const
+{
+    return "Adds and removes several children at once. See console";
+}
+
 //------------------------------------------------------------------
 //
 // Issue16100Test
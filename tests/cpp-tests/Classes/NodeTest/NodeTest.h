@@ -330,6 +330,19 @@ public:
     void test(float dt);
 };
 
+class NodeAddRemoveChildrenTest : public TestCocosNodeDemo
+{
+public:
+    CREATE_FUNC(NodeAddRemoveChildrenTest);
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+
+    virtual void onEnter() override;
+    virtual void onExit() override;
+
+    void test(float dt);
+};
+
 class Issue16100Test : public TestCocosNodeDemo
 {
 public:
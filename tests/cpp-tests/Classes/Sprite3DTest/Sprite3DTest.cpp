@@ -70,6 +70,8 @@ Sprite3DTests::Sprite3DTests()
     ADD_TEST_CASE(Sprite3DPropertyTest);
     ADD_TEST_CASE(Sprite3DNormalMappingTest);
     ADD_TEST_CASE(Issue16155Test);
+    ADD_TEST_CASE(Sprite3DInstancingTest);
+    ADD_TEST_CASE(Sprite3DOcclusionTest);
 };
 
 //------------------------------------------------------------------
@@ -2718,3 +2720,101 @@ std::string Issue16155Test::subtitle() const
 {
     return "Should not leak texture. See console";
 }
+
+//
+// Sprite3DInstancingTest
+//
+Sprite3DInstancingTest::Sprite3DInstancingTest()
+{
+    auto s = Director::getInstance()->getWinSize();
+
+    // all the ships share the model and the texture, so they are drawn with one instanced draw call
+    const int columns = 16;
+    const int rows = 10;
+    for (int i = 0; i < columns * rows; ++i)
+    {
+        auto sprite = Sprite3D::create("Sprite3DTest/boss1.obj");
+        sprite->setTexture("Sprite3DTest/boss.png");
+        sprite->setInstancingEnabled(true);
+        sprite->setScale(1.5f);
+        sprite->setPosition(Vec2(s.width * ((i % columns) + 0.5f) / columns, s.height * ((i / columns) + 0.5f) / rows));
+        sprite->setColor(Color3B(255, 128 + (i * 7) % 128, 128 + (i * 13) % 128));
+        sprite->runAction(RepeatForever::create(RotateBy::create(3 + (i % 4), Vec3(0, 360, 0))));
+        addChild(sprite);
+    }
+}
+
+std::string Sprite3DInstancingTest::title() const
+{
+    return "Sprite3D Instancing";
+}
+
+std::string Sprite3DInstancingTest::subtitle() const
+{
+    return Configuration::getInstance()->supportsInstancing()
+        ? "160 ships drawn with one instanced draw call"
+        : "Instancing not supported, ships drawn one by one";
+}
+
+//
+// Sprite3DOcclusionTest
+//
+void Sprite3DOcclusionTest::onEnter()
+{
+    Sprite3DTestDemo::onEnter();
+
+    // a camera looking at a wall from the front, it isn't added to the scene
+    auto s = Director::getInstance()->getWinSize();
+    auto camera = Camera::createPerspective(60, s.width / s.height, 1, 1000);
+    camera->setPosition3D(Vec3(0, 0, 100));
+    camera->lookAt(Vec3(0, 0, 0));
+
+    auto wall = Node::create();
+    addChild(wall);
+
+    const AABB behind(Vec3(-5, -5, -50), Vec3(5, 5, -40));
+    const AABB inFront(Vec3(-5, -5, 20), Vec3(5, 5, 30));
+    const AABB beside(Vec3(60, -5, -50), Vec3(70, 5, -40));
+
+    OcclusionCuller culler;
+    culler.addOccluder(wall, AABB(Vec3(-20, -20, -1), Vec3(20, 20, 1)));
+    culler.prepare(camera);
+    CCAssert(culler.isOccluded(behind), "");
+    CCAssert(!culler.isOccluded(inFront), "");
+    CCAssert(!culler.isOccluded(beside), "");
+    CCAssert(culler.getCulledCount() == 1, "");
+
+    // nothing is occluded once the pass is over
+    culler.reset();
+    CCAssert(!culler.isOccluded(behind), "");
+
+    // a sprite only occludes once it is given bounds inside its meshes, its AABB is too large
+    auto renderer = Director::getInstance()->getRenderer();
+    auto rendererCuller = renderer->getOcclusionCuller();
+    auto sprite = Sprite3D::create("Sprite3DTest/boss1.obj");
+    sprite->setScale(20);
+    addChild(sprite);
+    sprite->setOccluder(true);
+    rendererCuller->prepare(camera);
+    CCAssert(!rendererCuller->isOccluded(behind), "");
+
+    sprite->setOccluderBounds(AABB(Vec3(-1, -1, -0.1f), Vec3(1, 1, 0.1f)));
+    rendererCuller->prepare(camera);
+    CCAssert(rendererCuller->isOccluded(behind), "");
+
+    sprite->setOccluder(false);
+    rendererCuller->reset();
+    CCAssert(!rendererCuller->isOccluded(behind), "");
+
+    log("Sprite3DOcclusionTest: all the checks passed");
+}
+
+std::string Sprite3DOcclusionTest::title() const
+{
+    return "Sprite3D Occlusion Culling";
+}
+
+std::string Sprite3DOcclusionTest::subtitle() const
+{
+    return "See console";
+}
@@ -624,4 +624,22 @@ public:
     virtual std::string subtitle() const override;
 };
 
+class Sprite3DInstancingTest : public Sprite3DTestDemo
+{
+public:
+    CREATE_FUNC(Sprite3DInstancingTest);
+    Sprite3DInstancingTest();
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+};
+
+class Sprite3DOcclusionTest : public Sprite3DTestDemo
+{
+public:
+    CREATE_FUNC(Sprite3DOcclusionTest);
+    virtual void onEnter() override;
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+};
+
 #endif
@@ -8,6 +8,7 @@ USING_NS_CC;
 TextureCacheTests::TextureCacheTests()
 {
     ADD_TEST_CASE(TextureCacheTest);
+    ADD_TEST_CASE(TextureCacheDynamicAtlasTest);
 }
 
 TextureCacheTest::TextureCacheTest()
@@ -130,3 +131,62 @@ void TextureCacheTest::addSprite()
     this->addChild(s14);
     this->addChild(s15);
 }
+
+TextureCacheDynamicAtlasTest::TextureCacheDynamicAtlasTest()
+{
+    auto textureCache = Director::getInstance()->getTextureCache();
+    _dynamicAtlasEnabled = textureCache->isDynamicAtlasEnabled();
+    textureCache->setDynamicAtlasEnabled(true);
+
+    // loaded again, to be packed
+    textureCache->removeTextureForKey("Images/grossini_dance_01.png");
+
+    auto dynamicAtlas = textureCache->getDynamicAtlas();
+    auto texture = textureCache->addImage("Images/grossini_dance_01.png");
+    Rect rect(Vec2::ZERO, texture->getContentSizeInPixels());
+    auto page = dynamicAtlas->getPage(texture, &rect);
+    if (!page)
+    {
+        log("TextureCacheDynamicAtlasTest: the image isn't packed, it isn't RGBA8888");
+        return;
+    }
+
+    auto size = Director::getInstance()->getWinSize();
+    auto sprite = Sprite::create("Images/grossini_dance_01.png");
+    sprite->setPosition(Vec2(size.width / 2, size.height / 2));
+    this->addChild(sprite);
+    CCAssert(sprite->getTexture() == page, "");
+
+    // reloading the image updates its region in place
+    const auto textureCount = dynamicAtlas->getTextureCount();
+    textureCache->reloadTexture("Images/grossini_dance_01.png");
+    Rect reloadedRect(Vec2::ZERO, texture->getContentSizeInPixels());
+    CCAssert(dynamicAtlas->getPage(texture, &reloadedRect) == page, "");
+    CCAssert(reloadedRect.equals(rect), "");
+    CCAssert(dynamicAtlas->getTextureCount() == textureCount, "");
+
+    // the sprite draws the page, so the image isn't unused
+    textureCache->removeUnusedTextures();
+    CCAssert(textureCache->getTextureForKey("Images/grossini_dance_01.png") == texture, "");
+    CCAssert(textureCache->addImage("Images/grossini_dance_01.png") == texture, "");
+    CCAssert(dynamicAtlas->getTextureCount() == textureCount, "");
+
+    log("TextureCacheDynamicAtlasTest: all the checks passed");
+}
+
+void TextureCacheDynamicAtlasTest::onExit()
+{
+    TestCase::onExit();
+
+    Director::getInstance()->getTextureCache()->setDynamicAtlasEnabled(_dynamicAtlasEnabled);
+}
+
+std::string TextureCacheDynamicAtlasTest::title() const
+{
+    return "Dynamic atlas";
+}
+
+std::string TextureCacheDynamicAtlasTest::subtitle() const
+{
+    return "Reloads a packed image and removes the unused textures. See console";
+}
@@ -25,4 +25,19 @@ private:
     int _numberOfLoadedSprites;
 };
 
+class TextureCacheDynamicAtlasTest : public TestCase
+{
+public:
+    CREATE_FUNC(TextureCacheDynamicAtlasTest);
+
+    TextureCacheDynamicAtlasTest();
+
+    virtual void onExit() override;
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+
+private:
+    bool _dynamicAtlasEnabled;
+};
+
 #endif // _TEXTURECACHE_TEST_H_
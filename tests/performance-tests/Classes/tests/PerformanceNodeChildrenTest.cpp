@@ -41,10 +41,14 @@ PerformceNodeChildrenTests::PerformceNodeChildrenTests()
 //    ADD_TEST_CASE(AddSpriteSheet);
     ADD_TEST_CASE(GetSpriteSheet);
     ADD_TEST_CASE(RemoveSprite);
+    ADD_TEST_CASE(RemoveSpritesAtOnce);
 //    ADD_TEST_CASE(RemoveSpriteSheet);
 //    ADD_TEST_CASE(ReorderSpriteSheet);
 //    ADD_TEST_CASE(SortAllChildrenSpriteSheet);
     ADD_TEST_CASE(VisitSceneGraph);
+    ADD_TEST_CASE(UpdateTransformSystem);
+    ADD_TEST_CASE(SpawnSprite);
+    ADD_TEST_CASE(SpawnPooledSprite);
 }
 
 enum {
@@ -732,6 +736,54 @@ const char*  RemoveSprite::testName()
     return "Node::removeChild()";
 }
 
+////////////////////////////////////////////////////////
+//
+// RemoveSpritesAtOnce
+//
+////////////////////////////////////////////////////////
+void RemoveSpritesAtOnce::update(float dt)
+{
+    // 100 percent
+    int totalToAdd = currentQuantityOfNodes * 1;
+
+    if( totalToAdd > 0 )
+    {
+        Vector<Node*> sprites(totalToAdd);
+
+        // Don't include the sprite creation time as part of the profiling
+        for(int i=0;i<totalToAdd;i++)
+        {
+            sprites.pushBack(Sprite::createWithTexture(batchNode->getTexture(), Rect(0,0,32,32)));
+        }
+
+        // add them with random Z (very important!)
+        for( int i=0; i < totalToAdd;i++ )
+        {
+            this->addChild( sprites.at(i), CCRANDOM_MINUS1_1() * 50, kTagBase+i);
+        }
+
+        // remove them, they are cleaned up at the end of the frame
+        CC_PROFILER_START( this->profilerName() );
+        this->removeChildren(sprites, true);
+        CC_PROFILER_STOP( this->profilerName() );
+    }
+}
+
+std::string RemoveSpritesAtOnce::title() const
+{
+    return "Node::removeChildren()";
+}
+
+std::string RemoveSpritesAtOnce::subtitle() const
+{
+    return "Remove sprites at once. See console";
+}
+
+const char*  RemoveSpritesAtOnce::testName()
+{
+    return "Node::removeChildren()";
+}
+
 ////////////////////////////////////////////////////////
 //
 // RemoveSpriteSheet
@@ -980,3 +1032,192 @@ const char*  VisitSceneGraph::testName()
 {
     return "visit()";
 }
+
+////////////////////////////////////////////////////////
+//
+// UpdateTransformSystem
+//
+////////////////////////////////////////////////////////
+UpdateTransformSystem::UpdateTransformSystem()
+: _root(nullptr)
+, _system(nullptr)
+{
+}
+
+UpdateTransformSystem::~UpdateTransformSystem()
+{
+    delete _system;
+}
+
+void UpdateTransformSystem::initWithQuantityOfNodes(unsigned int nodes)
+{
+    _root = Node::create();
+    this->addChild(_root);
+    _system = new (std::nothrow) TransformSystem(_root);
+
+    NodeChildrenMainScene::initWithQuantityOfNodes(nodes);
+    scheduleUpdate();
+}
+
+void UpdateTransformSystem::updateQuantityOfNodes()
+{
+    auto s = Director::getInstance()->getWinSize();
+
+    // groups of 10 nodes, like the parts of the characters of a game
+    _root->removeAllChildren();
+    Node* group = nullptr;
+    for (int i = 0; i < quantityOfNodes; ++i)
+    {
+        if (i % 10 == 0)
+        {
+            group = Node::create();
+            group->setPosition(Vec2(CCRANDOM_0_1() * s.width, CCRANDOM_0_1() * s.height));
+            _root->addChild(group);
+        }
+        auto node = Node::create();
+        node->setPosition(Vec2(CCRANDOM_MINUS1_1() * 50, CCRANDOM_MINUS1_1() * 50));
+        group->addChild(node);
+    }
+
+    currentQuantityOfNodes = quantityOfNodes;
+}
+
+void UpdateTransformSystem::update(float dt)
+{
+    // 1 percent of the nodes move, the others shouldn't cost anything
+    const auto& groups = _root->getChildren();
+    for (ssize_t i = 0, count = groups.size(); i < count; i += 10)
+    {
+        auto node = groups.at(i)->getChildren().at(0);
+        node->setRotation(node->getRotation() + dt * 90);
+    }
+
+    CC_PROFILER_START( this->profilerName() );
+    _system->update(Mat4::IDENTITY);
+    CC_PROFILER_STOP( this->profilerName() );
+}
+
+std::string UpdateTransformSystem::title() const
+{
+    return "TransformSystem::update()";
+}
+
+std::string UpdateTransformSystem::subtitle() const
+{
+    return "1% of the nodes move. See console";
+}
+
+const char*  UpdateTransformSystem::testName()
+{
+    return "TransformSystem::update()";
+}
+
+////////////////////////////////////////////////////////
+//
+// SpawnSprite
+//
+////////////////////////////////////////////////////////
+void SpawnSprite::update(float dt)
+{
+    auto s = Director::getInstance()->getWinSize();
+
+    // 100 percent
+    int totalToAdd = currentQuantityOfNodes * 1;
+
+    if( totalToAdd > 0 )
+    {
+        std::vector<Sprite*> sprites(totalToAdd);
+
+        // creates them, as bullets or hit effects are spawned
+        CC_PROFILER_START( this->profilerName() );
+        for( int i=0; i < totalToAdd;i++ )
+        {
+            sprites[i] = Sprite::createWithTexture(batchNode->getTexture(), Rect(0,0,32,32));
+            sprites[i]->setPosition(Vec2( CCRANDOM_0_1()*s.width, CCRANDOM_0_1()*s.height));
+            this->addChild( sprites[i], 0, kTagBase+i);
+        }
+
+        for( int i=0;i <  totalToAdd;i++)
+        {
+            this->removeChild( sprites[i], true);
+        }
+        CC_PROFILER_STOP( this->profilerName() );
+    }
+}
+
+std::string SpawnSprite::title() const
+{
+    return "Sprite::create()";
+}
+
+std::string SpawnSprite::subtitle() const
+{
+    return "Creates, adds and removes sprites. See console";
+}
+
+const char*  SpawnSprite::testName()
+{
+    return "Sprite::create()";
+}
+
+////////////////////////////////////////////////////////
+//
+// SpawnPooledSprite
+//
+////////////////////////////////////////////////////////
+SpawnPooledSprite::SpawnPooledSprite()
+: _pool([this]() { return Sprite::createWithTexture(batchNode->getTexture(), Rect(0,0,32,32)); }, kMaxNodes)
+{
+}
+
+void SpawnPooledSprite::update(float dt)
+{
+    auto s = Director::getInstance()->getWinSize();
+
+    // 100 percent
+    int totalToAdd = currentQuantityOfNodes * 1;
+
+    if( totalToAdd > 0 )
+    {
+        std::vector<Sprite*> sprites(totalToAdd);
+
+        // takes them from the pool, which creates them on the first frame only
+        CC_PROFILER_START( this->profilerName() );
+        for( int i=0; i < totalToAdd;i++ )
+        {
+            sprites[i] = _pool.get();
+            sprites[i]->setPosition(Vec2( CCRANDOM_0_1()*s.width, CCRANDOM_0_1()*s.height));
+            this->addChild( sprites[i], 0, kTagBase+i);
+        }
+
+        for( int i=0;i <  totalToAdd;i++)
+        {
+            _pool.put(sprites[i]);
+        }
+        CC_PROFILER_STOP( this->profilerName() );
+    }
+}
+
+void SpawnPooledSprite::onExitTransitionDidStart()
+{
+    AddRemoveSpriteSheet::onExitTransitionDidStart();
+
+    const auto& stats = _pool.getStats();
+    log("NodePool: %u created, %u reused, %u unused, %u discarded, peak size %d",
+        stats.created, stats.reused, stats.unused, stats.discarded, (int)stats.peakSize);
+}
+
+std::string SpawnPooledSprite::title() const
+{
+    return "NodePool<Sprite>::get()";
+}
+
+std::string SpawnPooledSprite::subtitle() const
+{
+    return "Takes sprites from a pool, adds them and puts them back. See console";
+}
+
+const char*  SpawnPooledSprite::testName()
+{
+    return "NodePool<Sprite>::get()";
+}
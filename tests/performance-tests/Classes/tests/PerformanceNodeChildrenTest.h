@@ -168,6 +168,18 @@ public:
     virtual const char* testName()override;
 };
 
+class RemoveSpritesAtOnce : public AddRemoveSpriteSheet
+{
+public:
+    CREATE_FUNC(RemoveSpritesAtOnce);
+
+    virtual void update(float dt) override;
+
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+    virtual const char* testName()override;
+};
+
 class RemoveSpriteSheet : public AddRemoveSpriteSheet
 {
 public:
@@ -204,6 +216,35 @@ public:
     virtual const char* testName()override;
 };
 
+class SpawnSprite : public AddRemoveSpriteSheet
+{
+public:
+    CREATE_FUNC(SpawnSprite);
+
+    virtual void update(float dt) override;
+
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+    virtual const char* testName() override;
+};
+
+class SpawnPooledSprite : public AddRemoveSpriteSheet
+{
+public:
+    CREATE_FUNC(SpawnPooledSprite);
+
+    SpawnPooledSprite();
+    virtual void update(float dt) override;
+    virtual void onExitTransitionDidStart() override;
+
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+    virtual const char* testName() override;
+
+protected:
+    cocos2d::NodePool<cocos2d::Sprite> _pool;
+};
+
 class VisitSceneGraph : public NodeChildrenMainScene
 {
 public:
@@ -218,4 +259,24 @@ public:
     virtual const char* testName() override;
 };
 
+class UpdateTransformSystem : public NodeChildrenMainScene
+{
+public:
+    CREATE_FUNC(UpdateTransformSystem);
+
+    UpdateTransformSystem();
+    virtual ~UpdateTransformSystem();
+    void initWithQuantityOfNodes(unsigned int nodes) override;
+
+    virtual void update(float dt) override;
+    void updateQuantityOfNodes() override;
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+    virtual const char* testName() override;
+
+protected:
+    cocos2d::Node* _root;
+    cocos2d::TransformSystem* _system;
+};
+
 #endif // __PERFORMANCE_NODE_CHILDREN_TEST_H__
@@ -6,6 +6,7 @@ USING_NS_CC;
 PerformceTextureTests::PerformceTextureTests()
 {
     ADD_TEST_CASE(TexturePerformceTest);
+    ADD_TEST_CASE(TexturePixelConversionTest);
 }
 
 static float calculateDeltaTime( struct timeval *lastUpdate )
@@ -332,3 +333,211 @@ std::string TexturePerformceTest::subtitle() const
 {
     return "See console for results";
 }
+
+////////////////////////////////////////////////////////
+//
+// TexturePixelConversionTest
+//
+////////////////////////////////////////////////////////
+static const char* pixelFormatName(Texture2D::PixelFormat format)
+{
+    switch (format)
+    {
+        case Texture2D::PixelFormat::RGBA8888: return "RGBA8888";
+        case Texture2D::PixelFormat::RGB888: return "RGB888";
+        case Texture2D::PixelFormat::RGB565: return "RGB565";
+        case Texture2D::PixelFormat::RGBA4444: return "RGBA4444";
+        case Texture2D::PixelFormat::RGB5A1: return "RGB5A1";
+        case Texture2D::PixelFormat::AI88: return "AI88";
+        case Texture2D::PixelFormat::A8: return "A8";
+        case Texture2D::PixelFormat::I8: return "I8";
+        default: return "unknown";
+    }
+}
+
+// converts the pixels with the scalar and the SIMD converters, logs and returns false if they differ
+static bool compareConversion(const unsigned char* data, ssize_t dataLen, Texture2D::PixelFormat from, Texture2D::PixelFormat to, ssize_t pixels)
+{
+    unsigned char* outData[2] = { nullptr, nullptr };
+    ssize_t outDataLen[2] = { 0, 0 };
+    for (int useSIMD = 0; useSIMD < 2; ++useSIMD)
+    {
+        Texture2D::setSIMDConversionEnabled(useSIMD != 0);
+        Texture2D::convertDataToFormat(data, dataLen, from, to, &outData[useSIMD], &outDataLen[useSIMD]);
+    }
+
+    // same format or unsupported conversion
+    if (outData[0] == data)
+        return true;
+
+    const bool same = outDataLen[0] == outDataLen[1] && memcmp(outData[0], outData[1], outDataLen[0]) == 0;
+    if (!same)
+        log("MISMATCH %s -> %s, %d pixels: the scalar and SIMD conversions differ", pixelFormatName(from), pixelFormatName(to), (int)pixels);
+
+    free(outData[0]);
+    free(outData[1]);
+    return same;
+}
+
+static bool comparePremultiplyAlpha(const unsigned char* data, ssize_t dataLen)
+{
+    std::vector<unsigned char> result[2];
+    for (int useSIMD = 0; useSIMD < 2; ++useSIMD)
+    {
+        result[useSIMD].assign(data, data + dataLen);
+        Texture2D::setSIMDConversionEnabled(useSIMD != 0);
+        Texture2D::premultiplyAlpha(result[useSIMD].data(), dataLen);
+    }
+
+    const bool same = result[0] == result[1];
+    if (!same)
+        log("MISMATCH premultiply alpha, %d pixels: the scalar and SIMD results differ", (int)(dataLen / 4));
+    return same;
+}
+
+void TexturePixelConversionTest::performTests()
+{
+    if (isAutoTesting()) {
+        Profile::getInstance()->testCaseBegin("TexturePixelConversionTest",
+                                              genStrVector("Conversion", "Instructions", nullptr),
+                                              genStrVector("Time", nullptr));
+    }
+
+    const std::string simdName = Texture2D::getSIMDConversionName();
+    const char* simd = simdName.empty() ? "none" : simdName.c_str();
+    log("--- 2048x2048 pixel conversions, scalar and %s ---", simd);
+
+    // a 2048x2048 atlas of noise
+    const ssize_t pixels = 2048 * 2048;
+    std::vector<unsigned char> rgba(pixels * 4);
+    unsigned int seed = 1;
+    for (auto& byte : rgba)
+    {
+        seed = seed * 1103515245 + 12345;
+        byte = (unsigned char)(seed >> 16);
+    }
+
+    const Texture2D::PixelFormat formats[] = {
+        Texture2D::PixelFormat::RGBA8888, Texture2D::PixelFormat::RGB888, Texture2D::PixelFormat::AI88, Texture2D::PixelFormat::I8,
+        Texture2D::PixelFormat::RGB565, Texture2D::PixelFormat::RGBA4444, Texture2D::PixelFormat::RGB5A1, Texture2D::PixelFormat::A8
+    };
+    // pixel counts which aren't multiples of the vector widths, so the tails of the kernels are compared too
+    const ssize_t tailPixels[] = { 1, 2, 3, 5, 7, 9, 15, 17, 31, 33, 63, 65, 1021 };
+    int mismatches = 0;
+
+    struct timeval now;
+    for (int i = 0; i < 4; ++i)
+    {
+        const auto from = formats[i];
+        unsigned char* source = rgba.data();
+        ssize_t sourceLen = rgba.size();
+        if (from != Texture2D::PixelFormat::RGBA8888)
+            Texture2D::convertDataToFormat(rgba.data(), rgba.size(), Texture2D::PixelFormat::RGBA8888, from, &source, &sourceLen);
+        const ssize_t bytesPerPixel = sourceLen / pixels;
+
+        for (const auto to : formats)
+        {
+            float times[2];
+            unsigned char* outData[2] = { nullptr, nullptr };
+            ssize_t outDataLen[2] = { 0, 0 };
+            for (int useSIMD = 0; useSIMD < 2; ++useSIMD)
+            {
+                Texture2D::setSIMDConversionEnabled(useSIMD != 0);
+                gettimeofday(&now, nullptr);
+                Texture2D::convertDataToFormat(source, sourceLen, from, to, &outData[useSIMD], &outDataLen[useSIMD]);
+                times[useSIMD] = calculateDeltaTime(&now) * 1000;
+            }
+
+            // same format or unsupported conversion
+            if (outData[0] == source)
+                continue;
+
+            const std::string conversion = StringUtils::format("%s -> %s", pixelFormatName(from), pixelFormatName(to));
+            if (outDataLen[0] != outDataLen[1] || memcmp(outData[0], outData[1], outDataLen[0]) != 0)
+            {
+                log("MISMATCH %s, %d pixels: the scalar and SIMD conversions differ", conversion.c_str(), (int)pixels);
+                ++mismatches;
+            }
+            free(outData[0]);
+            free(outData[1]);
+
+            for (const auto count : tailPixels)
+            {
+                if (!compareConversion(source, count * bytesPerPixel, from, to, count))
+                    ++mismatches;
+            }
+
+            log("%s: scalar %.2fms, %s %.2fms", conversion.c_str(), times[0], simd, times[1]);
+            if (isAutoTesting())
+            {
+                Profile::getInstance()->addTestResult(genStrVector(conversion.c_str(), "scalar", nullptr),
+                                                      genStrVector(genStr("%fms", times[0]).c_str(), nullptr));
+                Profile::getInstance()->addTestResult(genStrVector(conversion.c_str(), simd, nullptr),
+                                                      genStrVector(genStr("%fms", times[1]).c_str(), nullptr));
+            }
+        }
+
+        if (source != rgba.data())
+            free(source);
+    }
+
+    float times[2];
+    std::vector<unsigned char> premultiplied[2];
+    for (int useSIMD = 0; useSIMD < 2; ++useSIMD)
+    {
+        premultiplied[useSIMD] = rgba;
+        Texture2D::setSIMDConversionEnabled(useSIMD != 0);
+        gettimeofday(&now, nullptr);
+        Texture2D::premultiplyAlpha(premultiplied[useSIMD].data(), premultiplied[useSIMD].size());
+        times[useSIMD] = calculateDeltaTime(&now) * 1000;
+    }
+    if (premultiplied[0] != premultiplied[1])
+    {
+        log("MISMATCH premultiply alpha, %d pixels: the scalar and SIMD results differ", (int)pixels);
+        ++mismatches;
+    }
+    for (const auto count : tailPixels)
+    {
+        if (!comparePremultiplyAlpha(rgba.data(), count * 4))
+            ++mismatches;
+    }
+
+    log("premultiply alpha: scalar %.2fms, %s %.2fms", times[0], simd, times[1]);
+    if (isAutoTesting())
+    {
+        Profile::getInstance()->addTestResult(genStrVector("premultiply alpha", "scalar", nullptr),
+                                              genStrVector(genStr("%fms", times[0]).c_str(), nullptr));
+        Profile::getInstance()->addTestResult(genStrVector("premultiply alpha", simd, nullptr),
+                                              genStrVector(genStr("%fms", times[1]).c_str(), nullptr));
+    }
+
+    Texture2D::setSIMDConversionEnabled(true);
+
+    if (mismatches > 0)
+        log("--- %d scalar and %s results differ ---", mismatches, simd);
+    else
+        log("--- the scalar and %s results are identical ---", simd);
+
+    if (isAutoTesting())
+    {
+        Profile::getInstance()->testCaseEnd();
+        setAutoTesting(false);
+    }
+}
+
+void TexturePixelConversionTest::onEnter()
+{
+    TestCase::onEnter();
+
+    performTests();
+}
+
+std::string TexturePixelConversionTest::title() const
+{
+    return "Pixel Format Conversion Test";
+}
+
+std::string TexturePixelConversionTest::subtitle() const
+{
+    return "See console for results";
+}
@@ -18,4 +18,16 @@ public:
     virtual void onEnter() override;
 };
 
+class TexturePixelConversionTest : public TestCase
+{
+public:
+    CREATE_FUNC(TexturePixelConversionTest);
+
+    void performTests();
+
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+    virtual void onEnter() override;
+};
+
 #endif